@@ -0,0 +1,168 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <bench/util/suite.hh>
+
+namespace
+{
+
+void print_usage_(char const* const program)
+{
+  ::std::printf(
+    "Usage: %s [options]\n"
+    "  --filter=TEXT        run measurements whose suite/workload/subject\n"
+    "                       name contains TEXT\n"
+    "  --sizes=N[,N...]     element counts, e.g. 1e3,1e6,1e8\n"
+    "                       (default 1e3,1e4,1e5,1e6)\n"
+    "  --min-ops=N          repeat small workloads up to N operations\n"
+    "                       (default 1e6)\n"
+    "  --linear-limit=N     largest size for O(n) mutations (default 1e5)\n"
+    "  --trace=FILE         replay a recorded trace where a suite supports it\n"
+    "  --list               list the suites and exit\n",
+    program);
+}
+
+// Accepts plain and scientific notation, such as 100000 or 1e5.
+bool parse_count_(char const* const text, ::std::size_t& count)
+{
+  char* end = nullptr;
+  double const value = ::std::strtod(text, &end);
+  if(end == text || 0.0 > value || 1e15 < value)
+  {
+    return false;
+  }
+
+  count = static_cast<::std::size_t>(value);
+  return true;
+}
+
+bool parse_sizes_(char const* text, ::std::vector<::std::size_t>& sizes)
+{
+  sizes.clear();
+  for(;;)
+  {
+    ::std::size_t size = 0u;
+    if(!parse_count_(text, size) || 0u == size)
+    {
+      return false;
+    }
+
+    sizes.push_back(size);
+    text = ::std::strchr(text, ',');
+    if(nullptr == text)
+    {
+      return true;
+    }
+    ++text;
+  }
+}
+
+bool starts_with_(char const* const arg, char const* const prefix)
+{
+  return 0 == ::std::strncmp(arg, prefix, ::std::strlen(prefix));
+}
+
+} // namespace
+
+int main(int const argc, char** const argv)
+{
+  using ::bench::util::Context;
+  using ::bench::util::Registry;
+
+  ::bench::util::Options options;
+  options.sizes = {1000u, 10000u, 100000u, 1000000u};
+  options.min_ops = 1000000u;
+  options.linear_limit = 100000u;
+
+  for(int i = 1; argc > i; ++i)
+  {
+    char const* const arg = argv[i];
+    bool ok = true;
+    if(starts_with_(arg, "--filter="))
+    {
+      options.filter = arg + ::std::strlen("--filter=");
+    }
+    else if(starts_with_(arg, "--sizes="))
+    {
+      ok = parse_sizes_(arg + ::std::strlen("--sizes="), options.sizes);
+    }
+    else if(starts_with_(arg, "--min-ops="))
+    {
+      ok = parse_count_(arg + ::std::strlen("--min-ops="), options.min_ops);
+    }
+    else if(starts_with_(arg, "--linear-limit="))
+    {
+      ok = parse_count_(
+        arg + ::std::strlen("--linear-limit="), options.linear_limit);
+    }
+    else if(starts_with_(arg, "--trace="))
+    {
+      options.trace = arg + ::std::strlen("--trace=");
+    }
+    else if(0 == ::std::strcmp(arg, "--list"))
+    {
+      for(Registry::Suite const& suite: Registry::suites())
+      {
+        ::std::printf("%s\n", suite.name);
+      }
+      return EXIT_SUCCESS;
+    }
+    else if(0 == ::std::strcmp(arg, "--help"))
+    {
+      print_usage_(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    else
+    {
+      ok = false;
+    }
+
+    if(!ok)
+    {
+      ::std::fprintf(stderr, "Invalid argument: %s\n", arg);
+      print_usage_(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  Context::print_header();
+  ::std::uint64_t checksum = 0u;
+  for(Registry::Suite const& suite: Registry::suites())
+  {
+    Context ctx(options, suite.name);
+    suite.run(ctx);
+    checksum += ctx.checksum();
+  }
+
+  // Printing the results keeps the measured work observable.
+  ::std::printf("# checksum %llu\n", static_cast<unsigned long long>(checksum));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_TREEXX_AVL_TREE_HH
+#define BENCH_TREEXX_AVL_TREE_HH
+
+#include <cstdint>
+#include <type_traits>
+
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace bench::treexx
+{
+
+// Bare node for driving Tree_algo directly, the way an intrusive user would.
+// value holds the key of a search tree, or the relative offset of an offset
+// tree.
+struct Avl_node
+{
+  using Side = ::treexx::bin::Side;
+  using Balance = ::treexx::bin::avl::Balance;
+
+  Avl_node* parent = nullptr;
+  Avl_node* left_child = nullptr;
+  Avl_node* right_child = nullptr;
+  ::std::uint64_t value = 0u;
+  Balance balance = Balance::poised;
+  Side side = Side::left;
+};
+
+// Tree adapter owning its nodes. With with_offset, value is exposed as the
+// node offset and the tree becomes an offset tree.
+template<bool with_offset>
+class Avl_tree
+{
+public:
+  using Offset =
+    typename ::std::conditional<with_offset, ::std::uint64_t, void>::type;
+  using Side = ::treexx::bin::Side;
+  using Balance = ::treexx::bin::avl::Balance;
+
+  Avl_tree() = default;
+  Avl_tree(Avl_tree&&) = delete;
+  Avl_tree(Avl_tree const&) = delete;
+
+  ~Avl_tree()
+  {
+    clear();
+  }
+
+  Avl_tree& operator =(Avl_tree&&) = delete;
+  Avl_tree& operator =(Avl_tree const&) = delete;
+
+  void clear() noexcept
+  {
+    ::treexx::bin::Tree_algo::clear(
+      *this,
+      [](Avl_node* const node_ptr)
+      {
+        delete node_ptr;
+      });
+    root_ptr_ = nullptr;
+    leftmost_ptr_ = nullptr;
+    rightmost_ptr_ = nullptr;
+  }
+
+  [[nodiscard]] Avl_node* const& root() const noexcept
+  {
+    return root_ptr_;
+  }
+
+  void set_root(Avl_node* const& node_ptr) noexcept
+  {
+    root_ptr_ = node_ptr;
+  }
+
+  template<Side side>
+  [[nodiscard]] Avl_node* const& extreme() const noexcept
+  {
+    if constexpr(Side::left == side)
+    {
+      return leftmost_ptr_;
+    }
+    else
+    {
+      return rightmost_ptr_;
+    }
+  }
+
+  template<Side side>
+  void set_extreme(Avl_node* const& node_ptr) noexcept
+  {
+    if constexpr(Side::left == side)
+    {
+      leftmost_ptr_ = node_ptr;
+    }
+    else
+    {
+      rightmost_ptr_ = node_ptr;
+    }
+  }
+
+  [[nodiscard]] static Avl_node* address(Avl_node* const& node_ptr) noexcept
+  {
+    return node_ptr;
+  }
+
+  [[nodiscard]] static Avl_node* const& parent(Avl_node const& node) noexcept
+  {
+    return node.parent;
+  }
+
+  static void set_parent(Avl_node& node, Avl_node* const& parent_ptr) noexcept
+  {
+    node.parent = parent_ptr;
+  }
+
+  template<Side side>
+  [[nodiscard]] static Avl_node* const& child(Avl_node const& node) noexcept
+  {
+    if constexpr(Side::left == side)
+    {
+      return node.left_child;
+    }
+    else
+    {
+      return node.right_child;
+    }
+  }
+
+  template<Side side>
+  static void set_child(Avl_node& node, Avl_node* const& child_ptr) noexcept
+  {
+    if constexpr(Side::left == side)
+    {
+      node.left_child = child_ptr;
+    }
+    else
+    {
+      node.right_child = child_ptr;
+    }
+  }
+
+  [[nodiscard]] static Balance balance(Avl_node const& node) noexcept
+  {
+    return node.balance;
+  }
+
+  static void set_balance(Avl_node& node, Balance const balance) noexcept
+  {
+    node.balance = balance;
+  }
+
+  [[nodiscard]] static Side side(Avl_node const& node) noexcept
+  {
+    return node.side;
+  }
+
+  static void set_side(Avl_node& node, Side const side) noexcept
+  {
+    node.side = side;
+  }
+
+  // Offset accessors, only consulted when Offset names an object type.
+
+  [[nodiscard]] static ::std::uint64_t const& offset(
+    Avl_node const& node) noexcept
+  {
+    return node.value;
+  }
+
+  static void set_offset(
+    Avl_node& node,
+    ::std::uint64_t const& offset) noexcept
+  {
+    node.value = offset;
+  }
+
+  static void add_to_offset(
+    Avl_node& node,
+    ::std::uint64_t const& increment) noexcept
+  {
+    node.value += increment;
+  }
+
+  static void subtract_from_offset(
+    Avl_node& node,
+    ::std::uint64_t const& decrement) noexcept
+  {
+    node.value -= decrement;
+  }
+
+  template<unsigned offset>
+  [[nodiscard]] static ::std::uint64_t make_offset() noexcept
+  {
+    return offset;
+  }
+
+private:
+  Avl_node* root_ptr_ = nullptr;
+  Avl_node* leftmost_ptr_ = nullptr;
+  Avl_node* rightmost_ptr_ = nullptr;
+};
+
+} // namespace bench::treexx
+
+#endif // BENCH_TREEXX_AVL_TREE_HH
@@ -0,0 +1,642 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Ordered-set workloads over 64-bit keys: insert, lookup, erase and full
+// iteration, with random, sequential and Zipfian key streams, run against
+// raw Tree_algo trees, indexed_multiset and the standard containers.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <bench/treexx/avl_tree.hh>
+#include <bench/util/suite.hh>
+#include <bench/util/zipf_gen.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/indexed_multiset.hh>
+
+namespace
+{
+
+using Key = ::std::uint64_t;
+using Keys = ::std::vector<Key>;
+using ::bench::treexx::Avl_node;
+using ::bench::treexx::Avl_tree;
+using ::bench::util::Context;
+
+// Subjects share one interface: insert and erase report whether the set
+// changed, iterate returns the sum of the keys in order.
+
+class Avl_subject_
+{
+public:
+  static char constexpr name[] = "treexx avl";
+  static bool constexpr linear_mutation = false;
+
+  bool insert(Key const key)
+  {
+    using ::treexx::Compare_result;
+    using ::treexx::bin::Side;
+
+    bool inserted = false;
+    Tree_algo_::try_insert(
+      tree_,
+      [key](Avl_node const& node) noexcept -> Compare_result
+      {
+        if(node.value < key)
+        {
+          return Compare_result::less;
+        }
+        return key < node.value ?
+          Compare_result::greater : Compare_result::equal;
+      },
+      [key, &inserted](Avl_node* const& parent, Side const side)
+      {
+        auto* const node = new Avl_node;
+        node->parent = parent;
+        node->value = key;
+        node->side = side;
+        inserted = true;
+        return node;
+      });
+    return inserted;
+  }
+
+  [[nodiscard]] bool contains(Key const key) const
+  {
+    return nullptr != find_(key);
+  }
+
+  bool erase(Key const key)
+  {
+    Avl_node* const node = find_(key);
+    if(nullptr == node)
+    {
+      return false;
+    }
+
+    Tree_algo_::erase(tree_, node);
+    delete node;
+    return true;
+  }
+
+  [[nodiscard]] Key iterate() const
+  {
+    Key sum = 0u;
+    for(
+      Avl_node* node = tree_.extreme<::treexx::bin::Side::left>();
+      nullptr != node;
+      node = ::treexx::bin::Tree_algo::next_node(tree_, *node))
+    {
+      sum += node->value;
+    }
+
+    return sum;
+  }
+
+private:
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+
+  [[nodiscard]] Avl_node* find_(Key const key) const
+  {
+    Avl_node* const node = Tree_algo_::partition_point(
+      tree_,
+      [key](Avl_node const& n) noexcept
+      {
+        return n.value < key;
+      });
+    return nullptr != node && key == node->value ? node : nullptr;
+  }
+
+  Avl_tree<false> tree_;
+};
+
+// The key is the absolute offset of its node. Offsets are stored relative
+// to an ancestor, so iteration visits nodes without resolving their keys and
+// returns the node count instead.
+class Offset_subject_
+{
+public:
+  static char constexpr name[] = "treexx offset";
+  static bool constexpr linear_mutation = false;
+
+  bool insert(Key const key)
+  {
+    if(nullptr != find_(key))
+    {
+      return false;
+    }
+
+    Tree_algo_::insert_at_offset(tree_, new Avl_node, key);
+    return true;
+  }
+
+  [[nodiscard]] bool contains(Key const key) const
+  {
+    return nullptr != find_(key);
+  }
+
+  bool erase(Key const key)
+  {
+    Avl_node* const node = find_(key);
+    if(nullptr == node)
+    {
+      return false;
+    }
+
+    Tree_algo_::erase(tree_, node);
+    delete node;
+    return true;
+  }
+
+  [[nodiscard]] Key iterate() const
+  {
+    Key count = 0u;
+    ::treexx::bin::Tree_algo::for_each(
+      tree_,
+      [&count](Avl_node const&) noexcept
+      {
+        ++count;
+      });
+    return count;
+  }
+
+private:
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+
+  [[nodiscard]] Avl_node* find_(Key const key) const
+  {
+    using ::treexx::Compare_result;
+
+    return Tree_algo_::binary_search<false, false, true>(
+      tree_,
+      [key](Key const& offset) noexcept -> Compare_result
+      {
+        if(offset < key)
+        {
+          return Compare_result::less;
+        }
+        return key < offset ?
+          Compare_result::greater : Compare_result::equal;
+      });
+  }
+
+  Avl_tree<true> tree_;
+};
+
+class Indexed_multiset_subject_
+{
+public:
+  static char constexpr name[] = "indexed_multiset";
+  static bool constexpr linear_mutation = false;
+
+  bool insert(Key const key)
+  {
+    if(set_.contains(key))
+    {
+      return false;
+    }
+
+    set_.insert(key);
+    return true;
+  }
+
+  [[nodiscard]] bool contains(Key const key) const
+  {
+    return set_.contains(key);
+  }
+
+  bool erase(Key const key)
+  {
+    return 0u < set_.erase(key);
+  }
+
+  [[nodiscard]] Key iterate() const
+  {
+    Key sum = 0u;
+    for(Key const key: set_)
+    {
+      sum += key;
+    }
+
+    return sum;
+  }
+
+private:
+  ::treexx::stdxx::indexed_multiset<Key> set_;
+};
+
+class Set_subject_
+{
+public:
+  static char constexpr name[] = "std::set";
+  static bool constexpr linear_mutation = false;
+
+  bool insert(Key const key)
+  {
+    return set_.insert(key).second;
+  }
+
+  [[nodiscard]] bool contains(Key const key) const
+  {
+    return set_.end() != set_.find(key);
+  }
+
+  bool erase(Key const key)
+  {
+    return 0u < set_.erase(key);
+  }
+
+  [[nodiscard]] Key iterate() const
+  {
+    Key sum = 0u;
+    for(Key const key: set_)
+    {
+      sum += key;
+    }
+
+    return sum;
+  }
+
+private:
+  ::std::set<Key> set_;
+};
+
+class Map_subject_
+{
+public:
+  static char constexpr name[] = "std::map";
+  static bool constexpr linear_mutation = false;
+
+  bool insert(Key const key)
+  {
+    return map_.emplace(key, key).second;
+  }
+
+  [[nodiscard]] bool contains(Key const key) const
+  {
+    return map_.end() != map_.find(key);
+  }
+
+  bool erase(Key const key)
+  {
+    return 0u < map_.erase(key);
+  }
+
+  [[nodiscard]] Key iterate() const
+  {
+    Key sum = 0u;
+    for(auto const& entry: map_)
+    {
+      sum += entry.first;
+    }
+
+    return sum;
+  }
+
+private:
+  ::std::map<Key, Key> map_;
+};
+
+class Sorted_vector_subject_
+{
+public:
+  static char constexpr name[] = "sorted std::vector";
+  static bool constexpr linear_mutation = true;
+
+  bool insert(Key const key)
+  {
+    auto const it = ::std::lower_bound(keys_.begin(), keys_.end(), key);
+    if(keys_.end() != it && key == *it)
+    {
+      return false;
+    }
+
+    keys_.insert(it, key);
+    return true;
+  }
+
+  [[nodiscard]] bool contains(Key const key) const
+  {
+    return ::std::binary_search(keys_.begin(), keys_.end(), key);
+  }
+
+  bool erase(Key const key)
+  {
+    auto const it = ::std::lower_bound(keys_.begin(), keys_.end(), key);
+    if(keys_.end() == it || key != *it)
+    {
+      return false;
+    }
+
+    keys_.erase(it);
+    return true;
+  }
+
+  [[nodiscard]] Key iterate() const
+  {
+    Key sum = 0u;
+    for(Key const key: keys_)
+    {
+      sum += key;
+    }
+
+    return sum;
+  }
+
+private:
+  Keys keys_;
+};
+
+template<class T>
+struct Type_
+{
+  using Type = T;
+};
+
+template<class Fun>
+void for_each_subject_(Fun&& fun)
+{
+  fun(Type_<Avl_subject_>());
+  fun(Type_<Offset_subject_>());
+  fun(Type_<Indexed_multiset_subject_>());
+  fun(Type_<Set_subject_>());
+  fun(Type_<Map_subject_>());
+  fun(Type_<Sorted_vector_subject_>());
+}
+
+// Bijective mixer from splitmix64, so distinct inputs give distinct keys.
+Key mix_(Key x) noexcept
+{
+  x += 0x9e3779b97f4a7c15u;
+  x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9u;
+  x = (x ^ (x >> 27u)) * 0x94d049bb133111ebu;
+  return x ^ (x >> 31u);
+}
+
+struct Streams_
+{
+  // n distinct keys in random order.
+  Keys random;
+
+  // The same keys in ascending order.
+  Keys sorted;
+
+  // Draws from random with Zipfian popularity, so hot keys are scattered
+  // over the key space; at least min_ops of them.
+  Keys zipfian;
+};
+
+Streams_ make_streams_(::std::size_t const n, ::std::size_t const ops)
+{
+  Streams_ streams;
+  streams.random.reserve(n);
+  for(::std::size_t i = 0u; n > i; ++i)
+  {
+    streams.random.push_back(mix_(i));
+  }
+
+  streams.sorted = streams.random;
+  ::std::sort(streams.sorted.begin(), streams.sorted.end());
+
+  ::bench::util::Zipf_gen zipf(n);
+  streams.zipfian.reserve(ops);
+  for(::std::size_t i = 0u; ops > i; ++i)
+  {
+    streams.zipfian.push_back(streams.random[zipf()]);
+  }
+
+  return streams;
+}
+
+template<class Subject>
+void build_(Subject& subject, Keys const& keys)
+{
+  for(Key const key: keys)
+  {
+    subject.insert(key);
+  }
+}
+
+// Runs keys through op on each subject in turn; keys shorter than ops are
+// cycled.
+template<class Subject, class Op>
+Key apply_(
+  ::std::vector<::std::unique_ptr<Subject>> const& subjects,
+  Keys const& keys,
+  Op const& op)
+{
+  Key checksum = 0u;
+  for(auto const& subject: subjects)
+  {
+    for(Key const key: keys)
+    {
+      checksum += op(*subject, key) ? 1u : 0u;
+    }
+  }
+
+  return checksum;
+}
+
+template<class Subject>
+void run_subject_(
+  Context& ctx,
+  ::std::size_t const n,
+  Streams_ const& streams)
+{
+  char const* const subject_name = Subject::name;
+  ::std::size_t const reps = ::bench::util::repeat_count(ctx.options(), n);
+  bool const too_large =
+    Subject::linear_mutation && ctx.options().linear_limit < n;
+
+  struct Stream_
+  {
+    char const* insert;
+    char const* erase;
+    Keys const* keys;
+  };
+  Stream_ const mutation_streams[] = {
+    {"insert/random", "erase/random", &streams.random},
+    {"insert/sequential", "erase/sequential", &streams.sorted},
+    {"insert/zipfian", "erase/zipfian", &streams.zipfian}};
+
+  auto const make_subjects = [](::std::size_t const count)
+  {
+    ::std::vector<::std::unique_ptr<Subject>> subjects;
+    for(::std::size_t i = 0u; count > i; ++i)
+    {
+      subjects.push_back(::std::make_unique<Subject>());
+    }
+
+    return subjects;
+  };
+
+  for(Stream_ const& stream: mutation_streams)
+  {
+    // A Zipfian stream already holds at least min_ops keys.
+    ::std::size_t const stream_reps = &streams.zipfian == stream.keys ? 1u : reps;
+    if(ctx.selected(stream.insert, subject_name))
+    {
+      if(too_large)
+      {
+        ctx.skip(stream.insert, subject_name, n);
+      }
+      else
+      {
+        auto subjects = make_subjects(stream_reps);
+        ctx.measure(
+          stream.insert, subject_name, n, stream_reps * stream.keys->size(),
+          [&]()
+          {
+            return apply_(
+              subjects,
+              *stream.keys,
+              [](Subject& s, Key const key)
+              {
+                return s.insert(key);
+              });
+          });
+      }
+    }
+
+    if(ctx.selected(stream.erase, subject_name))
+    {
+      if(too_large)
+      {
+        ctx.skip(stream.erase, subject_name, n);
+      }
+      else
+      {
+        auto subjects = make_subjects(stream_reps);
+        for(auto const& subject: subjects)
+        {
+          build_(*subject, streams.random);
+        }
+
+        ctx.measure(
+          stream.erase, subject_name, n, stream_reps * stream.keys->size(),
+          [&]()
+          {
+            return apply_(
+              subjects,
+              *stream.keys,
+              [](Subject& s, Key const key)
+              {
+                return s.erase(key);
+              });
+          });
+      }
+    }
+  }
+
+  struct Query_
+  {
+    char const* workload;
+    Keys const* keys;
+  };
+  Query_ const queries[] = {
+    {"lookup/random", &streams.random},
+    {"lookup/sequential", &streams.sorted},
+    {"lookup/zipfian", &streams.zipfian}};
+
+  bool const any_lookup =
+    ::std::any_of(
+      ::std::begin(queries), ::std::end(queries),
+      [&ctx, subject_name](Query_ const& query)
+      {
+        return ctx.selected(query.workload, subject_name);
+      }) ||
+    ctx.selected("iterate", subject_name);
+  if(!any_lookup)
+  {
+    return;
+  }
+
+  Subject subject;
+  build_(subject, streams.random);
+  for(Query_ const& query: queries)
+  {
+    if(ctx.selected(query.workload, subject_name))
+    {
+      ::std::size_t const query_reps =
+        &streams.zipfian == query.keys ? 1u : reps;
+      ctx.measure(
+        query.workload, subject_name, n, query_reps * query.keys->size(),
+        [&]()
+        {
+          Key checksum = 0u;
+          for(::std::size_t i = 0u; query_reps > i; ++i)
+          {
+            for(Key const key: *query.keys)
+            {
+              checksum += subject.contains(key) ? 1u : 0u;
+            }
+          }
+
+          return checksum;
+        });
+    }
+  }
+
+  if(ctx.selected("iterate", subject_name))
+  {
+    ctx.measure(
+      "iterate", subject_name, n, reps * n,
+      [&]()
+      {
+        Key checksum = 0u;
+        for(::std::size_t i = 0u; reps > i; ++i)
+        {
+          checksum += subject.iterate();
+        }
+
+        return checksum;
+      });
+  }
+}
+
+void run_(Context& ctx)
+{
+  for(::std::size_t const n: ctx.options().sizes)
+  {
+    ::std::size_t const ops = ::std::max(n, ctx.options().min_ops);
+    Streams_ const streams = make_streams_(n, ops);
+    for_each_subject_(
+      [&ctx, n, &streams](auto const type)
+      {
+        run_subject_<typename decltype(type)::Type>(ctx, n, streams);
+      });
+  }
+}
+
+::bench::util::Registry::Registration const registration_(
+  "container", &run_);
+
+} // namespace
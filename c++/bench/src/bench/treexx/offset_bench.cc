@@ -0,0 +1,738 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// A UI list of rows with varying heights, as kept by a widget toolkit: rows
+// are appended, inserted and resized, and every scroll renders the rows
+// intersecting the viewport. The offset tree structures shift all the rows
+// after an edit in O(log n); the baselines are a vector of heights whose
+// prefix sums are rescanned after an edit, and a map keyed by row offset
+// whose following keys are rewritten.
+//
+// Two synthetic traces are generated per size: "feed" only appends and
+// scrolls, as an infinite feed or a log view; "edit" also inserts and
+// resizes rows anywhere in the list. Recorded traces are replayed with
+// --trace=FILE, one operation per line:
+//
+//   append H      adds a row of height H at the end
+//   insert Y H    inserts a row of height H before the row covering Y
+//   resize Y H    sets the height of the row covering Y to H
+//   scroll DY     moves the viewport by DY, which may be negative
+//   jump Y        moves the viewport to Y
+//
+// Positions are taken modulo the total height and heights must be positive.
+// The appends that open the file build the list before timing starts.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <bench/treexx/avl_tree.hh>
+#include <bench/util/suite.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/spatial_list.hh>
+#include <treexx/stdxx/unrolled_spatial_list.hh>
+
+namespace
+{
+
+using Extent = ::std::uint64_t;
+using ::bench::treexx::Avl_node;
+using ::bench::treexx::Avl_tree;
+using ::bench::util::Context;
+
+Extent constexpr viewport_height_ = 1080u;
+
+// Subjects whose edits cost O(n) replay only as much of a trace as keeps
+// this many row visits, at least a thousand operations.
+::std::size_t constexpr linear_budget_ = 100000000u;
+
+enum class Kind_ : char unsigned
+{
+  append = 0u,
+  insert = 1u,
+  resize = 2u,
+  scroll = 3u,
+  jump = 4u
+};
+
+struct Op_
+{
+  Kind_ kind;
+
+  // Row height for append, insert and resize.
+  Extent height;
+
+  // Position for insert, resize and jump; for scroll the distance, two's
+  // complement.
+  Extent position;
+};
+
+struct Trace_
+{
+  // Heights of the rows appended before timing.
+  ::std::vector<Extent> rows;
+  ::std::vector<Op_> ops;
+  bool edits;
+};
+
+// Subjects share one interface. Positions passed in are below extent(), and
+// view returns the offset of the row covering top plus the number of the
+// rows intersecting [top, bottom), so that all of them produce the same
+// checksum for a trace.
+
+// Raw Tree_algo offset tree with a node per row. A row spans from its offset
+// to the offset of the next one.
+class Offset_tree_subject_
+{
+public:
+  static char constexpr name[] = "treexx offset";
+  static bool constexpr linear_mutation = false;
+  static bool constexpr supports_edits = true;
+
+  [[nodiscard]] Extent extent() const noexcept
+  {
+    return extent_;
+  }
+
+  void append(Extent const height)
+  {
+    Extent const gap = tree_.root() ? last_height_ : 0u;
+    Tree_algo_::push_back(tree_, new Avl_node, gap);
+    last_height_ = height;
+    extent_ += height;
+  }
+
+  void insert(Extent const y, Extent const height)
+  {
+    Extent start;
+    static_cast<void>(cover_(y, start));
+    Tree_algo_::insert_at_offset(tree_, new Avl_node, start, height);
+    extent_ += height;
+  }
+
+  void resize(Extent const y, Extent const height)
+  {
+    Extent start;
+    Avl_node* const row = cover_(y, start);
+    Avl_node* const next = ::treexx::bin::Tree_algo::next_node(tree_, *row);
+    Extent const end = next ? Tree_algo_::node_offset(tree_, *next) : extent_;
+    Extent const old_height = end - start;
+    if(!next)
+    {
+      last_height_ = height;
+    }
+    else if(old_height < height)
+    {
+      Tree_algo_::shift_suffix<Side_::right>(
+        tree_, *next, height - old_height);
+    }
+    else if(height < old_height)
+    {
+      Tree_algo_::shift_suffix<Side_::left>(
+        tree_, *next, old_height - height);
+    }
+
+    extent_ = extent_ - old_height + height;
+  }
+
+  [[nodiscard]] Extent view(Extent const top, Extent const bottom) const
+  {
+    Extent start;
+    Extent last_start;
+    Avl_node* row = cover_(top, start);
+    Avl_node* const last = cover_(bottom - 1u, last_start);
+    Extent count = 1u;
+    for(; last != row; ++count)
+    {
+      row = ::treexx::bin::Tree_algo::next_node(tree_, *row);
+    }
+
+    return start + count;
+  }
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+
+  [[nodiscard]] Avl_node* cover_(Extent const y, Extent& start) const
+  {
+    Avl_node* const root = tree_.root();
+    start = Avl_tree<true>::offset(*root);
+    return Tree_algo_::seek_offset(tree_, root, start, y);
+  }
+
+  Avl_tree<true> tree_;
+  Extent extent_ = 0u;
+  Extent last_height_ = 0u;
+};
+
+class Unrolled_subject_
+{
+public:
+  static char constexpr name[] = "unrolled_spatial_list";
+  static bool constexpr linear_mutation = false;
+  static bool constexpr supports_edits = true;
+
+  [[nodiscard]] Extent extent() const noexcept
+  {
+    return rows_.extent();
+  }
+
+  void append(Extent const height)
+  {
+    rows_.push_back(height);
+  }
+
+  void insert(Extent const y, Extent const height)
+  {
+    rows_.insert(rows_.find_offset(y), height);
+  }
+
+  void resize(Extent const y, Extent const height)
+  {
+    rows_.resize(rows_.find_offset(y), height);
+  }
+
+  [[nodiscard]] Extent view(Extent const top, Extent const bottom) const
+  {
+    ::std::size_t const first = rows_.find_offset(top);
+    ::std::size_t const last = rows_.find_offset(bottom - 1u);
+    return rows_.offset(first) + (last - first + 1u);
+  }
+
+private:
+  ::treexx::stdxx::unrolled_spatial_list<Extent> rows_;
+};
+
+// spatial_list only grows at the ends, so it runs the feed traces. Its
+// lookups start from the row found last, which suits scrolling.
+class Spatial_list_subject_
+{
+public:
+  static char constexpr name[] = "spatial_list";
+  static bool constexpr linear_mutation = false;
+  static bool constexpr supports_edits = false;
+
+  [[nodiscard]] Extent extent() const noexcept
+  {
+    return extent_;
+  }
+
+  void append(Extent const height)
+  {
+    rows_.emplace_back(height, '\0');
+    extent_ += height;
+  }
+
+  [[nodiscard]] Extent view(Extent const top, Extent const bottom)
+  {
+    auto row = rows_.find_offset(top);
+    Extent const start = row.offset();
+    auto const last = rows_.find_offset(bottom - 1u);
+    Extent count = 1u;
+    for(; last != row; ++count)
+    {
+      ++row;
+    }
+
+    return start + count;
+  }
+
+private:
+  ::treexx::stdxx::spatial_list<char, Extent> rows_;
+  Extent extent_ = 0u;
+};
+
+// Row heights with lazily maintained prefix sums: an edit invalidates the
+// sums from the edited row on, and the next lookup rescans them.
+class Prefix_sum_subject_
+{
+public:
+  static char constexpr name[] = "std::vector prefix sum";
+  static bool constexpr linear_mutation = true;
+  static bool constexpr supports_edits = true;
+
+  [[nodiscard]] Extent extent() const noexcept
+  {
+    return extent_;
+  }
+
+  void append(Extent const height)
+  {
+    if(valid_ == heights_.size())
+    {
+      starts_.push_back(extent_);
+      ++valid_;
+    }
+
+    heights_.push_back(height);
+    extent_ += height;
+  }
+
+  void insert(Extent const y, Extent const height)
+  {
+    ::std::size_t const idx = row_(y);
+    heights_.insert(heights_.begin() + idx, height);
+    valid_ = idx;
+    extent_ += height;
+  }
+
+  void resize(Extent const y, Extent const height)
+  {
+    ::std::size_t const idx = row_(y);
+    extent_ = extent_ - heights_[idx] + height;
+    heights_[idx] = height;
+    valid_ = idx + 1u;
+  }
+
+  [[nodiscard]] Extent view(Extent const top, Extent const bottom)
+  {
+    ::std::size_t const first = row_(top);
+    ::std::size_t const last = row_(bottom - 1u);
+    return starts_[first] + (last - first + 1u);
+  }
+
+private:
+  [[nodiscard]] ::std::size_t row_(Extent const y)
+  {
+    if(valid_ < heights_.size())
+    {
+      starts_.resize(heights_.size());
+      for(::std::size_t i = valid_; heights_.size() > i; ++i)
+      {
+        starts_[i] = 0u < i ? starts_[i - 1u] + heights_[i - 1u] : 0u;
+      }
+      valid_ = heights_.size();
+    }
+
+    auto const it = ::std::upper_bound(starts_.begin(), starts_.end(), y);
+    return static_cast<::std::size_t>(it - starts_.begin()) - 1u;
+  }
+
+  ::std::vector<Extent> heights_;
+  ::std::vector<Extent> starts_;
+  ::std::size_t valid_ = 0u;
+  Extent extent_ = 0u;
+};
+
+// Rows keyed by their offsets. An edit extracts every following row and
+// reinserts it under its shifted key.
+class Map_subject_
+{
+public:
+  static char constexpr name[] = "std::map rekey";
+  static bool constexpr linear_mutation = true;
+  static bool constexpr supports_edits = true;
+
+  [[nodiscard]] Extent extent() const noexcept
+  {
+    return extent_;
+  }
+
+  void append(Extent const height)
+  {
+    rows_.emplace_hint(rows_.end(), extent_, height);
+    extent_ += height;
+  }
+
+  void insert(Extent const y, Extent const height)
+  {
+    auto const row = row_(y);
+    Extent const start = row->first;
+    shift_up_(row, height);
+    rows_.emplace(start, height);
+    extent_ += height;
+  }
+
+  void resize(Extent const y, Extent const height)
+  {
+    auto const row = row_(y);
+    Extent const old_height = row->second;
+    row->second = height;
+    auto const next = ::std::next(row);
+    if(rows_.end() != next)
+    {
+      if(old_height < height)
+      {
+        shift_up_(next, height - old_height);
+      }
+      else if(height < old_height)
+      {
+        shift_down_(next, old_height - height);
+      }
+    }
+
+    extent_ = extent_ - old_height + height;
+  }
+
+  [[nodiscard]] Extent view(Extent const top, Extent const bottom) const
+  {
+    auto row = row_(top);
+    Extent const start = row->first;
+    auto const last = row_(bottom - 1u);
+    Extent count = 1u;
+    for(; last != row; ++count)
+    {
+      ++row;
+    }
+
+    return start + count;
+  }
+
+private:
+  using Rows_ = ::std::map<Extent, Extent>;
+
+  [[nodiscard]] Rows_::iterator row_(Extent const y)
+  {
+    return ::std::prev(rows_.upper_bound(y));
+  }
+
+  [[nodiscard]] Rows_::const_iterator row_(Extent const y) const
+  {
+    return ::std::prev(rows_.upper_bound(y));
+  }
+
+  // Keys grow, so the rows are moved from the last one back to keep the
+  // keys unique.
+  void shift_up_(Rows_::iterator const first, Extent const shift)
+  {
+    auto it = rows_.end();
+    for(bool done = false; !done;)
+    {
+      auto const row = ::std::prev(it);
+      done = first == row;
+      auto node = rows_.extract(row);
+      node.key() += shift;
+      it = rows_.insert(it, ::std::move(node));
+    }
+  }
+
+  void shift_down_(Rows_::iterator first, Extent const shift)
+  {
+    while(rows_.end() != first)
+    {
+      auto const next = ::std::next(first);
+      auto node = rows_.extract(first);
+      node.key() -= shift;
+      rows_.insert(next, ::std::move(node));
+      first = next;
+    }
+  }
+
+  Rows_ rows_;
+  Extent extent_ = 0u;
+};
+
+template<class T>
+struct Type_
+{
+  using Type = T;
+};
+
+template<class Fun>
+void for_each_subject_(Fun&& fun)
+{
+  fun(Type_<Offset_tree_subject_>());
+  fun(Type_<Unrolled_subject_>());
+  fun(Type_<Spatial_list_subject_>());
+  fun(Type_<Prefix_sum_subject_>());
+  fun(Type_<Map_subject_>());
+}
+
+template<class Subject>
+Extent replay_(Subject& subject, Op_ const* first, Op_ const* const last)
+{
+  Extent top = 0u;
+  Extent checksum = 0u;
+  for(; last != first; ++first)
+  {
+    Op_ const& op = *first;
+    Extent const extent = subject.extent();
+    bool scrolled = false;
+    switch(op.kind)
+    {
+    case Kind_::append:
+      subject.append(op.height);
+      break;
+    case Kind_::insert:
+      if constexpr(Subject::supports_edits)
+      {
+        if(0u < extent)
+        {
+          subject.insert(op.position % extent, op.height);
+        }
+        else
+        {
+          subject.append(op.height);
+        }
+      }
+      break;
+    case Kind_::resize:
+      if constexpr(Subject::supports_edits)
+      {
+        if(0u < extent)
+        {
+          subject.resize(op.position % extent, op.height);
+        }
+      }
+      break;
+    case Kind_::scroll:
+    {
+      auto const distance = static_cast<::std::int64_t>(op.position);
+      if(0 > distance)
+      {
+        Extent const up = Extent(0u) - op.position;
+        top = up < top ? top - up : 0u;
+      }
+      else
+      {
+        top += op.position;
+      }
+      scrolled = true;
+      break;
+    }
+    case Kind_::jump:
+      top = 0u < extent ? op.position % extent : 0u;
+      scrolled = true;
+      break;
+    }
+
+    if(scrolled && 0u < extent)
+    {
+      top = ::std::min(top, extent - 1u);
+      checksum += subject.view(
+        top, ::std::min(top + viewport_height_, extent));
+    }
+  }
+
+  return checksum;
+}
+
+Trace_ make_trace_(
+  ::std::size_t const rows,
+  ::std::size_t const ops,
+  bool const edits)
+{
+  ::std::mt19937_64 engine(rows);
+  auto const height = [&engine]() -> Extent
+  {
+    // Mostly text rows, with an image every sixteen rows on average.
+    Extent const r = engine();
+    return 0u == r % 16u ? 320u : 24u + r / 16u % 8u * 8u;
+  };
+
+  Trace_ trace;
+  trace.edits = edits;
+  trace.rows.reserve(rows);
+  for(::std::size_t i = 0u; rows > i; ++i)
+  {
+    trace.rows.push_back(height());
+  }
+
+  trace.ops.reserve(ops);
+  for(::std::size_t i = 0u; ops > i; ++i)
+  {
+    Extent const r = engine() % 100u;
+    Op_ op{Kind_::scroll, 0u, 0u};
+    if(edits ? 50u > r : 80u > r)
+    {
+      // Mostly downwards, up to a viewport per frame.
+      op.position = engine() % (viewport_height_ * 3u / 2u) -
+        viewport_height_ / 2u;
+    }
+    else if(edits ? 55u > r : 85u > r)
+    {
+      op.kind = Kind_::jump;
+      op.position = engine();
+    }
+    else if(edits ? 65u > r : true)
+    {
+      op.kind = Kind_::append;
+      op.height = height();
+    }
+    else
+    {
+      op.kind = 75u > r ? Kind_::insert : Kind_::resize;
+      op.position = engine();
+      op.height = height();
+    }
+
+    trace.ops.push_back(op);
+  }
+
+  return trace;
+}
+
+bool load_trace_(char const* const path, Trace_& trace)
+{
+  ::std::ifstream file(path);
+  if(!file)
+  {
+    ::std::fprintf(stderr, "Cannot open trace %s\n", path);
+    return false;
+  }
+
+  trace.rows.clear();
+  trace.ops.clear();
+  trace.edits = false;
+  ::std::string line;
+  for(::std::size_t line_no = 1u; ::std::getline(file, line); ++line_no)
+  {
+    ::std::istringstream words(line);
+    ::std::string word;
+    if(!(words >> word) || '#' == word[0])
+    {
+      continue;
+    }
+
+    Op_ op{Kind_::append, 0u, 0u};
+    bool ok = true;
+    if("append" == word)
+    {
+      ok = static_cast<bool>(words >> op.height);
+    }
+    else if("insert" == word || "resize" == word)
+    {
+      op.kind = "insert" == word ? Kind_::insert : Kind_::resize;
+      ok = static_cast<bool>(words >> op.position >> op.height);
+      trace.edits = true;
+    }
+    else if("scroll" == word)
+    {
+      ::std::int64_t distance = 0;
+      op.kind = Kind_::scroll;
+      ok = static_cast<bool>(words >> distance);
+      op.position = static_cast<Extent>(distance);
+    }
+    else if("jump" == word)
+    {
+      op.kind = Kind_::jump;
+      ok = static_cast<bool>(words >> op.position);
+    }
+    else
+    {
+      ok = false;
+    }
+
+    if(!ok || (Kind_::scroll != op.kind && Kind_::jump != op.kind &&
+      0u == op.height))
+    {
+      ::std::fprintf(stderr, "%s:%zu: invalid operation\n", path, line_no);
+      return false;
+    }
+
+    if(Kind_::append == op.kind && trace.ops.empty())
+    {
+      trace.rows.push_back(op.height);
+    }
+    else
+    {
+      trace.ops.push_back(op);
+    }
+  }
+
+  return true;
+}
+
+template<class Subject>
+void run_subject_(Context& ctx, char const* const workload, Trace_ const& trace)
+{
+  char const* const subject_name = Subject::name;
+  ::std::size_t const n = trace.rows.size();
+  if(!ctx.selected(workload, subject_name))
+  {
+    return;
+  }
+
+  if(
+    (trace.edits && !Subject::supports_edits) ||
+    (Subject::linear_mutation && ctx.options().linear_limit < n))
+  {
+    ctx.skip(workload, subject_name, n);
+    return;
+  }
+
+  ::std::size_t count = trace.ops.size();
+  if(Subject::linear_mutation && trace.edits)
+  {
+    ::std::size_t const budget = linear_budget_ / (0u < n ? n : 1u);
+    count = ::std::min(count, ::std::max<::std::size_t>(1000u, budget));
+  }
+
+  Subject subject;
+  for(Extent const height: trace.rows)
+  {
+    subject.append(height);
+  }
+
+  Op_ const* const ops = trace.ops.data();
+  ctx.measure(
+    workload, subject_name, n, count,
+    [&subject, ops, count]()
+    {
+      return replay_(subject, ops, ops + count);
+    });
+}
+
+void run_trace_(Context& ctx, char const* const workload, Trace_ const& trace)
+{
+  for_each_subject_(
+    [&ctx, workload, &trace](auto const type)
+    {
+      run_subject_<typename decltype(type)::Type>(ctx, workload, trace);
+    });
+}
+
+void run_(Context& ctx)
+{
+  if(!ctx.options().trace.empty())
+  {
+    Trace_ trace;
+    if(load_trace_(ctx.options().trace.c_str(), trace))
+    {
+      run_trace_(ctx, "trace", trace);
+    }
+    return;
+  }
+
+  for(::std::size_t const n: ctx.options().sizes)
+  {
+    ::std::size_t const ops = ::std::max(n, ctx.options().min_ops);
+    run_trace_(ctx, "feed", make_trace_(n, ops, false));
+    run_trace_(ctx, "edit", make_trace_(n, ops, true));
+  }
+}
+
+::bench::util::Registry::Registration const registration_("offset", &run_);
+
+} // namespace
@@ -0,0 +1,223 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_UTIL_COUNTERS_HH
+#define BENCH_UTIL_COUNTERS_HH
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#endif
+
+namespace bench::util
+{
+
+// Measurement of one timed region. A negative count means that the counter
+// is not available on this system.
+struct Sample
+{
+  double seconds;
+  double cycles;
+  double cache_misses;
+  bool cycles_from_tsc;
+};
+
+// Wall time plus, where the kernel allows it, the CPU cycles and last level
+// cache misses of the calling thread, read through perf_event_open(2).
+// Without perf events on x86, cycles fall back to the time stamp counter,
+// which ticks at a fixed rate rather than with the core clock.
+class Counters
+{
+public:
+  Counters() noexcept :
+    cycles_fd_(open_(counter_cycles_)),
+    misses_fd_(open_(counter_misses_)),
+    start_tsc_(0u)
+  {}
+
+  Counters(Counters&&) = delete;
+  Counters(Counters const&) = delete;
+
+  ~Counters()
+  {
+    close_(cycles_fd_);
+    close_(misses_fd_);
+  }
+
+  Counters& operator =(Counters&&) = delete;
+  Counters& operator =(Counters const&) = delete;
+
+  void start() noexcept
+  {
+    reset_(cycles_fd_);
+    reset_(misses_fd_);
+    start_tsc_ = tsc_();
+    start_time_ = Clock_::now();
+    enable_(cycles_fd_);
+    enable_(misses_fd_);
+  }
+
+  [[nodiscard]] Sample stop() noexcept
+  {
+    disable_(cycles_fd_);
+    disable_(misses_fd_);
+    auto const end_time = Clock_::now();
+    ::std::uint64_t const end_tsc = tsc_();
+
+    Sample sample;
+    sample.seconds =
+      ::std::chrono::duration<double>(end_time - start_time_).count();
+    sample.cycles = read_(cycles_fd_);
+    sample.cache_misses = read_(misses_fd_);
+    sample.cycles_from_tsc = false;
+    if(0.0 > sample.cycles && 0u < end_tsc)
+    {
+      sample.cycles = static_cast<double>(end_tsc - start_tsc_);
+      sample.cycles_from_tsc = true;
+    }
+
+    return sample;
+  }
+
+private:
+  using Clock_ = ::std::chrono::steady_clock;
+
+#if defined(__linux__)
+  static ::std::uint64_t constexpr counter_cycles_ = PERF_COUNT_HW_CPU_CYCLES;
+  static ::std::uint64_t constexpr counter_misses_ =
+    PERF_COUNT_HW_CACHE_MISSES;
+
+  [[nodiscard]] static int open_(::std::uint64_t const config) noexcept
+  {
+    perf_event_attr attr;
+    ::std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(
+      ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static void close_(int const fd) noexcept
+  {
+    if(0 <= fd)
+    {
+      ::close(fd);
+    }
+  }
+
+  static void reset_(int const fd) noexcept
+  {
+    if(0 <= fd)
+    {
+      ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    }
+  }
+
+  static void enable_(int const fd) noexcept
+  {
+    if(0 <= fd)
+    {
+      ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  static void disable_(int const fd) noexcept
+  {
+    if(0 <= fd)
+    {
+      ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  [[nodiscard]] static double read_(int const fd) noexcept
+  {
+    ::std::uint64_t count = 0u;
+    if(
+      0 <= fd &&
+      static_cast<::ssize_t>(sizeof(count)) ==
+        ::read(fd, &count, sizeof(count)))
+    {
+      return static_cast<double>(count);
+    }
+
+    return -1.0;
+  }
+#else
+  static ::std::uint64_t constexpr counter_cycles_ = 0u;
+  static ::std::uint64_t constexpr counter_misses_ = 0u;
+
+  [[nodiscard]] static int open_(::std::uint64_t) noexcept
+  {
+    return -1;
+  }
+
+  static void close_(int) noexcept
+  {}
+
+  static void reset_(int) noexcept
+  {}
+
+  static void enable_(int) noexcept
+  {}
+
+  static void disable_(int) noexcept
+  {}
+
+  [[nodiscard]] static double read_(int) noexcept
+  {
+    return -1.0;
+  }
+#endif
+
+  [[nodiscard]] static ::std::uint64_t tsc_() noexcept
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<::std::uint64_t>(__rdtsc());
+#else
+    return 0u;
+#endif
+  }
+
+  int cycles_fd_;
+  int misses_fd_;
+  ::std::uint64_t start_tsc_;
+  Clock_::time_point start_time_;
+};
+
+} // namespace bench::util
+
+#endif // BENCH_UTIL_COUNTERS_HH
@@ -0,0 +1,207 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_UTIL_SUITE_HH
+#define BENCH_UTIL_SUITE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <bench/util/counters.hh>
+
+namespace bench::util
+{
+
+struct Options
+{
+  // Element counts to run every workload at.
+  ::std::vector<::std::size_t> sizes;
+
+  // Only measurements whose "suite/workload/subject" name contains this run.
+  ::std::string filter;
+
+  // Each measurement repeats its workload until at least this many
+  // operations are timed, so that small sizes are not lost in timer noise.
+  ::std::size_t min_ops;
+
+  // Largest size at which O(n) mutations, such as inserting into a sorted
+  // vector, are still measured.
+  ::std::size_t linear_limit;
+
+  // Trace file for suites that replay recorded workloads, empty for none.
+  ::std::string trace;
+};
+
+// Runs the measurements of one suite and prints a row for each:
+// suite, workload, subject, size, ns/op, Mops/s, cycles/op, misses/op.
+class Context
+{
+public:
+  Context(Options const& options, char const* const suite) noexcept :
+    options_(options),
+    suite_(suite),
+    checksum_(0u)
+  {}
+
+  [[nodiscard]] Options const& options() const noexcept
+  {
+    return options_;
+  }
+
+  [[nodiscard]] bool selected(
+    char const* const workload,
+    char const* const subject) const
+  {
+    return
+      options_.filter.empty() ||
+      ::std::string::npos != name_(workload, subject).find(options_.filter);
+  }
+
+  // Times fun, which performs ops operations and returns a checksum of
+  // their results, the same for every subject doing the same work.
+  template<class Fun>
+  void measure(
+    char const* const workload,
+    char const* const subject,
+    ::std::size_t const size,
+    ::std::size_t const ops,
+    Fun&& fun)
+  {
+    counters_.start();
+    ::std::uint64_t const checksum = static_cast<Fun&&>(fun)();
+    Sample const sample = counters_.stop();
+    checksum_ += checksum;
+
+    double const per_op = 0u < ops ? 1.0 / static_cast<double>(ops) : 0.0;
+    char cycles[32];
+    char misses[32];
+    format_count_(cycles, sample.cycles * per_op, sample.cycles_from_tsc);
+    format_count_(misses, sample.cache_misses * per_op, false);
+    ::std::printf(
+      "%-12s %-24s %-22s %10zu %10.1f %9.2f %10s %10s\n",
+      suite_, workload, subject, size,
+      sample.seconds * 1e9 * per_op,
+      0.0 < sample.seconds ?
+        static_cast<double>(ops) / sample.seconds / 1e6 : 0.0,
+      cycles, misses);
+    ::std::fflush(stdout);
+  }
+
+  void skip(
+    char const* const workload,
+    char const* const subject,
+    ::std::size_t const size)
+  {
+    ::std::printf(
+      "%-12s %-24s %-22s %10zu %10s\n",
+      suite_, workload, subject, size, "skipped");
+  }
+
+  [[nodiscard]] ::std::uint64_t checksum() const noexcept
+  {
+    return checksum_;
+  }
+
+  static void print_header()
+  {
+    ::std::printf(
+      "%-12s %-24s %-22s %10s %10s %9s %10s %10s\n",
+      "suite", "workload", "subject", "size",
+      "ns/op", "Mops/s", "cycles/op", "misses/op");
+  }
+
+private:
+  [[nodiscard]] ::std::string name_(
+    char const* const workload,
+    char const* const subject) const
+  {
+    return
+      ::std::string(suite_) + '/' + workload + '/' + subject;
+  }
+
+  // A trailing '~' marks time stamp counter ticks standing in for cycles.
+  static void format_count_(
+    char (&buf)[32],
+    double const count,
+    bool const approximate)
+  {
+    if(0.0 > count)
+    {
+      ::std::snprintf(buf, sizeof(buf), "-");
+    }
+    else
+    {
+      ::std::snprintf(
+        buf, sizeof(buf), "%.1f%s", count, approximate ? "~" : "");
+    }
+  }
+
+  Options const& options_;
+  char const* suite_;
+  Counters counters_;
+  ::std::uint64_t checksum_;
+};
+
+// Suites register themselves from their translation units at start-up.
+class Registry
+{
+public:
+  using Run = void (*)(Context&);
+
+  struct Suite
+  {
+    char const* name;
+    Run run;
+  };
+
+  struct Registration
+  {
+    Registration(char const* const name, Run const run)
+    {
+      suites().push_back(Suite{name, run});
+    }
+  };
+
+  [[nodiscard]] static ::std::vector<Suite>& suites()
+  {
+    static ::std::vector<Suite> s;
+    return s;
+  }
+};
+
+// Number of times a workload of size operations is repeated to reach the
+// minimum operation count.
+[[nodiscard]] inline ::std::size_t repeat_count(
+  Options const& options,
+  ::std::size_t const size) noexcept
+{
+  return 0u < size && size < options.min_ops ?
+    (options.min_ops + size - 1u) / size : 1u;
+}
+
+} // namespace bench::util
+
+#endif // BENCH_UTIL_SUITE_HH
@@ -0,0 +1,100 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BENCH_UTIL_ZIPFGEN_HH
+#define BENCH_UTIL_ZIPFGEN_HH
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace bench::util
+{
+
+// Ranks in [0, n) drawn from a Zipfian distribution with exponent theta, so
+// that rank 0 is the most popular, as in YCSB. Uses the method of Gray et
+// al., "Quickly Generating Billion-Record Synthetic Databases": set-up is
+// O(n), every draw O(1).
+class Zipf_gen
+{
+public:
+  explicit Zipf_gen(
+    ::std::size_t const n,
+    double const theta = 0.99,
+    ::std::uint64_t const seed = 1u) :
+    engine_(seed),
+    dist_(0.0, 1.0),
+    n_(n),
+    theta_(theta),
+    alpha_(1.0 / (1.0 - theta)),
+    zeta_n_(zeta_(n, theta)),
+    eta_(
+      (1.0 - ::std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) /
+      (1.0 - zeta_(2u, theta) / zeta_n_))
+  {}
+
+  [[nodiscard]] ::std::size_t operator ()()
+  {
+    double const u = dist_(engine_);
+    double const uz = u * zeta_n_;
+    if(1.0 > uz)
+    {
+      return 0u;
+    }
+    if(1.0 + ::std::pow(0.5, theta_) > uz)
+    {
+      return 1u < n_ ? 1u : 0u;
+    }
+
+    auto const rank = static_cast<::std::size_t>(
+      static_cast<double>(n_) * ::std::pow(eta_ * u - eta_ + 1.0, alpha_));
+    return n_ > rank ? rank : n_ - 1u;
+  }
+
+private:
+  [[nodiscard]] static double zeta_(
+    ::std::size_t const n,
+    double const theta) noexcept
+  {
+    double sum = 0.0;
+    for(::std::size_t i = 1u; n >= i; ++i)
+    {
+      sum += 1.0 / ::std::pow(static_cast<double>(i), theta);
+    }
+
+    return sum;
+  }
+
+  ::std::mt19937_64 engine_;
+  ::std::uniform_real_distribution<double> dist_;
+  ::std::size_t n_;
+  double theta_;
+  double alpha_;
+  double zeta_n_;
+  double eta_;
+};
+
+} // namespace bench::util
+
+#endif // BENCH_UTIL_ZIPFGEN_HH
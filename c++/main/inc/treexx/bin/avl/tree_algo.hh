@@ -24,11 +24,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef TREEXX_BIN_AVL_TREEALGO_HH
 #define TREEXX_BIN_AVL_TREEALGO_HH
 
+#include <cstddef>
+#include <limits>
 #include <memory>
 #include <type_traits>
 
 #include <treexx/assert.hh>
 #include <treexx/compare_result.hh>
+#include <treexx/prefetch.hh>
 #include <treexx/bin/side.hh>
 #include <treexx/bin/tree_algo.hh>
 #include <treexx/bin/avl/balance.hh>
@@ -56,6 +59,9 @@ private:
   template<class T>
   using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<T>>>;
 
+  template<class T, class U>
+  using Is_same_ = typename ::std::is_same<T, U>::type;
+
   template<bool, class = void>
   struct Enable_if_
   {};
@@ -95,6 +101,8 @@ private:
 public:
   using Side = ::treexx::bin::Side;
 
+  using ::treexx::bin::Tree_algo::clear;
+
   template<class Tree>
   using Index = typename Index_trait_<Tree>::Type;
 
@@ -162,6 +170,194 @@ public:
         static_cast<Tree&&>(tree), static_cast<Compare&&>(compare));
   }
 
+  // First node for which is_before returns false, given that it returns true
+  // for a prefix of the nodes in order. With `node < key` this is
+  // lower_bound and with `!(key < node)` upper_bound. Unlike binary_search,
+  // the descent does not branch on the result: both children are loaded and
+  // one is selected by value, which compiles to conditional moves and keeps
+  // random keys from mispredicting on every level.
+  template<class Tree, class Is_before>
+  [[nodiscard]] static Node_pointer<Tree> partition_point(
+    Tree&& tree,
+    Is_before&& is_before)
+  {
+    return partition_point_(
+      static_cast<Tree&&>(tree),
+      static_cast<Tree&&>(tree).root(),
+      nullptr,
+      [&is_before](auto const& node) -> bool
+      {
+        return static_cast<Is_before&&>(is_before)(node);
+      });
+  }
+
+  // Lower bounds of a non-decreasing sequence of queries, written to out in
+  // order, null where a query follows every node. is_before(node, query)
+  // tells whether node orders before query. Each search resumes from the
+  // previous result: it climbs only until the subtree that holds the new
+  // result and descends from there, so k sorted queries cost about
+  // O(k + k log(n / k)) steps instead of O(k log n).
+  template<
+    class Tree,
+    class Input_iterator,
+    class Output_iterator,
+    class Is_before>
+  static Output_iterator lower_bound_batch(
+    Tree&& tree,
+    Input_iterator first,
+    Input_iterator const last,
+    Output_iterator out,
+    Is_before&& is_before)
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    Node_pointer result_ptr(nullptr);
+    bool is_first(true);
+    for(; last != first; ++first, ++out)
+    {
+      auto const& query = *first;
+      auto const is_node_before = [&is_before, &query](
+        auto const& node) -> bool
+      {
+        return static_cast<Is_before&&>(is_before)(node, query);
+      };
+
+      Node_pointer node_ptr(nullptr);
+      Node_pointer bound_ptr(nullptr);
+      if(is_first)
+      {
+        node_ptr = static_cast<Tree&&>(tree).root();
+        is_first = false;
+      }
+      else if(result_ptr)
+      {
+        auto* node(static_cast<Tree&&>(tree).address(result_ptr));
+        TREEXX_ASSERT(node);
+        if(!is_node_before(*node))
+        {
+          *out = result_ptr;
+          continue;
+        }
+
+        // Every node climbed through precedes the query. The first parent
+        // reached from the left that does not precede it bounds the result.
+        for(;;)
+        {
+          Node_pointer const parent_ptr(
+            static_cast<Tree&&>(tree).parent(*node));
+          if(!parent_ptr)
+          {
+            break;
+          }
+
+          auto* const parent(static_cast<Tree&&>(tree).address(parent_ptr));
+          TREEXX_ASSERT(parent);
+          if(
+            Side::left == static_cast<Tree&&>(tree).side(*node) &&
+            !is_node_before(*parent))
+          {
+            bound_ptr = parent_ptr;
+            break;
+          }
+
+          node = parent;
+        }
+
+        node_ptr =
+          static_cast<Tree&&>(tree).template child<Side::right>(*node);
+      }
+
+      result_ptr = partition_point_(
+        static_cast<Tree&&>(tree), node_ptr, bound_ptr, is_node_before);
+      *out = result_ptr;
+    }
+
+    return out;
+  }
+
+  // partition_point for each of independent queries, written to out in
+  // order, with is_before(node, query) as in lower_bound_batch. Runs
+  // group_size descents side by side: every step of one descent prefetches
+  // the child it moves to and passes on to the next descent, so the cache
+  // misses of a group overlap instead of following one another. Pays off
+  // once the tree does not fit in the cache. The queries must be readable
+  // more than once, that is, first must be a forward iterator.
+  template<
+    ::std::size_t group_size = 8u,
+    class Tree,
+    class Forward_iterator,
+    class Output_iterator,
+    class Is_before>
+  static Output_iterator partition_point_interleaved(
+    Tree&& tree,
+    Forward_iterator first,
+    Forward_iterator const last,
+    Output_iterator out,
+    Is_before&& is_before)
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    static_assert(0u < group_size);
+
+    struct Lane
+    {
+      Forward_iterator query;
+      Node_pointer node_ptr;
+      Node_pointer result_ptr;
+    };
+
+    Node_pointer const root_ptr(static_cast<Tree&&>(tree).root());
+    Lane lanes[group_size];
+    while(last != first)
+    {
+      ::std::size_t count = 0u;
+      for(; group_size > count && last != first; ++count, ++first)
+      {
+        Lane& lane = lanes[count];
+        lane.query = first;
+        lane.node_ptr = root_ptr;
+        lane.result_ptr = nullptr;
+      }
+
+      for(::std::size_t active = root_ptr ? count : 0u; 0u < active;)
+      {
+        for(::std::size_t i = 0u; count > i; ++i)
+        {
+          Lane& lane = lanes[i];
+          if(lane.node_ptr)
+          {
+            auto* const node(static_cast<Tree&&>(tree).address(lane.node_ptr));
+            TREEXX_ASSERT(node);
+            bool const before(
+              static_cast<Is_before&&>(is_before)(*node, *lane.query));
+            Node_pointer const left_ptr(
+              static_cast<Tree&&>(tree).template child<Side::left>(*node));
+            Node_pointer const right_ptr(
+              static_cast<Tree&&>(tree).template child<Side::right>(*node));
+            lane.result_ptr = before ? lane.result_ptr : lane.node_ptr;
+            lane.node_ptr = before ? right_ptr : left_ptr;
+            if(lane.node_ptr)
+            {
+              TREEXX_PREFETCH(
+                static_cast<Tree&&>(tree).address(lane.node_ptr));
+            }
+            else
+            {
+              --active;
+            }
+          }
+        }
+      }
+
+      for(::std::size_t i = 0u; count > i; ++i, ++out)
+      {
+        *out = lanes[i].result_ptr;
+      }
+    }
+
+    return out;
+  }
+
   template<class Tree>
   [[nodiscard]] static Node_pointer<Tree> at_index(
     Tree&& tree,
@@ -200,6 +396,118 @@ public:
     return node_index_or_offset_<true>(static_cast<Tree&&>(tree), node);
   }
 
+  // Finger search for the last node whose absolute offset is not greater
+  // than offset. Starts at finger_ptr, whose absolute offset must be passed
+  // in finger_offset, climbs only until the subtree that holds the result
+  // and descends from there. A target in the same or a nearby node costs a
+  // few steps instead of a descent from the root, although crossing the
+  // boundary of a large subtree still costs up to O(log n). Returns null if
+  // offset precedes the first node; otherwise finger_offset is set to the
+  // absolute offset of the result.
+  template<class Tree>
+  [[nodiscard]] static Node_pointer<Tree> seek_offset(
+    Tree&& tree,
+    Node_pointer<Tree> const& finger_ptr,
+    typename Offset_trait_<Tree>::Type& finger_offset,
+    typename Offset_trait_<Tree>::Type const& offset) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+    using Offset = typename Offset_trait_<Tree>::Type;
+
+    TREEXX_ASSERT(finger_ptr);
+    Node_pointer node_ptr(finger_ptr);
+    Node* node(static_cast<Tree&&>(tree).address(node_ptr));
+    TREEXX_ASSERT(node);
+    Offset node_offset(finger_offset);
+    Node_pointer result_ptr(nullptr);
+    Offset result_offset(node_offset);
+
+    // Going forward, the result is the finger or follows it, so the subtree
+    // of a left child holds it when offset precedes the parent. Going
+    // backward, the subtree of a right child holds it unless offset precedes
+    // the parent, which then becomes the fallback result.
+    bool const forward = !(offset < node_offset);
+    for(;;)
+    {
+      Node_pointer const parent_ptr(
+        static_cast<Tree&&>(tree).parent(*node));
+      if(!parent_ptr)
+      {
+        break;
+      }
+
+      Node* const parent(static_cast<Tree&&>(tree).address(parent_ptr));
+      TREEXX_ASSERT(parent);
+      Side const side(static_cast<Tree&&>(tree).side(*node));
+      Offset parent_offset(
+        node_offset - static_cast<Tree&&>(tree).offset(*node));
+      if(Side::left == side)
+      {
+        parent_offset += static_cast<Tree&&>(tree).offset(*parent);
+      }
+
+      if(forward)
+      {
+        if(Side::left == side && offset < parent_offset)
+        {
+          break;
+        }
+      }
+      else if(Side::right == side && !(offset < parent_offset))
+      {
+        result_ptr = parent_ptr;
+        result_offset = parent_offset;
+        break;
+      }
+
+      node_ptr = parent_ptr;
+      node = parent;
+      node_offset = parent_offset;
+    }
+
+    for(;;)
+    {
+      Node_pointer child_ptr;
+      Offset child_offset(node_offset);
+      if(offset < node_offset)
+      {
+        child_ptr =
+          static_cast<Tree&&>(tree).template child<Side::left>(*node);
+        if(!child_ptr)
+        {
+          break;
+        }
+
+        child_offset -= static_cast<Tree&&>(tree).offset(*node);
+      }
+      else
+      {
+        result_ptr = node_ptr;
+        result_offset = node_offset;
+        child_ptr =
+          static_cast<Tree&&>(tree).template child<Side::right>(*node);
+        if(!child_ptr)
+        {
+          break;
+        }
+      }
+
+      node_ptr = child_ptr;
+      node = static_cast<Tree&&>(tree).address(node_ptr);
+      TREEXX_ASSERT(node);
+      child_offset += static_cast<Tree&&>(tree).offset(*node);
+      node_offset = child_offset;
+    }
+
+    if(result_ptr)
+    {
+      finger_offset = result_offset;
+    }
+
+    return result_ptr;
+  }
+
   template<class Tree>
   static auto push_back(
     Tree&& tree,
@@ -569,6 +877,122 @@ public:
     insert_at_offset_(static_cast<Tree&&>(tree), node_ptr, offset, shift);
   }
 
+  // Links node_ptr in at offset right after prev_ptr, whose absolute offset
+  // is prev_offset, or in front of all the nodes when prev_ptr is null. The
+  // offset must not precede prev_offset nor follow the node after prev_ptr;
+  // no node is shifted. The node becomes the right child of prev_ptr or the
+  // left child of its successor, so no descent from the root is made and,
+  // rebalancing being amortized O(1), a run of insertions in offset order
+  // costs O(1) each on top of finding prev_ptr, e.g. with seek_offset. An
+  // index makes every insertion climb to the root to update it.
+  template<class Tree>
+  static void insert_after(
+    Tree&& tree,
+    Node_pointer<Tree> const& prev_ptr,
+    typename Offset_trait_<Tree>::Type const& prev_offset,
+    Node_pointer<Tree> const& node_ptr,
+    typename Offset_trait_<Tree>::Type const& offset) noexcept
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+    using Node = Tree_algo::Node<Tree>;
+    using Offset = Tree_algo::Offset<Tree>;
+
+    bool constexpr has_index(Index_trait_<Tree>::value);
+    TREEXX_ASSERT(node_ptr);
+
+    // The base of a node is the absolute offset its offset is relative to:
+    // that of the nearest ancestor it is in the right subtree of, or zero.
+    Node_pointer parent_ptr(prev_ptr);
+    Offset base_offset(make_offset_<Tree, 0u>());
+    Side side = Side::right;
+    if(prev_ptr)
+    {
+      Node* const prev(static_cast<Tree&&>(tree).address(prev_ptr));
+      TREEXX_ASSERT(prev);
+      TREEXX_ASSERT(!(offset < prev_offset));
+      base_offset = prev_offset;
+      Node_pointer child_ptr(
+        static_cast<Tree&&>(tree).template child<Side::right>(*prev));
+      while(child_ptr)
+      {
+        parent_ptr = child_ptr;
+        side = Side::left;
+        child_ptr = static_cast<Tree&&>(tree).template child<Side::left>(
+          *static_cast<Tree&&>(tree).address(child_ptr));
+      }
+    }
+    else
+    {
+      parent_ptr = static_cast<Tree&&>(tree).template extreme<Side::left>();
+      side = Side::left;
+    }
+
+    Node* const node(static_cast<Tree&&>(tree).address(node_ptr));
+    TREEXX_ASSERT(node);
+    static_cast<Tree&&>(tree).set_parent(*node, parent_ptr);
+    static_cast<Tree&&>(tree).template set_child<Side::left>(*node, nullptr);
+    static_cast<Tree&&>(tree).template set_child<Side::right>(*node, nullptr);
+    static_cast<Tree&&>(tree).set_offset(*node, offset - base_offset);
+    static_cast<Tree&&>(tree).set_balance(*node, Balance::poised);
+    static_cast<Tree&&>(tree).set_side(*node, side);
+
+    if(!prev_ptr)
+    {
+      static_cast<Tree&&>(tree).template set_extreme<Side::left>(node_ptr);
+    }
+    else if(
+      prev_ptr == static_cast<Tree&&>(tree).template extreme<Side::right>())
+    {
+      static_cast<Tree&&>(tree).template set_extreme<Side::right>(node_ptr);
+    }
+
+    if(!parent_ptr)
+    {
+      static_cast<Tree&&>(tree).template set_extreme<Side::right>(node_ptr);
+      static_cast<Tree&&>(tree).set_root(node_ptr);
+      if constexpr(has_index)
+      {
+        static_cast<Tree&&>(tree).template set_index<0u>(*node);
+      }
+
+      return;
+    }
+
+    if constexpr(has_index)
+    {
+      if(prev_ptr)
+      {
+        static_cast<Tree&&>(tree).template set_index<1u>(*node);
+      }
+      else
+      {
+        static_cast<Tree&&>(tree).template set_index<0u>(*node);
+      }
+
+      Node* parent(static_cast<Tree&&>(tree).address(parent_ptr));
+      TREEXX_ASSERT(parent);
+      for(Side from_side = side;;)
+      {
+        if(Side::left == from_side)
+        {
+          static_cast<Tree&&>(tree).increment_index(*parent);
+        }
+
+        Node_pointer const next_parent_ptr =
+          static_cast<Tree&&>(tree).parent(*parent);
+        if(!next_parent_ptr)
+        {
+          break;
+        }
+
+        from_side = static_cast<Tree&&>(tree).side(*parent);
+        parent = static_cast<Tree&&>(tree).address(next_parent_ptr);
+      }
+    }
+
+    attach_and_fix_up_(static_cast<Tree&&>(tree), parent_ptr, node_ptr, side);
+  }
+
   template<class Tree>
   static Node_pointer<Tree> pop_back(Tree&& tree) noexcept
   {
@@ -587,6 +1011,14 @@ public:
     erase_<false>(static_cast<Tree&&>(tree), node_ptr);
   }
 
+  template<class Tree>
+  static void erase_and_shift(
+    Tree&& tree,
+    Node_pointer<Tree> const& node_ptr) noexcept
+  {
+    erase_<true>(static_cast<Tree&&>(tree), node_ptr);
+  }
+
   template<Side side, class Tree>
   static void shift_suffix(
     Tree&& tree,
@@ -602,7 +1034,10 @@ public:
     {
       if constexpr(Side::left == side)
       {
-        TREEXX_ASSERT(shift < static_cast<Tree&&>(tree).offset(*node_addr));
+        TREEXX_ASSERT(
+          !static_cast<Tree&&>(tree).parent(*node_addr) ||
+          Side::left == static_cast<Tree&&>(tree).side(*node_addr) ||
+          shift < static_cast<Tree&&>(tree).offset(*node_addr));
         static_cast<Tree&&>(tree).subtract_from_offset(*node_addr, shift);
       }
       else
@@ -652,41 +1087,630 @@ public:
     }
   }
 
-private:
-  template<class Tree, bool>
-  struct Optional_index_
-  {};
 
-  template<class Tree>
-  struct Optional_index_<Tree, true>
+  // Moves the node at node_ptr and all the nodes following it out of tree
+  // into other, which must be empty. Runs in O(log n). Trees with offsets are
+  // not supported, as the algorithm does not know the extents of the nodes.
+  template<class Tree, class Other_tree>
+  static void split(
+    Tree&& tree,
+    Node_pointer<Tree> const& node_ptr,
+    Other_tree&& other) noexcept
   {
-    using Index = typename Index_trait_<Tree>::Type;
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+    using Subtree = Subtree_<Tree>;
+    using Level = Split_level_<Tree>;
 
-    Optional_index_() noexcept :
-      base_index(make_index_<Tree, 0u>())
-    {}
+    bool constexpr has_index(Index_trait_<Tree>::value);
+    static_assert(!Offset_trait_<Tree>::value);
+    static_assert(
+      Is_same_<Remove_cv_ref_<Tree>, Remove_cv_ref_<Other_tree>>::value);
 
-    Index base_index;
-    Index node_index;
-  };
+    TREEXX_ASSERT(node_ptr);
+    TREEXX_ASSERT(!static_cast<Other_tree&&>(other).root());
+    Node* const node(static_cast<Tree&&>(tree).address(node_ptr));
+    TREEXX_ASSERT(node);
 
-  template<class Tree, bool>
-  struct Optional_offset_
-  {};
+    Node_pointer const rightmost_ptr(
+      static_cast<Tree&&>(tree).template extreme<Side::right>());
+    Node_pointer const previous_ptr(
+      adjacent_node<Side::left>(static_cast<Tree&&>(tree), *node));
 
-  template<class Tree>
-  struct Optional_offset_<Tree, true>
-  {
-    using Offset = typename Offset_trait_<Tree>::Type;
+    // The path from the node up to the root.
+    Level path[max_height_];
+    unsigned depth = 0u;
+    for(Node_pointer ptr(node_ptr);;)
+    {
+      TREEXX_ASSERT(max_height_ > depth);
+      Node* const addr(static_cast<Tree&&>(tree).address(ptr));
+      TREEXX_ASSERT(addr);
+      path[depth].node = ptr;
+      path[depth].side = static_cast<Tree&&>(tree).side(*addr);
+      ++depth;
+      ptr = static_cast<Tree&&>(tree).parent(*addr);
+      if(!ptr)
+      {
+        break;
+      }
+    }
 
-    Optional_offset_() noexcept :
-      base_offset(make_offset_<Tree , 0u>())
-    {}
+    // Heights and index ranges of the subtrees along the path, top down.
+    {
+      Level& top = path[depth - 1u];
+      top.height = subtree_height_(static_cast<Tree&&>(tree), top.node);
+      if constexpr(has_index)
+      {
+        Node* const rightmost(
+          static_cast<Tree&&>(tree).address(rightmost_ptr));
+        TREEXX_ASSERT(rightmost);
+        top.base = make_index_<Tree, 0u>();
+        top.low = make_index_<Tree, 0u>();
+        top.high =
+          node_index(static_cast<Tree&&>(tree), *rightmost) +
+          make_index_<Tree, 1u>();
+        top.position = static_cast<Tree&&>(tree).index(
+          *static_cast<Tree&&>(tree).address(top.node));
+      }
+    }
+
+    for(unsigned i = depth - 1u; 0u < i; --i)
+    {
+      Level const& parent = path[i];
+      Level& level = path[i - 1u];
+      Node* const parent_addr(static_cast<Tree&&>(tree).address(parent.node));
+      level.height = child_height_(
+        static_cast<Tree&&>(tree), *parent_addr, parent.height, level.side);
+      if constexpr(has_index)
+      {
+        if(Side::left == level.side)
+        {
+          level.base = parent.base;
+          level.low = parent.low;
+          level.high = parent.position;
+        }
+        else
+        {
+          level.base = parent.position;
+          level.low = parent.position + make_index_<Tree, 1u>();
+          level.high = parent.high;
+        }
+
+        level.position = level.base + static_cast<Tree&&>(tree).index(
+          *static_cast<Tree&&>(tree).address(level.node));
+      }
+    }
+
+    Subtree left;
+    Subtree right;
+    subtree_of_child_<Side::left>(static_cast<Tree&&>(tree), path[0], left);
+    subtree_of_child_<Side::right>(static_cast<Tree&&>(tree), path[0], right);
+    {
+      Subtree empty;
+      empty.root = nullptr;
+      empty.height = 0u;
+      if constexpr(has_index)
+      {
+        empty.size = make_index_<Tree, 0u>();
+        empty.bias = true;
+      }
+
+      right = join_(static_cast<Tree&&>(tree), empty, node_ptr, right);
+    }
+
+    for(unsigned i = 1u; depth > i; ++i)
+    {
+      Subtree sibling;
+      if(Side::right == path[i - 1u].side)
+      {
+        subtree_of_child_<Side::left>(
+          static_cast<Tree&&>(tree), path[i], sibling);
+        left = join_(static_cast<Tree&&>(tree), sibling, path[i].node, left);
+      }
+      else
+      {
+        subtree_of_child_<Side::right>(
+          static_cast<Tree&&>(tree), path[i], sibling);
+        right = join_(static_cast<Tree&&>(tree), right, path[i].node, sibling);
+      }
+    }
+
+    if constexpr(has_index)
+    {
+      if(left.root && left.bias)
+      {
+        shift_left_edge_<false>(static_cast<Tree&&>(tree), left.root);
+      }
+
+      if(right.bias)
+      {
+        shift_left_edge_<false>(static_cast<Tree&&>(tree), right.root);
+      }
+    }
+
+    if(left.root)
+    {
+      // It is still linked to the node when no join has been involved.
+      Node* const root(static_cast<Tree&&>(tree).address(left.root));
+      TREEXX_ASSERT(root);
+      static_cast<Tree&&>(tree).set_parent(*root, nullptr);
+      static_cast<Tree&&>(tree).set_side(*root, Side::left);
+    }
+    else
+    {
+      static_cast<Tree&&>(tree).template set_extreme<Side::left>(nullptr);
+    }
+
+    static_cast<Tree&&>(tree).set_root(left.root);
+    static_cast<Tree&&>(tree).template set_extreme<Side::right>(previous_ptr);
+
+    static_cast<Other_tree&&>(other).set_root(right.root);
+    static_cast<Other_tree&&>(other).
+      template set_extreme<Side::left>(node_ptr);
+    static_cast<Other_tree&&>(other).
+      template set_extreme<Side::right>(rightmost_ptr);
+  }
+
+  // Appends the node at node_ptr and then all the nodes of other to tree,
+  // leaving other empty. Every node of tree must precede the node, which
+  // must precede every node of other. Runs in O(log n). Trees with offsets
+  // are not supported.
+  template<class Tree, class Other_tree>
+  static void join(
+    Tree&& tree,
+    Node_pointer<Tree> const& node_ptr,
+    Other_tree&& other) noexcept
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+    using Subtree = Subtree_<Tree>;
+
+    bool constexpr has_index(Index_trait_<Tree>::value);
+    static_assert(!Offset_trait_<Tree>::value);
+    static_assert(
+      Is_same_<Remove_cv_ref_<Tree>, Remove_cv_ref_<Other_tree>>::value);
+
+    TREEXX_ASSERT(node_ptr);
+    Subtree left;
+    Subtree right;
+    left.root = static_cast<Tree&&>(tree).root();
+    right.root = static_cast<Other_tree&&>(other).root();
+    left.height = subtree_height_(static_cast<Tree&&>(tree), left.root);
+    right.height = subtree_height_(static_cast<Tree&&>(tree), right.root);
+    if constexpr(has_index)
+    {
+      left.size = tree_size_(static_cast<Tree&&>(tree));
+      right.size = tree_size_(static_cast<Other_tree&&>(other));
+      left.bias = false;
+      right.bias = false;
+    }
+
+    Node_pointer const leftmost_ptr(
+      left.root ?
+        static_cast<Tree&&>(tree).template extreme<Side::left>() :
+        node_ptr);
+    Node_pointer const rightmost_ptr(
+      right.root ?
+        static_cast<Other_tree&&>(other).template extreme<Side::right>() :
+        node_ptr);
+
+    Subtree const joint(
+      join_(static_cast<Tree&&>(tree), left, node_ptr, right));
+    static_cast<Tree&&>(tree).set_root(joint.root);
+    static_cast<Tree&&>(tree).template set_extreme<Side::left>(leftmost_ptr);
+    static_cast<Tree&&>(tree).template set_extreme<Side::right>(rightmost_ptr);
+    static_cast<Other_tree&&>(other).set_root(nullptr);
+    static_cast<Other_tree&&>(other).template set_extreme<Side::left>(nullptr);
+    static_cast<Other_tree&&>(other).template set_extreme<Side::right>(nullptr);
+  }
+
+  // Appends all the nodes of other to tree, leaving other empty.
+  template<class Tree, class Other_tree>
+  static void join(Tree&& tree, Other_tree&& other) noexcept
+  {
+    if(static_cast<Other_tree&&>(other).root())
+    {
+      Node_pointer<Tree> const node_ptr(
+        pop_front(static_cast<Other_tree&&>(other)));
+      join(
+        static_cast<Tree&&>(tree), node_ptr,
+        static_cast<Other_tree&&>(other));
+    }
+  }
+
+  // Builds tree, which must be empty, out of the nodes [first, last) taken
+  // in this order, where the iterators dereference to node pointers. The
+  // result is perfectly balanced. With offsets, each node must hold its
+  // absolute offset on entry. Ranges of fork_join.grain_size() nodes and more
+  // have their halves built through fork_join.invoke(f, g), which may run f
+  // and g in parallel and is not expected to throw.
+  template<class Tree, class Iterator, class Fork_join>
+  static void build(
+    Tree&& tree,
+    Iterator const first,
+    Iterator const last,
+    Fork_join&& fork_join) noexcept
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    bool constexpr has_offset(Offset_trait_<Tree>::value);
+    TREEXX_ASSERT(!static_cast<Tree&&>(tree).root());
+    if(first == last)
+    {
+      return;
+    }
+
+    Optional_offset_<Tree, has_offset> const anchor;
+    Subtree_<Tree> const subtree(build_(
+      static_cast<Tree&&>(tree), first, last,
+      Node_pointer(nullptr), Side::left, false, anchor,
+      static_cast<Fork_join&&>(fork_join)));
+    Node_pointer const leftmost_ptr(*first);
+    Node_pointer const rightmost_ptr(*(last - 1));
+    static_cast<Tree&&>(tree).set_root(subtree.root);
+    static_cast<Tree&&>(tree).template set_extreme<Side::left>(leftmost_ptr);
+    static_cast<Tree&&>(tree).template set_extreme<Side::right>(rightmost_ptr);
+  }
+
+  // The set operations below take two trees of the same type, both ordered
+  // by compare(x, y), which tells how node x compares to node y, and leave
+  // the result in tree. Nodes dropped from the result are passed to dispose,
+  // possibly from several threads at once. They run in O(m log(n/m + 1)) for
+  // the smaller size m and the larger size n, dividing the work at the root
+  // and joining the parts back with join_(). Parts of about
+  // fork_join.grain_size() nodes and more are worked on through
+  // fork_join.invoke(f, g), which may run f and g in parallel and is not
+  // expected to throw. Trees with offsets are not supported.
+
+  // Moves the nodes of other into tree, leaving other empty. Nodes of other
+  // equal to a node of tree are disposed of.
+  template<
+    class Tree, class Other_tree, class Compare, class Dispose,
+    class Fork_join>
+  static void set_union(
+    Tree&& tree,
+    Other_tree&& other,
+    Compare&& compare,
+    Dispose&& dispose,
+    Fork_join&& fork_join) noexcept
+  {
+    using Detached_tree = Detached_tree_<Tree>;
+    using Subtree = Subtree_<Detached_tree&>;
+
+    static_assert(!Offset_trait_<Tree>::value);
+    static_assert(
+      Is_same_<Remove_cv_ref_<Tree>, Remove_cv_ref_<Other_tree>>::value);
+
+    Detached_tree detached(tree);
+    Subtree const a(whole_subtree_<Subtree>(static_cast<Tree&&>(tree)));
+    Subtree const b(
+      whole_subtree_<Subtree>(static_cast<Other_tree&&>(other)));
+    Subtree const result(union_(
+      detached, a, b, compare, dispose, static_cast<Fork_join&&>(fork_join)));
+    assign_subtree_(static_cast<Tree&&>(tree), result);
+    static_cast<Other_tree&&>(other).set_root(nullptr);
+    static_cast<Other_tree&&>(other).template set_extreme<Side::left>(nullptr);
+    static_cast<Other_tree&&>(other).template set_extreme<Side::right>(nullptr);
+  }
+
+  // Disposes of the nodes of tree not equal to any node of other. Other is
+  // left as it is.
+  template<
+    class Tree, class Other_tree, class Compare, class Dispose,
+    class Fork_join>
+  static void set_intersection(
+    Tree&& tree,
+    Other_tree&& other,
+    Compare&& compare,
+    Dispose&& dispose,
+    Fork_join&& fork_join) noexcept
+  {
+    using Detached_tree = Detached_tree_<Tree>;
+    using Subtree = Subtree_<Detached_tree&>;
+
+    static_assert(!Offset_trait_<Tree>::value);
+    static_assert(
+      Is_same_<Remove_cv_ref_<Tree>, Remove_cv_ref_<Other_tree>>::value);
+
+    Detached_tree detached(tree);
+    Subtree const a(whole_subtree_<Subtree>(static_cast<Tree&&>(tree)));
+    Subtree const b(
+      whole_subtree_<Subtree>(static_cast<Other_tree&&>(other)));
+    Subtree const result(intersection_(
+      detached, a, b, compare, dispose, static_cast<Fork_join&&>(fork_join)));
+    assign_subtree_(static_cast<Tree&&>(tree), result);
+  }
+
+  // Disposes of the nodes of tree equal to a node of other. Other is left as
+  // it is.
+  template<
+    class Tree, class Other_tree, class Compare, class Dispose,
+    class Fork_join>
+  static void set_difference(
+    Tree&& tree,
+    Other_tree&& other,
+    Compare&& compare,
+    Dispose&& dispose,
+    Fork_join&& fork_join) noexcept
+  {
+    using Detached_tree = Detached_tree_<Tree>;
+    using Subtree = Subtree_<Detached_tree&>;
+
+    static_assert(!Offset_trait_<Tree>::value);
+    static_assert(
+      Is_same_<Remove_cv_ref_<Tree>, Remove_cv_ref_<Other_tree>>::value);
+
+    Detached_tree detached(tree);
+    Subtree const a(whole_subtree_<Subtree>(static_cast<Tree&&>(tree)));
+    Subtree const b(
+      whole_subtree_<Subtree>(static_cast<Other_tree&&>(other)));
+    Subtree const result(difference_(
+      detached, a, b, compare, dispose, static_cast<Fork_join&&>(fork_join)));
+    assign_subtree_(static_cast<Tree&&>(tree), result);
+  }
+
+  // Calls fun(node) for every node of tree in no particular order. Subtrees
+  // of about fork_join.grain_size() nodes and more have their halves visited
+  // through fork_join.invoke(f, g), so fun may be called from several threads
+  // at once; smaller subtrees are visited in order. An exception thrown by
+  // fun propagates once the calls under way have returned.
+  template<class Tree, class Fun, class Fork_join>
+  static void for_each_unordered(
+    Tree&& tree,
+    Fun&& fun,
+    Fork_join&& fork_join)
+  {
+    for_each_unordered_(
+      static_cast<Tree&&>(tree),
+      static_cast<Tree&&>(tree).root(),
+      subtree_height_(
+        static_cast<Tree&&>(tree), static_cast<Tree&&>(tree).root()),
+      fun,
+      fork_join);
+  }
+
+  // Like clear(tree, destroy), but subtrees of about fork_join.grain_size()
+  // nodes and more are destroyed through fork_join.invoke(f, g), so destroy
+  // may be called from several threads at once. Each node is destroyed after
+  // its children. The root and the extremes of tree are left as they are.
+  template<class Tree, class Destroy, class Fork_join>
+  static void clear(
+    Tree&& tree,
+    Destroy&& destroy,
+    Fork_join&& fork_join) noexcept
+  {
+    clear_(
+      static_cast<Tree&&>(tree),
+      static_cast<Tree&&>(tree).root(),
+      subtree_height_(
+        static_cast<Tree&&>(tree), static_cast<Tree&&>(tree).root()),
+      destroy,
+      fork_join);
+  }
+
+private:
+  template<class Tree, bool>
+  struct Optional_index_
+  {};
+
+  template<class Tree>
+  struct Optional_index_<Tree, true>
+  {
+    using Index = typename Index_trait_<Tree>::Type;
+
+    Optional_index_() noexcept :
+      base_index(make_index_<Tree, 0u>())
+    {}
+
+    Index base_index;
+    Index node_index;
+  };
+
+  template<class Tree, bool>
+  struct Optional_offset_
+  {};
+
+  template<class Tree>
+  struct Optional_offset_<Tree, true>
+  {
+    using Offset = typename Offset_trait_<Tree>::Type;
+
+    Optional_offset_() noexcept :
+      base_offset(make_offset_<Tree , 0u>())
+    {}
 
     Offset base_offset;
     Offset node_offset;
   };
 
+  // An AVL tree of 2^64 nodes is not higher than this.
+  static unsigned constexpr max_height_ = 96u;
+
+  template<class Tree, bool = Index_trait_<Tree>::value>
+  struct Subtree_
+  {
+    Node_pointer<Tree> root;
+    unsigned height;
+  };
+
+  // When bias is set, the indices on the left edge of the subtree exceed the
+  // positions within the subtree by one, as they are still relative to the
+  // node it was detached from.
+  template<class Tree>
+  struct Subtree_<Tree, true> : Subtree_<Tree, false>
+  {
+    Index<Tree> size;
+    bool bias;
+  };
+
+  template<class Tree, bool = Index_trait_<Tree>::value>
+  struct Split_level_
+  {
+    Node_pointer<Tree> node;
+    unsigned height;
+    Side side;
+  };
+
+  // The index range [low, high) covered by the subtree, the index of its root
+  // and the index its left edge is relative to.
+  template<class Tree>
+  struct Split_level_<Tree, true> : Split_level_<Tree, false>
+  {
+    Index<Tree> base;
+    Index<Tree> low;
+    Index<Tree> high;
+    Index<Tree> position;
+  };
+
+  // The parts of a subtree split at a key, and the node equal to the key if
+  // there is one. Without the key, node is the last node of the subtree.
+  template<class Tree>
+  struct Key_split_
+  {
+    Subtree_<Tree> left;
+    Node_pointer<Tree> node;
+    Subtree_<Tree> right;
+  };
+
+  template<class Tree, bool = Index_trait_<Tree>::value>
+  struct Detached_index_
+  {};
+
+  template<class Tree>
+  struct Detached_index_<Tree, true>
+  {
+    using Index = typename Index_trait_<Tree>::Type;
+
+    template<unsigned i>
+    [[nodiscard]] static Index make_index() noexcept
+    {
+      return make_index_<Tree, i>();
+    }
+  };
+
+  // Stands in for the tree while its detached subtrees are worked on,
+  // keeping the root to itself. Each thread gets a copy of its own, so that
+  // the rotations at the top of the subtrees do not race on the root of the
+  // tree.
+  template<class Tree>
+  struct Detached_tree_ : Detached_index_<Tree>
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    explicit Detached_tree_(Remove_reference_<Tree>& t) noexcept :
+      tree_(::std::addressof(t)),
+      root_(nullptr)
+    {}
+
+    [[nodiscard]] Node_pointer const& root() const noexcept
+    {
+      return root_;
+    }
+
+    void set_root(Node_pointer const& p) noexcept
+    {
+      root_ = p;
+    }
+
+    template<class P>
+    [[nodiscard]] decltype(auto) address(P const& p) const noexcept
+    {
+      return base_().address(p);
+    }
+
+    template<class N>
+    [[nodiscard]] decltype(auto) balance(N& n) const noexcept
+    {
+      return base_().balance(n);
+    }
+
+    template<class N>
+    [[nodiscard]] decltype(auto) side(N& n) const noexcept
+    {
+      return base_().side(n);
+    }
+
+    template<class N>
+    [[nodiscard]] decltype(auto) parent(N& n) const noexcept
+    {
+      return base_().parent(n);
+    }
+
+    template<Side side, class N>
+    [[nodiscard]] decltype(auto) child(N& n) const noexcept
+    {
+      return base_().template child<side>(n);
+    }
+
+    template<class N>
+    [[nodiscard]] decltype(auto) index(N& n) const noexcept
+    {
+      return base_().index(n);
+    }
+
+    template<class N, class B>
+    void set_balance(N& n, B const& b) const noexcept
+    {
+      base_().set_balance(n, b);
+    }
+
+    template<class N, class S>
+    void set_side(N& n, S const& s) const noexcept
+    {
+      base_().set_side(n, s);
+    }
+
+    template<class N, class P>
+    void set_parent(N& n, P const& p) const noexcept
+    {
+      base_().set_parent(n, p);
+    }
+
+    template<Side side, class N, class P>
+    void set_child(N& n, P const& p) const noexcept
+    {
+      base_().template set_child<side>(n, p);
+    }
+
+    template<unsigned i, class N>
+    void set_index(N& n) const noexcept
+    {
+      base_().template set_index<i>(n);
+    }
+
+    template<class N>
+    void increment_index(N& n) const noexcept
+    {
+      base_().increment_index(n);
+    }
+
+    template<class N>
+    void decrement_index(N& n) const noexcept
+    {
+      base_().decrement_index(n);
+    }
+
+    template<class N, class I>
+    void add_to_index(N& n, I const& i) const noexcept
+    {
+      base_().add_to_index(n, i);
+    }
+
+    template<class N, class I>
+    void subtract_from_index(N& n, I const& i) const noexcept
+    {
+      base_().subtract_from_index(n, i);
+    }
+
+  private:
+    [[nodiscard]] Tree&& base_() const noexcept
+    {
+      return static_cast<Tree&&>(*tree_);
+    }
+
+    Remove_reference_<Tree>* tree_;
+    Node_pointer root_;
+  };
+
   template<class Tree, bool, bool>
   struct Erase_base_
   {};
@@ -737,6 +1761,33 @@ private:
   using Index_or_offset_ =
     typename Index_or_offset_type_<Tree, is_offset>::Type;
 
+  // Descends from node_ptr to the first node of its subtree for which
+  // is_before returns false, or returns result_ptr if there is none.
+  template<class Tree, class Is_before>
+  [[nodiscard]] static Node_pointer<Tree> partition_point_(
+    Tree&& tree,
+    Node_pointer<Tree> node_ptr,
+    Node_pointer<Tree> result_ptr,
+    Is_before&& is_before)
+  {
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    while(node_ptr)
+    {
+      auto* const node(static_cast<Tree&&>(tree).address(node_ptr));
+      TREEXX_ASSERT(node);
+      bool const before(static_cast<Is_before&&>(is_before)(*node));
+      Node_pointer const left_ptr(
+        static_cast<Tree&&>(tree).template child<Side::left>(*node));
+      Node_pointer const right_ptr(
+        static_cast<Tree&&>(tree).template child<Side::right>(*node));
+      result_ptr = before ? result_ptr : node_ptr;
+      node_ptr = before ? right_ptr : left_ptr;
+    }
+
+    return result_ptr;
+  }
+
   enum class Binary_search_type_ : char unsigned
   {
     any_match = 0u,
@@ -1615,6 +2666,1039 @@ private:
       fixup_node_ptr, data.fixup_side);
   }
 
+  template<class Tree>
+  [[nodiscard]] static unsigned subtree_height_(
+    Tree&& tree,
+    Node_pointer<Tree> ptr) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    unsigned height = 0u;
+    while(ptr)
+    {
+      Node* const node(static_cast<Tree&&>(tree).address(ptr));
+      TREEXX_ASSERT(node);
+      ++height;
+      if(Balance::overleft == static_cast<Tree&&>(tree).balance(*node))
+      {
+        ptr = static_cast<Tree&&>(tree).template child<Side::left>(*node);
+      }
+      else
+      {
+        ptr = static_cast<Tree&&>(tree).template child<Side::right>(*node);
+      }
+    }
+
+    return height;
+  }
+
+  template<class Tree>
+  [[nodiscard]] static unsigned child_height_(
+    Tree&& tree,
+    Node<Tree>& node,
+    unsigned const height,
+    Side const side) noexcept
+  {
+    TREEXX_ASSERT(0u < height);
+    Balance const balance(static_cast<Tree&&>(tree).balance(node));
+    bool const is_lower = Side::left == side ?
+      Balance::overright == balance :
+      Balance::overleft == balance;
+    return height - (is_lower ? 2u : 1u);
+  }
+
+  template<class Tree>
+  [[nodiscard]] static auto tree_size_(
+    Tree&& tree) noexcept -> typename Index_trait_<Tree>::Type
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    Node_pointer const ptr(
+      static_cast<Tree&&>(tree).template extreme<Side::right>());
+    if(ptr)
+    {
+      Node* const node(static_cast<Tree&&>(tree).address(ptr));
+      TREEXX_ASSERT(node);
+      return
+        node_index(static_cast<Tree&&>(tree), *node) +
+        make_index_<Tree, 1u>();
+    }
+
+    return make_index_<Tree, 0u>();
+  }
+
+  template<bool increment, class Tree>
+  static void shift_left_edge_(
+    Tree&& tree,
+    Node_pointer<Tree> ptr) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    while(ptr)
+    {
+      Node* const node(static_cast<Tree&&>(tree).address(ptr));
+      TREEXX_ASSERT(node);
+      if constexpr(increment)
+      {
+        static_cast<Tree&&>(tree).increment_index(*node);
+      }
+      else
+      {
+        static_cast<Tree&&>(tree).decrement_index(*node);
+      }
+
+      ptr = static_cast<Tree&&>(tree).template child<Side::left>(*node);
+    }
+  }
+
+  template<Side side, class Tree>
+  static void subtree_of_child_(
+    Tree&& tree,
+    Split_level_<Tree> const& level,
+    Subtree_<Tree>& subtree) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    static_assert(Side::left == side || Side::right == side);
+    Node* const node(static_cast<Tree&&>(tree).address(level.node));
+    TREEXX_ASSERT(node);
+    subtree.root = static_cast<Tree&&>(tree).template child<side>(*node);
+    subtree.height = child_height_(
+      static_cast<Tree&&>(tree), *node, level.height, side);
+    if constexpr(Index_trait_<Tree>::value)
+    {
+      if constexpr(Side::left == side)
+      {
+        subtree.size = level.position - level.low;
+        subtree.bias = make_index_<Tree, 0u>() < level.low;
+      }
+      else
+      {
+        subtree.size =
+          level.high - level.position - make_index_<Tree, 1u>();
+        subtree.bias = true;
+      }
+    }
+  }
+
+  // Links two detached subtrees through the node. The shorter subtree goes
+  // under the node, which is attached to the inner edge of the higher one
+  // where that edge is about as high, and the result is rebalanced the way
+  // it is done after an insertion.
+  template<class Tree>
+  [[nodiscard]] static Subtree_<Tree> join_(
+    Tree&& tree,
+    Subtree_<Tree> const& left,
+    Node_pointer<Tree> const& node_ptr,
+    Subtree_<Tree> const& right) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    bool constexpr has_index(Index_trait_<Tree>::value);
+    Node* const node(static_cast<Tree&&>(tree).address(node_ptr));
+    TREEXX_ASSERT(node);
+    Node* const left_root(
+      left.root ? static_cast<Tree&&>(tree).address(left.root) : nullptr);
+    Node* const right_root(
+      right.root ? static_cast<Tree&&>(tree).address(right.root) : nullptr);
+    if(left_root)
+    {
+      static_cast<Tree&&>(tree).set_parent(*left_root, nullptr);
+    }
+
+    if(right_root)
+    {
+      static_cast<Tree&&>(tree).set_parent(*right_root, nullptr);
+    }
+
+    Subtree_<Tree> joint;
+    if constexpr(has_index)
+    {
+      joint.size = left.size + right.size + make_index_<Tree, 1u>();
+      joint.bias = left.bias;
+      static_cast<Tree&&>(tree).template set_index<0u>(*node);
+      static_cast<Tree&&>(tree).add_to_index(*node, left.size);
+      if(left.bias)
+      {
+        static_cast<Tree&&>(tree).increment_index(*node);
+      }
+    }
+
+    if(right.height + 1u < left.height)
+    {
+      Node_pointer parent_ptr(left.root);
+      Node* parent(left_root);
+      Node_pointer child_ptr;
+      unsigned height = left.height;
+      unsigned child_height;
+      if constexpr(has_index)
+      {
+        // The right edge is relative to the parents all the way down.
+        static_cast<Tree&&>(tree).subtract_from_index(
+          *node, static_cast<Tree&&>(tree).index(*parent));
+      }
+
+      for(;;)
+      {
+        child_ptr = static_cast<Tree&&>(tree).
+          template child<Side::right>(*parent);
+        child_height = child_height_(
+          static_cast<Tree&&>(tree), *parent, height, Side::right);
+        if(right.height + 1u >= child_height)
+        {
+          break;
+        }
+
+        parent_ptr = child_ptr;
+        parent = static_cast<Tree&&>(tree).address(child_ptr);
+        TREEXX_ASSERT(parent);
+        height = child_height;
+        if constexpr(has_index)
+        {
+          static_cast<Tree&&>(tree).subtract_from_index(
+            *node, static_cast<Tree&&>(tree).index(*parent));
+        }
+      }
+
+      link_(static_cast<Tree&&>(tree), node_ptr, child_ptr, right.root);
+      if constexpr(has_index)
+      {
+        if(right_root && !right.bias)
+        {
+          shift_left_edge_<true>(static_cast<Tree&&>(tree), right.root);
+        }
+      }
+
+      static_cast<Tree&&>(tree).set_balance(
+        *node,
+        right.height < child_height ? Balance::overleft : Balance::poised);
+      static_cast<Tree&&>(tree).set_parent(*node, parent_ptr);
+      static_cast<Tree&&>(tree).set_side(*node, Side::right);
+      static_cast<Tree&&>(tree).template set_child<Side::right>(
+        *parent, node_ptr);
+      fix_up_join_(
+        static_cast<Tree&&>(tree), node_ptr, left.root, left.height, joint);
+    }
+    else if(left.height + 1u < right.height)
+    {
+      Node_pointer parent_ptr(right.root);
+      Node* parent(right_root);
+      Node_pointer child_ptr;
+      unsigned height = right.height;
+      unsigned child_height;
+      [[maybe_unused]] Optional_index_<Tree, has_index> shift;
+      if constexpr(has_index)
+      {
+        // The left edge of the right subtree stays on the left edge of the
+        // joint, behind the left subtree and the node.
+        shift.node_index = left.size + make_index_<Tree, 1u>();
+        if(left.bias)
+        {
+          shift.node_index = shift.node_index + make_index_<Tree, 1u>();
+        }
+
+        if(right.bias)
+        {
+          shift.node_index = shift.node_index - make_index_<Tree, 1u>();
+        }
+
+        static_cast<Tree&&>(tree).add_to_index(*parent, shift.node_index);
+      }
+
+      for(;;)
+      {
+        child_ptr = static_cast<Tree&&>(tree).
+          template child<Side::left>(*parent);
+        child_height = child_height_(
+          static_cast<Tree&&>(tree), *parent, height, Side::left);
+        if(left.height + 1u >= child_height)
+        {
+          break;
+        }
+
+        parent_ptr = child_ptr;
+        parent = static_cast<Tree&&>(tree).address(child_ptr);
+        TREEXX_ASSERT(parent);
+        height = child_height;
+        if constexpr(has_index)
+        {
+          static_cast<Tree&&>(tree).add_to_index(*parent, shift.node_index);
+        }
+      }
+
+      link_(static_cast<Tree&&>(tree), node_ptr, left.root, child_ptr);
+      if constexpr(has_index)
+      {
+        if(!right.bias)
+        {
+          shift_left_edge_<true>(static_cast<Tree&&>(tree), child_ptr);
+        }
+      }
+
+      static_cast<Tree&&>(tree).set_balance(
+        *node,
+        left.height < child_height ? Balance::overright : Balance::poised);
+      static_cast<Tree&&>(tree).set_parent(*node, parent_ptr);
+      static_cast<Tree&&>(tree).set_side(*node, Side::left);
+      static_cast<Tree&&>(tree).template set_child<Side::left>(
+        *parent, node_ptr);
+      fix_up_join_(
+        static_cast<Tree&&>(tree), node_ptr, right.root, right.height, joint);
+    }
+    else
+    {
+      link_(static_cast<Tree&&>(tree), node_ptr, left.root, right.root);
+      if constexpr(has_index)
+      {
+        if(right_root && !right.bias)
+        {
+          shift_left_edge_<true>(static_cast<Tree&&>(tree), right.root);
+        }
+      }
+
+      Balance balance = Balance::poised;
+      if(left.height < right.height)
+      {
+        balance = Balance::overright;
+      }
+      else if(right.height < left.height)
+      {
+        balance = Balance::overleft;
+      }
+
+      static_cast<Tree&&>(tree).set_balance(*node, balance);
+      static_cast<Tree&&>(tree).set_parent(*node, nullptr);
+      static_cast<Tree&&>(tree).set_side(*node, Side::left);
+      joint.root = node_ptr;
+      joint.height =
+        (left.height < right.height ? right.height : left.height) + 1u;
+    }
+
+    return joint;
+  }
+
+  template<class Tree>
+  static void link_(
+    Tree&& tree,
+    Node_pointer<Tree> const& node_ptr,
+    Node_pointer<Tree> const& left_ptr,
+    Node_pointer<Tree> const& right_ptr) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    Node* const node(static_cast<Tree&&>(tree).address(node_ptr));
+    TREEXX_ASSERT(node);
+    static_cast<Tree&&>(tree).template set_child<Side::left>(*node, left_ptr);
+    static_cast<Tree&&>(tree).template set_child<Side::right>(*node, right_ptr);
+    if(left_ptr)
+    {
+      Node* const left(static_cast<Tree&&>(tree).address(left_ptr));
+      TREEXX_ASSERT(left);
+      static_cast<Tree&&>(tree).set_parent(*left, node_ptr);
+      static_cast<Tree&&>(tree).set_side(*left, Side::left);
+    }
+
+    if(right_ptr)
+    {
+      Node* const right(static_cast<Tree&&>(tree).address(right_ptr));
+      TREEXX_ASSERT(right);
+      static_cast<Tree&&>(tree).set_parent(*right, node_ptr);
+      static_cast<Tree&&>(tree).set_side(*right, Side::right);
+    }
+  }
+
+  // The subtree rooted at the node has just become one level higher than the
+  // one it replaced inside the higher subtree of a join.
+  template<class Tree>
+  static void fix_up_join_(
+    Tree&& tree,
+    Node_pointer<Tree> const& node_ptr,
+    Node_pointer<Tree> const& top_ptr,
+    unsigned const top_height,
+    Subtree_<Tree>& joint) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    Node* const top(static_cast<Tree&&>(tree).address(top_ptr));
+    TREEXX_ASSERT(top);
+    Balance const top_balance(static_cast<Tree&&>(tree).balance(*top));
+    fix_up_attachment_(static_cast<Tree&&>(tree), node_ptr);
+
+    Node_pointer root_ptr(node_ptr);
+    Node* root(static_cast<Tree&&>(tree).address(root_ptr));
+    for(;;)
+    {
+      TREEXX_ASSERT(root);
+      Node_pointer const parent_ptr(static_cast<Tree&&>(tree).parent(*root));
+      if(!parent_ptr)
+      {
+        break;
+      }
+
+      root_ptr = parent_ptr;
+      root = static_cast<Tree&&>(tree).address(parent_ptr);
+    }
+
+    // Only a growth that reached the old top unbalances it without a rotation.
+    bool const grew =
+      root == top &&
+      Balance::poised == top_balance &&
+      Balance::poised != static_cast<Tree&&>(tree).balance(*top);
+    static_cast<Tree&&>(tree).set_side(*root, Side::left);
+    joint.root = root_ptr;
+    joint.height = top_height + (grew ? 1u : 0u);
+  }
+
+  // A subtree of the height is taken to have about 2^(height - 1) nodes.
+  template<class Fork_join>
+  [[nodiscard]] static bool is_coarse_(
+    Fork_join&& fork_join,
+    unsigned const height) noexcept
+  {
+    using Size = Remove_cv_ref_<decltype(fork_join.grain_size())>;
+
+    Size const grain = fork_join.grain_size();
+    if(1u > height || 1u > grain)
+    {
+      return 0u < height;
+    }
+
+    return
+      height > static_cast<unsigned>(::std::numeric_limits<Size>::digits) ||
+      0u == ((grain - 1u) >> (height - 1u));
+  }
+
+  // Runs left(tree) and right(tree) through fork_join when the subtrees are
+  // coarse enough, giving each a tree of its own.
+  template<class Tree, class Fork_join, class Left, class Right>
+  static void fork_(
+    Tree&& tree,
+    Fork_join&& fork_join,
+    unsigned const height,
+    Left&& left,
+    Right&& right) noexcept
+  {
+    if(is_coarse_(fork_join, height))
+    {
+      Remove_cv_ref_<Tree> left_tree(tree);
+      Remove_cv_ref_<Tree> right_tree(tree);
+      fork_join.invoke(
+        [&left, &left_tree]() { left(left_tree); },
+        [&right, &right_tree]() { right(right_tree); });
+    }
+    else
+    {
+      left(tree);
+      right(tree);
+    }
+  }
+
+  template<class Tree, class Iterator, class Fork_join>
+  [[nodiscard]] static Subtree_<Tree> build_(
+    Tree&& tree,
+    Iterator const first,
+    Iterator const last,
+    Node_pointer<Tree> const& parent_ptr,
+    Side const side,
+    bool const bias,
+    Optional_offset_<Tree, Offset_trait_<Tree>::value> const& anchor,
+    Fork_join&& fork_join) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+    using Subtree = Subtree_<Tree>;
+
+    bool constexpr has_index(Index_trait_<Tree>::value);
+    bool constexpr has_offset(Offset_trait_<Tree>::value);
+    auto const count = last - first;
+    Iterator const middle = first + count / 2;
+    Node_pointer const node_ptr(*middle);
+    Node* const node(static_cast<Tree&&>(tree).address(node_ptr));
+    TREEXX_ASSERT(node);
+
+    // The nodes of the right subtree are relative to this one.
+    [[maybe_unused]] Optional_offset_<Tree, has_offset> middle_anchor;
+    if constexpr(has_offset)
+    {
+      middle_anchor.base_offset = static_cast<Tree&&>(tree).offset(*node);
+      static_cast<Tree&&>(tree).subtract_from_offset(
+        *node, anchor.base_offset);
+    }
+
+    Subtree left(empty_subtree_<Tree>(bias));
+    Subtree right(empty_subtree_<Tree>(true));
+    auto const build_left = [&]() noexcept
+    {
+      if(first != middle)
+      {
+        left = build_(
+          static_cast<Tree&&>(tree), first, middle,
+          node_ptr, Side::left, bias, anchor, fork_join);
+      }
+    };
+
+    auto const build_right = [&]() noexcept
+    {
+      if(last != middle + 1)
+      {
+        right = build_(
+          static_cast<Tree&&>(tree), middle + 1, last,
+          node_ptr, Side::right, true, middle_anchor, fork_join);
+      }
+    };
+
+    auto const grain = fork_join.grain_size();
+    if(static_cast<Remove_cv_ref_<decltype(grain)>>(count) >= grain)
+    {
+      fork_join.invoke(build_left, build_right);
+    }
+    else
+    {
+      build_left();
+      build_right();
+    }
+
+    // The left half is never smaller than the right one.
+    static_cast<Tree&&>(tree).template set_child<Side::left>(*node, left.root);
+    static_cast<Tree&&>(tree).
+      template set_child<Side::right>(*node, right.root);
+    static_cast<Tree&&>(tree).set_parent(*node, parent_ptr);
+    static_cast<Tree&&>(tree).set_side(*node, side);
+    static_cast<Tree&&>(tree).set_balance(
+      *node,
+      right.height < left.height ? Balance::overleft : Balance::poised);
+
+    Subtree subtree;
+    subtree.root = node_ptr;
+    subtree.height = left.height + 1u;
+    if constexpr(has_index)
+    {
+      static_cast<Tree&&>(tree).template set_index<0u>(*node);
+      static_cast<Tree&&>(tree).add_to_index(*node, left.size);
+      if(bias)
+      {
+        static_cast<Tree&&>(tree).increment_index(*node);
+      }
+
+      subtree.size = left.size + right.size + make_index_<Tree, 1u>();
+      subtree.bias = bias;
+    }
+
+    return subtree;
+  }
+
+  template<class Tree>
+  [[nodiscard]] static Subtree_<Tree> empty_subtree_(bool const bias) noexcept
+  {
+    Subtree_<Tree> subtree;
+    subtree.root = nullptr;
+    subtree.height = 0u;
+    if constexpr(Index_trait_<Tree>::value)
+    {
+      subtree.size = make_index_<Tree, 0u>();
+      subtree.bias = bias;
+    }
+
+    return subtree;
+  }
+
+  template<class Subtree, class Tree>
+  [[nodiscard]] static Subtree whole_subtree_(Tree&& tree) noexcept
+  {
+    Subtree subtree;
+    subtree.root = static_cast<Tree&&>(tree).root();
+    subtree.height = subtree_height_(static_cast<Tree&&>(tree), subtree.root);
+    if constexpr(Index_trait_<Tree>::value)
+    {
+      subtree.size = tree_size_(static_cast<Tree&&>(tree));
+      subtree.bias = false;
+    }
+
+    return subtree;
+  }
+
+  // Makes the subtree the whole of tree.
+  template<class Tree, class Subtree>
+  static void assign_subtree_(Tree&& tree, Subtree const& subtree) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    Node_pointer extremes[2u] = {nullptr, nullptr};
+    if(subtree.root)
+    {
+      Node* const root(static_cast<Tree&&>(tree).address(subtree.root));
+      TREEXX_ASSERT(root);
+      static_cast<Tree&&>(tree).set_parent(*root, nullptr);
+      static_cast<Tree&&>(tree).set_side(*root, Side::left);
+      if constexpr(Index_trait_<Tree>::value)
+      {
+        if(subtree.bias)
+        {
+          shift_left_edge_<false>(static_cast<Tree&&>(tree), subtree.root);
+        }
+      }
+
+      extremes[0u] = extremes[1u] = subtree.root;
+      for(Node_pointer& ptr: extremes)
+      {
+        for(;;)
+        {
+          Node* const node(static_cast<Tree&&>(tree).address(ptr));
+          TREEXX_ASSERT(node);
+          Node_pointer const child_ptr(&ptr == extremes ?
+            static_cast<Tree&&>(tree).template child<Side::left>(*node) :
+            static_cast<Tree&&>(tree).template child<Side::right>(*node));
+          if(!child_ptr)
+          {
+            break;
+          }
+
+          ptr = child_ptr;
+        }
+      }
+    }
+
+    static_cast<Tree&&>(tree).set_root(subtree.root);
+    static_cast<Tree&&>(tree).template set_extreme<Side::left>(extremes[0u]);
+    static_cast<Tree&&>(tree).template set_extreme<Side::right>(extremes[1u]);
+  }
+
+  template<Side side, class Tree>
+  static void child_subtree_(
+    Tree&& tree,
+    Subtree_<Tree> const& subtree,
+    Subtree_<Tree>& child) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    static_assert(Side::left == side || Side::right == side);
+    Node* const node(static_cast<Tree&&>(tree).address(subtree.root));
+    TREEXX_ASSERT(node);
+    child.root = static_cast<Tree&&>(tree).template child<side>(*node);
+    child.height = child_height_(
+      static_cast<Tree&&>(tree), *node, subtree.height, side);
+    if constexpr(Index_trait_<Tree>::value)
+    {
+      Index<Tree> left_size(static_cast<Tree&&>(tree).index(*node));
+      if(subtree.bias)
+      {
+        left_size = left_size - make_index_<Tree, 1u>();
+      }
+
+      if constexpr(Side::left == side)
+      {
+        child.size = left_size;
+        child.bias = subtree.bias;
+      }
+      else
+      {
+        child.size = subtree.size - left_size - make_index_<Tree, 1u>();
+        child.bias = true;
+      }
+    }
+  }
+
+  // Splits the subtree into the nodes less than the key, the one equal to it
+  // and the greater ones, where compare(x, key) tells how node x compares to
+  // the key.
+  template<class Tree, class Compare>
+  [[nodiscard]] static Key_split_<Tree> split_at_key_(
+    Tree&& tree,
+    Subtree_<Tree> const& subtree,
+    Node<Tree>& key,
+    Compare& compare) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Subtree = Subtree_<Tree>;
+
+    Key_split_<Tree> split;
+    if(!subtree.root)
+    {
+      split.left = subtree;
+      split.node = nullptr;
+      split.right = subtree;
+      return split;
+    }
+
+    Node* const node(static_cast<Tree&&>(tree).address(subtree.root));
+    TREEXX_ASSERT(node);
+    Subtree left;
+    Subtree right;
+    child_subtree_<Side::left>(static_cast<Tree&&>(tree), subtree, left);
+    child_subtree_<Side::right>(static_cast<Tree&&>(tree), subtree, right);
+    switch(compare(*node, key))
+    {
+    case Compare_result::equal:
+      split.left = left;
+      split.node = subtree.root;
+      split.right = right;
+      break;
+
+    case Compare_result::greater:
+      split = split_at_key_(static_cast<Tree&&>(tree), left, key, compare);
+      split.right = join_(
+        static_cast<Tree&&>(tree), split.right, subtree.root, right);
+      break;
+
+    case Compare_result::less:
+      split = split_at_key_(static_cast<Tree&&>(tree), right, key, compare);
+      split.left = join_(
+        static_cast<Tree&&>(tree), left, subtree.root, split.left);
+      break;
+    }
+
+    return split;
+  }
+
+  // Takes the last node out of the subtree, which must not be empty.
+  template<class Tree>
+  [[nodiscard]] static Key_split_<Tree> split_last_(
+    Tree&& tree,
+    Subtree_<Tree> const& subtree) noexcept
+  {
+    using Subtree = Subtree_<Tree>;
+
+    TREEXX_ASSERT(subtree.root);
+    Subtree left;
+    Subtree right;
+    child_subtree_<Side::left>(static_cast<Tree&&>(tree), subtree, left);
+    child_subtree_<Side::right>(static_cast<Tree&&>(tree), subtree, right);
+    if(!right.root)
+    {
+      Key_split_<Tree> split;
+      split.left = left;
+      split.node = subtree.root;
+      split.right = right;
+      return split;
+    }
+
+    Key_split_<Tree> split(split_last_(static_cast<Tree&&>(tree), right));
+    split.left = join_(
+      static_cast<Tree&&>(tree), left, subtree.root, split.left);
+    return split;
+  }
+
+  // Joins two detached subtrees without a node in between.
+  template<class Tree>
+  [[nodiscard]] static Subtree_<Tree> join_(
+    Tree&& tree,
+    Subtree_<Tree> const& left,
+    Subtree_<Tree> const& right) noexcept
+  {
+    if(!left.root)
+    {
+      return right;
+    }
+
+    if(!right.root)
+    {
+      return left;
+    }
+
+    Key_split_<Tree> const split(split_last_(static_cast<Tree&&>(tree), left));
+    return join_(static_cast<Tree&&>(tree), split.left, split.node, right);
+  }
+
+  template<class Tree, class Dispose>
+  static void dispose_subtree_(
+    Tree&& tree,
+    Node_pointer<Tree> const& ptr,
+    Dispose& dispose) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    if(ptr)
+    {
+      Node* const node(static_cast<Tree&&>(tree).address(ptr));
+      TREEXX_ASSERT(node);
+      dispose_subtree_(
+        static_cast<Tree&&>(tree),
+        static_cast<Tree&&>(tree).template child<Side::left>(*node),
+        dispose);
+      dispose_subtree_(
+        static_cast<Tree&&>(tree),
+        static_cast<Tree&&>(tree).template child<Side::right>(*node),
+        dispose);
+      dispose(ptr);
+    }
+  }
+
+  template<class Tree, class Fun>
+  static void for_each_in_subtree_(
+    Tree&& tree,
+    Node_pointer<Tree> const& ptr,
+    Fun& fun)
+  {
+    using Node = Tree_algo::Node<Tree>;
+
+    if(ptr)
+    {
+      Node* const node(static_cast<Tree&&>(tree).address(ptr));
+      TREEXX_ASSERT(node);
+      for_each_in_subtree_(
+        static_cast<Tree&&>(tree),
+        static_cast<Tree&&>(tree).template child<Side::left>(*node),
+        fun);
+      fun(*node);
+      for_each_in_subtree_(
+        static_cast<Tree&&>(tree),
+        static_cast<Tree&&>(tree).template child<Side::right>(*node),
+        fun);
+    }
+  }
+
+  template<class Tree, class Fun, class Fork_join>
+  static void for_each_unordered_(
+    Tree&& tree,
+    Node_pointer<Tree> const& ptr,
+    unsigned const height,
+    Fun& fun,
+    Fork_join& fork_join)
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    if(!is_coarse_(fork_join, height))
+    {
+      for_each_in_subtree_(static_cast<Tree&&>(tree), ptr, fun);
+      return;
+    }
+
+    Node* const node(static_cast<Tree&&>(tree).address(ptr));
+    TREEXX_ASSERT(node);
+    Node_pointer const left_ptr(
+      static_cast<Tree&&>(tree).template child<Side::left>(*node));
+    Node_pointer const right_ptr(
+      static_cast<Tree&&>(tree).template child<Side::right>(*node));
+    unsigned const left_height(child_height_(
+      static_cast<Tree&&>(tree), *node, height, Side::left));
+    unsigned const right_height(child_height_(
+      static_cast<Tree&&>(tree), *node, height, Side::right));
+    fork_join.invoke(
+      [&]()
+      {
+        for_each_unordered_(
+          static_cast<Tree&&>(tree), left_ptr, left_height, fun, fork_join);
+      },
+      [&]()
+      {
+        for_each_unordered_(
+          static_cast<Tree&&>(tree), right_ptr, right_height, fun, fork_join);
+      });
+    fun(*node);
+  }
+
+  template<class Tree, class Destroy, class Fork_join>
+  static void clear_(
+    Tree&& tree,
+    Node_pointer<Tree> const& ptr,
+    unsigned const height,
+    Destroy& destroy,
+    Fork_join& fork_join) noexcept
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    if(!is_coarse_(fork_join, height))
+    {
+      dispose_subtree_(static_cast<Tree&&>(tree), ptr, destroy);
+      return;
+    }
+
+    Node* const node(static_cast<Tree&&>(tree).address(ptr));
+    TREEXX_ASSERT(node);
+    Node_pointer const left_ptr(
+      static_cast<Tree&&>(tree).template child<Side::left>(*node));
+    Node_pointer const right_ptr(
+      static_cast<Tree&&>(tree).template child<Side::right>(*node));
+    unsigned const left_height(child_height_(
+      static_cast<Tree&&>(tree), *node, height, Side::left));
+    unsigned const right_height(child_height_(
+      static_cast<Tree&&>(tree), *node, height, Side::right));
+    fork_join.invoke(
+      [&]() noexcept
+      {
+        clear_(
+          static_cast<Tree&&>(tree), left_ptr, left_height, destroy,
+          fork_join);
+      },
+      [&]() noexcept
+      {
+        clear_(
+          static_cast<Tree&&>(tree), right_ptr, right_height, destroy,
+          fork_join);
+      });
+    destroy(ptr);
+  }
+
+  template<class Tree, class Compare, class Dispose, class Fork_join>
+  [[nodiscard]] static Subtree_<Tree> union_(
+    Tree&& tree,
+    Subtree_<Tree> const& a,
+    Subtree_<Tree> const& b,
+    Compare& compare,
+    Dispose& dispose,
+    Fork_join&& fork_join) noexcept
+  {
+    using Subtree = Subtree_<Tree>;
+
+    if(!a.root)
+    {
+      return b;
+    }
+
+    if(!b.root)
+    {
+      return a;
+    }
+
+    Node<Tree>* const key(static_cast<Tree&&>(tree).address(a.root));
+    TREEXX_ASSERT(key);
+    Subtree a_left;
+    Subtree a_right;
+    child_subtree_<Side::left>(static_cast<Tree&&>(tree), a, a_left);
+    child_subtree_<Side::right>(static_cast<Tree&&>(tree), a, a_right);
+    Key_split_<Tree> const split(
+      split_at_key_(static_cast<Tree&&>(tree), b, *key, compare));
+
+    Subtree left;
+    Subtree right;
+    fork_(
+      static_cast<Tree&&>(tree), fork_join,
+      a.height < b.height ? a.height : b.height,
+      [&](auto& t) noexcept
+      {
+        left = union_(t, a_left, split.left, compare, dispose, fork_join);
+      },
+      [&](auto& t) noexcept
+      {
+        right = union_(t, a_right, split.right, compare, dispose, fork_join);
+      });
+
+    if(split.node)
+    {
+      dispose(split.node);
+    }
+
+    return join_(static_cast<Tree&&>(tree), left, a.root, right);
+  }
+
+  template<class Tree, class Compare, class Dispose, class Fork_join>
+  [[nodiscard]] static Subtree_<Tree> intersection_(
+    Tree&& tree,
+    Subtree_<Tree> const& a,
+    Subtree_<Tree> const& b,
+    Compare& compare,
+    Dispose& dispose,
+    Fork_join&& fork_join) noexcept
+  {
+    using Subtree = Subtree_<Tree>;
+
+    if(!a.root)
+    {
+      return a;
+    }
+
+    if(!b.root)
+    {
+      dispose_subtree_(static_cast<Tree&&>(tree), a.root, dispose);
+      Subtree empty(a);
+      empty.root = nullptr;
+      empty.height = 0u;
+      if constexpr(Index_trait_<Tree>::value)
+      {
+        empty.size = make_index_<Tree, 0u>();
+      }
+
+      return empty;
+    }
+
+    Node<Tree>* const key(static_cast<Tree&&>(tree).address(b.root));
+    TREEXX_ASSERT(key);
+    Subtree b_left;
+    Subtree b_right;
+    child_subtree_<Side::left>(static_cast<Tree&&>(tree), b, b_left);
+    child_subtree_<Side::right>(static_cast<Tree&&>(tree), b, b_right);
+    Key_split_<Tree> const split(
+      split_at_key_(static_cast<Tree&&>(tree), a, *key, compare));
+
+    Subtree left;
+    Subtree right;
+    fork_(
+      static_cast<Tree&&>(tree), fork_join,
+      a.height < b.height ? a.height : b.height,
+      [&](auto& t) noexcept
+      {
+        left = intersection_(
+          t, split.left, b_left, compare, dispose, fork_join);
+      },
+      [&](auto& t) noexcept
+      {
+        right = intersection_(
+          t, split.right, b_right, compare, dispose, fork_join);
+      });
+
+    if(split.node)
+    {
+      return join_(static_cast<Tree&&>(tree), left, split.node, right);
+    }
+
+    return join_(static_cast<Tree&&>(tree), left, right);
+  }
+
+  template<class Tree, class Compare, class Dispose, class Fork_join>
+  [[nodiscard]] static Subtree_<Tree> difference_(
+    Tree&& tree,
+    Subtree_<Tree> const& a,
+    Subtree_<Tree> const& b,
+    Compare& compare,
+    Dispose& dispose,
+    Fork_join&& fork_join) noexcept
+  {
+    using Subtree = Subtree_<Tree>;
+
+    if(!a.root || !b.root)
+    {
+      return a;
+    }
+
+    Node<Tree>* const key(static_cast<Tree&&>(tree).address(b.root));
+    TREEXX_ASSERT(key);
+    Subtree b_left;
+    Subtree b_right;
+    child_subtree_<Side::left>(static_cast<Tree&&>(tree), b, b_left);
+    child_subtree_<Side::right>(static_cast<Tree&&>(tree), b, b_right);
+    Key_split_<Tree> const split(
+      split_at_key_(static_cast<Tree&&>(tree), a, *key, compare));
+
+    Subtree left;
+    Subtree right;
+    fork_(
+      static_cast<Tree&&>(tree), fork_join,
+      a.height < b.height ? a.height : b.height,
+      [&](auto& t) noexcept
+      {
+        left = difference_(
+          t, split.left, b_left, compare, dispose, fork_join);
+      },
+      [&](auto& t) noexcept
+      {
+        right = difference_(
+          t, split.right, b_right, compare, dispose, fork_join);
+      });
+
+    if(split.node)
+    {
+      dispose(split.node);
+    }
+
+    return join_(static_cast<Tree&&>(tree), left, right);
+  }
+
   template<class Tree>
   static void attach_and_fix_up_(
     Tree&& tree,
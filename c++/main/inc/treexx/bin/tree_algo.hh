@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef TREEXX_BIN_TREEALGO_HH
 #define TREEXX_BIN_TREEALGO_HH
 
+#include <cstddef>
 #include <memory>
 #include <type_traits>
 
@@ -242,6 +243,73 @@ public:
     }
   }
 
+  // Destroys at most count nodes of tree, children before parents, and
+  // returns whether any are left. Every destroyed node is unlinked from its
+  // parent and the node to resume from is left as the root, so that repeated
+  // calls take a detached tree down piece by piece. Only the root of tree is
+  // used and updated; the extremes are left as they are.
+  template<class Tree, class Destroy>
+  static bool clear_some(
+    Tree&& tree,
+    Destroy&& destroy,
+    ::std::size_t count) noexcept(noexcept(
+      Util_::ref<Destroy>()(Util_::ref<Add_const_<Node_pointer<Tree>>&>())))
+  {
+    using Node = Tree_algo::Node<Tree>;
+    using Node_pointer = Tree_algo::Node_pointer<Tree>;
+
+    Node_pointer node_ptr(static_cast<Tree&&>(tree).root());
+    while(node_ptr)
+    {
+      Node* const node(static_cast<Tree&&>(tree).address(node_ptr));
+      TREEXX_ASSERT(node);
+      Node_pointer const left_child_ptr(
+        static_cast<Tree&&>(tree).template child<Side::left>(*node));
+      if(left_child_ptr)
+      {
+        node_ptr = left_child_ptr;
+        continue;
+      }
+
+      Node_pointer const right_child_ptr(
+        static_cast<Tree&&>(tree).template child<Side::right>(*node));
+      if(right_child_ptr)
+      {
+        node_ptr = right_child_ptr;
+        continue;
+      }
+
+      if(1u > count)
+      {
+        break;
+      }
+
+      --count;
+      Node_pointer const node_to_destroy_ptr(node_ptr);
+      node_ptr = static_cast<Tree&&>(tree).parent(*node);
+      if(node_ptr)
+      {
+        Node* const parent(static_cast<Tree&&>(tree).address(node_ptr));
+        TREEXX_ASSERT(parent);
+        if(Side::left == static_cast<Tree&&>(tree).side(*node))
+        {
+          static_cast<Tree&&>(tree).template set_child<Side::left>(
+            *parent, Node_pointer(nullptr));
+        }
+        else
+        {
+          static_cast<Tree&&>(tree).template set_child<Side::right>(
+            *parent, Node_pointer(nullptr));
+        }
+      }
+
+      static_cast<Destroy&&>(destroy)(node_to_destroy_ptr);
+    }
+
+    static_cast<Tree&&>(tree).set_root(node_ptr);
+    return node_ptr ? true : false;
+  }
+
   template<class Tree>
   static void swap(
     Tree&& tree,
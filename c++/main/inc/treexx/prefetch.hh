@@ -0,0 +1,37 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_PREFETCH_HH
+#define TREEXX_PREFETCH_HH
+
+// Hints that the memory at an address is about to be read. May be defined
+// before inclusion to use another intrinsic or to turn prefetching off.
+#ifndef TREEXX_PREFETCH
+# if defined(__GNUC__) || defined(__clang__)
+#   define TREEXX_PREFETCH(...) __builtin_prefetch(__VA_ARGS__)
+# else
+#   define TREEXX_PREFETCH(...) static_cast<void>(__VA_ARGS__)
+# endif
+#endif
+
+#endif // TREEXX_PREFETCH_HH
@@ -0,0 +1,366 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_AVLHOOK_HH
+#define TREEXX_STDXX_AVLHOOK_HH
+
+#include <cstddef>
+#include <type_traits>
+
+#include <treexx/bin/side.hh>
+#include <treexx/bin/avl/balance.hh>
+
+namespace treexx::stdxx
+{
+
+// Links embedded into a user object of type T, so that the object itself is
+// the tree node. I and O add an index and an offset respectively; void means
+// the hook does not carry one. Copying a hook never copies its links.
+template<class T, class I = void, class O = void>
+struct avl_hook : avl_hook<T, void, O>
+{
+  using index_type = I;
+
+  avl_hook() = default;
+
+  avl_hook(avl_hook const&) noexcept :
+    avl_hook<T, void, O>()
+  {}
+
+  avl_hook& operator =(avl_hook const&) noexcept
+  {
+    return *this;
+  }
+
+  I index = I();
+};
+
+template<class T, class O>
+struct avl_hook<T, void, O> : avl_hook<T>
+{
+  using offset_type = O;
+
+  avl_hook() = default;
+
+  avl_hook(avl_hook const&) noexcept :
+    avl_hook<T>()
+  {}
+
+  avl_hook& operator =(avl_hook const&) noexcept
+  {
+    return *this;
+  }
+
+  O offset = O();
+};
+
+template<class T>
+struct avl_hook<T, void, void>
+{
+  using index_type = void;
+  using offset_type = void;
+
+  avl_hook() = default;
+
+  avl_hook(avl_hook const&) noexcept
+  {}
+
+  avl_hook& operator =(avl_hook const&) noexcept
+  {
+    return *this;
+  }
+
+  T* parent = nullptr;
+  T* left_child = nullptr;
+  T* right_child = nullptr;
+  ::treexx::bin::avl::Balance balance = ::treexx::bin::avl::Balance::poised;
+  ::treexx::bin::Side side = ::treexx::bin::Side::left;
+};
+
+// Accessor of the hook member `hook`, as expected by basic_avl_hook_tree.
+template<class T, class H, H T::* hook>
+struct avl_member_hook
+{
+  [[nodiscard]] static H& get(T& x) noexcept
+  {
+    return x.*hook;
+  }
+
+  [[nodiscard]] static H const& get(T const& x) noexcept
+  {
+    return x.*hook;
+  }
+};
+
+// Tree adapter over objects linked through the hook returned by G::get. It
+// exposes Index and Offset only when H carries them.
+template<class T, class H, class G>
+struct basic_avl_hook_tree
+{
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Size_ = ::std::size_t;
+
+  template<bool c, class U, class V>
+  using Conditional_ = typename ::std::conditional<c, U, V>::type;
+
+  template<class U>
+  using Is_void_ = typename ::std::is_void<U>::type;
+
+  struct None_
+  {};
+
+public:
+  using Index = typename H::index_type;
+  using Offset = typename H::offset_type;
+
+private:
+  using Index_ = Conditional_<Is_void_<Index>::value, None_, Index>;
+  using Offset_ = Conditional_<Is_void_<Offset>::value, None_, Offset>;
+
+public:
+  basic_avl_hook_tree() noexcept :
+    root_(nullptr),
+    leftmost_(nullptr),
+    rightmost_(nullptr),
+    size_(static_cast<Size_>(0u))
+  {}
+
+  [[nodiscard]] static T* address(T* const n) noexcept
+  {
+    return n;
+  }
+
+  [[nodiscard]] static T* parent(T const& n) noexcept
+  {
+    return G::get(n).parent;
+  }
+
+  template<Side_ side>
+  [[nodiscard]] static T* child(T const& n) noexcept
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    if constexpr(Side_::left == side)
+    {
+      return G::get(n).left_child;
+    }
+    else if constexpr(Side_::right == side)
+    {
+      return G::get(n).right_child;
+    }
+  }
+
+  [[nodiscard]] static Balance_ balance(T const& n) noexcept
+  {
+    return G::get(n).balance;
+  }
+
+  [[nodiscard]] static Side_ side(T const& n) noexcept
+  {
+    return G::get(n).side;
+  }
+
+  [[nodiscard]] static Index_ const& index(T const& n) noexcept
+  {
+    return G::get(n).index;
+  }
+
+  [[nodiscard]] static Offset_ const& offset(T const& n) noexcept
+  {
+    return G::get(n).offset;
+  }
+
+  static void set_parent(T& n, T* const p) noexcept
+  {
+    G::get(n).parent = p;
+  }
+
+  template<Side_ side>
+  static void set_child(T& n, T* const c) noexcept
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    if constexpr(Side_::left == side)
+    {
+      G::get(n).left_child = c;
+    }
+    else if constexpr(Side_::right == side)
+    {
+      G::get(n).right_child = c;
+    }
+  }
+
+  static void set_balance(T& n, Balance_ const b) noexcept
+  {
+    G::get(n).balance = b;
+  }
+
+  static void set_side(T& n, Side_ const s) noexcept
+  {
+    G::get(n).side = s;
+  }
+
+  static void increment_index(T& n) noexcept
+  {
+    ++G::get(n).index;
+  }
+
+  static void decrement_index(T& n) noexcept
+  {
+    --G::get(n).index;
+  }
+
+  static void add_to_index(T& n, Index_ const& i) noexcept
+  {
+    G::get(n).index += i;
+  }
+
+  static void subtract_from_index(T& n, Index_ const& i) noexcept
+  {
+    G::get(n).index -= i;
+  }
+
+  static void set_index(T& n, Index_ const& i) noexcept
+  {
+    G::get(n).index = i;
+  }
+
+  template<unsigned i>
+  static void set_index(T& n) noexcept
+  {
+    G::get(n).index = static_cast<Index_>(i);
+  }
+
+  template<unsigned i>
+  [[nodiscard]] static Index_ make_index() noexcept
+  {
+    return static_cast<Index_>(i);
+  }
+
+  static void set_offset(T& n, Offset_ const& o) noexcept
+  {
+    G::get(n).offset = o;
+  }
+
+  static void add_to_offset(T& n, Offset_ const& o) noexcept
+  {
+    G::get(n).offset += o;
+  }
+
+  static void subtract_from_offset(T& n, Offset_ const& o) noexcept
+  {
+    G::get(n).offset -= o;
+  }
+
+  template<unsigned o>
+  [[nodiscard]] static Offset_ make_offset() noexcept
+  {
+    return static_cast<Offset_>(o);
+  }
+
+  [[nodiscard]] T* root() const noexcept
+  {
+    return root_;
+  }
+
+  template<Side_ side>
+  [[nodiscard]] T* extreme() const noexcept
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    if constexpr(Side_::left == side)
+    {
+      return leftmost_;
+    }
+    else if constexpr(Side_::right == side)
+    {
+      return rightmost_;
+    }
+  }
+
+  void set_root(T* const r) noexcept
+  {
+    root_ = r;
+  }
+
+  template<Side_ side>
+  void set_extreme(T* const x) noexcept
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    if constexpr(Side_::left == side)
+    {
+      leftmost_ = x;
+    }
+    else if constexpr(Side_::right == side)
+    {
+      rightmost_ = x;
+    }
+  }
+
+  [[nodiscard]] Size_ size() const noexcept
+  {
+    return size_;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return 1u > size_;
+  }
+
+  void increment_size() noexcept
+  {
+    ++size_;
+  }
+
+  void decrement_size() noexcept
+  {
+    --size_;
+  }
+
+  void reset() noexcept
+  {
+    root_ = nullptr;
+    leftmost_ = nullptr;
+    rightmost_ = nullptr;
+    size_ = static_cast<Size_>(0u);
+  }
+
+  void swap(basic_avl_hook_tree& x) noexcept
+  {
+    basic_avl_hook_tree const t(*this);
+    *this = x;
+    x = t;
+  }
+
+private:
+  T* root_;
+  T* leftmost_;
+  T* rightmost_;
+  Size_ size_;
+};
+
+template<class T, class H, H T::* hook>
+using avl_hook_tree = basic_avl_hook_tree<T, H, avl_member_hook<T, H, hook>>;
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_AVLHOOK_HH
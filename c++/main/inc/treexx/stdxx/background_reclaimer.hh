@@ -0,0 +1,172 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_BACKGROUNDRECLAIMER_HH
+#define TREEXX_STDXX_BACKGROUNDRECLAIMER_HH
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <treexx/assert.hh>
+
+namespace treexx::stdxx
+{
+
+// A thread that tears down detached node graphs so that their owners can
+// drop them in O(1). A job is called as job(chunk_size) until it returns
+// false, destroying at most chunk_size nodes per call; the pending jobs take
+// turns chunk by chunk, so a huge tree does not hold up a small one. The
+// destructor runs all the pending jobs to the end before joining the thread.
+struct background_reclaimer
+{
+  using size_type = ::std::size_t;
+
+private:
+  using Size_ = size_type;
+  using Job_ = ::std::function<bool(Size_)>;
+  using Mutex_ = ::std::mutex;
+  using Lock_ = ::std::unique_lock<Mutex_>;
+  using Condition_ = ::std::condition_variable;
+
+public:
+  explicit background_reclaimer(size_type const chunk_size = 4096u) :
+    chunk_size_(0u < chunk_size ? chunk_size : static_cast<Size_>(1u)),
+    running_(static_cast<Size_>(0u)),
+    stopping_(false)
+  {
+    thread_ = ::std::thread(
+      [this]() noexcept
+      {
+        run_();
+      });
+  }
+
+  background_reclaimer(background_reclaimer&&) = delete;
+  background_reclaimer(background_reclaimer const&) = delete;
+
+  ~background_reclaimer()
+  {
+    {
+      Lock_ const lock(mutex_);
+      stopping_ = true;
+    }
+
+    work_.notify_one();
+    thread_.join();
+  }
+
+  background_reclaimer& operator =(background_reclaimer&&) = delete;
+  background_reclaimer& operator =(background_reclaimer const&) = delete;
+
+  [[nodiscard]] size_type chunk_size() const noexcept
+  {
+    return chunk_size_;
+  }
+
+  // Number of jobs not finished yet.
+  [[nodiscard]] size_type pending() const
+  {
+    Lock_ const lock(mutex_);
+    return jobs_.size() + running_;
+  }
+
+  // Queues job, which must not throw.
+  template<class Job>
+  void post(Job&& job)
+  {
+    Job_ j(static_cast<Job&&>(job));
+    {
+      Lock_ const lock(mutex_);
+      TREEXX_ASSERT(!stopping_);
+      jobs_.push_back(::std::move(j));
+    }
+
+    work_.notify_one();
+  }
+
+  // Blocks until all the jobs posted so far are finished.
+  void drain()
+  {
+    Lock_ lock(mutex_);
+    idle_.wait(
+      lock,
+      [this]() noexcept
+      {
+        return jobs_.empty() && 1u > running_;
+      });
+  }
+
+private:
+  void run_() noexcept
+  {
+    Lock_ lock(mutex_);
+    for(;;)
+    {
+      work_.wait(
+        lock,
+        [this]() noexcept
+        {
+          return stopping_ || !jobs_.empty();
+        });
+
+      if(jobs_.empty())
+      {
+        break;
+      }
+
+      Job_ job(::std::move(jobs_.front()));
+      jobs_.pop_front();
+      ++running_;
+      lock.unlock();
+      bool const more = job(chunk_size_);
+      lock.lock();
+      --running_;
+      if(more)
+      {
+        jobs_.push_back(::std::move(job));
+      }
+      else if(jobs_.empty())
+      {
+        idle_.notify_all();
+      }
+    }
+  }
+
+  Size_ const chunk_size_;
+  ::std::deque<Job_> jobs_;
+  Size_ running_;
+  bool stopping_;
+  mutable Mutex_ mutex_;
+  Condition_ work_;
+  Condition_ idle_;
+  ::std::thread thread_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_BACKGROUNDRECLAIMER_HH
@@ -0,0 +1,382 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_COMBININGSEQUENCEMAP_HH
+#define TREEXX_STDXX_COMBININGSEQUENCEMAP_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <treexx/assert.hh>
+#include <treexx/stdxx/sparse_sequence_map.hh>
+
+namespace treexx::stdxx
+{
+
+// Sparse sequence map written by many threads through flat combining. Each
+// writer thread owns a slot on its own cache line and publishes one request
+// at a time there: an assignment, an erasure, or a shift of positions. Any
+// waiting writer that gets the lock becomes the combiner and applies all the
+// published requests in one go, in position order, while the others spin on
+// their slots. This is one of the orders the pending requests could have
+// taken effect in, since none of them has returned yet. Under contention a
+// batch costs one lock handoff instead of one per request, and the requests
+// go through one finger of the map: each seeks from where the previous one
+// ended and links new elements next to their neighbours, rather than
+// descending from the root.
+//
+// Exceptions thrown while applying a request are rethrown by its writer.
+template<class T, class A = ::std::allocator<T>>
+struct combining_sequence_map
+{
+  using map_type = sparse_sequence_map<T, A>;
+  using value_type = T;
+  using allocator_type = A;
+  using size_type = ::std::size_t;
+
+private:
+  using Map_ = map_type;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Mutex_ = ::std::mutex;
+  using Lock_ = ::std::unique_lock<Mutex_>;
+
+  static Size_ constexpr cache_line_size_ = 64u;
+
+  enum class Kind_ : unsigned char
+  {
+    insert_or_assign = 0u,
+    erase,
+    insert_rows,
+    erase_rows
+  };
+
+  enum class State_ : unsigned char
+  {
+    idle = 0u,
+    pending,
+    done
+  };
+
+  struct alignas(cache_line_size_) Slot_
+  {
+    Slot_() noexcept :
+      state(State_::idle),
+      in_use(false),
+      kind(Kind_::erase),
+      pos(static_cast<Size_>(0u)),
+      count(static_cast<Size_>(0u)),
+      value(nullptr),
+      result(static_cast<Size_>(0u))
+    {}
+
+    ::std::atomic<State_> state;
+    ::std::atomic<bool> in_use;
+    Kind_ kind;
+    Size_ pos;
+    Size_ count;
+    Value_* value;
+    Size_ result;
+    ::std::exception_ptr error;
+  };
+
+public:
+  // Registration of one writer thread. A writer is not thread-safe itself,
+  // each thread is expected to own one.
+  struct writer
+  {
+    writer() noexcept :
+      map_(nullptr),
+      slot_(nullptr)
+    {}
+
+    writer(writer&& x) noexcept :
+      map_(x.map_),
+      slot_(x.slot_)
+    {
+      x.map_ = nullptr;
+      x.slot_ = nullptr;
+    }
+
+    writer(writer const&) = delete;
+
+    ~writer()
+    {
+      release_();
+    }
+
+    writer& operator =(writer&& x) noexcept
+    {
+      if(this != ::std::addressof(x))
+      {
+        release_();
+        map_ = x.map_;
+        slot_ = x.slot_;
+        x.map_ = nullptr;
+        x.slot_ = nullptr;
+      }
+
+      return *this;
+    }
+
+    writer& operator =(writer const&) = delete;
+
+    explicit operator bool() const noexcept
+    {
+      return slot_ ? true : false;
+    }
+
+    // Returns true if an element was inserted, false if one was assigned.
+    template<class M>
+    bool insert_or_assign(size_type const& pos, M&& val)
+    {
+      Value_ v(static_cast<M&&>(val));
+      return static_cast<Size_>(0u) !=
+        submit_(Kind_::insert_or_assign, pos, static_cast<Size_>(0u), &v);
+    }
+
+    size_type erase(size_type const& pos)
+    {
+      return submit_(Kind_::erase, pos, static_cast<Size_>(0u), nullptr);
+    }
+
+    void insert_rows(size_type const& pos, size_type const& count)
+    {
+      static_cast<void>(submit_(Kind_::insert_rows, pos, count, nullptr));
+    }
+
+    size_type erase_rows(size_type const& pos, size_type const& count)
+    {
+      return submit_(Kind_::erase_rows, pos, count, nullptr);
+    }
+
+  private:
+    friend struct combining_sequence_map;
+
+    writer(combining_sequence_map& m, Slot_& s) noexcept :
+      map_(::std::addressof(m)),
+      slot_(::std::addressof(s))
+    {}
+
+    void release_() noexcept
+    {
+      if(slot_)
+      {
+        TREEXX_ASSERT(
+          State_::idle == slot_->state.load(::std::memory_order_relaxed));
+        slot_->in_use.store(false, ::std::memory_order_release);
+        map_ = nullptr;
+        slot_ = nullptr;
+      }
+    }
+
+    Size_ submit_(
+      Kind_ const kind,
+      Size_ const pos,
+      Size_ const count,
+      Value_* const value)
+    {
+      TREEXX_ASSERT(slot_);
+      Slot_& slot = *slot_;
+      slot.kind = kind;
+      slot.pos = pos;
+      slot.count = count;
+      slot.value = value;
+      slot.state.store(State_::pending, ::std::memory_order_release);
+      map_->wait_(slot);
+      slot.state.store(State_::idle, ::std::memory_order_relaxed);
+      if(slot.error)
+      {
+        ::std::exception_ptr error;
+        error.swap(slot.error);
+        ::std::rethrow_exception(error);
+      }
+
+      return slot.result;
+    }
+
+    combining_sequence_map* map_;
+    Slot_* slot_;
+  };
+
+  explicit combining_sequence_map(
+    size_type const max_writers = 64u,
+    allocator_type const& alloc = allocator_type()) :
+    map_(alloc),
+    slots_(new Slot_[max_writers]),
+    slot_count_(max_writers)
+  {
+    batch_.reserve(max_writers);
+  }
+
+  combining_sequence_map(combining_sequence_map&&) = delete;
+  combining_sequence_map(combining_sequence_map const&) = delete;
+
+  combining_sequence_map& operator =(combining_sequence_map&&) = delete;
+  combining_sequence_map& operator =(combining_sequence_map const&) = delete;
+
+  [[nodiscard]] size_type max_writers() const noexcept
+  {
+    return slot_count_;
+  }
+
+  // Registers the calling thread as a writer. Throws std::length_error when
+  // all the slots are taken.
+  [[nodiscard]] writer make_writer()
+  {
+    for(Size_ i = 0u; slot_count_ > i; ++i)
+    {
+      Slot_& slot = slots_[i];
+      bool expected = false;
+      if(
+        !slot.in_use.load(::std::memory_order_relaxed) &&
+        slot.in_use.compare_exchange_strong(
+          expected, true, ::std::memory_order_acquire))
+      {
+        return writer(*this, slot);
+      }
+    }
+
+    throw ::std::length_error(
+      "treexx::stdxx::combining_sequence_map: writer slots");
+  }
+
+  // Calls fun(map_type const&) under the lock and returns what it returns.
+  // The callback must not use the writers of this map.
+  template<class Fun>
+  decltype(auto) read(Fun&& fun) const
+  {
+    Lock_ const lock(mutex_);
+    return static_cast<Fun&&>(fun)(static_cast<Map_ const&>(map_));
+  }
+
+  [[nodiscard]] size_type size() const
+  {
+    Lock_ const lock(mutex_);
+    return map_.size();
+  }
+
+  [[nodiscard]] bool empty() const
+  {
+    Lock_ const lock(mutex_);
+    return map_.empty();
+  }
+
+private:
+  void wait_(Slot_& slot)
+  {
+    while(State_::done != slot.state.load(::std::memory_order_acquire))
+    {
+      Lock_ lock(mutex_, ::std::try_to_lock);
+      if(lock.owns_lock())
+      {
+        combine_();
+      }
+      else
+      {
+        ::std::this_thread::yield();
+      }
+    }
+  }
+
+  void combine_() noexcept
+  {
+    batch_.clear();
+    for(Size_ i = 0u; slot_count_ > i; ++i)
+    {
+      Slot_& slot = slots_[i];
+      if(State_::pending == slot.state.load(::std::memory_order_acquire))
+      {
+        batch_.push_back(::std::addressof(slot));
+      }
+    }
+
+    ::std::sort(
+      batch_.begin(), batch_.end(),
+      [](Slot_ const* const x, Slot_ const* const y) noexcept
+      {
+        return x->pos != y->pos ?
+          x->pos < y->pos :
+          ::std::less<Slot_ const*>()(x, y);
+      });
+
+    typename Map_::finger finger;
+    for(Slot_* const slot: batch_)
+    {
+      try
+      {
+        slot->result = apply_(*slot, finger);
+      }
+      catch(...)
+      {
+        slot->error = ::std::current_exception();
+      }
+
+      slot->state.store(State_::done, ::std::memory_order_release);
+    }
+  }
+
+  Size_ apply_(Slot_ const& slot, typename Map_::finger& finger)
+  {
+    switch(slot.kind)
+    {
+    case Kind_::insert_or_assign:
+      {
+        TREEXX_ASSERT(slot.value);
+        bool const inserted = map_.insert_or_assign(
+          finger, slot.pos, static_cast<Value_&&>(*slot.value)).second;
+        return inserted ? static_cast<Size_>(1u) : static_cast<Size_>(0u);
+      }
+
+    case Kind_::erase:
+      return map_.erase(finger, slot.pos);
+
+    case Kind_::insert_rows:
+      map_.insert_rows(finger, slot.pos, slot.count);
+      return static_cast<Size_>(0u);
+
+    default:
+      TREEXX_ASSERT(Kind_::erase_rows == slot.kind);
+      return map_.erase_rows(finger, slot.pos, slot.count);
+    }
+  }
+
+  Map_ map_;
+  ::std::unique_ptr<Slot_[]> slots_;
+  Size_ slot_count_;
+  ::std::vector<Slot_*> batch_;
+  mutable Mutex_ mutex_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_COMBININGSEQUENCEMAP_HH
@@ -0,0 +1,316 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_EPOCHDOMAIN_HH
+#define TREEXX_STDXX_EPOCHDOMAIN_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <treexx/assert.hh>
+
+namespace treexx::stdxx
+{
+
+// Epoch-based reclamation for data structures read without locks. Every
+// reader thread owns a slot on its own cache line and announces the epoch it
+// entered in; readers never write shared memory. A writer either waits for a
+// grace period with synchronize(), or hands unlinked objects to retire() and
+// lets reclaim() free them once no reader can still reach them. Those three
+// belong to the writer side and are not thread-safe among themselves.
+struct epoch_domain
+{
+  using size_type = ::std::size_t;
+  using epoch_type = ::std::uint64_t;
+
+private:
+  using Size_ = size_type;
+  using Epoch_ = epoch_type;
+  using Dispose_ = void (*)(void*, void*);
+
+  static Size_ constexpr cache_line_size_ = 64u;
+
+  struct alignas(cache_line_size_) Slot_
+  {
+    Slot_() noexcept :
+      epoch(static_cast<Epoch_>(0u)),
+      in_use(false)
+    {}
+
+    ::std::atomic<Epoch_> epoch;
+    ::std::atomic<bool> in_use;
+  };
+
+  struct Retired_
+  {
+    void* object;
+    void* context;
+    Dispose_ dispose;
+    Epoch_ epoch;
+  };
+
+public:
+  // Registration of one reader thread. A reader is not thread-safe itself,
+  // each thread is expected to own one.
+  struct reader
+  {
+    reader() noexcept :
+      domain_(nullptr),
+      slot_(nullptr)
+    {}
+
+    reader(reader&& x) noexcept :
+      domain_(x.domain_),
+      slot_(x.slot_)
+    {
+      x.domain_ = nullptr;
+      x.slot_ = nullptr;
+    }
+
+    reader(reader const&) = delete;
+
+    ~reader()
+    {
+      release_();
+    }
+
+    reader& operator =(reader&& x) noexcept
+    {
+      if(this != ::std::addressof(x))
+      {
+        release_();
+        domain_ = x.domain_;
+        slot_ = x.slot_;
+        x.domain_ = nullptr;
+        x.slot_ = nullptr;
+      }
+
+      return *this;
+    }
+
+    reader& operator =(reader const&) = delete;
+
+    explicit operator bool() const noexcept
+    {
+      return slot_ ? true : false;
+    }
+
+  private:
+    friend struct epoch_domain;
+
+    reader(epoch_domain const& d, Slot_& s) noexcept :
+      domain_(::std::addressof(d)),
+      slot_(::std::addressof(s))
+    {}
+
+    void release_() noexcept
+    {
+      if(slot_)
+      {
+        TREEXX_ASSERT(
+          static_cast<Epoch_>(0u) ==
+          slot_->epoch.load(::std::memory_order_relaxed));
+        slot_->in_use.store(false, ::std::memory_order_release);
+        domain_ = nullptr;
+        slot_ = nullptr;
+      }
+    }
+
+    epoch_domain const* domain_;
+    Slot_* slot_;
+  };
+
+  // Critical section of a reader. Anything reached through a pointer loaded
+  // inside the section stays alive until the guard is destroyed.
+  struct guard
+  {
+    explicit guard(reader& r) noexcept :
+      slot_(r.slot_)
+    {
+      TREEXX_ASSERT(slot_);
+      TREEXX_ASSERT(
+        static_cast<Epoch_>(0u) ==
+        slot_->epoch.load(::std::memory_order_relaxed));
+      slot_->epoch.store(
+        r.domain_->epoch_.load(::std::memory_order_relaxed),
+        ::std::memory_order_relaxed);
+      ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+    }
+
+    guard(guard&&) = delete;
+    guard(guard const&) = delete;
+
+    ~guard()
+    {
+      slot_->epoch.store(
+        static_cast<Epoch_>(0u), ::std::memory_order_release);
+    }
+
+    guard& operator =(guard&&) = delete;
+    guard& operator =(guard const&) = delete;
+
+  private:
+    Slot_* slot_;
+  };
+
+  explicit epoch_domain(size_type const max_readers = 128u) :
+    slots_(new Slot_[max_readers]),
+    slot_count_(max_readers),
+    epoch_(static_cast<Epoch_>(1u))
+  {}
+
+  epoch_domain(epoch_domain&&) = delete;
+  epoch_domain(epoch_domain const&) = delete;
+
+  ~epoch_domain()
+  {
+    for(Retired_ const& r: retired_)
+    {
+      r.dispose(r.object, r.context);
+    }
+  }
+
+  epoch_domain& operator =(epoch_domain&&) = delete;
+  epoch_domain& operator =(epoch_domain const&) = delete;
+
+  [[nodiscard]] size_type max_readers() const noexcept
+  {
+    return slot_count_;
+  }
+
+  // Registers the calling thread as a reader. Throws std::length_error when
+  // all the slots are taken.
+  [[nodiscard]] reader make_reader()
+  {
+    for(Size_ i = 0u; slot_count_ > i; ++i)
+    {
+      Slot_& slot = slots_[i];
+      bool expected = false;
+      if(
+        !slot.in_use.load(::std::memory_order_relaxed) &&
+        slot.in_use.compare_exchange_strong(
+          expected, true, ::std::memory_order_acquire))
+      {
+        return reader(*this, slot);
+      }
+    }
+
+    throw ::std::length_error("treexx::stdxx::epoch_domain: reader slots");
+  }
+
+  // Opens a new epoch and blocks until every reader that entered a critical
+  // section before the call has left it. Afterwards all the retired objects
+  // are freed. Must not be called from inside a critical section.
+  void synchronize() noexcept
+  {
+    Epoch_ const target = advance_();
+    for(Size_ i = 0u; slot_count_ > i; ++i)
+    {
+      Slot_ const& slot = slots_[i];
+      for(;;)
+      {
+        Epoch_ const e = slot.epoch.load(::std::memory_order_acquire);
+        if(static_cast<Epoch_>(0u) == e || target <= e)
+        {
+          break;
+        }
+
+        ::std::this_thread::yield();
+      }
+    }
+
+    dispose_older_than_(target);
+  }
+
+  // Defers `dispose(object, context)` until no reader can hold a pointer to
+  // object. The object must already be unreachable for readers entering from
+  // now on.
+  void retire(void* const object, void* const context, Dispose_ const dispose)
+  {
+    TREEXX_ASSERT(dispose);
+    retired_.push_back(Retired_
+      {object, context, dispose, epoch_.load(::std::memory_order_relaxed)});
+  }
+
+  // Frees the retired objects that no reader can reach any more without
+  // waiting for the readers. Returns the number of objects still pending.
+  size_type reclaim() noexcept
+  {
+    Epoch_ oldest = advance_();
+    for(Size_ i = 0u; slot_count_ > i; ++i)
+    {
+      Epoch_ const e = slots_[i].epoch.load(::std::memory_order_acquire);
+      if(static_cast<Epoch_>(0u) != e && oldest > e)
+      {
+        oldest = e;
+      }
+    }
+
+    dispose_older_than_(oldest);
+    return retired_.size();
+  }
+
+private:
+  [[nodiscard]] Epoch_ advance_() noexcept
+  {
+    ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+    Epoch_ const e = epoch_.fetch_add(
+      static_cast<Epoch_>(1u), ::std::memory_order_seq_cst) + 1u;
+    ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+    return e;
+  }
+
+  void dispose_older_than_(Epoch_ const e) noexcept
+  {
+    Size_ kept = 0u;
+    for(Size_ i = 0u; retired_.size() > i; ++i)
+    {
+      Retired_ const r = retired_[i];
+      if(e > r.epoch)
+      {
+        r.dispose(r.object, r.context);
+      }
+      else
+      {
+        retired_[kept++] = r;
+      }
+    }
+
+    retired_.resize(kept);
+  }
+
+  ::std::unique_ptr<Slot_[]> slots_;
+  Size_ slot_count_;
+  ::std::atomic<Epoch_> epoch_;
+  ::std::vector<Retired_> retired_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_EPOCHDOMAIN_HH
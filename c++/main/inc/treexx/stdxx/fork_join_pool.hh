@@ -0,0 +1,362 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_FORKJOINPOOL_HH
+#define TREEXX_STDXX_FORKJOINPOOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <treexx/assert.hh>
+
+namespace treexx::stdxx
+{
+
+// Work-stealing pool of std::thread workers for fork-join parallelism.
+// invoke(f, g) offers g to the other threads and runs f itself; a thread
+// waiting for a stolen task keeps running other tasks in the meantime, so
+// nested invocations do not block workers. Every worker owns a deque it
+// pushes to and pops from at the back, thieves take from the front. Threads
+// that are not workers of the pool share one more deque.
+//
+// The grain size is a hint to the algorithms run on the pool: work on fewer
+// elements than that is not worth splitting any further.
+struct fork_join_pool
+{
+  using size_type = ::std::size_t;
+
+private:
+  using Size_ = size_type;
+  using Mutex_ = ::std::mutex;
+  using Lock_ = ::std::unique_lock<Mutex_>;
+
+  static Size_ constexpr cache_line_size_ = 64u;
+
+  struct Task_
+  {
+    explicit Task_(void (*const r)(Task_&) noexcept) noexcept :
+      run(r),
+      done(false)
+    {}
+
+    void (*run)(Task_&) noexcept;
+    ::std::exception_ptr error;
+    ::std::atomic<bool> done;
+  };
+
+  template<class Fun>
+  struct Task_of_ : Task_
+  {
+    explicit Task_of_(Fun& f) noexcept :
+      Task_(&Task_of_::run_),
+      fun(f)
+    {}
+
+    Fun& fun;
+
+  private:
+    static void run_(Task_& task) noexcept
+    {
+      Task_of_& self = static_cast<Task_of_&>(task);
+      try
+      {
+        self.fun();
+      }
+      catch(...)
+      {
+        self.error = ::std::current_exception();
+      }
+    }
+  };
+
+  struct alignas(cache_line_size_) Deque_
+  {
+    Mutex_ mutex;
+    ::std::deque<Task_*> tasks;
+  };
+
+  struct Context_
+  {
+    fork_join_pool const* pool;
+    Size_ index;
+  };
+
+public:
+  // Starts thread_count workers. The threads calling invoke() take part in
+  // the work as well, so a pool without workers runs everything inline.
+  explicit fork_join_pool(
+    size_type const thread_count = ::std::thread::hardware_concurrency(),
+    size_type const grain_size = 4096u) :
+      deques_(new Deque_[thread_count + 1u]),
+      deque_count_(thread_count + 1u),
+      grain_size_(0u < grain_size ? grain_size : 1u),
+      pending_(0u),
+      sleeping_(0u),
+      stopped_(false)
+  {
+    threads_.reserve(thread_count);
+    try
+    {
+      for(Size_ i = 0u; thread_count > i; ++i)
+      {
+        threads_.emplace_back([this, i]() { work_(i); });
+      }
+    }
+    catch(...)
+    {
+      stop_();
+      throw;
+    }
+  }
+
+  fork_join_pool(fork_join_pool&&) = delete;
+  fork_join_pool(fork_join_pool const&) = delete;
+
+  ~fork_join_pool()
+  {
+    stop_();
+  }
+
+  fork_join_pool& operator =(fork_join_pool&&) = delete;
+  fork_join_pool& operator =(fork_join_pool const&) = delete;
+
+  [[nodiscard]] size_type thread_count() const noexcept
+  {
+    return threads_.size();
+  }
+
+  [[nodiscard]] size_type grain_size() const noexcept
+  {
+    return grain_size_;
+  }
+
+  // Calls f() and g(), possibly in parallel, and returns once both are done.
+  // When either throws, the exception is rethrown after both have finished,
+  // the one thrown by f() first.
+  template<class F, class G>
+  void invoke(F&& f, G&& g)
+  {
+    Task_of_<G> task(g);
+    Size_ const self = context_index_();
+    push_(self, task);
+
+    ::std::exception_ptr error;
+    try
+    {
+      f();
+    }
+    catch(...)
+    {
+      error = ::std::current_exception();
+    }
+
+    if(pop_back_if_(self, task))
+    {
+      task.run(task);
+    }
+    else
+    {
+      wait_(self, task);
+    }
+
+    if(error)
+    {
+      ::std::rethrow_exception(error);
+    }
+
+    if(task.error)
+    {
+      ::std::rethrow_exception(task.error);
+    }
+  }
+
+private:
+  [[nodiscard]] static Context_& context_() noexcept
+  {
+    static thread_local Context_ context{nullptr, 0u};
+    return context;
+  }
+
+  [[nodiscard]] Size_ context_index_() const noexcept
+  {
+    Context_ const& context = context_();
+    return this == context.pool ? context.index : deque_count_ - 1u;
+  }
+
+  void push_(Size_ const index, Task_& task)
+  {
+    {
+      Deque_& deque = deques_[index];
+      Lock_ const lock(deque.mutex);
+      deque.tasks.push_back(&task);
+    }
+
+    pending_.fetch_add(1u, ::std::memory_order_seq_cst);
+    if(0u < sleeping_.load(::std::memory_order_seq_cst))
+    {
+      // The lock orders the notification after a worker has started to wait.
+      { Lock_ const lock(sleep_mutex_); }
+      sleep_cv_.notify_one();
+    }
+  }
+
+  [[nodiscard]] bool pop_back_if_(Size_ const index, Task_& task) noexcept
+  {
+    Deque_& deque = deques_[index];
+    Lock_ const lock(deque.mutex);
+    if(!deque.tasks.empty() && &task == deque.tasks.back())
+    {
+      deque.tasks.pop_back();
+      pending_.fetch_sub(1u, ::std::memory_order_relaxed);
+      return true;
+    }
+
+    return false;
+  }
+
+  // Pops a task of the own deque, or steals the oldest one of another deque.
+  [[nodiscard]] Task_* take_(Size_ const index) noexcept
+  {
+    for(Size_ i = 0u; deque_count_ > i; ++i)
+    {
+      Size_ const victim = (index + i) % deque_count_;
+      Deque_& deque = deques_[victim];
+      Lock_ const lock(deque.mutex);
+      if(!deque.tasks.empty())
+      {
+        Task_* task;
+        if(0u < i)
+        {
+          task = deque.tasks.front();
+          deque.tasks.pop_front();
+        }
+        else
+        {
+          task = deque.tasks.back();
+          deque.tasks.pop_back();
+        }
+
+        pending_.fetch_sub(1u, ::std::memory_order_relaxed);
+        return task;
+      }
+    }
+
+    return nullptr;
+  }
+
+  static void execute_(Task_& task) noexcept
+  {
+    task.run(task);
+
+    // The owner may destroy the task as soon as it sees this.
+    task.done.store(true, ::std::memory_order_release);
+  }
+
+  void wait_(Size_ const index, Task_ const& task) noexcept
+  {
+    while(!task.done.load(::std::memory_order_acquire))
+    {
+      Task_* const other = take_(index);
+      if(other)
+      {
+        execute_(*other);
+      }
+      else
+      {
+        ::std::this_thread::yield();
+      }
+    }
+  }
+
+  void work_(Size_ const index) noexcept
+  {
+    Context_& context = context_();
+    context.pool = this;
+    context.index = index;
+    for(;;)
+    {
+      Task_* const task = take_(index);
+      if(task)
+      {
+        execute_(*task);
+        continue;
+      }
+
+      Lock_ lock(sleep_mutex_);
+      if(stopped_)
+      {
+        break;
+      }
+
+      sleeping_.fetch_add(1u, ::std::memory_order_seq_cst);
+      sleep_cv_.wait(
+        lock,
+        [this]() noexcept
+        {
+          return
+            stopped_ ||
+            0u < pending_.load(::std::memory_order_seq_cst);
+        });
+      sleeping_.fetch_sub(1u, ::std::memory_order_relaxed);
+    }
+
+    context.pool = nullptr;
+  }
+
+  void stop_() noexcept
+  {
+    {
+      Lock_ const lock(sleep_mutex_);
+      stopped_ = true;
+    }
+
+    sleep_cv_.notify_all();
+    for(::std::thread& thread: threads_)
+    {
+      thread.join();
+    }
+
+    threads_.clear();
+  }
+
+  ::std::unique_ptr<Deque_[]> deques_;
+  Size_ deque_count_;
+  Size_ grain_size_;
+  ::std::atomic<Size_> pending_;
+  ::std::atomic<Size_> sleeping_;
+  Mutex_ sleep_mutex_;
+  ::std::condition_variable sleep_cv_;
+  bool stopped_;
+  ::std::vector<::std::thread> threads_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_FORKJOINPOOL_HH
@@ -0,0 +1,1061 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_INDEXEDLIST_HH
+#define TREEXX_STDXX_INDEXEDLIST_HH
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace treexx::stdxx
+{
+
+template<class T, class A = ::std::allocator<T>>
+struct indexed_list
+{
+  using value_type = T;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+
+  template<bool c, class U, class V>
+  using Conditional_ = typename ::std::conditional<c, U, V>::type;
+
+  template<class U>
+  using Add_const_ = typename ::std::add_const<U>::type;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  struct Node_
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    Node_* parent;
+    Node_* left_child;
+    Node_* right_child;
+    Size_ index;
+    Balance_ balance;
+    Side_ side;
+    Value_ value;
+  };
+
+  struct Tree_static_
+  {
+    using Index = Size_;
+
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node_* parent(Node_ const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node_* child(Node_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node_ const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Node_ const& n) noexcept
+    {
+      return n.side;
+    }
+
+    [[nodiscard]] static Index const& index(Node_ const& n) noexcept
+    {
+      return n.index;
+    }
+
+    static void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Node_& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+
+    static void increment_index(Node_& n) noexcept
+    {
+      ++n.index;
+    }
+
+    static void decrement_index(Node_& n) noexcept
+    {
+      --n.index;
+    }
+
+    static void add_to_index(Node_& n, Index const& i) noexcept
+    {
+      n.index += i;
+    }
+
+    static void subtract_from_index(Node_& n, Index const& i) noexcept
+    {
+      n.index -= i;
+    }
+
+    static void set_index(Node_& n, Index const& i) noexcept
+    {
+      n.index = i;
+    }
+
+    template<unsigned i>
+    static void set_index(Node_& n) noexcept
+    {
+      n.index = static_cast<Index>(i);
+    }
+
+    template<unsigned i>
+    [[nodiscard]] static Index make_index() noexcept
+    {
+      return static_cast<Index>(i);
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return 1u > size_;
+    }
+
+    void increment_size() noexcept
+    {
+      ++size_;
+    }
+
+    void decrement_size() noexcept
+    {
+      --size_;
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+  private:
+    Node_* root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    Size_ size_;
+  };
+
+  template<bool is_const>
+  struct Iterator_
+  {
+    using iterator_category = ::std::random_access_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = Conditional_<
+      is_const, Add_const_<value_type>&, value_type&>;
+    using pointer = Conditional_<
+      is_const, Add_const_<value_type>*, value_type*>;
+
+    Iterator_() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    template<bool e = is_const, class = typename Enable_if_<e>::Type>
+    Iterator_(Iterator_<false> const& x) noexcept :
+      tree_(x.tree_),
+      node_(x.node_)
+    {}
+
+    [[nodiscard]] size_type index() const noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      return node_ ? Tree_algo_::node_index(*tree_, *node_) : tree_->size();
+    }
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_->value;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return ::std::addressof(node_->value);
+    }
+
+    [[nodiscard]] reference operator [](difference_type const n) const noexcept
+    {
+      return *(*this + n);
+    }
+
+    Iterator_& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    Iterator_ operator ++(int) noexcept
+    {
+      Iterator_ const x(*this);
+      ++*this;
+      return x;
+    }
+
+    Iterator_& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    Iterator_ operator --(int) noexcept
+    {
+      Iterator_ const x(*this);
+      --*this;
+      return x;
+    }
+
+    Iterator_& operator +=(difference_type const n) noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(0 != n)
+      {
+        size_type const idx(
+          index() + static_cast<size_type>(n));
+        TREEXX_ASSERT(idx <= tree_->size());
+        node_ = idx < tree_->size() ?
+          Tree_algo_::at_index(*tree_, idx) : nullptr;
+      }
+
+      return *this;
+    }
+
+    Iterator_& operator -=(difference_type const n) noexcept
+    {
+      return *this += -n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator +(
+      Iterator_ x,
+      difference_type const n) noexcept
+    {
+      return x += n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator +(
+      difference_type const n,
+      Iterator_ x) noexcept
+    {
+      return x += n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator -(
+      Iterator_ x,
+      difference_type const n) noexcept
+    {
+      return x -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator -(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return
+        static_cast<difference_type>(x.index()) -
+        static_cast<difference_type>(y.index());
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+    [[nodiscard]] friend bool operator <(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_ && x.index() < y.index();
+    }
+
+    [[nodiscard]] friend bool operator >(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return y < x;
+    }
+
+    [[nodiscard]] friend bool operator <=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return !(y < x);
+    }
+
+    [[nodiscard]] friend bool operator >=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return !(x < y);
+    }
+
+  private:
+    friend struct indexed_list;
+    friend struct Iterator_<true>;
+
+    Iterator_(Tree_ const* const t, Node_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    Tree_ const* tree_;
+    Node_* node_;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  static_assert(Is_same_<Value_, Remove_cv_ref_<Value_>>::value);
+  static_assert(Is_same_<Allocator_, Remove_cv_ref_<Allocator_>>::value);
+
+public:
+  using iterator = Iterator_<false>;
+  using const_iterator = Iterator_<true>;
+  using reverse_iterator = ::std::reverse_iterator<iterator>;
+  using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+  indexed_list() = default;
+
+  explicit indexed_list(allocator_type const& alloc) :
+    tree_and_alloc_(alloc)
+  {}
+
+  indexed_list(
+    ::std::initializer_list<value_type> const values,
+    allocator_type const& alloc = allocator_type()) :
+    tree_and_alloc_(alloc)
+  {
+    for(auto const& x: values)
+    {
+      emplace_back(x);
+    }
+  }
+
+  indexed_list(indexed_list&& x) noexcept :
+    tree_and_alloc_(static_cast<Node_allocator_&&>(x.tree_and_alloc_))
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+  }
+
+  indexed_list(indexed_list const& x) :
+    tree_and_alloc_(
+      Node_allocator_traits_::select_on_container_copy_construction(
+        x.tree_and_alloc_))
+  {
+    for(auto const& val: x)
+    {
+      emplace_back(val);
+    }
+  }
+
+  ~indexed_list()
+  {
+    clear();
+  }
+
+  // Steals the nodes of x when the allocator moves along with them or the
+  // two allocators are equal. Otherwise the nodes of x cannot be freed by
+  // this allocator, so the elements are moved one by one into new nodes, as
+  // the standard containers do.
+  indexed_list& operator =(indexed_list&& x) noexcept(
+    Node_allocator_traits_::propagate_on_container_move_assignment::value ||
+    Node_allocator_traits_::is_always_equal::value)
+  {
+    if(this != ::std::addressof(x))
+    {
+      if constexpr(
+        Node_allocator_traits_::propagate_on_container_move_assignment::value)
+      {
+        clear();
+        tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+        tree_and_alloc_.allocator() =
+          static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator());
+      }
+      else if(
+        Node_allocator_traits_::is_always_equal::value ||
+        tree_and_alloc_.allocator() == x.tree_and_alloc_.allocator())
+      {
+        clear();
+        tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+      }
+      else
+      {
+        indexed_list y(get_allocator());
+        for(auto& val: x)
+        {
+          y.emplace_back(static_cast<value_type&&>(val));
+        }
+
+        clear();
+        tree_and_alloc_.tree.swap(y.tree_and_alloc_.tree);
+      }
+    }
+
+    return *this;
+  }
+
+  // The copy is built with the allocator this list ends up with, so that
+  // swapping it in never mixes nodes of different allocators.
+  indexed_list& operator =(indexed_list const& x)
+  {
+    if(this != ::std::addressof(x))
+    {
+      if constexpr(
+        Node_allocator_traits_::propagate_on_container_copy_assignment::value)
+      {
+        if(tree_and_alloc_.allocator() != x.tree_and_alloc_.allocator())
+        {
+          clear();
+        }
+
+        tree_and_alloc_.allocator() = x.tree_and_alloc_.allocator();
+      }
+
+      indexed_list y(get_allocator());
+      for(auto const& val: x)
+      {
+        y.emplace_back(val);
+      }
+
+      clear();
+      tree_and_alloc_.tree.swap(y.tree_and_alloc_.tree);
+    }
+
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(tree_and_alloc_.allocator());
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_and_alloc_.tree.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_and_alloc_.tree.size();
+  }
+
+  [[nodiscard]] iterator begin() noexcept
+  {
+    return make_iterator_(tree_and_alloc_.tree.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept
+  {
+    return make_iterator_(tree_and_alloc_.tree.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] iterator end() noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  [[nodiscard]] reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+
+  [[nodiscard]] reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  [[nodiscard]] iterator find(size_type const& idx) noexcept
+  {
+    return make_iterator_(Tree_algo_::at_index(tree_and_alloc_.tree, idx));
+  }
+
+  [[nodiscard]] const_iterator find(size_type const& idx) const noexcept
+  {
+    return make_iterator_(Tree_algo_::at_index(tree_and_alloc_.tree, idx));
+  }
+
+  [[nodiscard]] reference operator [](size_type const& idx) noexcept
+  {
+    TREEXX_ASSERT(idx < size());
+    return Tree_algo_::at_index(tree_and_alloc_.tree, idx)->value;
+  }
+
+  [[nodiscard]] const_reference operator [](
+    size_type const& idx) const noexcept
+  {
+    TREEXX_ASSERT(idx < size());
+    return Tree_algo_::at_index(tree_and_alloc_.tree, idx)->value;
+  }
+
+  [[nodiscard]] reference at(size_type const& idx)
+  {
+    check_index_(idx);
+    return (*this)[idx];
+  }
+
+  [[nodiscard]] const_reference at(size_type const& idx) const
+  {
+    check_index_(idx);
+    return (*this)[idx];
+  }
+
+  [[nodiscard]] reference front() noexcept
+  {
+    return extreme_<Side_::left>();
+  }
+
+  [[nodiscard]] const_reference front() const noexcept
+  {
+    return extreme_<Side_::left>();
+  }
+
+  [[nodiscard]] reference back() noexcept
+  {
+    return extreme_<Side_::right>();
+  }
+
+  [[nodiscard]] const_reference back() const noexcept
+  {
+    return extreme_<Side_::right>();
+  }
+
+  template<class... Args>
+  reference emplace_back(Args&&... args)
+  {
+    return emplace_<Side_::right>(static_cast<Args&&>(args)...);
+  }
+
+  template<class... Args>
+  reference emplace_front(Args&&... args)
+  {
+    return emplace_<Side_::left>(static_cast<Args&&>(args)...);
+  }
+
+  reference push_back(value_type&& val)
+  {
+    return emplace_back(static_cast<value_type&&>(val));
+  }
+
+  reference push_back(value_type const& val)
+  {
+    return emplace_back(val);
+  }
+
+  reference push_front(value_type&& val)
+  {
+    return emplace_front(static_cast<value_type&&>(val));
+  }
+
+  reference push_front(value_type const& val)
+  {
+    return emplace_front(val);
+  }
+
+  template<class... Args>
+  iterator emplace(size_type const& idx, Args&&... args)
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(idx <= tree.size());
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    Tree_algo_::insert_at_index(tree, node_ptr, idx);
+    node.release();
+    tree.increment_size();
+    return make_iterator_(node_ptr);
+  }
+
+  template<class... Args>
+  iterator emplace(const_iterator const& pos, Args&&... args)
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(::std::addressof(tree) == pos.tree_);
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    Tree_algo_::insert(tree, pos.node_, node_ptr);
+    node.release();
+    tree.increment_size();
+    return make_iterator_(node_ptr);
+  }
+
+  iterator insert(size_type const& idx, value_type&& val)
+  {
+    return emplace(idx, static_cast<value_type&&>(val));
+  }
+
+  iterator insert(size_type const& idx, value_type const& val)
+  {
+    return emplace(idx, val);
+  }
+
+  iterator insert(const_iterator const& pos, value_type&& val)
+  {
+    return emplace(pos, static_cast<value_type&&>(val));
+  }
+
+  iterator insert(const_iterator const& pos, value_type const& val)
+  {
+    return emplace(pos, val);
+  }
+
+  iterator erase(const_iterator const& pos) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const node = pos.node_;
+    TREEXX_ASSERT(::std::addressof(tree) == pos.tree_);
+    TREEXX_ASSERT(node);
+
+    Node_* const next = Tree_algo_::next_node(tree, *node);
+    Tree_algo_::erase(tree, node);
+    tree.decrement_size();
+    destroy_node_(node);
+    return make_iterator_(next);
+  }
+
+  iterator erase(size_type const& idx) noexcept
+  {
+    TREEXX_ASSERT(idx < size());
+    return erase(find(idx));
+  }
+
+  void pop_back() noexcept
+  {
+    pop_<Side_::right>();
+  }
+
+  void pop_front() noexcept
+  {
+    pop_<Side_::left>();
+  }
+
+  void clear() noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
+  void swap(indexed_list& x) noexcept
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+    if constexpr(Node_allocator_traits_::propagate_on_container_swap::value)
+    {
+      using ::std::swap;
+      swap(tree_and_alloc_.allocator(), x.tree_and_alloc_.allocator());
+    }
+  }
+
+  friend void swap(indexed_list& x, indexed_list& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  struct Unique_node_
+  {
+    using Ptr = typename Node_allocator_traits_::pointer;
+
+    explicit Unique_node_(Node_allocator_& alloc) :
+      alloc_(::std::addressof(alloc)),
+      ptr_(Node_allocator_traits_::allocate(alloc, 1u)),
+      constructed(false)
+    {}
+
+    Unique_node_(Unique_node_&&) = delete;
+    Unique_node_(Unique_node_ const&) = delete;
+
+    ~Unique_node_()
+    {
+      if(alloc_ && ptr_)
+      {
+        if(constructed)
+        {
+          Node_allocator_traits_::destroy(*alloc_, ptr_);
+        }
+
+        Node_allocator_traits_::deallocate(*alloc_, ptr_, 1u);
+      }
+    }
+
+    Unique_node_& operator =(Unique_node_&&) = delete;
+    Unique_node_& operator =(Unique_node_ const&) = delete;
+
+    [[nodiscard]] Ptr const& get() const noexcept
+    {
+      return ptr_;
+    }
+
+    void release() noexcept
+    {
+      alloc_ = nullptr;
+    }
+
+    template<class... Args>
+    void construct(Args&&... args)
+    {
+      TREEXX_ASSERT(alloc_);
+      TREEXX_ASSERT(!constructed);
+      Node_allocator_traits_::construct(
+        *alloc_, ptr_, static_cast<Args&&>(args)...);
+      constructed = true;
+    }
+
+  private:
+    Node_allocator_* alloc_;
+    Ptr ptr_;
+    bool constructed;
+  };
+
+  struct Allocator_base_ : Node_allocator_
+  {
+    Allocator_base_() = default;
+
+    template<class Alloc>
+    explicit Allocator_base_(Alloc&& alloc) :
+      Node_allocator_(static_cast<Alloc&&>(alloc))
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    [[nodiscard]] Node_allocator_ const& allocator() const noexcept
+    {
+      return *this;
+    }
+  };
+
+  struct Tree_and_alloc_ : Allocator_base_
+  {
+    using Allocator_base_::Allocator_base_;
+
+    Tree_ tree;
+  };
+
+  [[nodiscard]] iterator make_iterator_(Node_* const node) noexcept
+  {
+    return iterator(::std::addressof(tree_and_alloc_.tree), node);
+  }
+
+  [[nodiscard]] const_iterator make_iterator_(
+    Node_* const node) const noexcept
+  {
+    return const_iterator(::std::addressof(tree_and_alloc_.tree), node);
+  }
+
+  void check_index_(size_type const& idx) const
+  {
+    if(size() <= idx)
+    {
+      throw ::std::out_of_range("treexx::stdxx::indexed_list: index");
+    }
+  }
+
+  template<Side_ side>
+  [[nodiscard]] Value_& extreme_() const noexcept
+  {
+    Node_* const node = tree_and_alloc_.tree.template extreme<side>();
+    TREEXX_ASSERT(node);
+    return node->value;
+  }
+
+  template<Side_ side, class... Args>
+  reference emplace_(Args&&... args)
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    Tree_& tree = tree_and_alloc_.tree;
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    if constexpr(Side_::left == side)
+    {
+      Tree_algo_::push_front(tree, node_ptr);
+    }
+    else if constexpr(Side_::right == side)
+    {
+      Tree_algo_::push_back(tree, node_ptr);
+    }
+
+    node.release();
+    tree.increment_size();
+    return node_ptr->value;
+  }
+
+  template<Side_ side>
+  void pop_() noexcept
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(!tree.empty());
+
+    Node_* node;
+    if constexpr(Side_::left == side)
+    {
+      node = Tree_algo_::pop_front(tree);
+    }
+    else if constexpr(Side_::right == side)
+    {
+      node = Tree_algo_::pop_back(tree);
+    }
+
+    tree.decrement_size();
+    destroy_node_(node);
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Tree_and_alloc_ tree_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_INDEXEDLIST_HH
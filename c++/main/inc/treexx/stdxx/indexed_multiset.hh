@@ -0,0 +1,1149 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_INDEXEDMULTISET_HH
+#define TREEXX_STDXX_INDEXEDMULTISET_HH
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/background_reclaimer.hh>
+
+namespace treexx::stdxx
+{
+
+template<
+  class T,
+  class C = ::std::less<T>,
+  class A = ::std::allocator<T>>
+struct indexed_multiset
+{
+  using key_type = T;
+  using value_type = T;
+  using key_compare = C;
+  using value_compare = C;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Compare_ = key_compare;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+
+  template<bool c, class U, class V>
+  using Conditional_ = typename ::std::conditional<c, U, V>::type;
+
+  template<class U>
+  using Add_const_ = typename ::std::add_const<U>::type;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  template<class, class = ::std::void_t<>>
+  struct Prefix_trait_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Prefix_trait_<U, ::std::void_t<decltype(
+    ::std::declval<U const&>().prefix(::std::declval<T const&>()))>>
+  {
+    using Type = Remove_cv_ref_<decltype(
+      ::std::declval<U const&>().prefix(::std::declval<T const&>()))>;
+    static bool constexpr value = true;
+  };
+
+  // A comparator with a prefix() member, such as prefix_less, makes every
+  // node keep the prefix of its value, which is compared before the values.
+  static bool constexpr has_prefix_ = Prefix_trait_<Compare_>::value;
+
+  template<bool = has_prefix_, int = 0>
+  struct Node_base_
+  {};
+
+  template<int z>
+  struct Node_base_<true, z>
+  {
+    typename Prefix_trait_<Compare_>::Type prefix;
+  };
+
+  // Key of a search, along with its prefix if there is one.
+  template<bool = has_prefix_, int = 0>
+  struct Search_key_
+  {
+    Search_key_(Compare_ const&, Value_ const& k) noexcept :
+      key(k)
+    {}
+
+    Value_ const& key;
+  };
+
+  template<int z>
+  struct Search_key_<true, z>
+  {
+    Search_key_(Compare_ const& c, Value_ const& k) :
+      key(k),
+      prefix(c.prefix(k))
+    {}
+
+    Value_ const& key;
+    typename Prefix_trait_<Compare_>::Type prefix;
+  };
+
+  struct Node_ : Node_base_<>
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    Node_* parent;
+    Node_* left_child;
+    Node_* right_child;
+    Size_ index;
+    Balance_ balance;
+    Side_ side;
+    Value_ value;
+  };
+
+  struct Tree_static_
+  {
+    using Index = Size_;
+
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node_* parent(Node_ const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node_* child(Node_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node_ const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Node_ const& n) noexcept
+    {
+      return n.side;
+    }
+
+    [[nodiscard]] static Index const& index(Node_ const& n) noexcept
+    {
+      return n.index;
+    }
+
+    static void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Node_& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+
+    static void increment_index(Node_& n) noexcept
+    {
+      ++n.index;
+    }
+
+    static void decrement_index(Node_& n) noexcept
+    {
+      --n.index;
+    }
+
+    static void add_to_index(Node_& n, Index const& i) noexcept
+    {
+      n.index += i;
+    }
+
+    static void subtract_from_index(Node_& n, Index const& i) noexcept
+    {
+      n.index -= i;
+    }
+
+    static void set_index(Node_& n, Index const& i) noexcept
+    {
+      n.index = i;
+    }
+
+    template<unsigned i>
+    static void set_index(Node_& n) noexcept
+    {
+      n.index = static_cast<Index>(i);
+    }
+
+    template<unsigned i>
+    [[nodiscard]] static Index make_index() noexcept
+    {
+      return static_cast<Index>(i);
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return 1u > size_;
+    }
+
+    void increment_size() noexcept
+    {
+      ++size_;
+    }
+
+    void decrement_size() noexcept
+    {
+      --size_;
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+  private:
+    Node_* root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    Size_ size_;
+  };
+
+  template<bool is_const>
+  struct Iterator_
+  {
+    using iterator_category = ::std::random_access_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = Conditional_<
+      is_const, Add_const_<value_type>&, value_type&>;
+    using pointer = Conditional_<
+      is_const, Add_const_<value_type>*, value_type*>;
+
+    Iterator_() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    template<bool e = is_const, class = typename Enable_if_<e>::Type>
+    Iterator_(Iterator_<false> const& x) noexcept :
+      tree_(x.tree_),
+      node_(x.node_)
+    {}
+
+    [[nodiscard]] size_type index() const noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      return node_ ? Tree_algo_::node_index(*tree_, *node_) : tree_->size();
+    }
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_->value;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return ::std::addressof(node_->value);
+    }
+
+    [[nodiscard]] reference operator [](difference_type const n) const noexcept
+    {
+      return *(*this + n);
+    }
+
+    Iterator_& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    Iterator_ operator ++(int) noexcept
+    {
+      Iterator_ const x(*this);
+      ++*this;
+      return x;
+    }
+
+    Iterator_& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    Iterator_ operator --(int) noexcept
+    {
+      Iterator_ const x(*this);
+      --*this;
+      return x;
+    }
+
+    Iterator_& operator +=(difference_type const n) noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(0 != n)
+      {
+        size_type const idx(
+          index() + static_cast<size_type>(n));
+        TREEXX_ASSERT(idx <= tree_->size());
+        node_ = idx < tree_->size() ?
+          Tree_algo_::at_index(*tree_, idx) : nullptr;
+      }
+
+      return *this;
+    }
+
+    Iterator_& operator -=(difference_type const n) noexcept
+    {
+      return *this += -n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator +(
+      Iterator_ x,
+      difference_type const n) noexcept
+    {
+      return x += n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator +(
+      difference_type const n,
+      Iterator_ x) noexcept
+    {
+      return x += n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator -(
+      Iterator_ x,
+      difference_type const n) noexcept
+    {
+      return x -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator -(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return
+        static_cast<difference_type>(x.index()) -
+        static_cast<difference_type>(y.index());
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+    [[nodiscard]] friend bool operator <(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_ && x.index() < y.index();
+    }
+
+    [[nodiscard]] friend bool operator >(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return y < x;
+    }
+
+    [[nodiscard]] friend bool operator <=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return !(y < x);
+    }
+
+    [[nodiscard]] friend bool operator >=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return !(x < y);
+    }
+
+  private:
+    friend struct indexed_multiset;
+    friend struct Iterator_<true>;
+
+    Iterator_(Tree_ const* const t, Node_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    Tree_ const* tree_;
+    Node_* node_;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  static_assert(Is_same_<Value_, Remove_cv_ref_<Value_>>::value);
+  static_assert(Is_same_<Allocator_, Remove_cv_ref_<Allocator_>>::value);
+  static_assert(Is_same_<Compare_, Remove_cv_ref_<Compare_>>::value);
+
+public:
+  using iterator = Iterator_<true>;
+  using const_iterator = iterator;
+  using reverse_iterator = ::std::reverse_iterator<iterator>;
+  using const_reverse_iterator = reverse_iterator;
+
+  indexed_multiset() = default;
+
+  explicit indexed_multiset(
+    key_compare const& compare,
+    allocator_type const& alloc = allocator_type()) :
+    tree_and_alloc_(compare, alloc)
+  {}
+
+  explicit indexed_multiset(allocator_type const& alloc) :
+    tree_and_alloc_(key_compare(), alloc)
+  {}
+
+  indexed_multiset(
+    ::std::initializer_list<value_type> const values,
+    key_compare const& compare = key_compare(),
+    allocator_type const& alloc = allocator_type()) :
+    tree_and_alloc_(compare, alloc)
+  {
+    for(auto const& x: values)
+    {
+      emplace(x);
+    }
+  }
+
+  indexed_multiset(indexed_multiset&& x) noexcept :
+    tree_and_alloc_(
+      x.tree_and_alloc_.compare,
+      static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator()))
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+  }
+
+  indexed_multiset(indexed_multiset const& x) :
+    tree_and_alloc_(
+      x.tree_and_alloc_.compare,
+      Node_allocator_traits_::select_on_container_copy_construction(
+        x.tree_and_alloc_.allocator()))
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    for(auto const& val: x)
+    {
+      Node_* const node = create_node_(val);
+      Tree_algo_::push_back(tree, node);
+      tree.increment_size();
+    }
+  }
+
+  ~indexed_multiset()
+  {
+    clear();
+  }
+
+  indexed_multiset& operator =(indexed_multiset&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+      tree_and_alloc_.compare = x.tree_and_alloc_.compare;
+      if constexpr(
+        Node_allocator_traits_::propagate_on_container_move_assignment::value)
+      {
+        tree_and_alloc_.allocator() =
+          static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator());
+      }
+    }
+
+    return *this;
+  }
+
+  indexed_multiset& operator =(indexed_multiset const& x)
+  {
+    if(this != ::std::addressof(x))
+    {
+      indexed_multiset y(x);
+      swap(y);
+    }
+
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(tree_and_alloc_.allocator());
+  }
+
+  [[nodiscard]] key_compare key_comp() const
+  {
+    return tree_and_alloc_.compare;
+  }
+
+  [[nodiscard]] value_compare value_comp() const
+  {
+    return tree_and_alloc_.compare;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_and_alloc_.tree.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_and_alloc_.tree.size();
+  }
+
+  [[nodiscard]] iterator begin() const noexcept
+  {
+    return make_iterator_(tree_and_alloc_.tree.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] iterator end() const noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  [[nodiscard]] reverse_iterator rbegin() const noexcept
+  {
+    return reverse_iterator(end());
+  }
+
+  [[nodiscard]] reverse_iterator rend() const noexcept
+  {
+    return reverse_iterator(begin());
+  }
+
+  [[nodiscard]] const_reference front() const noexcept
+  {
+    return extreme_<Side_::left>();
+  }
+
+  [[nodiscard]] const_reference back() const noexcept
+  {
+    return extreme_<Side_::right>();
+  }
+
+  template<class... Args>
+  iterator emplace(Args&&... args)
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+    set_prefix_(*node_ptr);
+
+    Tree_algo_::insert(tree, upper_bound_(node_ptr->value), node_ptr);
+    node.release();
+    tree.increment_size();
+    return make_iterator_(node_ptr);
+  }
+
+  iterator insert(value_type&& val)
+  {
+    return emplace(static_cast<value_type&&>(val));
+  }
+
+  iterator insert(value_type const& val)
+  {
+    return emplace(val);
+  }
+
+  iterator erase(const_iterator const& pos) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const node = pos.node_;
+    TREEXX_ASSERT(::std::addressof(tree) == pos.tree_);
+    TREEXX_ASSERT(node);
+
+    Node_* const next = Tree_algo_::next_node(tree, *node);
+    Tree_algo_::erase(tree, node);
+    tree.decrement_size();
+    destroy_node_(node);
+    return make_iterator_(next);
+  }
+
+  size_type erase(key_type const& key)
+  {
+    Node_* const last = upper_bound_(key);
+    size_type count = static_cast<size_type>(0u);
+    for(iterator it(lower_bound(key)); last != it.node_; ++count)
+    {
+      it = erase(it);
+    }
+
+    return count;
+  }
+
+  void clear() noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
+  // Empties the container in O(1), leaving the elements to be destroyed on
+  // the thread of reclaimer. Called before destruction, it makes the
+  // destructor O(1) as well. The allocator must be usable from that thread.
+  void clear(background_reclaimer& reclaimer)
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const root = tree.root();
+    if(root)
+    {
+      Tree_ detached;
+      detached.set_root(root);
+      Node_allocator_ alloc(tree_and_alloc_.allocator());
+      reclaimer.post(
+        [detached, alloc](Size_ const count) mutable noexcept -> bool
+        {
+          return ::treexx::bin::Tree_algo::clear_some(
+            detached,
+            [&alloc](Node_* const node) noexcept
+            {
+              Node_allocator_traits_::destroy(alloc, node);
+              Node_allocator_traits_::deallocate(alloc, node, 1u);
+            },
+            count);
+        });
+      tree.reset();
+    }
+  }
+
+  void swap(indexed_multiset& x) noexcept
+  {
+    using ::std::swap;
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+    swap(tree_and_alloc_.compare, x.tree_and_alloc_.compare);
+    if constexpr(Node_allocator_traits_::propagate_on_container_swap::value)
+    {
+      swap(tree_and_alloc_.allocator(), x.tree_and_alloc_.allocator());
+    }
+  }
+
+  friend void swap(indexed_multiset& x, indexed_multiset& y) noexcept
+  {
+    x.swap(y);
+  }
+
+  [[nodiscard]] iterator find(key_type const& key) const
+  {
+    Search_key_<> const search_key(tree_and_alloc_.compare, key);
+    Node_* const node = lower_bound_(search_key);
+    if(node && !is_before_(search_key, *node))
+    {
+      return make_iterator_(node);
+    }
+
+    return end();
+  }
+
+  [[nodiscard]] bool contains(key_type const& key) const
+  {
+    return end() != find(key);
+  }
+
+  [[nodiscard]] size_type count(key_type const& key) const
+  {
+    return count_in_range_(rank(key), rank_<true>(key));
+  }
+
+  [[nodiscard]] iterator lower_bound(key_type const& key) const
+  {
+    return make_iterator_(lower_bound_(key));
+  }
+
+  [[nodiscard]] iterator upper_bound(key_type const& key) const
+  {
+    return make_iterator_(upper_bound_(key));
+  }
+
+  [[nodiscard]] ::std::pair<iterator, iterator> equal_range(
+    key_type const& key) const
+  {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  [[nodiscard]] size_type rank(key_type const& key) const
+  {
+    return rank_<false>(key);
+  }
+
+  [[nodiscard]] iterator select(size_type const& idx) const
+  {
+    return make_iterator_(Tree_algo_::at_index(tree_and_alloc_.tree, idx));
+  }
+
+  // Counts the elements in the half-open range [lo, hi).
+  [[nodiscard]] size_type count_in_range(
+    key_type const& lo,
+    key_type const& hi) const
+  {
+    return count_in_range_(rank(lo), rank(hi));
+  }
+
+  // Nearest-rank quantile: the element at index floor(q * (size() - 1)).
+  [[nodiscard]] const_reference quantile(double const q) const noexcept
+  {
+    TREEXX_ASSERT(!empty());
+    TREEXX_ASSERT(0.0 <= q && 1.0 >= q);
+    auto const last = static_cast<double>(size() - 1u);
+    auto idx = static_cast<size_type>(q * last);
+    if(size() <= idx)
+    {
+      idx = size() - 1u;
+    }
+
+    Node_* const node = Tree_algo_::at_index(tree_and_alloc_.tree, idx);
+    TREEXX_ASSERT(node);
+    return node->value;
+  }
+
+private:
+  struct Unique_node_
+  {
+    using Ptr = typename Node_allocator_traits_::pointer;
+
+    explicit Unique_node_(Node_allocator_& alloc) :
+      alloc_(::std::addressof(alloc)),
+      ptr_(Node_allocator_traits_::allocate(alloc, 1u)),
+      constructed(false)
+    {}
+
+    Unique_node_(Unique_node_&&) = delete;
+    Unique_node_(Unique_node_ const&) = delete;
+
+    ~Unique_node_()
+    {
+      if(alloc_ && ptr_)
+      {
+        if(constructed)
+        {
+          Node_allocator_traits_::destroy(*alloc_, ptr_);
+        }
+
+        Node_allocator_traits_::deallocate(*alloc_, ptr_, 1u);
+      }
+    }
+
+    Unique_node_& operator =(Unique_node_&&) = delete;
+    Unique_node_& operator =(Unique_node_ const&) = delete;
+
+    [[nodiscard]] Ptr const& get() const noexcept
+    {
+      return ptr_;
+    }
+
+    void release() noexcept
+    {
+      alloc_ = nullptr;
+    }
+
+    template<class... Args>
+    void construct(Args&&... args)
+    {
+      TREEXX_ASSERT(alloc_);
+      TREEXX_ASSERT(!constructed);
+      Node_allocator_traits_::construct(
+        *alloc_, ptr_, static_cast<Args&&>(args)...);
+      constructed = true;
+    }
+
+  private:
+    Node_allocator_* alloc_;
+    Ptr ptr_;
+    bool constructed;
+  };
+
+  struct Allocator_base_ : Node_allocator_
+  {
+    Allocator_base_() = default;
+
+    template<class Alloc>
+    explicit Allocator_base_(Alloc&& alloc) :
+      Node_allocator_(static_cast<Alloc&&>(alloc))
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    [[nodiscard]] Node_allocator_ const& allocator() const noexcept
+    {
+      return *this;
+    }
+  };
+
+  struct Tree_and_alloc_ : Allocator_base_
+  {
+    Tree_and_alloc_() = default;
+
+    template<class Alloc>
+    Tree_and_alloc_(Compare_ const& c, Alloc&& alloc) :
+      Allocator_base_(static_cast<Alloc&&>(alloc)),
+      compare(c)
+    {}
+
+    Tree_ tree;
+    Compare_ compare;
+  };
+
+  [[nodiscard]] iterator make_iterator_(Node_* const node) const noexcept
+  {
+    return iterator(::std::addressof(tree_and_alloc_.tree), node);
+  }
+
+  [[nodiscard]] static size_type count_in_range_(
+    size_type const& lo_rank,
+    size_type const& hi_rank) noexcept
+  {
+    return lo_rank < hi_rank ? hi_rank - lo_rank : static_cast<size_type>(0u);
+  }
+
+  [[nodiscard]] bool is_before_(
+    Node_ const& node,
+    Search_key_<> const& search_key) const
+  {
+    if constexpr(has_prefix_)
+    {
+      if(node.prefix != search_key.prefix)
+      {
+        return node.prefix < search_key.prefix;
+      }
+    }
+
+    return tree_and_alloc_.compare(node.value, search_key.key);
+  }
+
+  [[nodiscard]] bool is_before_(
+    Search_key_<> const& search_key,
+    Node_ const& node) const
+  {
+    if constexpr(has_prefix_)
+    {
+      if(search_key.prefix != node.prefix)
+      {
+        return search_key.prefix < node.prefix;
+      }
+    }
+
+    return tree_and_alloc_.compare(search_key.key, node.value);
+  }
+
+  [[nodiscard]] Node_* lower_bound_(key_type const& key) const
+  {
+    return lower_bound_(Search_key_<>(tree_and_alloc_.compare, key));
+  }
+
+  [[nodiscard]] Node_* lower_bound_(Search_key_<> const& search_key) const
+  {
+    return Tree_algo_::partition_point(
+      tree_and_alloc_.tree,
+      [this, &search_key](Node_ const& node) -> bool
+      {
+        return is_before_(node, search_key);
+      });
+  }
+
+  [[nodiscard]] Node_* upper_bound_(key_type const& key) const
+  {
+    Search_key_<> const search_key(tree_and_alloc_.compare, key);
+    return Tree_algo_::partition_point(
+      tree_and_alloc_.tree,
+      [this, &search_key](Node_ const& node) -> bool
+      {
+        return !is_before_(search_key, node);
+      });
+  }
+
+  template<bool upper>
+  [[nodiscard]] size_type rank_(key_type const& key) const
+  {
+    Search_key_<> const search_key(tree_and_alloc_.compare, key);
+    Size_ rank = static_cast<Size_>(0u);
+    Node_* const node = Tree_algo_::lower_bound<true, true>(
+      tree_and_alloc_.tree,
+      [this, &search_key, &rank](
+        Node_ const& node,
+        Size_ const& idx) -> Compare_result_
+      {
+        bool is_less;
+        if constexpr(upper)
+        {
+          is_less = !is_before_(search_key, node);
+        }
+        else
+        {
+          is_less = is_before_(node, search_key);
+        }
+
+        if(is_less)
+        {
+          return Compare_result_::less;
+        }
+
+        rank = idx;
+        return Compare_result_::greater;
+      });
+
+    return node ? rank : size();
+  }
+
+  template<Side_ side>
+  [[nodiscard]] Value_ const& extreme_() const noexcept
+  {
+    Node_* const node = tree_and_alloc_.tree.template extreme<side>();
+    TREEXX_ASSERT(node);
+    return node->value;
+  }
+
+  template<class... Args>
+  [[nodiscard]] Node_* create_node_(Args&&... args)
+  {
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+    set_prefix_(*node_ptr);
+    node.release();
+    return node_ptr;
+  }
+
+  void set_prefix_(Node_& node) const
+  {
+    if constexpr(has_prefix_)
+    {
+      node.prefix = tree_and_alloc_.compare.prefix(node.value);
+    }
+    else
+    {
+      static_cast<void>(node);
+    }
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Tree_and_alloc_ tree_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_INDEXEDMULTISET_HH
@@ -0,0 +1,540 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_INTRUSIVEINDEXEDLIST_HH
+#define TREEXX_STDXX_INTRUSIVEINDEXEDLIST_HH
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/avl_hook.hh>
+
+namespace treexx::stdxx
+{
+
+// Sequence of objects linked through the hook member `hook`, with
+// O(log n) positional access. The list never allocates and never owns its
+// elements.
+template<class T, avl_hook<T, ::std::size_t> T::* hook>
+struct intrusive_indexed_list
+{
+  using value_type = T;
+  using hook_type = avl_hook<T, ::std::size_t>;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+  using Tree_ = avl_hook_tree<Value_, hook_type, hook>;
+
+  template<bool c, class U, class V>
+  using Conditional_ = typename ::std::conditional<c, U, V>::type;
+
+  template<class U>
+  using Add_const_ = typename ::std::add_const<U>::type;
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  template<bool is_const>
+  struct Iterator_
+  {
+    using iterator_category = ::std::random_access_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = Conditional_<
+      is_const, Add_const_<value_type>&, value_type&>;
+    using pointer = Conditional_<
+      is_const, Add_const_<value_type>*, value_type*>;
+
+    Iterator_() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    template<bool e = is_const, class = typename Enable_if_<e>::Type>
+    Iterator_(Iterator_<false> const& x) noexcept :
+      tree_(x.tree_),
+      node_(x.node_)
+    {}
+
+    [[nodiscard]] size_type index() const noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      return node_ ? Tree_algo_::node_index(*tree_, *node_) : tree_->size();
+    }
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return *node_;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_;
+    }
+
+    [[nodiscard]] reference operator [](difference_type const n) const noexcept
+    {
+      return *(*this + n);
+    }
+
+    Iterator_& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    Iterator_ operator ++(int) noexcept
+    {
+      Iterator_ const x(*this);
+      ++*this;
+      return x;
+    }
+
+    Iterator_& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    Iterator_ operator --(int) noexcept
+    {
+      Iterator_ const x(*this);
+      --*this;
+      return x;
+    }
+
+    Iterator_& operator +=(difference_type const n) noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(0 != n)
+      {
+        size_type const idx(
+          index() + static_cast<size_type>(n));
+        TREEXX_ASSERT(idx <= tree_->size());
+        node_ = idx < tree_->size() ?
+          Tree_algo_::at_index(*tree_, idx) : nullptr;
+      }
+
+      return *this;
+    }
+
+    Iterator_& operator -=(difference_type const n) noexcept
+    {
+      return *this += -n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator +(
+      Iterator_ x,
+      difference_type const n) noexcept
+    {
+      return x += n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator +(
+      difference_type const n,
+      Iterator_ x) noexcept
+    {
+      return x += n;
+    }
+
+    [[nodiscard]] friend Iterator_ operator -(
+      Iterator_ x,
+      difference_type const n) noexcept
+    {
+      return x -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator -(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return
+        static_cast<difference_type>(x.index()) -
+        static_cast<difference_type>(y.index());
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+    [[nodiscard]] friend bool operator <(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_ && x.index() < y.index();
+    }
+
+    [[nodiscard]] friend bool operator >(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return y < x;
+    }
+
+    [[nodiscard]] friend bool operator <=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return !(y < x);
+    }
+
+    [[nodiscard]] friend bool operator >=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return !(x < y);
+    }
+
+  private:
+    friend struct intrusive_indexed_list;
+    friend struct Iterator_<true>;
+
+    Iterator_(Tree_ const* const t, Value_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    Tree_ const* tree_;
+    Value_* node_;
+  };
+
+public:
+  using iterator = Iterator_<false>;
+  using const_iterator = Iterator_<true>;
+  using reverse_iterator = ::std::reverse_iterator<iterator>;
+  using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+  intrusive_indexed_list() = default;
+
+  intrusive_indexed_list(intrusive_indexed_list&& x) noexcept
+  {
+    tree_.swap(x.tree_);
+  }
+
+  intrusive_indexed_list(intrusive_indexed_list const&) = delete;
+
+  intrusive_indexed_list& operator =(intrusive_indexed_list&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      swap(x);
+    }
+
+    return *this;
+  }
+
+  intrusive_indexed_list& operator =(intrusive_indexed_list const&) = delete;
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_.size();
+  }
+
+  [[nodiscard]] iterator begin() noexcept
+  {
+    return make_iterator_(tree_.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept
+  {
+    return make_iterator_(tree_.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] iterator end() noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  [[nodiscard]] reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+
+  [[nodiscard]] reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  [[nodiscard]] iterator iterator_to(reference x) noexcept
+  {
+    return make_iterator_(::std::addressof(x));
+  }
+
+  [[nodiscard]] const_iterator iterator_to(const_reference x) const noexcept
+  {
+    return make_iterator_(const_cast<Value_*>(::std::addressof(x)));
+  }
+
+  [[nodiscard]] size_type index_of(const_reference x) const noexcept
+  {
+    return Tree_algo_::node_index(tree_, const_cast<Value_&>(x));
+  }
+
+  [[nodiscard]] reference operator [](size_type const& idx) noexcept
+  {
+    TREEXX_ASSERT(idx < size());
+    return *Tree_algo_::at_index(tree_, idx);
+  }
+
+  [[nodiscard]] const_reference operator [](
+    size_type const& idx) const noexcept
+  {
+    TREEXX_ASSERT(idx < size());
+    return *Tree_algo_::at_index(tree_, idx);
+  }
+
+  [[nodiscard]] reference at(size_type const& idx)
+  {
+    check_index_(idx);
+    return (*this)[idx];
+  }
+
+  [[nodiscard]] const_reference at(size_type const& idx) const
+  {
+    check_index_(idx);
+    return (*this)[idx];
+  }
+
+  [[nodiscard]] reference front() noexcept
+  {
+    return extreme_<Side_::left>();
+  }
+
+  [[nodiscard]] const_reference front() const noexcept
+  {
+    return extreme_<Side_::left>();
+  }
+
+  [[nodiscard]] reference back() noexcept
+  {
+    return extreme_<Side_::right>();
+  }
+
+  [[nodiscard]] const_reference back() const noexcept
+  {
+    return extreme_<Side_::right>();
+  }
+
+  void push_back(reference x) noexcept
+  {
+    Tree_algo_::push_back(tree_, ::std::addressof(x));
+    tree_.increment_size();
+  }
+
+  void push_front(reference x) noexcept
+  {
+    Tree_algo_::push_front(tree_, ::std::addressof(x));
+    tree_.increment_size();
+  }
+
+  iterator insert(size_type const& idx, reference x) noexcept
+  {
+    TREEXX_ASSERT(idx <= tree_.size());
+    Value_* const node = ::std::addressof(x);
+    Tree_algo_::insert_at_index(tree_, node, idx);
+    tree_.increment_size();
+    return make_iterator_(node);
+  }
+
+  iterator insert(const_iterator const& pos, reference x) noexcept
+  {
+    TREEXX_ASSERT(::std::addressof(tree_) == pos.tree_);
+    Value_* const node = ::std::addressof(x);
+    Tree_algo_::insert(tree_, pos.node_, node);
+    tree_.increment_size();
+    return make_iterator_(node);
+  }
+
+  iterator erase(const_iterator const& pos) noexcept
+  {
+    Value_* const node = pos.node_;
+    TREEXX_ASSERT(::std::addressof(tree_) == pos.tree_);
+    TREEXX_ASSERT(node);
+
+    Value_* const next = Tree_algo_::next_node(tree_, *node);
+    Tree_algo_::erase(tree_, node);
+    tree_.decrement_size();
+    return make_iterator_(next);
+  }
+
+  iterator erase(reference x) noexcept
+  {
+    return erase(iterator_to(x));
+  }
+
+  reference pop_back() noexcept
+  {
+    TREEXX_ASSERT(!tree_.empty());
+    Value_* const node = Tree_algo_::pop_back(tree_);
+    tree_.decrement_size();
+    return *node;
+  }
+
+  reference pop_front() noexcept
+  {
+    TREEXX_ASSERT(!tree_.empty());
+    Value_* const node = Tree_algo_::pop_front(tree_);
+    tree_.decrement_size();
+    return *node;
+  }
+
+  void clear() noexcept
+  {
+    tree_.reset();
+  }
+
+  template<class Dispose>
+  void clear_and_dispose(Dispose&& dispose)
+  {
+    ::treexx::bin::Tree_algo::clear(
+      tree_,
+      [&dispose](Value_* const node)
+      {
+        dispose(node);
+      });
+    tree_.reset();
+  }
+
+  void swap(intrusive_indexed_list& x) noexcept
+  {
+    tree_.swap(x.tree_);
+  }
+
+  friend void swap(
+    intrusive_indexed_list& x,
+    intrusive_indexed_list& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  [[nodiscard]] iterator make_iterator_(Value_* const node) noexcept
+  {
+    return iterator(::std::addressof(tree_), node);
+  }
+
+  [[nodiscard]] const_iterator make_iterator_(
+    Value_* const node) const noexcept
+  {
+    return const_iterator(::std::addressof(tree_), node);
+  }
+
+  void check_index_(size_type const& idx) const
+  {
+    if(size() <= idx)
+    {
+      throw ::std::out_of_range(
+        "treexx::stdxx::intrusive_indexed_list: index");
+    }
+  }
+
+  template<Side_ side>
+  [[nodiscard]] Value_& extreme_() const noexcept
+  {
+    Value_* const node = tree_.template extreme<side>();
+    TREEXX_ASSERT(node);
+    return *node;
+  }
+
+  Tree_ tree_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_INTRUSIVEINDEXEDLIST_HH
@@ -0,0 +1,485 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_INTRUSIVESET_HH
+#define TREEXX_STDXX_INTRUSIVESET_HH
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/avl_hook.hh>
+
+namespace treexx::stdxx
+{
+
+// Ordered set of unique objects linked through the hook member `hook`.
+// The set never allocates and never owns its elements.
+template<
+  class T,
+  avl_hook<T> T::* hook,
+  class C = ::std::less<T>>
+struct intrusive_set
+{
+  using key_type = T;
+  using value_type = T;
+  using key_compare = C;
+  using value_compare = C;
+  using hook_type = avl_hook<T>;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Compare_ = key_compare;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+  using Tree_ = avl_hook_tree<Value_, hook_type, hook>;
+
+  template<bool c, class U, class V>
+  using Conditional_ = typename ::std::conditional<c, U, V>::type;
+
+  template<class U>
+  using Add_const_ = typename ::std::add_const<U>::type;
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  template<bool is_const>
+  struct Iterator_
+  {
+    using iterator_category = ::std::bidirectional_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = Conditional_<
+      is_const, Add_const_<value_type>&, value_type&>;
+    using pointer = Conditional_<
+      is_const, Add_const_<value_type>*, value_type*>;
+
+    Iterator_() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    template<bool e = is_const, class = typename Enable_if_<e>::Type>
+    Iterator_(Iterator_<false> const& x) noexcept :
+      tree_(x.tree_),
+      node_(x.node_)
+    {}
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return *node_;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_;
+    }
+
+    Iterator_& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    Iterator_ operator ++(int) noexcept
+    {
+      Iterator_ const x(*this);
+      ++*this;
+      return x;
+    }
+
+    Iterator_& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    Iterator_ operator --(int) noexcept
+    {
+      Iterator_ const x(*this);
+      --*this;
+      return x;
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+  private:
+    friend struct intrusive_set;
+    friend struct Iterator_<true>;
+
+    Iterator_(Tree_ const* const t, Value_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    Tree_ const* tree_;
+    Value_* node_;
+  };
+
+public:
+  using iterator = Iterator_<false>;
+  using const_iterator = Iterator_<true>;
+  using reverse_iterator = ::std::reverse_iterator<iterator>;
+  using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+  intrusive_set() = default;
+
+  explicit intrusive_set(key_compare const& compare) :
+    compare_(compare)
+  {}
+
+  intrusive_set(intrusive_set&& x) noexcept :
+    compare_(x.compare_)
+  {
+    tree_.swap(x.tree_);
+  }
+
+  intrusive_set(intrusive_set const&) = delete;
+
+  intrusive_set& operator =(intrusive_set&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      swap(x);
+    }
+
+    return *this;
+  }
+
+  intrusive_set& operator =(intrusive_set const&) = delete;
+
+  [[nodiscard]] key_compare key_comp() const
+  {
+    return compare_;
+  }
+
+  [[nodiscard]] value_compare value_comp() const
+  {
+    return compare_;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_.size();
+  }
+
+  [[nodiscard]] iterator begin() noexcept
+  {
+    return make_iterator_(tree_.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept
+  {
+    return make_iterator_(tree_.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] iterator end() noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  [[nodiscard]] reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+
+  [[nodiscard]] reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  [[nodiscard]] iterator iterator_to(reference x) noexcept
+  {
+    return make_iterator_(::std::addressof(x));
+  }
+
+  [[nodiscard]] const_iterator iterator_to(const_reference x) const noexcept
+  {
+    return make_iterator_(const_cast<Value_*>(::std::addressof(x)));
+  }
+
+  ::std::pair<iterator, bool> insert(reference x)
+  {
+    Compare_ const& compare = compare_;
+    Value_* const node = ::std::addressof(x);
+    Value_* const found = Tree_algo_::try_insert(
+      tree_,
+      [&compare, node](Value_ const& n) -> Compare_result_
+      {
+        if(compare(*node, n))
+        {
+          return Compare_result_::greater;
+        }
+        if(compare(n, *node))
+        {
+          return Compare_result_::less;
+        }
+        return Compare_result_::equal;
+      },
+      [node](Value_* const parent, Side_ const side) noexcept -> Value_*
+      {
+        (node->*hook).parent = parent;
+        (node->*hook).side = side;
+        return node;
+      });
+
+    bool const inserted(node == found);
+    if(inserted)
+    {
+      tree_.increment_size();
+    }
+
+    return ::std::pair<iterator, bool>(make_iterator_(found), inserted);
+  }
+
+  iterator erase(const_iterator const& pos) noexcept
+  {
+    Value_* const node = pos.node_;
+    TREEXX_ASSERT(::std::addressof(tree_) == pos.tree_);
+    TREEXX_ASSERT(node);
+
+    Value_* const next = Tree_algo_::next_node(tree_, *node);
+    Tree_algo_::erase(tree_, node);
+    tree_.decrement_size();
+    return make_iterator_(next);
+  }
+
+  iterator erase(reference x) noexcept
+  {
+    return erase(iterator_to(x));
+  }
+
+  void clear() noexcept
+  {
+    tree_.reset();
+  }
+
+  template<class Dispose>
+  void clear_and_dispose(Dispose&& dispose)
+  {
+    ::treexx::bin::Tree_algo::clear(
+      tree_,
+      [&dispose](Value_* const node)
+      {
+        dispose(node);
+      });
+    tree_.reset();
+  }
+
+  void swap(intrusive_set& x) noexcept
+  {
+    using ::std::swap;
+    tree_.swap(x.tree_);
+    swap(compare_, x.compare_);
+  }
+
+  friend void swap(intrusive_set& x, intrusive_set& y) noexcept
+  {
+    x.swap(y);
+  }
+
+  template<class K>
+  [[nodiscard]] iterator find(K const& key)
+  {
+    return make_iterator_(find_(key));
+  }
+
+  template<class K>
+  [[nodiscard]] const_iterator find(K const& key) const
+  {
+    return make_iterator_(find_(key));
+  }
+
+  template<class K>
+  [[nodiscard]] bool contains(K const& key) const
+  {
+    return find_(key) ? true : false;
+  }
+
+  template<class K>
+  [[nodiscard]] iterator lower_bound(K const& key)
+  {
+    return make_iterator_(lower_bound_(key));
+  }
+
+  template<class K>
+  [[nodiscard]] const_iterator lower_bound(K const& key) const
+  {
+    return make_iterator_(lower_bound_(key));
+  }
+
+  template<class K>
+  [[nodiscard]] iterator upper_bound(K const& key)
+  {
+    return make_iterator_(upper_bound_(key));
+  }
+
+  template<class K>
+  [[nodiscard]] const_iterator upper_bound(K const& key) const
+  {
+    return make_iterator_(upper_bound_(key));
+  }
+
+private:
+  [[nodiscard]] iterator make_iterator_(Value_* const node) noexcept
+  {
+    return iterator(::std::addressof(tree_), node);
+  }
+
+  [[nodiscard]] const_iterator make_iterator_(
+    Value_* const node) const noexcept
+  {
+    return const_iterator(::std::addressof(tree_), node);
+  }
+
+  template<class K>
+  [[nodiscard]] Value_* find_(K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::binary_search(
+      tree_,
+      [&compare, &key](Value_ const& n) -> Compare_result_
+      {
+        if(compare(n, key))
+        {
+          return Compare_result_::less;
+        }
+        if(compare(key, n))
+        {
+          return Compare_result_::greater;
+        }
+        return Compare_result_::equal;
+      });
+  }
+
+  template<class K>
+  [[nodiscard]] Value_* lower_bound_(K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::lower_bound(
+      tree_,
+      [&compare, &key](Value_ const& n) -> Compare_result_
+      {
+        return compare(n, key) ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+  }
+
+  template<class K>
+  [[nodiscard]] Value_* upper_bound_(K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::lower_bound(
+      tree_,
+      [&compare, &key](Value_ const& n) -> Compare_result_
+      {
+        return compare(key, n) ?
+          Compare_result_::greater : Compare_result_::less;
+      });
+  }
+
+  Tree_ tree_;
+  Compare_ compare_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_INTRUSIVESET_HH
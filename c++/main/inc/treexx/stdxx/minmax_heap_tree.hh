@@ -0,0 +1,688 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_MINMAXHEAPTREE_HH
+#define TREEXX_STDXX_MINMAXHEAPTREE_HH
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace treexx::stdxx
+{
+
+template<
+  class T,
+  class C = ::std::less<T>,
+  class A = ::std::allocator<T>>
+struct minmax_heap_tree
+{
+  using value_type = T;
+  using value_compare = C;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Compare_ = value_compare;
+  using Value_ = value_type;
+  using Size_ = size_type;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  struct Node_
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    Node_* parent;
+    Node_* left_child;
+    Node_* right_child;
+    Balance_ balance;
+    Side_ side;
+    Value_ value;
+  };
+
+  struct Tree_static_
+  {
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node_* parent(Node_ const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node_* child(Node_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node_ const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Node_ const& n) noexcept
+    {
+      return n.side;
+    }
+
+    static void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Node_& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return 1u > size_;
+    }
+
+    void increment_size() noexcept
+    {
+      ++size_;
+    }
+
+    void decrement_size() noexcept
+    {
+      --size_;
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+  private:
+    Node_* root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    Size_ size_;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  static_assert(Is_same_<Value_, Remove_cv_ref_<Value_>>::value);
+  static_assert(Is_same_<Allocator_, Remove_cv_ref_<Allocator_>>::value);
+  static_assert(Is_same_<Compare_, Remove_cv_ref_<Compare_>>::value);
+
+public:
+  struct handle
+  {
+    handle() noexcept :
+      node_(nullptr)
+    {}
+
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+      return node_ ? true : false;
+    }
+
+    [[nodiscard]] const_reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_->value;
+    }
+
+    [[nodiscard]] value_type const* operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return ::std::addressof(node_->value);
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      handle const& x,
+      handle const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      handle const& x,
+      handle const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+  private:
+    friend struct minmax_heap_tree;
+
+    explicit handle(Node_* const n) noexcept :
+      node_(n)
+    {}
+
+    Node_* node_;
+  };
+
+  minmax_heap_tree() = default;
+
+  explicit minmax_heap_tree(
+    value_compare const& compare,
+    allocator_type const& alloc = allocator_type()) :
+    tree_and_alloc_(compare, alloc)
+  {}
+
+  explicit minmax_heap_tree(allocator_type const& alloc) :
+    tree_and_alloc_(value_compare(), alloc)
+  {}
+
+  minmax_heap_tree(minmax_heap_tree&& x) noexcept :
+    tree_and_alloc_(
+      x.tree_and_alloc_.compare,
+      static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator()))
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+  }
+
+  minmax_heap_tree(minmax_heap_tree const& x) :
+    tree_and_alloc_(
+      x.tree_and_alloc_.compare,
+      Node_allocator_traits_::select_on_container_copy_construction(
+        x.tree_and_alloc_.allocator()))
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Tree_ const& x_tree = x.tree_and_alloc_.tree;
+    for(Node_* x_node = x_tree.template extreme<Side_::left>(); x_node;
+      x_node = Tree_algo_::next_node(x_tree, *x_node))
+    {
+      Unique_node_ node(tree_and_alloc_.allocator());
+      node.construct(x_node->value);
+      Tree_algo_::push_back(tree, node.get());
+      node.release();
+      tree.increment_size();
+    }
+  }
+
+  ~minmax_heap_tree()
+  {
+    clear();
+  }
+
+  minmax_heap_tree& operator =(minmax_heap_tree&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+      tree_and_alloc_.compare = x.tree_and_alloc_.compare;
+      if constexpr(
+        Node_allocator_traits_::propagate_on_container_move_assignment::value)
+      {
+        tree_and_alloc_.allocator() =
+          static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator());
+      }
+    }
+
+    return *this;
+  }
+
+  minmax_heap_tree& operator =(minmax_heap_tree const& x)
+  {
+    if(this != ::std::addressof(x))
+    {
+      minmax_heap_tree y(x);
+      swap(y);
+    }
+
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(tree_and_alloc_.allocator());
+  }
+
+  [[nodiscard]] value_compare value_comp() const
+  {
+    return tree_and_alloc_.compare;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_and_alloc_.tree.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_and_alloc_.tree.size();
+  }
+
+  [[nodiscard]] const_reference min() const noexcept
+  {
+    return extreme_<Side_::left>();
+  }
+
+  [[nodiscard]] const_reference max() const noexcept
+  {
+    return extreme_<Side_::right>();
+  }
+
+  [[nodiscard]] handle min_handle() const noexcept
+  {
+    return handle(tree_and_alloc_.tree.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] handle max_handle() const noexcept
+  {
+    return handle(tree_and_alloc_.tree.template extreme<Side_::right>());
+  }
+
+  template<class... Args>
+  handle emplace(Args&&... args)
+  {
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    insert_(node_ptr);
+    node.release();
+    tree_and_alloc_.tree.increment_size();
+    return handle(node_ptr);
+  }
+
+  handle push(value_type&& val)
+  {
+    return emplace(static_cast<value_type&&>(val));
+  }
+
+  handle push(value_type const& val)
+  {
+    return emplace(val);
+  }
+
+  void pop_min() noexcept
+  {
+    pop_<Side_::left>();
+  }
+
+  void pop_max() noexcept
+  {
+    pop_<Side_::right>();
+  }
+
+  void erase(handle const& h) noexcept
+  {
+    Node_* const node = h.node_;
+    TREEXX_ASSERT(node);
+    Tree_& tree = tree_and_alloc_.tree;
+    Tree_algo_::erase(tree, node);
+    tree.decrement_size();
+    destroy_node_(node);
+  }
+
+  template<class Val>
+  handle update(handle const& h, Val&& val)
+  {
+    Node_* const node = h.node_;
+    TREEXX_ASSERT(node);
+    Tree_& tree = tree_and_alloc_.tree;
+    Tree_algo_::erase(tree, node);
+    try
+    {
+      node->value = static_cast<Val&&>(val);
+    }
+    catch(...)
+    {
+      tree.decrement_size();
+      destroy_node_(node);
+      throw;
+    }
+
+    insert_(node);
+    return h;
+  }
+
+  void clear() noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
+  void swap(minmax_heap_tree& x) noexcept
+  {
+    using ::std::swap;
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+    swap(tree_and_alloc_.compare, x.tree_and_alloc_.compare);
+    if constexpr(Node_allocator_traits_::propagate_on_container_swap::value)
+    {
+      swap(tree_and_alloc_.allocator(), x.tree_and_alloc_.allocator());
+    }
+  }
+
+  friend void swap(minmax_heap_tree& x, minmax_heap_tree& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  struct Unique_node_
+  {
+    using Ptr = typename Node_allocator_traits_::pointer;
+
+    explicit Unique_node_(Node_allocator_& alloc) :
+      alloc_(::std::addressof(alloc)),
+      ptr_(Node_allocator_traits_::allocate(alloc, 1u)),
+      constructed(false)
+    {}
+
+    Unique_node_(Unique_node_&&) = delete;
+    Unique_node_(Unique_node_ const&) = delete;
+
+    ~Unique_node_()
+    {
+      if(alloc_ && ptr_)
+      {
+        if(constructed)
+        {
+          Node_allocator_traits_::destroy(*alloc_, ptr_);
+        }
+
+        Node_allocator_traits_::deallocate(*alloc_, ptr_, 1u);
+      }
+    }
+
+    Unique_node_& operator =(Unique_node_&&) = delete;
+    Unique_node_& operator =(Unique_node_ const&) = delete;
+
+    [[nodiscard]] Ptr const& get() const noexcept
+    {
+      return ptr_;
+    }
+
+    void release() noexcept
+    {
+      alloc_ = nullptr;
+    }
+
+    template<class... Args>
+    void construct(Args&&... args)
+    {
+      TREEXX_ASSERT(alloc_);
+      TREEXX_ASSERT(!constructed);
+      Node_allocator_traits_::construct(
+        *alloc_, ptr_, static_cast<Args&&>(args)...);
+      constructed = true;
+    }
+
+  private:
+    Node_allocator_* alloc_;
+    Ptr ptr_;
+    bool constructed;
+  };
+
+  struct Allocator_base_ : Node_allocator_
+  {
+    Allocator_base_() = default;
+
+    template<class Alloc>
+    explicit Allocator_base_(Alloc&& alloc) :
+      Node_allocator_(static_cast<Alloc&&>(alloc))
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    [[nodiscard]] Node_allocator_ const& allocator() const noexcept
+    {
+      return *this;
+    }
+  };
+
+  struct Tree_and_alloc_ : Allocator_base_
+  {
+    Tree_and_alloc_() = default;
+
+    template<class Alloc>
+    Tree_and_alloc_(Compare_ const& c, Alloc&& alloc) :
+      Allocator_base_(static_cast<Alloc&&>(alloc)),
+      compare(c)
+    {}
+
+    Tree_ tree;
+    Compare_ compare;
+  };
+
+  template<Side_ side>
+  [[nodiscard]] Value_ const& extreme_() const noexcept
+  {
+    Node_* const node = tree_and_alloc_.tree.template extreme<side>();
+    TREEXX_ASSERT(node);
+    return node->value;
+  }
+
+  void insert_(Node_* const node)
+  {
+    Compare_ const& compare = tree_and_alloc_.compare;
+    Value_ const& val = node->value;
+    static_cast<void>(Tree_algo_::try_insert(
+      tree_and_alloc_.tree,
+      [&compare, &val](Node_ const& n) -> Compare_result_
+      {
+        return compare(val, n.value) ?
+          Compare_result_::greater : Compare_result_::less;
+      },
+      [node](Node_* const parent, Side_ const side) noexcept -> Node_*
+      {
+        node->parent = parent;
+        node->side = side;
+        return node;
+      }));
+  }
+
+  template<Side_ side>
+  void pop_() noexcept
+  {
+    static_assert(Side_::left == side || Side_::right == side);
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(!tree.empty());
+
+    Node_* node;
+    if constexpr(Side_::left == side)
+    {
+      node = Tree_algo_::pop_front(tree);
+    }
+    else if constexpr(Side_::right == side)
+    {
+      node = Tree_algo_::pop_back(tree);
+    }
+
+    tree.decrement_size();
+    destroy_node_(node);
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Tree_and_alloc_ tree_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_MINMAXHEAPTREE_HH
@@ -0,0 +1,1119 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_MULTIINDEX_HH
+#define TREEXX_STDXX_MULTIINDEX_HH
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/avl_hook.hh>
+
+namespace treexx::stdxx
+{
+
+// View ordered by K()(value) under C. Equal keys keep insertion order.
+template<class K, class C = ::std::less<>>
+struct ordered_view
+{
+  using key_of = K;
+  using key_compare = C;
+};
+
+// View in insertion order with O(log n) positional access.
+struct sequenced_view
+{};
+
+// View in insertion order where every element spans E()(value) units of
+// type O right after its predecessor, so elements can be located by offset.
+template<class O, class E>
+struct offset_view
+{
+  using offset_type = O;
+  using extent_of = E;
+};
+
+template<class... V>
+struct views
+{};
+
+template<class T, class V, class A = ::std::allocator<T>>
+struct multi_index;
+
+// Every element is allocated once and carries one set of AVL links per view,
+// so inserting or erasing it updates all the views at once.
+template<class T, class... V, class A>
+struct multi_index<T, views<V...>, A>
+{
+  using value_type = T;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+
+  static Size_ constexpr view_count_ = sizeof...(V);
+  static_assert(0u < view_count_);
+
+  template<bool c, class U, class W>
+  using Conditional_ = typename ::std::conditional<c, U, W>::type;
+
+  template<class U>
+  using Add_const_ = typename ::std::add_const<U>::type;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  template<Size_ i>
+  using View_type_ = typename ::std::tuple_element<i, ::std::tuple<V...>>::type;
+
+  template<class W>
+  struct Is_ordered_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class K, class C>
+  struct Is_ordered_<ordered_view<K, C>>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<class W>
+  struct Is_offset_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class O, class E>
+  struct Is_offset_<offset_view<O, E>>
+  {
+    static bool constexpr value = true;
+  };
+
+  struct Node_;
+
+  template<class W, bool = true>
+  struct Hook_of_
+  {
+    using Type = avl_hook<Node_>;
+  };
+
+  template<bool b>
+  struct Hook_of_<sequenced_view, b>
+  {
+    using Type = avl_hook<Node_, Size_>;
+  };
+
+  template<class O, class E, bool b>
+  struct Hook_of_<offset_view<O, E>, b>
+  {
+    using Type = avl_hook<Node_, void, O>;
+  };
+
+  struct Node_
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    ::std::tuple<typename Hook_of_<V>::Type...> hooks;
+    Value_ value;
+  };
+
+  template<Size_ i>
+  struct Get_hook_
+  {
+    using Hook = typename Hook_of_<View_type_<i>>::Type;
+
+    [[nodiscard]] static Hook& get(Node_& n) noexcept
+    {
+      return ::std::get<i>(n.hooks);
+    }
+
+    [[nodiscard]] static Hook const& get(Node_ const& n) noexcept
+    {
+      return ::std::get<i>(n.hooks);
+    }
+  };
+
+  template<Size_ i>
+  using Tree_ =
+    basic_avl_hook_tree<Node_, typename Get_hook_<i>::Hook, Get_hook_<i>>;
+
+  template<Size_ i>
+  using Offset_ = typename Tree_<i>::Offset;
+
+  template<class>
+  struct Trees_of_;
+
+  template<Size_... i>
+  struct Trees_of_<::std::index_sequence<i...>>
+  {
+    using Type = ::std::tuple<Tree_<i>...>;
+  };
+
+  using Trees_ =
+    typename Trees_of_<::std::make_index_sequence<view_count_>>::Type;
+
+  template<Size_ i, bool is_const, class W = View_type_<i>>
+  struct View_;
+
+  template<Size_ i, bool is_const>
+  struct Iterator_
+  {
+    using iterator_category = ::std::bidirectional_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = Conditional_<
+      is_const, Add_const_<value_type>&, value_type&>;
+    using pointer = Conditional_<
+      is_const, Add_const_<value_type>*, value_type*>;
+
+    Iterator_() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    template<bool e = is_const, class = typename Enable_if_<e>::Type>
+    Iterator_(Iterator_<i, false> const& x) noexcept :
+      tree_(x.tree_),
+      node_(x.node_)
+    {}
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_->value;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return ::std::addressof(node_->value);
+    }
+
+    Iterator_& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    Iterator_ operator ++(int) noexcept
+    {
+      Iterator_ const x(*this);
+      ++*this;
+      return x;
+    }
+
+    Iterator_& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    Iterator_ operator --(int) noexcept
+    {
+      Iterator_ const x(*this);
+      --*this;
+      return x;
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+  private:
+    friend struct multi_index;
+    friend struct Iterator_<i, true>;
+
+    template<Size_, bool, class>
+    friend struct View_;
+
+    Iterator_(Tree_<i> const* const t, Node_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    Tree_<i> const* tree_;
+    Node_* node_;
+  };
+
+  template<Size_ i, bool is_const>
+  struct View_base_
+  {
+    using iterator = Iterator_<i, is_const>;
+    using reverse_iterator = ::std::reverse_iterator<iterator>;
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return tree_().empty();
+    }
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+      return tree_().size();
+    }
+
+    [[nodiscard]] iterator begin() const noexcept
+    {
+      return make_iterator_(tree_().template extreme<Side_::left>());
+    }
+
+    [[nodiscard]] iterator end() const noexcept
+    {
+      return make_iterator_(nullptr);
+    }
+
+    [[nodiscard]] reverse_iterator rbegin() const noexcept
+    {
+      return reverse_iterator(end());
+    }
+
+    [[nodiscard]] reverse_iterator rend() const noexcept
+    {
+      return reverse_iterator(begin());
+    }
+
+  protected:
+    using Container = Conditional_<
+      is_const, Add_const_<multi_index>, multi_index>;
+
+    explicit View_base_(Container& c) noexcept :
+      container_(::std::addressof(c))
+    {}
+
+    [[nodiscard]] Tree_<i> const& tree_() const noexcept
+    {
+      return container_->template tree_<i>();
+    }
+
+    [[nodiscard]] iterator make_iterator_(Node_* const node) const noexcept
+    {
+      return iterator(::std::addressof(tree_()), node);
+    }
+
+    Container* container_;
+  };
+
+  template<Size_ i, bool is_const, class K, class C>
+  struct View_<i, is_const, ordered_view<K, C>> : View_base_<i, is_const>
+  {
+    using typename View_base_<i, is_const>::iterator;
+
+    template<class Key>
+    [[nodiscard]] iterator find(Key const& key) const
+    {
+      Node_* const node = multi_index::lower_bound_<i>(this->tree_(), key);
+      if(node && !C()(key, K()(node->value)))
+      {
+        return this->make_iterator_(node);
+      }
+
+      return this->end();
+    }
+
+    template<class Key>
+    [[nodiscard]] bool contains(Key const& key) const
+    {
+      return this->end() != find(key);
+    }
+
+    template<class Key>
+    [[nodiscard]] size_type count(Key const& key) const
+    {
+      Size_ n = static_cast<Size_>(0u);
+      iterator const last(upper_bound(key));
+      for(iterator it(lower_bound(key)); last != it; ++it)
+      {
+        ++n;
+      }
+
+      return n;
+    }
+
+    template<class Key>
+    [[nodiscard]] iterator lower_bound(Key const& key) const
+    {
+      return this->make_iterator_(
+        multi_index::lower_bound_<i>(this->tree_(), key));
+    }
+
+    template<class Key>
+    [[nodiscard]] iterator upper_bound(Key const& key) const
+    {
+      return this->make_iterator_(
+        multi_index::upper_bound_<i>(this->tree_(), key));
+    }
+
+    template<class Key>
+    [[nodiscard]] ::std::pair<iterator, iterator> equal_range(
+      Key const& key) const
+    {
+      return {lower_bound(key), upper_bound(key)};
+    }
+
+  private:
+    friend struct multi_index;
+
+    explicit View_(typename View_base_<i, is_const>::Container& c) noexcept :
+      View_base_<i, is_const>(c)
+    {}
+  };
+
+  template<Size_ i, bool is_const>
+  struct View_<i, is_const, sequenced_view> : View_base_<i, is_const>
+  {
+    using typename View_base_<i, is_const>::iterator;
+    using reference = typename iterator::reference;
+
+    [[nodiscard]] iterator nth(size_type const& idx) const noexcept
+    {
+      return this->make_iterator_(Tree_algo_::at_index(this->tree_(), idx));
+    }
+
+    [[nodiscard]] size_type index_of(iterator const& it) const noexcept
+    {
+      return it.node_ ?
+        Tree_algo_::node_index(this->tree_(), *it.node_) : this->size();
+    }
+
+    [[nodiscard]] reference operator [](size_type const& idx) const noexcept
+    {
+      TREEXX_ASSERT(idx < this->size());
+      return Tree_algo_::at_index(this->tree_(), idx)->value;
+    }
+
+    [[nodiscard]] reference at(size_type const& idx) const
+    {
+      if(this->size() <= idx)
+      {
+        throw ::std::out_of_range("treexx::stdxx::multi_index: index");
+      }
+
+      return (*this)[idx];
+    }
+
+    [[nodiscard]] reference front() const noexcept
+    {
+      return *this->begin();
+    }
+
+    [[nodiscard]] reference back() const noexcept
+    {
+      return *this->rbegin();
+    }
+
+  private:
+    friend struct multi_index;
+
+    explicit View_(typename View_base_<i, is_const>::Container& c) noexcept :
+      View_base_<i, is_const>(c)
+    {}
+  };
+
+  template<Size_ i, bool is_const, class O, class E>
+  struct View_<i, is_const, offset_view<O, E>> : View_base_<i, is_const>
+  {
+    using typename View_base_<i, is_const>::iterator;
+    using offset_type = O;
+
+    [[nodiscard]] offset_type offset_of(iterator const& it) const noexcept
+    {
+      TREEXX_ASSERT(it.node_);
+      return Tree_algo_::node_offset(this->tree_(), *it.node_);
+    }
+
+    // Sum of the extents of all the elements.
+    [[nodiscard]] offset_type extent() const
+    {
+      Node_* const back = this->tree_().template extreme<Side_::right>();
+      if(back)
+      {
+        return Tree_algo_::node_offset(this->tree_(), *back) +
+          E()(back->value);
+      }
+
+      return offset_type();
+    }
+
+    // The element whose span [offset, offset + extent) covers `off`.
+    [[nodiscard]] iterator locate(offset_type const& off) const
+    {
+      Node_* node = multi_index::upper_bound_<i>(this->tree_(), off);
+      node = node ?
+        Tree_algo_::previous_node(this->tree_(), *node) :
+        this->tree_().template extreme<Side_::right>();
+      if(node &&
+        off < Tree_algo_::node_offset(this->tree_(), *node) +
+          E()(node->value))
+      {
+        return this->make_iterator_(node);
+      }
+
+      return this->end();
+    }
+
+    [[nodiscard]] iterator lower_bound(offset_type const& off) const noexcept
+    {
+      return this->make_iterator_(
+        multi_index::lower_bound_<i>(this->tree_(), off));
+    }
+
+    [[nodiscard]] iterator upper_bound(offset_type const& off) const noexcept
+    {
+      return this->make_iterator_(
+        multi_index::upper_bound_<i>(this->tree_(), off));
+    }
+
+  private:
+    friend struct multi_index;
+
+    explicit View_(typename View_base_<i, is_const>::Container& c) noexcept :
+      View_base_<i, is_const>(c)
+    {}
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  static_assert(Is_same_<Value_, Remove_cv_ref_<Value_>>::value);
+  static_assert(Is_same_<Allocator_, Remove_cv_ref_<Allocator_>>::value);
+
+public:
+  template<size_type i>
+  using iterator = Iterator_<i, false>;
+
+  template<size_type i>
+  using const_iterator = Iterator_<i, true>;
+
+  template<size_type i>
+  using view = View_<i, false>;
+
+  template<size_type i>
+  using const_view = View_<i, true>;
+
+  multi_index() = default;
+
+  explicit multi_index(allocator_type const& alloc) :
+    trees_and_alloc_(alloc)
+  {}
+
+  multi_index(multi_index&& x) noexcept :
+    trees_and_alloc_(static_cast<Node_allocator_&&>(x.trees_and_alloc_))
+  {
+    swap_trees_(x);
+  }
+
+  multi_index(multi_index const&) = delete;
+
+  ~multi_index()
+  {
+    clear();
+  }
+
+  multi_index& operator =(multi_index&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      swap_trees_(x);
+      if constexpr(
+        Node_allocator_traits_::propagate_on_container_move_assignment::value)
+      {
+        trees_and_alloc_.allocator() =
+          static_cast<Node_allocator_&&>(x.trees_and_alloc_.allocator());
+      }
+    }
+
+    return *this;
+  }
+
+  multi_index& operator =(multi_index const&) = delete;
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(trees_and_alloc_.allocator());
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_<0u>().empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_<0u>().size();
+  }
+
+  template<size_type i>
+  [[nodiscard]] view<i> get() noexcept
+  {
+    return view<i>(*this);
+  }
+
+  template<size_type i>
+  [[nodiscard]] const_view<i> get() const noexcept
+  {
+    return const_view<i>(*this);
+  }
+
+  // Converts an iterator of view i into the iterator of view j pointing to
+  // the same element.
+  template<size_type j, size_type i, bool is_const>
+  [[nodiscard]] Iterator_<j, is_const> project(
+    Iterator_<i, is_const> const& it) const noexcept
+  {
+    return Iterator_<j, is_const>(::std::addressof(tree_<j>()), it.node_);
+  }
+
+  template<class... Args>
+  iterator<0u> emplace(Args&&... args)
+  {
+    Unique_node_ node(trees_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    link_all_<0u>(node_ptr);
+    node.release();
+    return iterator<0u>(::std::addressof(tree_<0u>()), node_ptr);
+  }
+
+  iterator<0u> insert(value_type&& val)
+  {
+    return emplace(static_cast<value_type&&>(val));
+  }
+
+  iterator<0u> insert(value_type const& val)
+  {
+    return emplace(val);
+  }
+
+  // Erases the element from every view and returns the next element in
+  // view i.
+  template<size_type i, bool is_const>
+  iterator<i> erase(Iterator_<i, is_const> const& pos) noexcept
+  {
+    Node_* const node = pos.node_;
+    TREEXX_ASSERT(::std::addressof(tree_<i>()) == pos.tree_);
+    TREEXX_ASSERT(node);
+
+    Node_* const next = Tree_algo_::next_node(tree_<i>(), *node);
+    unlink_all_except_<view_count_, 0u>(node);
+    destroy_node_(node);
+    return iterator<i>(::std::addressof(tree_<i>()), next);
+  }
+
+  // Applies `fun` to the element and restores every view: ordered views are
+  // re-sorted and offset views are re-laid out. If `fun`, a key or an extent
+  // throws, the element is erased and the exception is rethrown.
+  template<size_type i, bool is_const, class Fun>
+  void modify(Iterator_<i, is_const> const& pos, Fun&& fun)
+  {
+    Node_* const node = pos.node_;
+    TREEXX_ASSERT(::std::addressof(tree_<i>()) == pos.tree_);
+    TREEXX_ASSERT(node);
+
+    try
+    {
+      static_cast<Fun&&>(fun)(node->value);
+    }
+    catch(...)
+    {
+      unlink_all_except_<view_count_, 0u>(node);
+      destroy_node_(node);
+      throw;
+    }
+
+    relink_<0u>(node);
+  }
+
+  void clear() noexcept
+  {
+    ::treexx::bin::Tree_algo::clear(
+      tree_<0u>(),
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    reset_trees_<0u>();
+  }
+
+  void swap(multi_index& x) noexcept
+  {
+    swap_trees_(x);
+    if constexpr(Node_allocator_traits_::propagate_on_container_swap::value)
+    {
+      using ::std::swap;
+      swap(trees_and_alloc_.allocator(), x.trees_and_alloc_.allocator());
+    }
+  }
+
+  friend void swap(multi_index& x, multi_index& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  struct Unique_node_
+  {
+    using Ptr = typename Node_allocator_traits_::pointer;
+
+    explicit Unique_node_(Node_allocator_& alloc) :
+      alloc_(::std::addressof(alloc)),
+      ptr_(Node_allocator_traits_::allocate(alloc, 1u)),
+      constructed(false)
+    {}
+
+    Unique_node_(Unique_node_&&) = delete;
+    Unique_node_(Unique_node_ const&) = delete;
+
+    ~Unique_node_()
+    {
+      if(alloc_ && ptr_)
+      {
+        if(constructed)
+        {
+          Node_allocator_traits_::destroy(*alloc_, ptr_);
+        }
+
+        Node_allocator_traits_::deallocate(*alloc_, ptr_, 1u);
+      }
+    }
+
+    Unique_node_& operator =(Unique_node_&&) = delete;
+    Unique_node_& operator =(Unique_node_ const&) = delete;
+
+    [[nodiscard]] Ptr const& get() const noexcept
+    {
+      return ptr_;
+    }
+
+    void release() noexcept
+    {
+      alloc_ = nullptr;
+    }
+
+    template<class... Args>
+    void construct(Args&&... args)
+    {
+      TREEXX_ASSERT(alloc_);
+      TREEXX_ASSERT(!constructed);
+      Node_allocator_traits_::construct(
+        *alloc_, ptr_, static_cast<Args&&>(args)...);
+      constructed = true;
+    }
+
+  private:
+    Node_allocator_* alloc_;
+    Ptr ptr_;
+    bool constructed;
+  };
+
+  struct Allocator_base_ : Node_allocator_
+  {
+    Allocator_base_() = default;
+
+    template<class Alloc>
+    explicit Allocator_base_(Alloc&& alloc) :
+      Node_allocator_(static_cast<Alloc&&>(alloc))
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    [[nodiscard]] Node_allocator_ const& allocator() const noexcept
+    {
+      return *this;
+    }
+  };
+
+  struct Trees_and_alloc_ : Allocator_base_
+  {
+    using Allocator_base_::Allocator_base_;
+
+    Trees_ trees;
+  };
+
+  template<Size_ i>
+  [[nodiscard]] Tree_<i>& tree_() noexcept
+  {
+    return ::std::get<i>(trees_and_alloc_.trees);
+  }
+
+  template<Size_ i>
+  [[nodiscard]] Tree_<i> const& tree_() const noexcept
+  {
+    return ::std::get<i>(trees_and_alloc_.trees);
+  }
+
+  template<Size_ i, class Key>
+  [[nodiscard]] static Node_* lower_bound_(Tree_<i> const& tree, Key const& key)
+  {
+    using W = View_type_<i>;
+    if constexpr(Is_ordered_<W>::value)
+    {
+      using K = typename W::key_of;
+      using C = typename W::key_compare;
+      return Tree_algo_::lower_bound(
+        tree,
+        [&key](Node_ const& n) -> Compare_result_
+        {
+          return C()(K()(n.value), key) ?
+            Compare_result_::less : Compare_result_::greater;
+        });
+    }
+    else
+    {
+      return Tree_algo_::lower_bound<false, false, true>(
+        tree,
+        [&key](Offset_<i> const& offset) -> Compare_result_
+        {
+          return offset < key ?
+            Compare_result_::less : Compare_result_::greater;
+        });
+    }
+  }
+
+  template<Size_ i, class Key>
+  [[nodiscard]] static Node_* upper_bound_(Tree_<i> const& tree, Key const& key)
+  {
+    using W = View_type_<i>;
+    if constexpr(Is_ordered_<W>::value)
+    {
+      using K = typename W::key_of;
+      using C = typename W::key_compare;
+      return Tree_algo_::lower_bound(
+        tree,
+        [&key](Node_ const& n) -> Compare_result_
+        {
+          return C()(key, K()(n.value)) ?
+            Compare_result_::greater : Compare_result_::less;
+        });
+    }
+    else
+    {
+      return Tree_algo_::lower_bound<false, false, true>(
+        tree,
+        [&key](Offset_<i> const& offset) -> Compare_result_
+        {
+          return key < offset ?
+            Compare_result_::greater : Compare_result_::less;
+        });
+    }
+  }
+
+  template<Size_ i>
+  void link_(Node_* const node)
+  {
+    using W = View_type_<i>;
+    Tree_<i>& tree = tree_<i>();
+    if constexpr(Is_ordered_<W>::value)
+    {
+      using K = typename W::key_of;
+      Node_* const spot = upper_bound_<i>(tree, K()(node->value));
+      Tree_algo_::insert(tree, spot, node);
+    }
+    else if constexpr(Is_offset_<W>::value)
+    {
+      using E = typename W::extent_of;
+      Node_* const back = tree.template extreme<Side_::right>();
+      if(back)
+      {
+        Tree_algo_::push_back(tree, node, E()(back->value));
+      }
+      else
+      {
+        Tree_algo_::push_back(
+          tree, node, Tree_<i>::template make_offset<0u>());
+      }
+    }
+    else
+    {
+      Tree_algo_::push_back(tree, node);
+    }
+
+    tree.increment_size();
+  }
+
+  template<Size_ i>
+  void unlink_(Node_* const node) noexcept
+  {
+    Tree_<i>& tree = tree_<i>();
+    if constexpr(Is_offset_<View_type_<i>>::value)
+    {
+      Tree_algo_::erase_and_shift(tree, node);
+    }
+    else
+    {
+      Tree_algo_::erase(tree, node);
+    }
+
+    tree.decrement_size();
+  }
+
+  template<Size_ i>
+  void link_all_(Node_* const node)
+  {
+    if constexpr(i < view_count_)
+    {
+      link_<i>(node);
+      try
+      {
+        link_all_<i + 1u>(node);
+      }
+      catch(...)
+      {
+        unlink_<i>(node);
+        throw;
+      }
+    }
+  }
+
+  template<Size_ skip, Size_ i>
+  void unlink_all_except_(Node_* const node) noexcept
+  {
+    if constexpr(i < view_count_)
+    {
+      if constexpr(skip != i)
+      {
+        unlink_<i>(node);
+      }
+
+      unlink_all_except_<skip, i + 1u>(node);
+    }
+  }
+
+  template<Size_ i>
+  [[nodiscard]] bool in_order_(Node_* const node) const
+  {
+    using W = View_type_<i>;
+    using K = typename W::key_of;
+    using C = typename W::key_compare;
+    Tree_<i> const& tree = tree_<i>();
+    Node_* const prev = Tree_algo_::previous_node(tree, *node);
+    Node_* const next = Tree_algo_::next_node(tree, *node);
+    auto const& key = K()(node->value);
+    return
+      (!prev || !C()(key, K()(prev->value))) &&
+      (!next || !C()(K()(next->value), key));
+  }
+
+  template<Size_ i>
+  void relayout_(Node_* const node)
+  {
+    using E = typename View_type_<i>::extent_of;
+    Tree_<i>& tree = tree_<i>();
+    Node_* const next = Tree_algo_::next_node(tree, *node);
+    if(next)
+    {
+      Offset_<i> const old_extent(
+        Tree_algo_::node_offset(tree, *next) -
+        Tree_algo_::node_offset(tree, *node));
+      Offset_<i> const new_extent(E()(node->value));
+      if(old_extent < new_extent)
+      {
+        Tree_algo_::shift_suffix<Side_::right>(
+          tree, *next, new_extent - old_extent);
+      }
+      else if(new_extent < old_extent)
+      {
+        Tree_algo_::shift_suffix<Side_::left>(
+          tree, *next, old_extent - new_extent);
+      }
+    }
+  }
+
+  template<Size_ i>
+  void relink_(Node_* const node)
+  {
+    if constexpr(i < view_count_)
+    {
+      using W = View_type_<i>;
+      if constexpr(Is_ordered_<W>::value)
+      {
+        bool unlinked = false;
+        try
+        {
+          if(!in_order_<i>(node))
+          {
+            unlink_<i>(node);
+            unlinked = true;
+            link_<i>(node);
+            unlinked = false;
+          }
+        }
+        catch(...)
+        {
+          if(unlinked)
+          {
+            unlink_all_except_<i, 0u>(node);
+          }
+          else
+          {
+            unlink_all_except_<view_count_, 0u>(node);
+          }
+
+          destroy_node_(node);
+          throw;
+        }
+      }
+      else if constexpr(Is_offset_<W>::value)
+      {
+        try
+        {
+          relayout_<i>(node);
+        }
+        catch(...)
+        {
+          unlink_all_except_<view_count_, 0u>(node);
+          destroy_node_(node);
+          throw;
+        }
+      }
+
+      relink_<i + 1u>(node);
+    }
+  }
+
+  template<Size_ i>
+  void reset_trees_() noexcept
+  {
+    if constexpr(i < view_count_)
+    {
+      tree_<i>().reset();
+      reset_trees_<i + 1u>();
+    }
+  }
+
+  void swap_trees_(multi_index& x) noexcept
+  {
+    swap_trees_<0u>(x);
+  }
+
+  template<Size_ i>
+  void swap_trees_(multi_index& x) noexcept
+  {
+    if constexpr(i < view_count_)
+    {
+      tree_<i>().swap(x.template tree_<i>());
+      swap_trees_<i + 1u>(x);
+    }
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = trees_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Trees_and_alloc_ trees_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_MULTIINDEX_HH
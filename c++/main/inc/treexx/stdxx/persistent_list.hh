@@ -0,0 +1,1193 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_PERSISTENTLIST_HH
+#define TREEXX_STDXX_PERSISTENTLIST_HH
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/bin/side.hh>
+
+namespace treexx::stdxx
+{
+
+// Persistent sequence on a path-copying AVL tree. Nodes are reference counted
+// and shared between a list and its snapshots; a node is modified in place
+// only while it is reachable from one list alone, otherwise the O(log(n))
+// nodes on the modified path are cloned. snapshot() and copying are O(1), and
+// a snapshot may be read on another thread while the list keeps changing.
+//
+// Every node carries the size of its subtree, so elements are addressed by
+// index. When O is not void every element also carries an offset of type O,
+// stored the way the offset trees of Tree_algo store it: relative to the
+// nearest ancestor holding the node in its right subtree. Rotations then touch
+// the rotated nodes only, and shift_suffix() is a single path copy. Offsets
+// have to be kept non-decreasing for the offset lookups.
+//
+// A modification first takes ownership of every node it may change, which is
+// the only step that allocates or copies elements. If it throws, the list is
+// left unchanged.
+template<
+  class T,
+  class O = void,
+  class A = ::std::allocator<T>>
+struct persistent_list
+{
+  using value_type = T;
+  using offset_type = O;
+  using allocator_type = A;
+  using reference = value_type const&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+  using Height_ = unsigned char;
+
+  // An AVL tree of 2^64 nodes is not higher than this.
+  static Size_ constexpr max_height_ = 96u;
+
+  template<class U>
+  using Is_void_ = typename ::std::is_void<U>::type;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  static bool constexpr has_offset_ = !Is_void_<offset_type>::value;
+
+  struct None_
+  {};
+
+  using Offset_ = typename ::std::conditional<
+    has_offset_, offset_type, None_>::type;
+
+  template<bool = has_offset_, int = 0>
+  struct Node_base_
+  {};
+
+  template<int z>
+  struct Node_base_<true, z>
+  {
+    Offset_ offset;
+  };
+
+  struct Node_ : Node_base_<>
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      refs(static_cast<Size_>(1u)),
+      left(nullptr),
+      right(nullptr),
+      size(static_cast<Size_>(1u)),
+      height(static_cast<Height_>(1u)),
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    ::std::atomic<Size_> refs;
+    Node_* left;
+    Node_* right;
+    Size_ size;
+    Height_ height;
+    Value_ value;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+public:
+  // Forward iterator keeping the path from the root, as nodes have no parent
+  // links. It stays valid while the list it came from is not modified.
+  struct const_iterator
+  {
+    using iterator_category = ::std::forward_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = value_type const&;
+    using pointer = value_type const*;
+
+    const_iterator() noexcept :
+      depth_(0u)
+    {}
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(0u < depth_);
+      return path_[depth_ - 1u]->value;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(0u < depth_);
+      return ::std::addressof(path_[depth_ - 1u]->value);
+    }
+
+    // Absolute offset of the element.
+    template<bool e = has_offset_>
+    [[nodiscard]] auto offset() const noexcept ->
+      typename Enable_if_<e && has_offset_ == e, offset_type>::Type
+    {
+      TREEXX_ASSERT(0u < depth_);
+      return bases_[depth_ - 1u] + path_[depth_ - 1u]->offset;
+    }
+
+    const_iterator& operator ++() noexcept
+    {
+      TREEXX_ASSERT(0u < depth_);
+      Node_ const* node = path_[depth_ - 1u];
+      if(node->right)
+      {
+        push_<true>(node->right);
+        descend_left_();
+      }
+      else
+      {
+        for(;;)
+        {
+          --depth_;
+          if(1u > depth_ || path_[depth_ - 1u]->left == node)
+          {
+            break;
+          }
+
+          node = path_[depth_ - 1u];
+        }
+      }
+
+      return *this;
+    }
+
+    const_iterator operator ++(int) noexcept
+    {
+      const_iterator const x(*this);
+      ++*this;
+      return x;
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      const_iterator const& x,
+      const_iterator const& y) noexcept
+    {
+      return x.node_() == y.node_();
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      const_iterator const& x,
+      const_iterator const& y) noexcept
+    {
+      return x.node_() != y.node_();
+    }
+
+  private:
+    friend struct persistent_list;
+
+    template<bool = has_offset_, int = 0>
+    struct Bases_
+    {
+      void set(Size_, Offset_ const&) noexcept
+      {}
+
+      [[nodiscard]] Offset_ operator [](Size_) const noexcept
+      {
+        return Offset_();
+      }
+    };
+
+    template<int z>
+    struct Bases_<true, z>
+    {
+      void set(Size_ const i, Offset_ const& base) noexcept
+      {
+        values[i] = base;
+      }
+
+      [[nodiscard]] Offset_ const& operator [](Size_ const i) const noexcept
+      {
+        return values[i];
+      }
+
+      Offset_ values[max_height_];
+    };
+
+    [[nodiscard]] Node_ const* node_() const noexcept
+    {
+      return 0u < depth_ ? path_[depth_ - 1u] : nullptr;
+    }
+
+    // Pushes node, which is the right child of the top node when is_right.
+    template<bool is_right>
+    void push_(Node_ const* const node) noexcept
+    {
+      TREEXX_ASSERT(max_height_ > depth_);
+      if constexpr(has_offset_)
+      {
+        if(1u > depth_)
+        {
+          bases_.set(depth_, Offset_());
+        }
+        else if constexpr(is_right)
+        {
+          bases_.set(
+            depth_, bases_[depth_ - 1u] + path_[depth_ - 1u]->offset);
+        }
+        else
+        {
+          bases_.set(depth_, bases_[depth_ - 1u]);
+        }
+      }
+
+      path_[depth_++] = node;
+    }
+
+    void descend_left_() noexcept
+    {
+      for(Node_ const* n = path_[depth_ - 1u]->left; n; n = n->left)
+      {
+        push_<false>(n);
+      }
+    }
+
+    Node_ const* path_[max_height_];
+    Bases_<> bases_;
+    Size_ depth_;
+  };
+
+  using iterator = const_iterator;
+
+  persistent_list() = default;
+
+  explicit persistent_list(allocator_type const& alloc) :
+    root_and_alloc_(alloc)
+  {}
+
+  template<bool e = !has_offset_, class = typename Enable_if_<e>::Type>
+  persistent_list(
+    ::std::initializer_list<value_type> const values,
+    allocator_type const& alloc = allocator_type()) :
+    root_and_alloc_(alloc)
+  {
+    for(auto const& val: values)
+    {
+      push_back(val);
+    }
+  }
+
+  // O(1), the nodes are shared.
+  persistent_list(persistent_list const& x) noexcept :
+    root_and_alloc_(x.root_and_alloc_.allocator())
+  {
+    root_and_alloc_.root = acquire_(x.root_and_alloc_.root);
+  }
+
+  persistent_list(persistent_list&& x) noexcept :
+    root_and_alloc_(x.root_and_alloc_.allocator())
+  {
+    root_and_alloc_.root = x.root_and_alloc_.root;
+    x.root_and_alloc_.root = nullptr;
+  }
+
+  ~persistent_list()
+  {
+    release_(root_and_alloc_.root);
+  }
+
+  persistent_list& operator =(persistent_list const& x) noexcept
+  {
+    Node_* const root = acquire_(x.root_and_alloc_.root);
+    release_(root_and_alloc_.root);
+    root_and_alloc_.root = root;
+    return *this;
+  }
+
+  persistent_list& operator =(persistent_list&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      release_(root_and_alloc_.root);
+      root_and_alloc_.root = x.root_and_alloc_.root;
+      x.root_and_alloc_.root = nullptr;
+    }
+
+    return *this;
+  }
+
+  // Point-in-time copy sharing all the nodes with this list. Changing either
+  // of them later copies only the touched paths.
+  [[nodiscard]] persistent_list snapshot() const noexcept
+  {
+    return persistent_list(*this);
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(root_and_alloc_.allocator());
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return !root_and_alloc_.root;
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return size_(root_and_alloc_.root);
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept
+  {
+    const_iterator it;
+    if(root_and_alloc_.root)
+    {
+      it.template push_<false>(root_and_alloc_.root);
+      it.descend_left_();
+    }
+
+    return it;
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept
+  {
+    return const_iterator();
+  }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  [[nodiscard]] const_reference operator [](size_type const& idx) const noexcept
+  {
+    return at_(idx)->value;
+  }
+
+  [[nodiscard]] const_reference at(size_type const& idx) const
+  {
+    check_index_(idx);
+    return at_(idx)->value;
+  }
+
+  [[nodiscard]] const_reference front() const noexcept
+  {
+    return at_(0u)->value;
+  }
+
+  [[nodiscard]] const_reference back() const noexcept
+  {
+    return at_(size() - 1u)->value;
+  }
+
+  // Iterator to the element at index idx, or end().
+  [[nodiscard]] const_iterator find(size_type const& idx) const noexcept
+  {
+    const_iterator it;
+    Node_ const* node = root_and_alloc_.root;
+    if(!node)
+    {
+      return it;
+    }
+
+    it.template push_<false>(node);
+    Size_ i = idx;
+    for(;;)
+    {
+      Size_ const left_size = size_(node->left);
+      if(i < left_size)
+      {
+        node = node->left;
+        it.template push_<false>(node);
+      }
+      else if(left_size < i)
+      {
+        i -= left_size + 1u;
+        node = node->right;
+        if(!node)
+        {
+          return const_iterator();
+        }
+
+        it.template push_<true>(node);
+      }
+      else
+      {
+        return it;
+      }
+    }
+  }
+
+  template<bool e = has_offset_>
+  [[nodiscard]] auto offset(size_type const& idx) const noexcept ->
+    typename Enable_if_<e && has_offset_ == e, offset_type>::Type
+  {
+    TREEXX_ASSERT(size() > idx);
+    Node_ const* node = root_and_alloc_.root;
+    Offset_ base = Offset_();
+    Size_ i = idx;
+    for(;;)
+    {
+      Size_ const left_size = size_(node->left);
+      if(i < left_size)
+      {
+        node = node->left;
+      }
+      else if(left_size < i)
+      {
+        i -= left_size + 1u;
+        base += node->offset;
+        node = node->right;
+      }
+      else
+      {
+        return base + node->offset;
+      }
+    }
+  }
+
+  // Index of the first element whose offset is not less than off, or size().
+  template<bool e = has_offset_>
+  [[nodiscard]] auto lower_bound(Offset_ const& off) const noexcept ->
+    typename Enable_if_<e && has_offset_ == e, size_type>::Type
+  {
+    return bound_<false>(off);
+  }
+
+  // Index of the first element whose offset is greater than off, or size().
+  template<bool e = has_offset_>
+  [[nodiscard]] auto upper_bound(Offset_ const& off) const noexcept ->
+    typename Enable_if_<e && has_offset_ == e, size_type>::Type
+  {
+    return bound_<true>(off);
+  }
+
+  template<class... Args, bool e = !has_offset_>
+  auto emplace(size_type const& idx, Args&&... args) ->
+    typename Enable_if_<e && !has_offset_ == e>::Type
+  {
+    TREEXX_ASSERT(size() >= idx);
+    insert_node_(idx, create_node_(static_cast<Args&&>(args)...), Offset_());
+  }
+
+  // Inserts the element at index idx with absolute offset off.
+  template<class... Args, bool e = has_offset_>
+  auto emplace(size_type const& idx, Offset_ const& off, Args&&... args) ->
+    typename Enable_if_<e && has_offset_ == e>::Type
+  {
+    TREEXX_ASSERT(size() >= idx);
+    insert_node_(idx, create_node_(static_cast<Args&&>(args)...), off);
+  }
+
+  template<bool e = !has_offset_>
+  auto insert(size_type const& idx, value_type const& val) ->
+    typename Enable_if_<e && !has_offset_ == e>::Type
+  {
+    emplace(idx, val);
+  }
+
+  template<bool e = has_offset_>
+  auto insert(
+    size_type const& idx,
+    Offset_ const& off,
+    value_type const& val) ->
+      typename Enable_if_<e && has_offset_ == e>::Type
+  {
+    emplace(idx, off, val);
+  }
+
+  template<bool e = !has_offset_>
+  auto push_back(value_type const& val) ->
+    typename Enable_if_<e && !has_offset_ == e>::Type
+  {
+    emplace(size(), val);
+  }
+
+  template<bool e = !has_offset_>
+  auto push_front(value_type const& val) ->
+    typename Enable_if_<e && !has_offset_ == e>::Type
+  {
+    emplace(0u, val);
+  }
+
+  // Replaces the element at index idx, copying only the path to it.
+  void replace(size_type const& idx, value_type const& val)
+  {
+    TREEXX_ASSERT(size() > idx);
+    Node_* const node = create_node_(val);
+    try
+    {
+      own_path_<false>(idx);
+    }
+    catch(...)
+    {
+      release_(node);
+      throw;
+    }
+
+    Node_** link = ::std::addressof(root_and_alloc_.root);
+    Size_ i = idx;
+    for(;;)
+    {
+      Node_* const n = *link;
+      Size_ const left_size = size_(n->left);
+      if(i < left_size)
+      {
+        link = ::std::addressof(n->left);
+      }
+      else if(left_size < i)
+      {
+        i -= left_size + 1u;
+        link = ::std::addressof(n->right);
+      }
+      else
+      {
+        node->left = n->left;
+        node->right = n->right;
+        node->size = n->size;
+        node->height = n->height;
+        if constexpr(has_offset_)
+        {
+          node->offset = n->offset;
+        }
+
+        n->left = nullptr;
+        n->right = nullptr;
+        *link = node;
+        release_(n);
+        return;
+      }
+    }
+  }
+
+  void erase(size_type const& idx)
+  {
+    TREEXX_ASSERT(size() > idx);
+    own_for_erase_(idx);
+    Node_* erased = nullptr;
+    root_and_alloc_.root = erase_(root_and_alloc_.root, idx, erased);
+    TREEXX_ASSERT(erased);
+    release_(erased);
+  }
+
+  void pop_back()
+  {
+    erase(size() - 1u);
+  }
+
+  void pop_front()
+  {
+    erase(0u);
+  }
+
+  // Adds shift to the offsets of the elements starting at index idx.
+  template<bool e = has_offset_>
+  auto shift_suffix(size_type const& idx, Offset_ const& shift) ->
+    typename Enable_if_<e && has_offset_ == e>::Type
+  {
+    TREEXX_ASSERT(size() >= idx);
+    own_path_<true>(idx);
+
+    // A node in the suffix carries its right subtree along. Its left
+    // subtree is not relative to it and is handled on the way down.
+    Node_* node = root_and_alloc_.root;
+    Size_ i = idx;
+    while(node)
+    {
+      Size_ const left_size = size_(node->left);
+      if(i <= left_size)
+      {
+        node->offset += shift;
+        node = node->left;
+      }
+      else
+      {
+        i -= left_size + 1u;
+        node = node->right;
+      }
+    }
+  }
+
+  void clear() noexcept
+  {
+    release_(root_and_alloc_.root);
+    root_and_alloc_.root = nullptr;
+  }
+
+  void swap(persistent_list& x) noexcept
+  {
+    Node_* const root = root_and_alloc_.root;
+    root_and_alloc_.root = x.root_and_alloc_.root;
+    x.root_and_alloc_.root = root;
+  }
+
+  friend void swap(persistent_list& x, persistent_list& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  [[nodiscard]] static Size_ size_(Node_ const* const n) noexcept
+  {
+    return n ? n->size : static_cast<Size_>(0u);
+  }
+
+  [[nodiscard]] static Height_ height_(Node_ const* const n) noexcept
+  {
+    return n ? n->height : static_cast<Height_>(0u);
+  }
+
+  static void update_(Node_& n) noexcept
+  {
+    Height_ const l = height_(n.left);
+    Height_ const r = height_(n.right);
+    n.size = size_(n.left) + size_(n.right) + 1u;
+    n.height = static_cast<Height_>((l < r ? r : l) + 1u);
+  }
+
+  void check_index_(Size_ const idx) const
+  {
+    if(size() <= idx)
+    {
+      throw ::std::out_of_range("treexx::stdxx::persistent_list: index");
+    }
+  }
+
+  [[nodiscard]] static Node_* acquire_(Node_* const n) noexcept
+  {
+    if(n)
+    {
+      n->refs.fetch_add(static_cast<Size_>(1u), ::std::memory_order_relaxed);
+    }
+
+    return n;
+  }
+
+  void release_(Node_* const n) noexcept
+  {
+    if(n &&
+      static_cast<Size_>(1u) ==
+        n->refs.fetch_sub(static_cast<Size_>(1u), ::std::memory_order_acq_rel))
+    {
+      release_(n->left);
+      release_(n->right);
+      destroy_node_(n);
+    }
+  }
+
+  // Makes *link reference a node that is reachable through *link only,
+  // cloning the node if it is shared. Cloning bumps the reference counts of
+  // the children, so they are detected as shared in turn.
+  Node_* own_(Node_*& link)
+  {
+    Node_* const n = link;
+    TREEXX_ASSERT(n);
+    if(static_cast<Size_>(1u) == n->refs.load(::std::memory_order_acquire))
+    {
+      return n;
+    }
+
+    Node_* const copy = create_node_(n->value);
+    copy->left = acquire_(n->left);
+    copy->right = acquire_(n->right);
+    copy->size = n->size;
+    copy->height = n->height;
+    if constexpr(has_offset_)
+    {
+      copy->offset = n->offset;
+    }
+
+    link = copy;
+    release_(n);
+    return copy;
+  }
+
+  // Takes the ownership of the path to the element at index idx, or to the
+  // gap in front of it when to_gap.
+  template<bool to_gap>
+  void own_path_(Size_ idx)
+  {
+    Node_** link = ::std::addressof(root_and_alloc_.root);
+    while(*link)
+    {
+      Node_* const n = own_(*link);
+      Size_ const left_size = size_(n->left);
+      if(idx < left_size || (to_gap && idx == left_size))
+      {
+        link = ::std::addressof(n->left);
+      }
+      else if(left_size < idx)
+      {
+        idx -= left_size + 1u;
+        link = ::std::addressof(n->right);
+      }
+      else
+      {
+        return;
+      }
+    }
+  }
+
+  // Takes the ownership of the child that a rotation may promote, and of its
+  // children.
+  void own_off_path_(Node_*& link)
+  {
+    if(link)
+    {
+      Node_* const n = own_(link);
+      if(n->left)
+      {
+        own_(n->left);
+      }
+      if(n->right)
+      {
+        own_(n->right);
+      }
+    }
+  }
+
+  // Takes the ownership of everything erase_() is going to change: the path
+  // to the element and further to its successor, and whatever the rotations
+  // along that path may involve.
+  void own_for_erase_(Size_ idx)
+  {
+    Node_** link = ::std::addressof(root_and_alloc_.root);
+    Node_* n;
+    for(;;)
+    {
+      n = own_(*link);
+      Size_ const left_size = size_(n->left);
+      if(idx < left_size)
+      {
+        own_off_path_(n->right);
+        link = ::std::addressof(n->left);
+      }
+      else if(left_size < idx)
+      {
+        idx -= left_size + 1u;
+        own_off_path_(n->left);
+        link = ::std::addressof(n->right);
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    if(n->left && n->right)
+    {
+      own_off_path_(n->left);
+      link = ::std::addressof(n->right);
+      for(;;)
+      {
+        Node_* const m = own_(*link);
+        if(!m->left)
+        {
+          break;
+        }
+
+        own_off_path_(m->right);
+        link = ::std::addressof(m->left);
+      }
+    }
+    else if(n->right)
+    {
+      own_(n->right);
+    }
+  }
+
+  [[nodiscard]] Node_ const* at_(Size_ idx) const noexcept
+  {
+    TREEXX_ASSERT(size() > idx);
+    Node_ const* node = root_and_alloc_.root;
+    for(;;)
+    {
+      Size_ const left_size = size_(node->left);
+      if(idx < left_size)
+      {
+        node = node->left;
+      }
+      else if(left_size < idx)
+      {
+        idx -= left_size + 1u;
+        node = node->right;
+      }
+      else
+      {
+        return node;
+      }
+    }
+  }
+
+  template<bool upper>
+  [[nodiscard]] Size_ bound_(Offset_ const& off) const noexcept
+  {
+    Node_ const* node = root_and_alloc_.root;
+    Offset_ base = Offset_();
+    Size_ skipped = 0u;
+    Size_ result = size();
+    while(node)
+    {
+      Offset_ const offset = base + node->offset;
+      if(upper ? off < offset : !(offset < off))
+      {
+        result = skipped + size_(node->left);
+        node = node->left;
+      }
+      else
+      {
+        skipped += size_(node->left) + 1u;
+        base = offset;
+        node = node->right;
+      }
+    }
+
+    return result;
+  }
+
+  void insert_node_(Size_ const idx, Node_* const node, Offset_ const& off)
+  {
+    try
+    {
+      own_path_<true>(idx);
+    }
+    catch(...)
+    {
+      release_(node);
+      throw;
+    }
+
+    Node_* const root = root_and_alloc_.root;
+    if(root)
+    {
+      root_and_alloc_.root = insert_(root, idx, node, Offset_(), off);
+    }
+    else
+    {
+      if constexpr(has_offset_)
+      {
+        node->offset = off;
+      }
+
+      root_and_alloc_.root = node;
+    }
+  }
+
+  // The nodes passed to insert_(), erase_() and erase_min_() are owned.
+  [[nodiscard]] Node_* insert_(
+    Node_* const n,
+    Size_ const idx,
+    Node_* const node,
+    Offset_ const& base,
+    Offset_ const& off) noexcept
+  {
+    Size_ const left_size = size_(n->left);
+    if(idx <= left_size)
+    {
+      if(n->left)
+      {
+        n->left = insert_(n->left, idx, node, base, off);
+      }
+      else
+      {
+        set_offset_(*node, off, base);
+        n->left = node;
+      }
+    }
+    else
+    {
+      Offset_ base_right = Offset_();
+      if constexpr(has_offset_)
+      {
+        base_right = base + n->offset;
+      }
+
+      if(n->right)
+      {
+        n->right = insert_(
+          n->right, idx - left_size - 1u, node, base_right, off);
+      }
+      else
+      {
+        set_offset_(*node, off, base_right);
+        n->right = node;
+      }
+    }
+
+    return rebalance_(n);
+  }
+
+  // Unlinks the element at index idx from the subtree and hands it over in
+  // erased with its children detached.
+  [[nodiscard]] Node_* erase_(
+    Node_* const n,
+    Size_ const idx,
+    Node_*& erased) noexcept
+  {
+    Size_ const left_size = size_(n->left);
+    if(idx < left_size)
+    {
+      n->left = erase_(n->left, idx, erased);
+      return rebalance_(n);
+    }
+    if(left_size < idx)
+    {
+      n->right = erase_(n->right, idx - left_size - 1u, erased);
+      return rebalance_(n);
+    }
+
+    erased = n;
+    Node_* const left = n->left;
+    Node_* const right = n->right;
+    n->left = nullptr;
+    n->right = nullptr;
+    if(!right)
+    {
+      return left;
+    }
+    if(!left)
+    {
+      // The right child was relative to n.
+      if constexpr(has_offset_)
+      {
+        right->offset += n->offset;
+      }
+
+      return right;
+    }
+
+    // The leftmost node of the right subtree takes the place of n.
+    Node_* successor = nullptr;
+    Node_* const rest = erase_min_(right, successor);
+    TREEXX_ASSERT(successor);
+    if constexpr(has_offset_)
+    {
+      successor->offset += n->offset;
+    }
+
+    successor->left = left;
+    successor->right = rest;
+    return rebalance_(successor);
+  }
+
+  // Detaches the leftmost node of the subtree. The nodes on the left edge of
+  // the subtree become relative to it instead of the erased parent.
+  [[nodiscard]] Node_* erase_min_(Node_* const n, Node_*& min) noexcept
+  {
+    if(n->left)
+    {
+      n->left = erase_min_(n->left, min);
+      if constexpr(has_offset_)
+      {
+        n->offset -= min->offset;
+      }
+
+      return rebalance_(n);
+    }
+
+    min = n;
+    Node_* const right = n->right;
+    n->right = nullptr;
+    return right;
+  }
+
+  static void set_offset_(
+    Node_& node,
+    Offset_ const& off,
+    Offset_ const& base) noexcept
+  {
+    if constexpr(has_offset_)
+    {
+      node.offset = off - base;
+    }
+    else
+    {
+      static_cast<void>(node);
+      static_cast<void>(off);
+      static_cast<void>(base);
+    }
+  }
+
+  [[nodiscard]] Node_* rebalance_(Node_* const n)
+  {
+    Height_ const l = height_(n->left);
+    Height_ const r = height_(n->right);
+    if(r + 1u < l)
+    {
+      Node_* const left = own_(n->left);
+      if(height_(left->left) < height_(left->right))
+      {
+        n->left = rotate_<Side_::left>(left);
+      }
+
+      return rotate_<Side_::right>(n);
+    }
+    if(l + 1u < r)
+    {
+      Node_* const right = own_(n->right);
+      if(height_(right->right) < height_(right->left))
+      {
+        n->right = rotate_<Side_::right>(right);
+      }
+
+      return rotate_<Side_::left>(n);
+    }
+
+    update_(*n);
+    return n;
+  }
+
+  // Rotates the subtree rooted at n to the given side and returns its new
+  // root. Only n and the promoted child change their offsets.
+  template<Side_ side>
+  [[nodiscard]] Node_* rotate_(Node_* const n)
+  {
+    bool constexpr to_right = Side_::right == side;
+    Node_*& pivot_link = to_right ? n->left : n->right;
+    Node_* const pivot = own_(pivot_link);
+    Node_*& inner_link = to_right ? pivot->right : pivot->left;
+    if constexpr(has_offset_)
+    {
+      if constexpr(to_right)
+      {
+        n->offset -= pivot->offset;
+      }
+      else
+      {
+        pivot->offset += n->offset;
+      }
+    }
+
+    pivot_link = inner_link;
+    inner_link = n;
+    update_(*n);
+    update_(*pivot);
+    return pivot;
+  }
+
+  template<class... Args>
+  [[nodiscard]] Node_* create_node_(Args&&... args)
+  {
+    Node_allocator_& alloc = root_and_alloc_.allocator();
+    Node_* const node = Node_allocator_traits_::allocate(alloc, 1u);
+    try
+    {
+      Node_allocator_traits_::construct(
+        alloc, node, static_cast<Args&&>(args)...);
+    }
+    catch(...)
+    {
+      Node_allocator_traits_::deallocate(alloc, node, 1u);
+      throw;
+    }
+
+    return node;
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    Node_allocator_& alloc = root_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  struct Root_and_alloc_ : Node_allocator_
+  {
+    Root_and_alloc_() :
+      root(nullptr)
+    {}
+
+    template<class Alloc>
+    explicit Root_and_alloc_(Alloc const& alloc) :
+      Node_allocator_(alloc),
+      root(nullptr)
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    [[nodiscard]] Node_allocator_ const& allocator() const noexcept
+    {
+      return *this;
+    }
+
+    Node_* root;
+  };
+
+  Root_and_alloc_ root_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_PERSISTENTLIST_HH
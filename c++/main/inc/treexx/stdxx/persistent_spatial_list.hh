@@ -0,0 +1,302 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_PERSISTENTSPATIALLIST_HH
+#define TREEXX_STDXX_PERSISTENTSPATIALLIST_HH
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/stdxx/persistent_list.hh>
+#include <treexx/stdxx/spatial_list.hh>
+
+namespace treexx::stdxx
+{
+
+// spatial_list whose versions share structure. snapshot() is O(1); the next
+// change of either the list or the snapshot copies only the touched paths.
+// The reference counts are atomic, so a snapshot may be handed to another
+// thread and read there without locks while the list keeps changing. Elements
+// are immutable once inserted, as they may be shared.
+template<
+  class T,
+  class S = ::std::size_t,
+  class A = ::std::allocator<spatial_list_element<T, S>>,
+  bool indexed = false>
+struct persistent_spatial_list
+{
+  using data_type = T;
+  using allocator_type = A;
+  using spatial_size_type = S;
+  using is_indexed = ::std::integral_constant<bool, indexed>;
+  using value_type = spatial_list_element<data_type, spatial_size_type>;
+  using reference = value_type const&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Spatial_size_ = spatial_size_type;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using List_ = persistent_list<Value_, Spatial_size_, allocator_type>;
+  using List_iterator_ = typename List_::const_iterator;
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+public:
+  struct const_iterator
+  {
+    using iterator_category = ::std::forward_iterator_tag;
+    using value_type = Value_;
+    using difference_type = ::std::ptrdiff_t;
+    using reference = value_type const&;
+    using pointer = value_type const*;
+
+    const_iterator() = default;
+
+    [[nodiscard]] spatial_size_type offset() const noexcept
+    {
+      return it_.offset();
+    }
+
+    template<bool e = indexed>
+    [[nodiscard]] auto index() const noexcept ->
+      typename Enable_if_<e && indexed == e, size_type>::Type
+    {
+      return index_;
+    }
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      return *it_;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      return it_.operator ->();
+    }
+
+    const_iterator& operator ++() noexcept
+    {
+      ++it_;
+      ++index_;
+      return *this;
+    }
+
+    const_iterator operator ++(int) noexcept
+    {
+      const_iterator const x(*this);
+      ++*this;
+      return x;
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      const_iterator const& x,
+      const_iterator const& y) noexcept
+    {
+      return x.it_ == y.it_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      const_iterator const& x,
+      const_iterator const& y) noexcept
+    {
+      return x.it_ != y.it_;
+    }
+
+  private:
+    friend struct persistent_spatial_list;
+
+    const_iterator(List_iterator_ const& it, Size_ const idx) noexcept :
+      it_(it),
+      index_(idx)
+    {}
+
+    List_iterator_ it_;
+    Size_ index_;
+  };
+
+  using iterator = const_iterator;
+
+  persistent_spatial_list() = default;
+
+  explicit persistent_spatial_list(allocator_type const& alloc) :
+    list_(alloc)
+  {}
+
+  // Point-in-time copy sharing all the nodes with this list.
+  [[nodiscard]] persistent_spatial_list snapshot() const noexcept
+  {
+    return *this;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return list_.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return list_.size();
+  }
+
+  // Sum of the sizes of all the elements.
+  [[nodiscard]] spatial_size_type extent() const noexcept
+  {
+    return list_.empty() ?
+      static_cast<Spatial_size_>(0u) :
+      list_.offset(list_.size() - 1u) + list_.back().size();
+  }
+
+  template<class... Args>
+  reference emplace_back(Args&&... args)
+  {
+    list_.emplace(list_.size(), extent(), static_cast<Args&&>(args)...);
+    TREEXX_ASSERT(static_cast<Spatial_size_>(0u) < list_.back().size());
+    return list_.back();
+  }
+
+  template<class... Args>
+  reference emplace_front(Args&&... args)
+  {
+    Value_ val(static_cast<Args&&>(args)...);
+    Spatial_size_ const val_size = val.size();
+    TREEXX_ASSERT(static_cast<Spatial_size_>(0u) < val_size);
+
+    list_.shift_suffix(0u, val_size);
+    try
+    {
+      list_.emplace(
+        0u, static_cast<Spatial_size_>(0u), static_cast<Value_&&>(val));
+    }
+    catch(...)
+    {
+      // The shift has taken the ownership of the path, undoing it does not
+      // allocate.
+      list_.shift_suffix(0u, static_cast<Spatial_size_>(0u) - val_size);
+      throw;
+    }
+
+    return list_.front();
+  }
+
+  reference push_back(value_type&& val)
+  {
+    return emplace_back(static_cast<value_type&&>(val));
+  }
+
+  reference push_back(value_type const& val)
+  {
+    return emplace_back(val);
+  }
+
+  reference push_front(value_type&& val)
+  {
+    return emplace_front(static_cast<value_type&&>(val));
+  }
+
+  reference push_front(value_type const& val)
+  {
+    return emplace_front(val);
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept
+  {
+    return const_iterator(list_.begin(), 0u);
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept
+  {
+    return const_iterator(list_.end(), list_.size());
+  }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  template<bool e = indexed>
+  [[nodiscard]] auto find(size_type const& idx) const noexcept ->
+    typename Enable_if_<e && indexed == e, const_iterator>::Type
+  {
+    return const_iterator(list_.find(idx), idx);
+  }
+
+  // Iterator to the element covering offset off, or end().
+  [[nodiscard]] const_iterator find_offset(
+    spatial_size_type const& off) const noexcept
+  {
+    Size_ const idx = list_.upper_bound(off);
+    if(0u < idx)
+    {
+      const_iterator const it(list_.find(idx - 1u), idx - 1u);
+      if(off - it.offset() < it->size())
+      {
+        return it;
+      }
+    }
+
+    return end();
+  }
+
+  void clear() noexcept
+  {
+    list_.clear();
+  }
+
+  void swap(persistent_spatial_list& x) noexcept
+  {
+    list_.swap(x.list_);
+  }
+
+  friend void swap(
+    persistent_spatial_list& x,
+    persistent_spatial_list& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  List_ list_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_PERSISTENTSPATIALLIST_HH
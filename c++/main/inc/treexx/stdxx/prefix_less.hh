@@ -0,0 +1,71 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_PREFIXLESS_HH
+#define TREEXX_STDXX_PREFIXLESS_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace treexx::stdxx
+{
+
+// Less-than comparison of byte strings, such as std::string, that also
+// supplies an order-preserving prefix of every key: its first eight bytes as
+// a big-endian integer, padded with zeros. x < y implies
+// prefix(x) <= prefix(y), so keys with different prefixes are ordered by the
+// prefixes alone. indexed_multiset stores the prefix in every node when its
+// comparator has a prefix() member, and only compares the keys themselves
+// when the prefixes are equal.
+template<class T = ::std::string>
+struct prefix_less
+{
+  using prefix_type = ::std::uint64_t;
+
+  [[nodiscard]] bool operator ()(T const& x, T const& y) const
+  {
+    return x < y;
+  }
+
+  [[nodiscard]] prefix_type prefix(T const& x) const noexcept
+  {
+    static_assert(1u == sizeof(*x.data()));
+
+    ::std::size_t const size = x.size();
+    ::std::size_t const count = 8u < size ? 8u : size;
+    auto const* const data = x.data();
+    prefix_type prefix = static_cast<prefix_type>(0u);
+    for(::std::size_t i = 0u; count > i; ++i)
+    {
+      prefix |= static_cast<prefix_type>(
+        static_cast<unsigned char>(data[i])) << (56u - 8u * i);
+    }
+
+    return prefix;
+  }
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_PREFIXLESS_HH
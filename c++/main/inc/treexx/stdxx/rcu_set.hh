@@ -0,0 +1,953 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_RCUSET_HH
+#define TREEXX_STDXX_RCUSET_HH
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/avl_hook.hh>
+#include <treexx/stdxx/epoch_domain.hh>
+
+namespace treexx::stdxx
+{
+
+// Ordered set of unique values with one writer and any number of lock-free
+// readers registered in an epoch_domain.
+//
+// Every element is linked into two AVL trees through two hooks. Readers only
+// ever walk the published tree, so they run the plain Tree_algo lookups and
+// parent-linked iteration. The writer mutates the other tree, publishes it
+// with a release store and retires a marker in the domain. Once reclaim()
+// disposes of the marker, the readers of the tree that was just taken out of
+// service are gone: the elements erased from it are unlinked and freed, and
+// the next write replays the insertions on it.
+//
+// Writers never wait for readers. A write that finds the standby tree still
+// in use is held back, and the first later write that finds it free
+// publishes all the held writes at once. flush() and clear() are the only
+// members that block for a grace period.
+//
+// Writing members must be called from one thread at a time. The domain must
+// outlive the set.
+template<
+  class T,
+  class C = ::std::less<T>,
+  class A = ::std::allocator<T>>
+struct rcu_set
+{
+  using key_type = T;
+  using value_type = T;
+  using key_compare = C;
+  using value_compare = C;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+  using domain_type = epoch_domain;
+  using reader_type = typename domain_type::reader;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Compare_ = key_compare;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+
+  static Size_ constexpr cache_line_size_ = 64u;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  struct Node_
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    avl_hook<Node_> hooks[2];
+    Value_ value;
+  };
+
+  using Hook_ = avl_hook<Node_>;
+
+public:
+  // One of the two trees, linked through the hook with the index it was
+  // created with. It satisfies the Tree requirements of Tree_algo, so a read
+  // view can hand it to the algorithms directly.
+  struct alignas(cache_line_size_) tree_type
+  {
+    using Node = Node_;
+
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] Node_* parent(Node_ const& n) const noexcept
+    {
+      return hook_(n).parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* child(Node_ const& n) const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return hook_(n).left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return hook_(n).right_child;
+      }
+    }
+
+    [[nodiscard]] Balance_ balance(Node_ const& n) const noexcept
+    {
+      return hook_(n).balance;
+    }
+
+    [[nodiscard]] Side_ side(Node_ const& n) const noexcept
+    {
+      return hook_(n).side;
+    }
+
+    void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      hook_(n).parent = p;
+    }
+
+    template<Side_ side>
+    void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        hook_(n).left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        hook_(n).right_child = c;
+      }
+    }
+
+    void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      hook_(n).balance = b;
+    }
+
+    void set_side(Node_& n, Side_ const s) noexcept
+    {
+      hook_(n).side = s;
+    }
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return 1u > size_;
+    }
+
+  private:
+    friend struct rcu_set;
+
+    explicit tree_type(unsigned char const h) noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u)),
+      hook_index_(h)
+    {}
+
+    [[nodiscard]] Hook_& hook_(Node_& n) const noexcept
+    {
+      return n.hooks[hook_index_];
+    }
+
+    [[nodiscard]] Hook_ const& hook_(Node_ const& n) const noexcept
+    {
+      return n.hooks[hook_index_];
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    Node_* root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    Size_ size_;
+    unsigned char hook_index_;
+  };
+
+  struct const_iterator
+  {
+    using iterator_category = ::std::bidirectional_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = value_type const&;
+    using pointer = value_type const*;
+
+    const_iterator() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_->value;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return ::std::addressof(node_->value);
+    }
+
+    const_iterator& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    const_iterator operator ++(int) noexcept
+    {
+      const_iterator const x(*this);
+      ++*this;
+      return x;
+    }
+
+    const_iterator& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    const_iterator operator --(int) noexcept
+    {
+      const_iterator const x(*this);
+      --*this;
+      return x;
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      const_iterator const& x,
+      const_iterator const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      const_iterator const& x,
+      const_iterator const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+  private:
+    friend struct rcu_set;
+
+    const_iterator(tree_type const* const t, Node_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    tree_type const* tree_;
+    Node_* node_;
+  };
+
+  using iterator = const_iterator;
+  using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+  using reverse_iterator = const_reverse_iterator;
+
+  // Consistent read-only view of the set, pinned for the lifetime of the
+  // view. Iterators and references obtained through a view must not outlive
+  // it. A reader may hold at most one view at a time.
+  struct read_view
+  {
+    read_view(rcu_set const& set, reader_type& reader) noexcept :
+      guard_(reader),
+      set_(::std::addressof(set)),
+      tree_(::std::addressof(
+        set.trees_[set.active_.load(::std::memory_order_acquire)]))
+    {}
+
+    read_view(read_view&&) = delete;
+    read_view(read_view const&) = delete;
+    read_view& operator =(read_view&&) = delete;
+    read_view& operator =(read_view const&) = delete;
+
+    [[nodiscard]] tree_type const& tree() const noexcept
+    {
+      return *tree_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return tree_->empty();
+    }
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+      return tree_->size();
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept
+    {
+      return const_iterator(tree_, tree_->template extreme<Side_::left>());
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept
+    {
+      return const_iterator(tree_, nullptr);
+    }
+
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+    {
+      return const_reverse_iterator(end());
+    }
+
+    [[nodiscard]] const_reverse_iterator rend() const noexcept
+    {
+      return const_reverse_iterator(begin());
+    }
+
+    template<class K>
+    [[nodiscard]] const_iterator find(K const& key) const
+    {
+      return const_iterator(tree_, set_->find_(*tree_, key));
+    }
+
+    template<class K>
+    [[nodiscard]] bool contains(K const& key) const
+    {
+      return set_->find_(*tree_, key) ? true : false;
+    }
+
+    template<class K>
+    [[nodiscard]] const_iterator lower_bound(K const& key) const
+    {
+      return const_iterator(tree_, set_->lower_bound_(*tree_, key));
+    }
+
+    template<class K>
+    [[nodiscard]] const_iterator upper_bound(K const& key) const
+    {
+      return const_iterator(tree_, set_->upper_bound_(*tree_, key));
+    }
+
+  private:
+    domain_type::guard guard_;
+    rcu_set const* set_;
+    tree_type const* tree_;
+  };
+
+  explicit rcu_set(
+    domain_type& domain,
+    key_compare const& compare = key_compare(),
+    allocator_type const& alloc = allocator_type()) :
+    trees_{tree_type(0u), tree_type(1u)},
+    domain_(::std::addressof(domain)),
+    active_(0u),
+    compare_(compare),
+    allocator_(alloc),
+    standby_busy_(false)
+  {}
+
+  rcu_set(rcu_set&&) = delete;
+  rcu_set(rcu_set const&) = delete;
+
+  ~rcu_set()
+  {
+    if(standby_busy_)
+    {
+      domain_->synchronize();
+    }
+
+    destroy_all_();
+  }
+
+  rcu_set& operator =(rcu_set&&) = delete;
+  rcu_set& operator =(rcu_set const&) = delete;
+
+  [[nodiscard]] key_compare key_comp() const
+  {
+    return compare_;
+  }
+
+  [[nodiscard]] value_compare value_comp() const
+  {
+    return compare_;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(allocator_);
+  }
+
+  [[nodiscard]] domain_type& domain() const noexcept
+  {
+    return *domain_;
+  }
+
+  [[nodiscard]] read_view read(reader_type& reader) const noexcept
+  {
+    return read_view(*this, reader);
+  }
+
+  // Writer side. The size of the published tree, held writes excluded.
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return published_().size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return published_().empty();
+  }
+
+  // Writer side. The number of writes not published yet because readers
+  // still hold the standby tree.
+  [[nodiscard]] size_type backlog() const noexcept
+  {
+    return held_.size();
+  }
+
+  template<class... Args>
+  bool emplace(Args&&... args)
+  {
+    Node_* const node = create_node_(static_cast<Args&&>(args)...);
+    try
+    {
+      Compare_ const& compare = compare_;
+      Size_ i = held_lower_bound_(node->value);
+      bool erased = false;
+      for(;
+        held_.size() > i && !compare(node->value, held_[i].node->value);
+        ++i)
+      {
+        if(held_[i].insert)
+        {
+          destroy_node_(node);
+          return false;
+        }
+
+        erased = true;
+      }
+
+      if(!erased && find_(published_(), node->value))
+      {
+        destroy_node_(node);
+        return false;
+      }
+
+      held_.insert(held_.begin() + i, Pending_{node, true});
+    }
+    catch(...)
+    {
+      destroy_node_(node);
+      throw;
+    }
+
+    publish_held_();
+    return true;
+  }
+
+  bool insert(value_type&& val)
+  {
+    return emplace(static_cast<value_type&&>(val));
+  }
+
+  bool insert(value_type const& val)
+  {
+    return emplace(val);
+  }
+
+  template<class K>
+  size_type erase(K const& key)
+  {
+    Compare_ const& compare = compare_;
+    Size_ const i = held_lower_bound_(key);
+    for(Size_ j = i;
+      held_.size() > j && !compare(key, held_[j].node->value);
+      ++j)
+    {
+      if(held_[j].insert)
+      {
+        // Never published, so no reader can know the element.
+        Node_* const node = held_[j].node;
+        held_.erase(held_.begin() + j);
+        destroy_node_(node);
+        return static_cast<Size_>(1u);
+      }
+    }
+
+    if(held_.size() > i && !compare(key, held_[i].node->value))
+    {
+      return static_cast<Size_>(0u);
+    }
+
+    Node_* const node = find_(published_(), key);
+    if(!node)
+    {
+      return static_cast<Size_>(0u);
+    }
+
+    held_.insert(held_.begin() + i, Pending_{node, false});
+    publish_held_();
+    return static_cast<Size_>(1u);
+  }
+
+  void clear()
+  {
+    flush();
+    if(published_().empty())
+    {
+      return;
+    }
+
+    standby_().reset();
+    publish_();
+    domain_->synchronize();
+    destroy_tree_(standby_());
+  }
+
+  // Waits for the readers of the standby tree, publishes the held writes
+  // and brings both trees up to date, freeing the erased elements.
+  void flush()
+  {
+    for(;;)
+    {
+      if(standby_busy_)
+      {
+        domain_->synchronize();
+      }
+
+      catch_up_();
+      if(held_.empty())
+      {
+        break;
+      }
+
+      publish_held_();
+    }
+  }
+
+private:
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  struct Pending_
+  {
+    Node_* node;
+    bool insert;
+  };
+
+  static void dispose_marker_(void* const set, void*) noexcept
+  {
+    static_cast<rcu_set*>(set)->release_standby_();
+  }
+
+  [[nodiscard]] tree_type const& published_() const noexcept
+  {
+    return trees_[active_.load(::std::memory_order_relaxed)];
+  }
+
+  [[nodiscard]] tree_type& standby_() noexcept
+  {
+    return trees_[1u - active_.load(::std::memory_order_relaxed)];
+  }
+
+  void publish_() noexcept
+  {
+    active_.store(
+      1u - active_.load(::std::memory_order_relaxed),
+      ::std::memory_order_release);
+  }
+
+  // Called by the domain once no reader can be in the standby tree.
+  void release_standby_() noexcept
+  {
+    tree_type& tree = standby_();
+    for(Node_* const node: erased_)
+    {
+      Tree_algo_::erase(tree, node);
+      --tree.size_;
+      destroy_node_(node);
+    }
+
+    erased_.clear();
+    standby_busy_ = false;
+  }
+
+  // Replays the insertions of the last publication on the standby tree.
+  void catch_up_()
+  {
+    TREEXX_ASSERT(!standby_busy_);
+    tree_type& tree = standby_();
+    while(!replayed_.empty())
+    {
+      bool const linked = link_(tree, replayed_.back());
+      TREEXX_ASSERT(linked);
+      static_cast<void>(linked);
+      replayed_.pop_back();
+    }
+  }
+
+  // Publishes the held writes unless the standby tree is still in use.
+  // Never blocks.
+  void publish_held_()
+  {
+    if(standby_busy_)
+    {
+      domain_->reclaim();
+      if(standby_busy_)
+      {
+        return;
+      }
+    }
+
+    catch_up_();
+    if(held_.empty())
+    {
+      return;
+    }
+
+    replayed_.reserve(held_.size());
+    erased_.reserve(held_.size());
+    domain_->retire(this, nullptr, &rcu_set::dispose_marker_);
+    standby_busy_ = true;
+
+    tree_type& tree = standby_();
+    for(Pending_ const& p: held_)
+    {
+      if(p.insert)
+      {
+        bool const linked = link_(tree, p.node);
+        TREEXX_ASSERT(linked);
+        static_cast<void>(linked);
+        replayed_.push_back(p.node);
+      }
+      else
+      {
+        Tree_algo_::erase(tree, p.node);
+        --tree.size_;
+        erased_.push_back(p.node);
+      }
+    }
+
+    held_.clear();
+    publish_();
+  }
+
+  template<class K>
+  [[nodiscard]] Size_ held_lower_bound_(K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    Size_ first = 0u;
+    Size_ count = held_.size();
+    while(0u < count)
+    {
+      Size_ const half = count / 2u;
+      if(compare(held_[first + half].node->value, key))
+      {
+        first += half + 1u;
+        count -= half + 1u;
+      }
+      else
+      {
+        count = half;
+      }
+    }
+
+    return first;
+  }
+
+  bool link_(tree_type& tree, Node_* const node)
+  {
+    Compare_ const& compare = compare_;
+    Node_* const found = Tree_algo_::try_insert(
+      tree,
+      [&compare, node](Node_ const& n) -> Compare_result_
+      {
+        if(compare(node->value, n.value))
+        {
+          return Compare_result_::greater;
+        }
+        if(compare(n.value, node->value))
+        {
+          return Compare_result_::less;
+        }
+        return Compare_result_::equal;
+      },
+      [&tree, node](Node_* const parent, Side_ const side) noexcept -> Node_*
+      {
+        tree.set_parent(*node, parent);
+        tree.set_side(*node, side);
+        return node;
+      });
+
+    if(node != found)
+    {
+      return false;
+    }
+
+    ++tree.size_;
+    return true;
+  }
+
+  template<class K>
+  [[nodiscard]] Node_* find_(tree_type const& tree, K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::binary_search(
+      tree,
+      [&compare, &key](Node_ const& n) -> Compare_result_
+      {
+        if(compare(n.value, key))
+        {
+          return Compare_result_::less;
+        }
+        if(compare(key, n.value))
+        {
+          return Compare_result_::greater;
+        }
+        return Compare_result_::equal;
+      });
+  }
+
+  template<class K>
+  [[nodiscard]] Node_* lower_bound_(tree_type const& tree, K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::lower_bound(
+      tree,
+      [&compare, &key](Node_ const& n) -> Compare_result_
+      {
+        return compare(n.value, key) ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+  }
+
+  template<class K>
+  [[nodiscard]] Node_* upper_bound_(tree_type const& tree, K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::lower_bound(
+      tree,
+      [&compare, &key](Node_ const& n) -> Compare_result_
+      {
+        return compare(key, n.value) ?
+          Compare_result_::greater : Compare_result_::less;
+      });
+  }
+
+  template<class... Args>
+  [[nodiscard]] Node_* create_node_(Args&&... args)
+  {
+    Node_allocator_& alloc = allocator_;
+    Node_* const node = Node_allocator_traits_::allocate(alloc, 1u);
+    try
+    {
+      Node_allocator_traits_::construct(
+        alloc, node, static_cast<Args&&>(args)...);
+    }
+    catch(...)
+    {
+      Node_allocator_traits_::deallocate(alloc, node, 1u);
+      throw;
+    }
+
+    return node;
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = allocator_;
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  void destroy_tree_(tree_type& tree) noexcept
+  {
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
+  void destroy_all_() noexcept
+  {
+    // Held insertions are in neither tree, everything else is in the
+    // published one.
+    TREEXX_ASSERT(!standby_busy_);
+    for(Pending_ const& p: held_)
+    {
+      if(p.insert)
+      {
+        destroy_node_(p.node);
+      }
+    }
+
+    held_.clear();
+    replayed_.clear();
+    standby_().reset();
+    destroy_tree_(trees_[active_.load(::std::memory_order_relaxed)]);
+  }
+
+  tree_type trees_[2];
+  domain_type* domain_;
+  ::std::atomic<unsigned> active_;
+  Compare_ compare_;
+  Node_allocator_ allocator_;
+  // Writes not published yet, ordered by key. An erasure precedes an
+  // insertion of the same key.
+  ::std::vector<Pending_> held_;
+  // Published insertions still missing from the standby tree.
+  ::std::vector<Node_*> replayed_;
+  // Published erasures still linked into the standby tree.
+  ::std::vector<Node_*> erased_;
+  bool standby_busy_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_RCUSET_HH
@@ -0,0 +1,729 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_SEQLOCKSET_HH
+#define TREEXX_STDXX_SEQLOCKSET_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace treexx::stdxx
+{
+
+// Ordered set of unique values with writers serialized by a mutex and
+// readers that neither lock nor write shared memory.
+//
+// Every write makes a sequence counter odd before it touches the tree and
+// even again when it is done. A reader runs its lookup with the plain
+// Tree_algo searches and retries it if the counter was odd or has moved.
+// Nodes are never handed back to the allocator while the set lives; erased
+// ones are kept on a free list and reused, so a lookup racing a write only
+// ever reads nodes of this set. The fields a lookup reads are atomics
+// accessed with relaxed ordering, and a lookup gives up after following
+// more links than any balanced tree of this size has, so a torn read always
+// ends and is thrown away.
+//
+// This suits small sets read far more often than written: readers retry
+// for as long as writes keep coming, and the memory of erased elements is
+// only released with the set. T must be trivially copyable and default
+// constructible; readers copy values out word by word.
+template<
+  class T,
+  class C = ::std::less<T>,
+  class A = ::std::allocator<T>>
+struct seqlock_set
+{
+  using key_type = T;
+  using value_type = T;
+  using key_compare = C;
+  using value_compare = C;
+  using allocator_type = A;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Compare_ = key_compare;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Sequence_ = ::std::uint64_t;
+  using Word_ = ::std::uintptr_t;
+  using Mutex_ = ::std::mutex;
+  using Lock_ = ::std::lock_guard<Mutex_>;
+
+  static_assert(::std::is_trivially_copyable<Value_>::value);
+  static_assert(::std::is_default_constructible<Value_>::value);
+
+  static Size_ constexpr word_count_ =
+    (sizeof(Value_) + sizeof(Word_) - 1u) / sizeof(Word_);
+
+  // Enough for any AVL tree that fits in memory, twice over.
+  static unsigned constexpr max_links_ = 192u;
+
+  template<class U>
+  static U load_(::std::atomic<U> const& x) noexcept
+  {
+    return x.load(::std::memory_order_relaxed);
+  }
+
+  template<class U>
+  static void store_(::std::atomic<U>& x, U const& u) noexcept
+  {
+    x.store(u, ::std::memory_order_relaxed);
+  }
+
+  struct Value_words_
+  {
+    [[nodiscard]] Value_ load() const noexcept
+    {
+      Word_ words_copy[word_count_];
+      for(Size_ i = 0u; word_count_ > i; ++i)
+      {
+        words_copy[i] = load_(words[i]);
+      }
+
+      Value_ val;
+      ::std::memcpy(::std::addressof(val), words_copy, sizeof(Value_));
+      return val;
+    }
+
+    void store(Value_ const& val) noexcept
+    {
+      Word_ words_copy[word_count_] = {};
+      ::std::memcpy(words_copy, ::std::addressof(val), sizeof(Value_));
+      for(Size_ i = 0u; word_count_ > i; ++i)
+      {
+        store_(words[i], words_copy[i]);
+      }
+    }
+
+    ::std::atomic<Word_> words[word_count_];
+  };
+
+  struct Node_
+  {
+    Node_() noexcept :
+      parent(nullptr),
+      left_child(nullptr),
+      right_child(nullptr),
+      index(static_cast<Size_>(0u)),
+      balance(Balance_::poised),
+      side(Side_::left),
+      next_free(nullptr)
+    {}
+
+    ::std::atomic<Node_*> parent;
+    ::std::atomic<Node_*> left_child;
+    ::std::atomic<Node_*> right_child;
+    ::std::atomic<Size_> index;
+    ::std::atomic<Balance_> balance;
+    ::std::atomic<Side_> side;
+    Value_words_ value;
+    Node_* next_free;
+  };
+
+  struct Tree_static_
+  {
+    using Index = Size_;
+
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node_* parent(Node_ const& n) noexcept
+    {
+      return load_(n.parent);
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node_* child(Node_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return load_(n.left_child);
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return load_(n.right_child);
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node_ const& n) noexcept
+    {
+      return load_(n.balance);
+    }
+
+    [[nodiscard]] static Side_ side(Node_ const& n) noexcept
+    {
+      return load_(n.side);
+    }
+
+    [[nodiscard]] static Index index(Node_ const& n) noexcept
+    {
+      return load_(n.index);
+    }
+
+    static void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      store_(n.parent, p);
+    }
+
+    template<Side_ side>
+    static void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        store_(n.left_child, c);
+      }
+      else if constexpr(Side_::right == side)
+      {
+        store_(n.right_child, c);
+      }
+    }
+
+    static void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      store_(n.balance, b);
+    }
+
+    static void set_side(Node_& n, Side_ const s) noexcept
+    {
+      store_(n.side, s);
+    }
+
+    static void increment_index(Node_& n) noexcept
+    {
+      store_(n.index, load_(n.index) + 1u);
+    }
+
+    static void decrement_index(Node_& n) noexcept
+    {
+      store_(n.index, load_(n.index) - 1u);
+    }
+
+    static void add_to_index(Node_& n, Index const& i) noexcept
+    {
+      store_(n.index, load_(n.index) + i);
+    }
+
+    static void subtract_from_index(Node_& n, Index const& i) noexcept
+    {
+      store_(n.index, load_(n.index) - i);
+    }
+
+    static void set_index(Node_& n, Index const& i) noexcept
+    {
+      store_(n.index, i);
+    }
+
+    template<unsigned i>
+    static void set_index(Node_& n) noexcept
+    {
+      store_(n.index, static_cast<Index>(i));
+    }
+
+    template<unsigned i>
+    [[nodiscard]] static Index make_index() noexcept
+    {
+      return static_cast<Index>(i);
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return load_(root_);
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      store_(root_, r);
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return load_(size_);
+    }
+
+    void set_size(Size_ const s) noexcept
+    {
+      store_(size_, s);
+    }
+
+    void reset() noexcept
+    {
+      set_root(nullptr);
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      set_size(static_cast<Size_>(0u));
+    }
+
+    ::std::atomic<Node_*> root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    ::std::atomic<Size_> size_;
+  };
+
+  // The view of the tree a reader searches. It stops handing out links once
+  // more have been followed than a consistent tree could need.
+  struct Reader_tree_ : Tree_static_
+  {
+    explicit Reader_tree_(Tree_ const& t) noexcept :
+      tree_(::std::addressof(t)),
+      links_left_(max_links_)
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return follow_(tree_->root());
+    }
+
+    [[nodiscard]] Node_* parent(Node_ const& n) const noexcept
+    {
+      return follow_(Tree_static_::parent(n));
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* child(Node_ const& n) const noexcept
+    {
+      return follow_(Tree_static_::template child<side>(n));
+    }
+
+    [[nodiscard]] bool exhausted() const noexcept
+    {
+      return 0u == links_left_;
+    }
+
+  private:
+    [[nodiscard]] Node_* follow_(Node_* const n) const noexcept
+    {
+      if(0u == links_left_)
+      {
+        return nullptr;
+      }
+
+      --links_left_;
+      return n;
+    }
+
+    Tree_ const* tree_;
+    mutable unsigned links_left_;
+  };
+
+  // Brackets a write with the two increments of the sequence counter.
+  struct Write_section_
+  {
+    explicit Write_section_(seqlock_set& s) noexcept :
+      set_(s)
+    {
+      Sequence_ const seq = load_(set_.sequence_);
+      TREEXX_ASSERT(0u == (seq & 1u));
+      store_(set_.sequence_, static_cast<Sequence_>(seq + 1u));
+      ::std::atomic_thread_fence(::std::memory_order_release);
+    }
+
+    Write_section_(Write_section_&&) = delete;
+    Write_section_(Write_section_ const&) = delete;
+
+    ~Write_section_()
+    {
+      set_.sequence_.store(
+        load_(set_.sequence_) + 1u, ::std::memory_order_release);
+    }
+
+    Write_section_& operator =(Write_section_&&) = delete;
+    Write_section_& operator =(Write_section_ const&) = delete;
+
+  private:
+    seqlock_set& set_;
+  };
+
+public:
+  explicit seqlock_set(
+    key_compare const& compare = key_compare(),
+    allocator_type const& alloc = allocator_type()) :
+    sequence_(static_cast<Sequence_>(0u)),
+    free_(nullptr),
+    capacity_(static_cast<Size_>(0u)),
+    compare_(compare),
+    allocator_(alloc)
+  {}
+
+  seqlock_set(seqlock_set&&) = delete;
+  seqlock_set(seqlock_set const&) = delete;
+
+  ~seqlock_set()
+  {
+    ::treexx::bin::Tree_algo::clear(
+      tree_,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+
+    while(free_)
+    {
+      Node_* const node = free_;
+      free_ = node->next_free;
+      destroy_node_(node);
+    }
+  }
+
+  seqlock_set& operator =(seqlock_set&&) = delete;
+  seqlock_set& operator =(seqlock_set const&) = delete;
+
+  [[nodiscard]] key_compare key_comp() const
+  {
+    return compare_;
+  }
+
+  [[nodiscard]] value_compare value_comp() const
+  {
+    return compare_;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(allocator_);
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_.size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return 1u > tree_.size();
+  }
+
+  // Number of nodes owned by the set, linked or free.
+  [[nodiscard]] size_type capacity() const
+  {
+    Lock_ const lock(mutex_);
+    return capacity_;
+  }
+
+  // Reader side, lock-free.
+
+  template<class K>
+  [[nodiscard]] bool contains(K const& key) const
+  {
+    return read_(
+      [this, &key](Reader_tree_ const& tree) -> bool
+      {
+        return find_(tree, key) ? true : false;
+      });
+  }
+
+  template<class K>
+  [[nodiscard]] ::std::optional<value_type> find(K const& key) const
+  {
+    return read_(
+      [this, &key](Reader_tree_ const& tree) -> ::std::optional<Value_>
+      {
+        Node_* const node = find_(tree, key);
+        if(node)
+        {
+          return node->value.load();
+        }
+
+        return ::std::nullopt;
+      });
+  }
+
+  [[nodiscard]] ::std::optional<value_type> at_index(
+    size_type const& idx) const
+  {
+    return read_(
+      [&idx](Reader_tree_ const& tree) -> ::std::optional<Value_>
+      {
+        Node_* const node = Tree_algo_::at_index(tree, idx);
+        if(node)
+        {
+          return node->value.load();
+        }
+
+        return ::std::nullopt;
+      });
+  }
+
+  template<class K>
+  [[nodiscard]] ::std::optional<size_type> index_of(K const& key) const
+  {
+    return read_(
+      [this, &key](Reader_tree_ const& tree) -> ::std::optional<Size_>
+      {
+        Node_* const node = find_(tree, key);
+        if(node)
+        {
+          return Tree_algo_::node_index(tree, *node);
+        }
+
+        return ::std::nullopt;
+      });
+  }
+
+  // Writer side, serialized by the mutex.
+
+  bool insert(value_type const& val)
+  {
+    Lock_ const lock(mutex_);
+    Node_* const node = acquire_node_();
+    node->value.store(val);
+    Compare_ const& compare = compare_;
+    bool linked = false;
+    try
+    {
+      Write_section_ const section(*this);
+      Node_* const found = Tree_algo_::try_insert(
+        tree_,
+        [&compare, &val](Node_ const& n) -> Compare_result_
+        {
+          Value_ const n_val(n.value.load());
+          if(compare(val, n_val))
+          {
+            return Compare_result_::greater;
+          }
+          if(compare(n_val, val))
+          {
+            return Compare_result_::less;
+          }
+          return Compare_result_::equal;
+        },
+        [this, node](Node_* const parent, Side_ const side) noexcept -> Node_*
+        {
+          tree_.set_parent(*node, parent);
+          tree_.set_side(*node, side);
+          return node;
+        });
+
+      linked = node == found;
+      if(linked)
+      {
+        tree_.set_size(tree_.size() + 1u);
+      }
+    }
+    catch(...)
+    {
+      release_node_(node);
+      throw;
+    }
+
+    if(!linked)
+    {
+      release_node_(node);
+    }
+
+    return linked;
+  }
+
+  template<class K>
+  size_type erase(K const& key)
+  {
+    Lock_ const lock(mutex_);
+    Node_* const node = find_(tree_, key);
+    if(!node)
+    {
+      return static_cast<Size_>(0u);
+    }
+
+    {
+      Write_section_ const section(*this);
+      Tree_algo_::erase(tree_, node);
+      tree_.set_size(tree_.size() - 1u);
+    }
+
+    release_node_(node);
+    return static_cast<Size_>(1u);
+  }
+
+  // Unlinks every element. The nodes stay with the set for reuse.
+  void clear()
+  {
+    Lock_ const lock(mutex_);
+    Write_section_ const section(*this);
+    ::treexx::bin::Tree_algo::clear(
+      tree_,
+      [this](Node_* const node) noexcept
+      {
+        release_node_(node);
+      });
+    tree_.reset();
+  }
+
+private:
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  template<class Read>
+  [[nodiscard]] auto read_(Read const& read) const
+  {
+    for(;;)
+    {
+      Sequence_ const seq = sequence_.load(::std::memory_order_acquire);
+      if(0u == (seq & 1u))
+      {
+        Reader_tree_ const tree(tree_);
+        auto result = read(tree);
+        ::std::atomic_thread_fence(::std::memory_order_acquire);
+        if(seq == load_(sequence_) && !tree.exhausted())
+        {
+          return result;
+        }
+      }
+
+      ::std::this_thread::yield();
+    }
+  }
+
+  template<class Tree, class K>
+  [[nodiscard]] Node_* find_(Tree const& tree, K const& key) const
+  {
+    Compare_ const& compare = compare_;
+    return Tree_algo_::binary_search(
+      tree,
+      [&compare, &key](Node_ const& n) -> Compare_result_
+      {
+        Value_ const n_val(n.value.load());
+        if(compare(n_val, key))
+        {
+          return Compare_result_::less;
+        }
+        if(compare(key, n_val))
+        {
+          return Compare_result_::greater;
+        }
+        return Compare_result_::equal;
+      });
+  }
+
+  [[nodiscard]] Node_* acquire_node_()
+  {
+    if(free_)
+    {
+      // Only readers already bound to fail validation can still see it.
+      Node_* const node = free_;
+      free_ = node->next_free;
+      node->next_free = nullptr;
+      Tree_static_::set_parent(*node, nullptr);
+      Tree_static_::template set_child<Side_::left>(*node, nullptr);
+      Tree_static_::template set_child<Side_::right>(*node, nullptr);
+      Tree_static_::template set_index<0u>(*node);
+      Tree_static_::set_balance(*node, Balance_::poised);
+      return node;
+    }
+
+    Node_allocator_& alloc = allocator_;
+    Node_* const node = Node_allocator_traits_::allocate(alloc, 1u);
+    Node_allocator_traits_::construct(alloc, node);
+    ++capacity_;
+    return node;
+  }
+
+  void release_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    node->next_free = free_;
+    free_ = node;
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = allocator_;
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Tree_ tree_;
+  ::std::atomic<Sequence_> sequence_;
+  Node_* free_;
+  Size_ capacity_;
+  Compare_ compare_;
+  Node_allocator_ allocator_;
+  mutable Mutex_ mutex_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_SEQLOCKSET_HH
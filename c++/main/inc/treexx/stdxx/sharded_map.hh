@@ -0,0 +1,787 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_SHARDEDMAP_HH
+#define TREEXX_STDXX_SHARDEDMAP_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/avl_hook.hh>
+
+namespace treexx::stdxx
+{
+
+// Ordered map safe for concurrent use, partitioned by key range into shards.
+// Every shard is an indexed AVL tree behind its own mutex, so writers to
+// different ranges do not wait for each other. A shard that grows over
+// max_shard_size, or whose lock is often found taken, is split at its median
+// in O(log n); shards that shrink are joined with a neighbour. Scans visit the
+// shards in key order, locking one at a time, so they see each shard
+// consistently but not the whole map at one instant. The callbacks run under
+// a shard lock and must not use the map.
+//
+// The shard boundaries live in an immutable directory published through an
+// atomic pointer, which operations only load. An operation locks the shard
+// its directory names and checks under that lock that the directory is still
+// current, since a split or a join holds the locks of the shards it changes
+// while publishing the next one. Readers do not announce themselves, so the
+// replaced directories are kept until the map is destroyed.
+//
+// The allocator is called from several threads at once.
+template<
+  class K,
+  class V,
+  class C = ::std::less<K>,
+  class A = ::std::allocator<::std::pair<K const, V>>>
+struct sharded_map
+{
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = ::std::pair<key_type const, mapped_type>;
+  using key_compare = C;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Compare_ = key_compare;
+  using Key_ = key_type;
+  using Mapped_ = mapped_type;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Mutex_ = ::std::mutex;
+  using Lock_ = ::std::unique_lock<Mutex_>;
+
+  static Size_ constexpr cache_line_size_ = 64u;
+
+  // A shard whose lock was found taken this many times since it was last
+  // split is hot, and is split as long as it is not smaller than
+  // min_hot_split_size_.
+  static Size_ constexpr hot_contention_ = 256u;
+  static Size_ constexpr min_hot_split_size_ = 64u;
+
+  struct Node_
+  {
+    template<class Key, class... Args>
+    explicit Node_(Key&& key, Args&&... args) :
+      value(
+        ::std::piecewise_construct,
+        ::std::forward_as_tuple(static_cast<Key&&>(key)),
+        ::std::forward_as_tuple(static_cast<Args&&>(args)...))
+    {}
+
+    avl_hook<Node_, Size_> hook;
+    Value_ value;
+  };
+
+  using Hook_ = avl_hook<Node_, Size_>;
+  using Tree_ = avl_hook_tree<Node_, Hook_, &Node_::hook>;
+
+  // The size is atomic so that the neighbours can be sized up without their
+  // locks when deciding on a join, and the map size summed up.
+  struct alignas(cache_line_size_) Shard_
+  {
+    Shard_() noexcept :
+      size(static_cast<Size_>(0u)),
+      contention(static_cast<Size_>(0u))
+    {}
+
+    Mutex_ mutex;
+    Tree_ tree;
+    ::std::atomic<Size_> size;
+    ::std::atomic<Size_> contention;
+  };
+
+  struct Directory_
+  {
+    ::std::vector<Shard_*> shards;
+    // Shard i covers the keys from bounds[i - 1] up to bounds[i].
+    ::std::vector<Key_> bounds;
+  };
+
+  // A shard locked while its directory is the current one.
+  struct Locked_shard_
+  {
+    Directory_ const* directory;
+    Size_ index;
+    Shard_* shard;
+    Lock_ lock;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  enum class Rebalance_ : char unsigned
+  {
+    none = 0u,
+    split,
+    join
+  };
+
+public:
+  explicit sharded_map(
+    size_type const max_shard_size = 4096u,
+    key_compare const& compare = key_compare(),
+    allocator_type const& alloc = allocator_type()) :
+    compare_and_alloc_(compare, alloc),
+    max_shard_size_(
+      static_cast<Size_>(2u) < max_shard_size ?
+        max_shard_size : static_cast<Size_>(2u)),
+    directory_(nullptr)
+  {
+    shards_.push_back(::std::make_unique<Shard_>());
+    directories_.push_back(::std::make_unique<Directory_>());
+    directories_.back()->shards.push_back(shards_.back().get());
+    directory_.store(directories_.back().get(), ::std::memory_order_relaxed);
+  }
+
+  sharded_map(sharded_map&&) = delete;
+  sharded_map(sharded_map const&) = delete;
+
+  ~sharded_map()
+  {
+    for(Shard_* const shard: current_().shards)
+    {
+      clear_(*shard);
+    }
+  }
+
+  sharded_map& operator =(sharded_map&&) = delete;
+  sharded_map& operator =(sharded_map const&) = delete;
+
+  // Sums up the shard sizes, so it is exact only while no write runs.
+  [[nodiscard]] size_type size() const noexcept
+  {
+    Size_ size = 0u;
+    for(Shard_ const* const shard: current_().shards)
+    {
+      size += shard->size.load(::std::memory_order_relaxed);
+    }
+
+    return size;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    for(Shard_ const* const shard: current_().shards)
+    {
+      if(0u < shard->size.load(::std::memory_order_relaxed))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  [[nodiscard]] size_type max_shard_size() const noexcept
+  {
+    return max_shard_size_;
+  }
+
+  [[nodiscard]] size_type shard_count() const noexcept
+  {
+    return current_().shards.size();
+  }
+
+  // Inserts the element when the key is not there yet. The key is looked up
+  // first, so args are left alone when it is found; otherwise the element is
+  // built under the shard lock.
+  template<class... Args>
+  bool try_emplace(key_type const& key, Args&&... args)
+  {
+    return emplace_<false>(key, static_cast<Args&&>(args)...);
+  }
+
+  bool insert(value_type const& val)
+  {
+    return try_emplace(val.first, val.second);
+  }
+
+  // Returns true when the element was inserted rather than assigned.
+  template<class M>
+  bool insert_or_assign(key_type const& key, M&& mapped)
+  {
+    return emplace_<true>(key, static_cast<M&&>(mapped));
+  }
+
+  size_type erase(key_type const& key)
+  {
+    Node_* node;
+    Rebalance_ rebalance;
+    {
+      Locked_shard_ const locked(lock_shard_(key));
+      Shard_& shard = *locked.shard;
+      node = find_(shard.tree, key);
+      if(!node)
+      {
+        return static_cast<Size_>(0u);
+      }
+
+      Tree_algo_::erase(shard.tree, node);
+      shard.size.fetch_sub(static_cast<Size_>(1u), ::std::memory_order_relaxed);
+      rebalance = rebalance_needed_(*locked.directory, locked.index);
+    }
+
+    destroy_node_(node);
+    if(Rebalance_::none != rebalance)
+    {
+      rebalance_(key);
+    }
+
+    return static_cast<Size_>(1u);
+  }
+
+  [[nodiscard]] bool contains(key_type const& key) const
+  {
+    Locked_shard_ const locked(lock_shard_(key));
+    return find_(locked.shard->tree, key) ? true : false;
+  }
+
+  // Copy of the mapped value, taken under the lock of its shard.
+  [[nodiscard]] ::std::optional<mapped_type> get(key_type const& key) const
+  {
+    Locked_shard_ const locked(lock_shard_(key));
+    Node_ const* const node = find_(locked.shard->tree, key);
+    if(node)
+    {
+      return node->value.second;
+    }
+
+    return ::std::nullopt;
+  }
+
+  // Calls fun(value_type&) under the lock of the shard holding the key.
+  // Returns false when there is no such key.
+  template<class Fun>
+  bool visit(key_type const& key, Fun&& fun)
+  {
+    Locked_shard_ const locked(lock_shard_(key));
+    Node_* const node = find_(locked.shard->tree, key);
+    if(node)
+    {
+      static_cast<Fun&&>(fun)(node->value);
+      return true;
+    }
+
+    return false;
+  }
+
+  // Calls fun(value_type const&) for every element in key order.
+  template<class Fun>
+  void for_each(Fun&& fun) const
+  {
+    scan_(nullptr, nullptr, fun);
+  }
+
+  // Calls fun(value_type const&) for the elements with keys in [first, last)
+  // in key order.
+  template<class Fun>
+  void for_each(key_type const& first, key_type const& last, Fun&& fun) const
+  {
+    scan_(::std::addressof(first), ::std::addressof(last), fun);
+  }
+
+  void clear()
+  {
+    Lock_ const directory_lock(directory_mutex_);
+    Directory_ const& directory = current_();
+    auto next = ::std::make_unique<Directory_>();
+    next->shards.push_back(directory.shards.front());
+    directories_.reserve(directories_.size() + 1u);
+    spare_shards_.reserve(spare_shards_.size() + directory.shards.size());
+
+    ::std::vector<Lock_> locks;
+    locks.reserve(directory.shards.size());
+    for(Shard_* const shard: directory.shards)
+    {
+      locks.emplace_back(shard->mutex);
+    }
+
+    for(Shard_* const shard: directory.shards)
+    {
+      clear_(*shard);
+    }
+
+    publish_(::std::move(next));
+    spare_shards_.insert(
+      spare_shards_.cend(),
+      directory.shards.cbegin() + 1,
+      directory.shards.cend());
+  }
+
+private:
+  struct Compare_and_alloc_ : Node_allocator_
+  {
+    Compare_and_alloc_(Compare_ const& c, Allocator_ const& a) :
+      Node_allocator_(a),
+      compare(c)
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    Compare_ compare;
+  };
+
+  [[nodiscard]] Directory_ const& current_() const noexcept
+  {
+    return *directory_.load(::std::memory_order_acquire);
+  }
+
+  // Locks the shard covering the key, retrying while splits or joins replace
+  // the directory under it.
+  [[nodiscard]] Locked_shard_ lock_shard_(Key_ const& key) const
+  {
+    for(;;)
+    {
+      Directory_ const* const directory =
+        directory_.load(::std::memory_order_acquire);
+      Size_ const i = shard_index_(*directory, key);
+      Shard_& shard = *directory->shards[i];
+      Lock_ lock(lock_(shard));
+      if(directory == directory_.load(::std::memory_order_acquire))
+      {
+        return Locked_shard_{directory, i, &shard, ::std::move(lock)};
+      }
+    }
+  }
+
+  // Builds and links an element from args when the key is not there yet, or
+  // assigns args to the mapped value of the element found when assign. The
+  // search and the link are one descent, and the node is only allocated once
+  // the descent has not found the key.
+  template<bool assign, class... Args>
+  bool emplace_(Key_ const& key, Args&&... args)
+  {
+    Rebalance_ rebalance;
+    {
+      Locked_shard_ const locked(lock_shard_(key));
+      Shard_& shard = *locked.shard;
+      Compare_ const& compare = compare_and_alloc_.compare;
+      Node_* created = nullptr;
+      Node_* const found = Tree_algo_::try_insert(
+        shard.tree,
+        [&compare, &key](Node_ const& n) -> Compare_result_
+        {
+          if(compare(n.value.first, key))
+          {
+            return Compare_result_::less;
+          }
+          if(compare(key, n.value.first))
+          {
+            return Compare_result_::greater;
+          }
+          return Compare_result_::equal;
+        },
+        [this, &created, &key, &args...](
+          Node_* const parent,
+          Side_ const side) -> Node_*
+        {
+          created = create_node_(key, static_cast<Args&&>(args)...);
+          created->hook.parent = parent;
+          created->hook.side = side;
+          return created;
+        });
+
+      if(found != created)
+      {
+        if constexpr(assign)
+        {
+          assign_(found->value.second, static_cast<Args&&>(args)...);
+        }
+
+        return false;
+      }
+
+      shard.size.fetch_add(
+        static_cast<Size_>(1u), ::std::memory_order_relaxed);
+      rebalance = rebalance_needed_(*locked.directory, locked.index);
+    }
+
+    if(Rebalance_::none != rebalance)
+    {
+      rebalance_(key);
+    }
+
+    return true;
+  }
+
+  template<class M>
+  static void assign_(Mapped_& mapped, M&& x)
+  {
+    mapped = static_cast<M&&>(x);
+  }
+
+  // Visits the keys in [*first, *last) shard by shard; a null bound is open.
+  // When the directory changes between two shards the scan goes on from the
+  // lower bound of the next shard in the new directory.
+  template<class Fun>
+  void scan_(Key_ const* first, Key_ const* const last, Fun& fun) const
+  {
+    Compare_ const& compare = compare_and_alloc_.compare;
+    Directory_ const* directory = directory_.load(::std::memory_order_acquire);
+    Size_ i = first ? shard_index_(*directory, *first) : 0u;
+    for(;;)
+    {
+      Shard_& shard = *directory->shards[i];
+      Lock_ lock(lock_(shard));
+      Directory_ const* const current =
+        directory_.load(::std::memory_order_acquire);
+      if(directory != current)
+      {
+        lock.unlock();
+        directory = current;
+        i = first ? shard_index_(*directory, *first) : 0u;
+        continue;
+      }
+
+      for(
+        Node_* node = first ?
+          lower_bound_(shard.tree, *first) :
+          shard.tree.template extreme<Side_::left>();
+        node;
+        node = Tree_algo_::next_node(shard.tree, *node))
+      {
+        if(last && !compare(node->value.first, *last))
+        {
+          return;
+        }
+
+        fun(static_cast<Value_ const&>(node->value));
+      }
+
+      if(directory->bounds.size() <= i)
+      {
+        return;
+      }
+
+      // The bounds of a published directory never change.
+      first = &directory->bounds[i];
+      ++i;
+    }
+  }
+
+  [[nodiscard]] Size_ shard_index_(
+    Directory_ const& directory,
+    Key_ const& key) const
+  {
+    return static_cast<Size_>(
+      ::std::upper_bound(
+        directory.bounds.cbegin(), directory.bounds.cend(), key,
+        compare_and_alloc_.compare) -
+      directory.bounds.cbegin());
+  }
+
+  [[nodiscard]] static Lock_ lock_(Shard_& shard)
+  {
+    Lock_ lock(shard.mutex, ::std::try_to_lock);
+    if(!lock.owns_lock())
+    {
+      shard.contention.fetch_add(
+        static_cast<Size_>(1u), ::std::memory_order_relaxed);
+      lock.lock();
+    }
+
+    return lock;
+  }
+
+  [[nodiscard]] Rebalance_ rebalance_needed_(
+    Directory_ const& directory,
+    Size_ const i) const noexcept
+  {
+    Shard_ const& shard = *directory.shards[i];
+    Size_ const size = shard.size.load(::std::memory_order_relaxed);
+    if(
+      max_shard_size_ < size ||
+      (min_hot_split_size_ <= size &&
+        hot_contention_ <=
+          shard.contention.load(::std::memory_order_relaxed)))
+    {
+      return Rebalance_::split;
+    }
+
+    if(size < max_shard_size_ / 8u && join_partner_(directory, i) != i)
+    {
+      return Rebalance_::join;
+    }
+
+    return Rebalance_::none;
+  }
+
+  // The smaller neighbour of shard i if the two together stay within half of
+  // the maximum size, or i itself.
+  [[nodiscard]] Size_ join_partner_(
+    Directory_ const& directory,
+    Size_ const i) const noexcept
+  {
+    auto const& shards = directory.shards;
+    Size_ j = i;
+    Size_ partner_size = max_shard_size_;
+    if(0u < i)
+    {
+      j = i - 1u;
+      partner_size = shards[j]->size.load(::std::memory_order_relaxed);
+    }
+
+    if(shards.size() > i + 1u)
+    {
+      Size_ const next_size =
+        shards[i + 1u]->size.load(::std::memory_order_relaxed);
+      if(next_size < partner_size)
+      {
+        j = i + 1u;
+        partner_size = next_size;
+      }
+    }
+
+    Size_ const size = shards[i]->size.load(::std::memory_order_relaxed);
+    return size + partner_size <= max_shard_size_ / 2u ? j : i;
+  }
+
+  // Splits or joins the shard covering the key if it still needs that once
+  // the directory and the shards involved are locked.
+  void rebalance_(Key_ const& key)
+  {
+    Lock_ const directory_lock(directory_mutex_);
+    Directory_ const& directory = current_();
+    Size_ const i = shard_index_(directory, key);
+    switch(rebalance_needed_(directory, i))
+    {
+    case Rebalance_::split:
+      split_(directory, i);
+      break;
+    case Rebalance_::join:
+      {
+        Size_ const j = join_partner_(directory, i);
+        join_(directory, j < i ? j : i);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  // Moves the upper half of shard i into a spare shard following it.
+  void split_(Directory_ const& directory, Size_ const i)
+  {
+    auto next = ::std::make_unique<Directory_>(directory);
+    next->shards.reserve(next->shards.size() + 1u);
+    next->bounds.reserve(next->bounds.size() + 1u);
+    directories_.reserve(directories_.size() + 1u);
+    Shard_* const upper = spare_shard_();
+
+    Shard_& shard = *directory.shards[i];
+    Lock_ const lock(shard.mutex);
+    Size_ const size = shard.size.load(::std::memory_order_relaxed);
+    Size_ const half = size / 2u;
+    if(1u > half)
+    {
+      return;
+    }
+
+    Node_* const median = Tree_algo_::at_index(shard.tree, half);
+    TREEXX_ASSERT(median);
+    next->bounds.insert(
+      next->bounds.cbegin() + static_cast<difference_type>(i),
+      median->value.first);
+    next->shards.insert(
+      next->shards.cbegin() + static_cast<difference_type>(i + 1u), upper);
+
+    spare_shards_.pop_back();
+    Tree_algo_::split(shard.tree, median, upper->tree);
+    shard.size.store(half, ::std::memory_order_relaxed);
+    upper->size.store(size - half, ::std::memory_order_relaxed);
+    shard.contention.store(
+      static_cast<Size_>(0u), ::std::memory_order_relaxed);
+    upper->contention.store(
+      static_cast<Size_>(0u), ::std::memory_order_relaxed);
+    publish_(::std::move(next));
+  }
+
+  // Moves the elements of shard i + 1 into shard i and keeps the former as
+  // a spare.
+  void join_(Directory_ const& directory, Size_ const i)
+  {
+    auto next = ::std::make_unique<Directory_>(directory);
+    next->shards.erase(
+      next->shards.cbegin() + static_cast<difference_type>(i + 1u));
+    next->bounds.erase(
+      next->bounds.cbegin() + static_cast<difference_type>(i));
+    directories_.reserve(directories_.size() + 1u);
+    spare_shards_.reserve(spare_shards_.size() + 1u);
+
+    Shard_& shard = *directory.shards[i];
+    Shard_& drained = *directory.shards[i + 1u];
+    Lock_ const lock(shard.mutex);
+    Lock_ const drained_lock(drained.mutex);
+    Size_ const size = shard.size.load(::std::memory_order_relaxed);
+    Size_ const drained_size = drained.size.load(::std::memory_order_relaxed);
+    if(max_shard_size_ / 2u < size + drained_size)
+    {
+      return;
+    }
+
+    Tree_algo_::join(shard.tree, drained.tree);
+    shard.size.store(size + drained_size, ::std::memory_order_relaxed);
+    drained.size.store(static_cast<Size_>(0u), ::std::memory_order_relaxed);
+    shard.contention.store(
+      static_cast<Size_>(0u), ::std::memory_order_relaxed);
+    publish_(::std::move(next));
+    spare_shards_.push_back(&drained);
+  }
+
+  // A drained shard, or a new one. It stays on the spare list until the
+  // caller takes it off.
+  [[nodiscard]] Shard_* spare_shard_()
+  {
+    if(spare_shards_.empty())
+    {
+      shards_.reserve(shards_.size() + 1u);
+      spare_shards_.reserve(spare_shards_.size() + 1u);
+      shards_.push_back(::std::make_unique<Shard_>());
+      spare_shards_.push_back(shards_.back().get());
+    }
+
+    return spare_shards_.back();
+  }
+
+  // Called with the directory mutex and the locks of the changed shards
+  // held, and with room reserved in directories_.
+  void publish_(::std::unique_ptr<Directory_>&& next) noexcept
+  {
+    directory_.store(next.get(), ::std::memory_order_release);
+    directories_.push_back(::std::move(next));
+  }
+
+  [[nodiscard]] Node_* find_(Tree_ const& tree, Key_ const& key) const
+  {
+    Compare_ const& compare = compare_and_alloc_.compare;
+    return Tree_algo_::binary_search(
+      tree,
+      [&compare, &key](Node_ const& n) -> Compare_result_
+      {
+        if(compare(n.value.first, key))
+        {
+          return Compare_result_::less;
+        }
+        if(compare(key, n.value.first))
+        {
+          return Compare_result_::greater;
+        }
+        return Compare_result_::equal;
+      });
+  }
+
+  [[nodiscard]] Node_* lower_bound_(Tree_ const& tree, Key_ const& key) const
+  {
+    Compare_ const& compare = compare_and_alloc_.compare;
+    return Tree_algo_::lower_bound(
+      tree,
+      [&compare, &key](Node_ const& n) -> Compare_result_
+      {
+        return compare(n.value.first, key) ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+  }
+
+  void clear_(Shard_& shard) noexcept
+  {
+    ::treexx::bin::Tree_algo::clear(
+      shard.tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    shard.tree.reset();
+    shard.size.store(static_cast<Size_>(0u), ::std::memory_order_relaxed);
+    shard.contention.store(
+      static_cast<Size_>(0u), ::std::memory_order_relaxed);
+  }
+
+  template<class... Args>
+  [[nodiscard]] Node_* create_node_(Args&&... args)
+  {
+    Node_allocator_& alloc = compare_and_alloc_.allocator();
+    Node_* const node = Node_allocator_traits_::allocate(alloc, 1u);
+    try
+    {
+      Node_allocator_traits_::construct(
+        alloc, node, static_cast<Args&&>(args)...);
+    }
+    catch(...)
+    {
+      Node_allocator_traits_::deallocate(alloc, node, 1u);
+      throw;
+    }
+
+    return node;
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    Node_allocator_& alloc = compare_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Compare_and_alloc_ compare_and_alloc_;
+  Size_ max_shard_size_;
+  // Serializes splits, joins and clear(). Other operations never take it.
+  Mutex_ directory_mutex_;
+  ::std::atomic<Directory_ const*> directory_;
+  // Every directory published so far, the current one last.
+  ::std::vector<::std::unique_ptr<Directory_>> directories_;
+  // Every shard created so far, live or spare.
+  ::std::vector<::std::unique_ptr<Shard_>> shards_;
+  ::std::vector<Shard_*> spare_shards_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_SHARDEDMAP_HH
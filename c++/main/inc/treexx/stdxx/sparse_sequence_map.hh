@@ -0,0 +1,1120 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_SPARSESEQUENCEMAP_HH
+#define TREEXX_STDXX_SPARSESEQUENCEMAP_HH
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/background_reclaimer.hh>
+
+namespace treexx::stdxx
+{
+
+template<class T, class A = ::std::allocator<T>>
+struct sparse_sequence_map
+{
+  using value_type = T;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using difference_type = ::std::ptrdiff_t;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Value_ = value_type;
+  using Size_ = size_type;
+  using Difference_ = difference_type;
+
+  template<bool c, class U, class V>
+  using Conditional_ = typename ::std::conditional<c, U, V>::type;
+
+  template<class U>
+  using Add_const_ = typename ::std::add_const<U>::type;
+
+  template<class U>
+  using Remove_cv_ = typename ::std::remove_cv<U>::type;
+
+  template<class U>
+  using Remove_reference_ = typename ::std::remove_reference<U>::type;
+
+  template<class U>
+  using Remove_cv_ref_ = Remove_cv_<Remove_reference_<Remove_cv_<U>>>;
+
+  template<class U, class... Args>
+  using Is_constructible_ = typename ::std::is_constructible<U, Args...>::type;
+
+  template<class, class...>
+  struct Is_same_
+  {
+    static bool constexpr value = false;
+  };
+
+  template<class U>
+  struct Is_same_<U, U>
+  {
+    static bool constexpr value = true;
+  };
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class U>
+  struct Enable_if_<true, U>
+  {
+    using Type = U;
+  };
+
+  struct Node_
+  {
+    template<
+      class... Val_args,
+      bool e = Is_constructible_<Value_, Val_args...>::value,
+      bool d = Is_same_<Node_, Remove_cv_ref_<Val_args>...>::value,
+      class = typename Enable_if_<e && !d>::Type>
+    explicit Node_(Val_args&&... val_args) :
+      value(static_cast<Val_args&&>(val_args)...)
+    {}
+
+    Node_* parent;
+    Node_* left_child;
+    Node_* right_child;
+    Size_ offset;
+    Balance_ balance;
+    Side_ side;
+    Value_ value;
+  };
+
+  struct Tree_static_
+  {
+    using Offset = Size_;
+
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node_* parent(Node_ const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node_* child(Node_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node_ const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Node_ const& n) noexcept
+    {
+      return n.side;
+    }
+
+    [[nodiscard]] static Offset const& offset(Node_ const& n) noexcept
+    {
+      return n.offset;
+    }
+
+    static void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Node_& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+
+    static void set_offset(Node_& n, Offset const& o) noexcept
+    {
+      n.offset = o;
+    }
+
+    static void add_to_offset(Node_& n, Offset const& o) noexcept
+    {
+      n.offset += o;
+    }
+
+    static void subtract_from_offset(Node_& n, Offset const& o) noexcept
+    {
+      n.offset -= o;
+    }
+
+    template<unsigned o>
+    [[nodiscard]] static Offset make_offset() noexcept
+    {
+      return static_cast<Offset>(o);
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+      return 1u > size_;
+    }
+
+    void increment_size() noexcept
+    {
+      ++size_;
+    }
+
+    void decrement_size() noexcept
+    {
+      --size_;
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+  private:
+    Node_* root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    Size_ size_;
+  };
+
+  template<bool is_const>
+  struct Iterator_
+  {
+    using iterator_category = ::std::bidirectional_iterator_tag;
+    using value_type = Value_;
+    using difference_type = Difference_;
+    using reference = Conditional_<
+      is_const, Add_const_<value_type>&, value_type&>;
+    using pointer = Conditional_<
+      is_const, Add_const_<value_type>*, value_type*>;
+
+    Iterator_() noexcept :
+      tree_(nullptr),
+      node_(nullptr)
+    {}
+
+    template<bool e = is_const, class = typename Enable_if_<e>::Type>
+    Iterator_(Iterator_<false> const& x) noexcept :
+      tree_(x.tree_),
+      node_(x.node_)
+    {}
+
+    [[nodiscard]] size_type position() const noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      TREEXX_ASSERT(node_);
+      return Tree_algo_::node_offset(*tree_, *node_);
+    }
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return node_->value;
+    }
+
+    [[nodiscard]] pointer operator ->() const noexcept
+    {
+      TREEXX_ASSERT(node_);
+      return ::std::addressof(node_->value);
+    }
+
+    Iterator_& operator ++() noexcept
+    {
+      TREEXX_ASSERT(node_);
+      node_ = Tree_algo_::next_node(*tree_, *node_);
+      return *this;
+    }
+
+    Iterator_ operator ++(int) noexcept
+    {
+      Iterator_ const x(*this);
+      ++*this;
+      return x;
+    }
+
+    Iterator_& operator --() noexcept
+    {
+      TREEXX_ASSERT(tree_);
+      if(node_)
+      {
+        node_ = Tree_algo_::previous_node(*tree_, *node_);
+      }
+      else
+      {
+        node_ = tree_->template extreme<Side_::right>();
+      }
+
+      TREEXX_ASSERT(node_);
+      return *this;
+    }
+
+    Iterator_ operator --(int) noexcept
+    {
+      Iterator_ const x(*this);
+      --*this;
+      return x;
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ == y.node_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      Iterator_ const& x,
+      Iterator_ const& y) noexcept
+    {
+      return x.node_ != y.node_;
+    }
+
+  private:
+    friend struct sparse_sequence_map;
+    friend struct Iterator_<true>;
+
+    Iterator_(Tree_ const* const t, Node_* const n) noexcept :
+      tree_(t),
+      node_(n)
+    {}
+
+    Tree_ const* tree_;
+    Node_* node_;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  static_assert(Is_same_<Value_, Remove_cv_ref_<Value_>>::value);
+  static_assert(Is_same_<Allocator_, Remove_cv_ref_<Allocator_>>::value);
+
+public:
+  using iterator = Iterator_<false>;
+  using const_iterator = Iterator_<true>;
+  using reverse_iterator = ::std::reverse_iterator<iterator>;
+  using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+  // Hint for a run of operations at nearby positions: the element the last
+  // of them ended at and its position, from where seek_offset goes on. A
+  // default constructed finger starts at the root. The members taking a
+  // finger keep it valid; any other erasure or row shift invalidates it.
+  struct finger
+  {
+    finger() noexcept :
+      node_(nullptr),
+      pos_(static_cast<Size_>(0u))
+    {}
+
+  private:
+    friend struct sparse_sequence_map;
+
+    Node_* node_;
+    Size_ pos_;
+  };
+
+  sparse_sequence_map() = default;
+
+  explicit sparse_sequence_map(allocator_type const& alloc) :
+    tree_and_alloc_(alloc)
+  {}
+
+  sparse_sequence_map(sparse_sequence_map&& x) noexcept :
+    tree_and_alloc_(static_cast<Node_allocator_&&>(x.tree_and_alloc_))
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+  }
+
+  sparse_sequence_map(sparse_sequence_map const& x) :
+    tree_and_alloc_(
+      Node_allocator_traits_::select_on_container_copy_construction(
+        x.tree_and_alloc_))
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Size_ prev_pos = static_cast<Size_>(0u);
+    for(auto it = x.begin(); x.end() != it; ++it)
+    {
+      Size_ const pos = it.position();
+      Unique_node_ node(tree_and_alloc_.allocator());
+      node.construct(*it);
+      auto const node_ptr = node.get();
+      TREEXX_ASSERT(node_ptr);
+
+      Tree_algo_::push_back(tree, node_ptr, pos - prev_pos);
+      node.release();
+      tree.increment_size();
+      prev_pos = pos;
+    }
+  }
+
+  ~sparse_sequence_map()
+  {
+    clear();
+  }
+
+  sparse_sequence_map& operator =(sparse_sequence_map&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+      if constexpr(
+        Node_allocator_traits_::propagate_on_container_move_assignment::value)
+      {
+        tree_and_alloc_.allocator() =
+          static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator());
+      }
+    }
+
+    return *this;
+  }
+
+  sparse_sequence_map& operator =(sparse_sequence_map const& x)
+  {
+    if(this != ::std::addressof(x))
+    {
+      sparse_sequence_map y(x);
+      swap(y);
+    }
+
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(tree_and_alloc_.allocator());
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return tree_and_alloc_.tree.empty();
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_and_alloc_.tree.size();
+  }
+
+  [[nodiscard]] iterator begin() noexcept
+  {
+    return make_iterator_(tree_and_alloc_.tree.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept
+  {
+    return make_iterator_(tree_and_alloc_.tree.template extreme<Side_::left>());
+  }
+
+  [[nodiscard]] iterator end() noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept
+  {
+    return make_iterator_(nullptr);
+  }
+
+  [[nodiscard]] const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  [[nodiscard]] const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  [[nodiscard]] reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+
+  [[nodiscard]] reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+
+  [[nodiscard]] const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  [[nodiscard]] iterator find(size_type const& pos) noexcept
+  {
+    return make_iterator_(find_(pos));
+  }
+
+  [[nodiscard]] const_iterator find(size_type const& pos) const noexcept
+  {
+    return make_iterator_(find_(pos));
+  }
+
+  [[nodiscard]] bool contains(size_type const& pos) const noexcept
+  {
+    return find_(pos) ? true : false;
+  }
+
+  [[nodiscard]] iterator lower_bound(size_type const& pos) noexcept
+  {
+    return make_iterator_(lower_bound_(pos));
+  }
+
+  [[nodiscard]] const_iterator lower_bound(
+    size_type const& pos) const noexcept
+  {
+    return make_iterator_(lower_bound_(pos));
+  }
+
+  [[nodiscard]] iterator upper_bound(size_type const& pos) noexcept
+  {
+    return make_iterator_(upper_bound_(pos));
+  }
+
+  [[nodiscard]] const_iterator upper_bound(
+    size_type const& pos) const noexcept
+  {
+    return make_iterator_(upper_bound_(pos));
+  }
+
+  [[nodiscard]] reference operator [](size_type const& pos)
+  {
+    return *try_emplace(pos).first;
+  }
+
+  [[nodiscard]] reference at(size_type const& pos)
+  {
+    return at_(pos)->value;
+  }
+
+  [[nodiscard]] const_reference at(size_type const& pos) const
+  {
+    return at_(pos)->value;
+  }
+
+  template<class... Args>
+  ::std::pair<iterator, bool> try_emplace(
+    size_type const& pos,
+    Args&&... args)
+  {
+    Node_* const found = find_(pos);
+    if(found)
+    {
+      return ::std::pair<iterator, bool>(make_iterator_(found), false);
+    }
+
+    Tree_& tree = tree_and_alloc_.tree;
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<Args&&>(args)...);
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    Tree_algo_::insert_at_offset(tree, node_ptr, pos);
+    node.release();
+    tree.increment_size();
+    return ::std::pair<iterator, bool>(make_iterator_(node_ptr), true);
+  }
+
+  template<class M>
+  ::std::pair<iterator, bool> insert_or_assign(
+    size_type const& pos,
+    M&& val)
+  {
+    Node_* const found = find_(pos);
+    if(found)
+    {
+      found->value = static_cast<M&&>(val);
+      return ::std::pair<iterator, bool>(make_iterator_(found), false);
+    }
+
+    return try_emplace(pos, static_cast<M&&>(val));
+  }
+
+  // insert_or_assign that finds the position from the finger and links a
+  // new element next to its predecessor instead of descending from the root.
+  template<class M>
+  ::std::pair<iterator, bool> insert_or_assign(
+    finger& f,
+    size_type const& pos,
+    M&& val)
+  {
+    Node_* const prev = seek_(f, pos);
+    if(prev && pos == f.pos_)
+    {
+      prev->value = static_cast<M&&>(val);
+      return ::std::pair<iterator, bool>(make_iterator_(prev), false);
+    }
+
+    Tree_& tree = tree_and_alloc_.tree;
+    Unique_node_ node(tree_and_alloc_.allocator());
+    node.construct(static_cast<M&&>(val));
+    auto const node_ptr = node.get();
+    TREEXX_ASSERT(node_ptr);
+
+    Tree_algo_::insert_after(
+      tree, prev, prev ? f.pos_ : static_cast<Size_>(0u), node_ptr, pos);
+    node.release();
+    tree.increment_size();
+    f.node_ = node_ptr;
+    f.pos_ = pos;
+    return ::std::pair<iterator, bool>(make_iterator_(node_ptr), true);
+  }
+
+  iterator erase(const_iterator const& it) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const node = it.node_;
+    TREEXX_ASSERT(::std::addressof(tree) == it.tree_);
+    TREEXX_ASSERT(node);
+
+    Node_* const next = Tree_algo_::next_node(tree, *node);
+    Tree_algo_::erase(tree, node);
+    tree.decrement_size();
+    destroy_node_(node);
+    return make_iterator_(next);
+  }
+
+  size_type erase(size_type const& pos) noexcept
+  {
+    Node_* const node = find_(pos);
+    if(node)
+    {
+      static_cast<void>(erase(make_iterator_(node)));
+      return static_cast<Size_>(1u);
+    }
+
+    return static_cast<Size_>(0u);
+  }
+
+  size_type erase(finger& f, size_type const& pos) noexcept
+  {
+    Node_* const node = seek_(f, pos);
+    if(!node || pos != f.pos_)
+    {
+      return static_cast<Size_>(0u);
+    }
+
+    // The finger moves to the preceding element.
+    Tree_& tree = tree_and_alloc_.tree;
+    Size_ prev_pos(pos);
+    Node_* const prev = 0u < pos ?
+      Tree_algo_::seek_offset(tree, node, prev_pos, pos - 1u) : nullptr;
+    Tree_algo_::erase(tree, node);
+    tree.decrement_size();
+    destroy_node_(node);
+    f.node_ = prev;
+    f.pos_ = prev ? prev_pos : static_cast<Size_>(0u);
+    return static_cast<Size_>(1u);
+  }
+
+  void insert_rows(size_type const& pos, size_type const& count) noexcept
+  {
+    if(0u < count)
+    {
+      Node_* const node = lower_bound_(pos);
+      if(node)
+      {
+        TREEXX_ASSERT(
+          count <= ::std::numeric_limits<Size_>::max() - last_position_());
+        Tree_algo_::shift_suffix<Side_::right>(
+          tree_and_alloc_.tree, *node, count);
+      }
+    }
+  }
+
+  void insert_rows(
+    finger& f,
+    size_type const& pos,
+    size_type const& count) noexcept
+  {
+    if(0u < count)
+    {
+      Tree_& tree = tree_and_alloc_.tree;
+      Node_* const prev = seek_(f, pos);
+      Node_* const first = !prev ?
+        tree.template extreme<Side_::left>() :
+        pos == f.pos_ ? prev : Tree_algo_::next_node(tree, *prev);
+      if(first)
+      {
+        TREEXX_ASSERT(
+          count <= ::std::numeric_limits<Size_>::max() - last_position_());
+        Tree_algo_::shift_suffix<Side_::right>(tree, *first, count);
+        if(first == prev)
+        {
+          f.pos_ += count;
+        }
+        else if(!prev)
+        {
+          f = finger();
+        }
+      }
+    }
+  }
+
+  size_type erase_rows(size_type const& pos, size_type const& count) noexcept
+  {
+    Size_ erased = static_cast<Size_>(0u);
+    if(0u < count)
+    {
+      Tree_& tree = tree_and_alloc_.tree;
+      Size_ constexpr max_pos = ::std::numeric_limits<Size_>::max();
+      bool const has_end(count <= max_pos - pos);
+      Node_* const last = has_end ? lower_bound_(pos + count) : nullptr;
+      for(Node_* node = lower_bound_(pos); last != node; ++erased)
+      {
+        TREEXX_ASSERT(node);
+        Node_* const next = Tree_algo_::next_node(tree, *node);
+        Tree_algo_::erase(tree, node);
+        tree.decrement_size();
+        destroy_node_(node);
+        node = next;
+      }
+
+      if(last)
+      {
+        Tree_algo_::shift_suffix<Side_::left>(tree, *last, count);
+      }
+    }
+
+    return erased;
+  }
+
+  size_type erase_rows(
+    finger& f,
+    size_type const& pos,
+    size_type const& count) noexcept
+  {
+    Size_ erased = static_cast<Size_>(0u);
+    if(0u < count)
+    {
+      // The finger moves to the last element before pos, which stays put.
+      Tree_& tree = tree_and_alloc_.tree;
+      Node_* const prev = 0u < pos ?
+        seek_(f, pos - 1u) : static_cast<Node_*>(nullptr);
+      if(!prev)
+      {
+        f = finger();
+      }
+
+      Size_ constexpr max_pos = ::std::numeric_limits<Size_>::max();
+      bool const has_end(count <= max_pos - pos);
+      Node_* last = nullptr;
+      if(has_end)
+      {
+        finger end_f(f);
+        Node_* const before_end = seek_(end_f, pos + count - 1u);
+        last = before_end ?
+          Tree_algo_::next_node(tree, *before_end) :
+          tree.template extreme<Side_::left>();
+      }
+
+      for(
+        Node_* node = prev ?
+          Tree_algo_::next_node(tree, *prev) :
+          tree.template extreme<Side_::left>();
+        last != node;
+        ++erased)
+      {
+        TREEXX_ASSERT(node);
+        Node_* const next = Tree_algo_::next_node(tree, *node);
+        Tree_algo_::erase(tree, node);
+        tree.decrement_size();
+        destroy_node_(node);
+        node = next;
+      }
+
+      if(last)
+      {
+        Tree_algo_::shift_suffix<Side_::left>(tree, *last, count);
+      }
+    }
+
+    return erased;
+  }
+
+  void clear() noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
+  // Empties the container in O(1), leaving the elements to be destroyed on
+  // the thread of reclaimer. Called before destruction, it makes the
+  // destructor O(1) as well. The allocator must be usable from that thread.
+  void clear(background_reclaimer& reclaimer)
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const root = tree.root();
+    if(root)
+    {
+      Tree_ detached;
+      detached.set_root(root);
+      Node_allocator_ alloc(tree_and_alloc_.allocator());
+      reclaimer.post(
+        [detached, alloc](Size_ const count) mutable noexcept -> bool
+        {
+          return ::treexx::bin::Tree_algo::clear_some(
+            detached,
+            [&alloc](Node_* const node) noexcept
+            {
+              Node_allocator_traits_::destroy(alloc, node);
+              Node_allocator_traits_::deallocate(alloc, node, 1u);
+            },
+            count);
+        });
+      tree.reset();
+    }
+  }
+
+  void swap(sparse_sequence_map& x) noexcept
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+    if constexpr(Node_allocator_traits_::propagate_on_container_swap::value)
+    {
+      using ::std::swap;
+      swap(tree_and_alloc_.allocator(), x.tree_and_alloc_.allocator());
+    }
+  }
+
+  friend void swap(sparse_sequence_map& x, sparse_sequence_map& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  struct Unique_node_
+  {
+    using Ptr = typename Node_allocator_traits_::pointer;
+
+    explicit Unique_node_(Node_allocator_& alloc) :
+      alloc_(::std::addressof(alloc)),
+      ptr_(Node_allocator_traits_::allocate(alloc, 1u)),
+      constructed(false)
+    {}
+
+    Unique_node_(Unique_node_&&) = delete;
+    Unique_node_(Unique_node_ const&) = delete;
+
+    ~Unique_node_()
+    {
+      if(alloc_ && ptr_)
+      {
+        if(constructed)
+        {
+          Node_allocator_traits_::destroy(*alloc_, ptr_);
+        }
+
+        Node_allocator_traits_::deallocate(*alloc_, ptr_, 1u);
+      }
+    }
+
+    Unique_node_& operator =(Unique_node_&&) = delete;
+    Unique_node_& operator =(Unique_node_ const&) = delete;
+
+    [[nodiscard]] Ptr const& get() const noexcept
+    {
+      return ptr_;
+    }
+
+    void release() noexcept
+    {
+      alloc_ = nullptr;
+    }
+
+    template<class... Args>
+    void construct(Args&&... args)
+    {
+      TREEXX_ASSERT(alloc_);
+      TREEXX_ASSERT(!constructed);
+      Node_allocator_traits_::construct(
+        *alloc_, ptr_, static_cast<Args&&>(args)...);
+      constructed = true;
+    }
+
+  private:
+    Node_allocator_* alloc_;
+    Ptr ptr_;
+    bool constructed;
+  };
+
+  struct Allocator_base_ : Node_allocator_
+  {
+    Allocator_base_() = default;
+
+    template<class Alloc>
+    explicit Allocator_base_(Alloc&& alloc) :
+      Node_allocator_(static_cast<Alloc&&>(alloc))
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    [[nodiscard]] Node_allocator_ const& allocator() const noexcept
+    {
+      return *this;
+    }
+  };
+
+  struct Tree_and_alloc_ : Allocator_base_
+  {
+    using Allocator_base_::Allocator_base_;
+
+    Tree_ tree;
+  };
+
+  [[nodiscard]] iterator make_iterator_(Node_* const node) noexcept
+  {
+    return iterator(::std::addressof(tree_and_alloc_.tree), node);
+  }
+
+  [[nodiscard]] const_iterator make_iterator_(
+    Node_* const node) const noexcept
+  {
+    return const_iterator(::std::addressof(tree_and_alloc_.tree), node);
+  }
+
+  [[nodiscard]] Node_* find_(Size_ const& pos) const noexcept
+  {
+    return Tree_algo_::binary_search<false, false, true>(
+      tree_and_alloc_.tree,
+      [&pos](Size_ const& offset) -> Compare_result_
+      {
+        if(offset < pos)
+        {
+          return Compare_result_::less;
+        }
+        if(pos < offset)
+        {
+          return Compare_result_::greater;
+        }
+        return Compare_result_::equal;
+      });
+  }
+
+  [[nodiscard]] Node_* lower_bound_(Size_ const& pos) const noexcept
+  {
+    return Tree_algo_::lower_bound<false, false, true>(
+      tree_and_alloc_.tree,
+      [&pos](Size_ const& offset) -> Compare_result_
+      {
+        return offset < pos ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+  }
+
+  [[nodiscard]] Node_* upper_bound_(Size_ const& pos) const noexcept
+  {
+    return Tree_algo_::lower_bound<false, false, true>(
+      tree_and_alloc_.tree,
+      [&pos](Size_ const& offset) -> Compare_result_
+      {
+        return pos < offset ?
+          Compare_result_::greater : Compare_result_::less;
+      });
+  }
+
+  [[nodiscard]] Node_* at_(Size_ const& pos) const
+  {
+    Node_* const node = find_(pos);
+    if(!node)
+    {
+      throw ::std::out_of_range(
+        "treexx::stdxx::sparse_sequence_map: position");
+    }
+
+    return node;
+  }
+
+  // The last element at or before pos, found from the finger, which moves
+  // there. Null when pos precedes all the elements; the finger stays then.
+  [[nodiscard]] Node_* seek_(finger& f, Size_ const& pos) const noexcept
+  {
+    Tree_ const& tree = tree_and_alloc_.tree;
+    if(!f.node_)
+    {
+      Node_* const root = tree.root();
+      if(!root)
+      {
+        return nullptr;
+      }
+
+      f.node_ = root;
+      f.pos_ = Tree_static_::offset(*root);
+    }
+
+    Size_ node_pos(f.pos_);
+    Node_* const node = Tree_algo_::seek_offset(tree, f.node_, node_pos, pos);
+    if(node)
+    {
+      f.node_ = node;
+      f.pos_ = node_pos;
+    }
+
+    return node;
+  }
+
+  [[nodiscard]] Size_ last_position_() const noexcept
+  {
+    Tree_ const& tree = tree_and_alloc_.tree;
+    Node_* const node = tree.template extreme<Side_::right>();
+    TREEXX_ASSERT(node);
+    return Tree_algo_::node_offset(tree, *node);
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Tree_and_alloc_ tree_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_SPARSESEQUENCEMAP_HH
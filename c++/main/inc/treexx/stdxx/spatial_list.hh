@@ -31,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <treexx/assert.hh>
 #include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
 #include <treexx/bin/avl/balance.hh>
 #include <treexx/bin/avl/tree_algo.hh>
 
@@ -133,6 +134,18 @@ struct spatial_list
   using difference_type = ::std::ptrdiff_t;
   using size_type = ::std::size_t;
 
+  spatial_list() = default;
+  spatial_list(spatial_list&&) = delete;
+  spatial_list(spatial_list const&) = delete;
+
+  ~spatial_list()
+  {
+    clear();
+  }
+
+  spatial_list& operator =(spatial_list&&) = delete;
+  spatial_list& operator =(spatial_list const&) = delete;
+
   [[nodiscard]] bool empty() const noexcept
   {
     return tree_and_alloc_.tree.empty();
@@ -167,6 +180,7 @@ struct spatial_list
     Tree_algo_::push_back(tree, node_ptr, offset);
     node.release();
     tree.increment_size();
+    tree.increment_version();
     return node_ptr->value;
   }
 
@@ -187,6 +201,7 @@ struct spatial_list
 
     node.release();
     tree.increment_size();
+    tree.increment_version();
     return node_ptr->value;
   }
 
@@ -210,6 +225,18 @@ struct spatial_list
     return emplace_front(val);
   }
 
+  void clear() noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
 private:
   using Side_ = ::treexx::bin::Side;
   using Balance_ = ::treexx::bin::avl::Balance;
@@ -423,7 +450,76 @@ public:
     return Tree_algo_::at_index(tree_and_alloc_.tree, idx);
   }
 
+  // Element covering offset off, or end(). The element found is remembered,
+  // and while the list stays unchanged the next search starts from it, so
+  // that a lookup near the previous one, as when a viewport scrolls between
+  // frames, takes a few steps instead of a descent from the root.
+  [[nodiscard]] iterator find_offset(spatial_size_type const& off) noexcept
+  {
+    Tree_ const& tree = tree_and_alloc_.tree;
+    Finger_& finger = finger_;
+    if(!finger.node || tree.version() != finger.version)
+    {
+      finger.node = tree.root();
+      if(!finger.node)
+      {
+        return end();
+      }
+
+      finger.offset = Tree_static_::offset(*finger.node);
+      finger.version = tree.version();
+    }
+
+    Node_* const node =
+      Tree_algo_::seek_offset(tree, finger.node, finger.offset, off);
+    if(!node)
+    {
+      return end();
+    }
+
+    finger.node = node;
+    return covers_(*node, finger.offset, off) ? node : nullptr;
+  }
+
+  [[nodiscard]] const_iterator find_offset(
+    spatial_size_type const& off) const noexcept
+  {
+    Tree_ const& tree = tree_and_alloc_.tree;
+    Node_* const root = tree.root();
+    if(!root)
+    {
+      return end();
+    }
+
+    Spatial_size_ offset = Tree_static_::offset(*root);
+    Node_* const node = Tree_algo_::seek_offset(tree, root, offset, off);
+    return node && covers_(*node, offset, off) ? node : nullptr;
+  }
+
 private:
+  // Last element found by find_offset, its absolute offset, and the version
+  // of the tree it was found in.
+  struct Finger_
+  {
+    Finger_() noexcept :
+      node(nullptr),
+      offset(static_cast<Spatial_size_>(0u)),
+      version(static_cast<Size_>(0u))
+    {}
+
+    Node_* node;
+    Spatial_size_ offset;
+    Size_ version;
+  };
+
+  [[nodiscard]] static bool covers_(
+    Node_ const& node,
+    Spatial_size_ const& node_offset,
+    Spatial_size_ const& off) noexcept
+  {
+    return !(off < node_offset) && off - node_offset < node.value.size();
+  }
+
   struct Unique_node_
   {
     using Ptr = typename Node_allocator_traits_::pointer;
@@ -631,7 +727,8 @@ private:
       root_(nullptr),
       leftmost_(nullptr),
       rightmost_(nullptr),
-      size_(static_cast<size_type>(0u))
+      size_(static_cast<size_type>(0u)),
+      version_(static_cast<size_type>(0u))
     {}
 
     [[nodiscard]] Node_* root() const noexcept
@@ -687,11 +784,33 @@ private:
       ++size_;
     }
 
+    // Drops all the nodes; the version moves on so that no finger survives.
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+      ++version_;
+    }
+
+    // Changes with every mutation that may move nodes or their offsets.
+    [[nodiscard]] Size_ version() const noexcept
+    {
+      return version_;
+    }
+
+    void increment_version() noexcept
+    {
+      ++version_;
+    }
+
   private:
     Node_* root_;
     Node_* leftmost_;
     Node_* rightmost_;
     Size_ size_;
+    Size_ version_;
   };
 
   struct Tree_and_alloc_ : Allocator_base_
@@ -699,7 +818,16 @@ private:
     Tree_ tree;
   };
 
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
   Tree_and_alloc_ tree_and_alloc_;
+  Finger_ finger_;
 };
 
 } // namespace treexx::stdxx
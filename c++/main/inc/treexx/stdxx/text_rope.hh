@@ -0,0 +1,1046 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_TEXTROPE_HH
+#define TREEXX_STDXX_TEXTROPE_HH
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace treexx::stdxx
+{
+
+template<
+  class C = char,
+  bool line_indexed = false,
+  class A = ::std::allocator<C>>
+struct text_rope
+{
+  using value_type = C;
+  using traits_type = ::std::char_traits<value_type>;
+  using allocator_type = A;
+  using size_type = ::std::size_t;
+  using string_type =
+    ::std::basic_string<value_type, traits_type, allocator_type>;
+  using string_view_type = ::std::basic_string_view<value_type, traits_type>;
+
+  static size_type constexpr npos = static_cast<size_type>(-1);
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Char_ = value_type;
+  using Size_ = size_type;
+  using String_ = string_type;
+  using String_view_ = string_view_type;
+
+  template<bool, class = void>
+  struct Enable_if_
+  {};
+
+  template<class T>
+  struct Enable_if_<true, T>
+  {
+    using Type = T;
+  };
+
+  template<class Node>
+  struct Node_base_
+  {
+    Node* parent;
+    Node* left_child;
+    Node* right_child;
+    Size_ offset;
+    Balance_ balance;
+    Side_ side;
+  };
+
+  struct Piece_ : Node_base_<Piece_>
+  {
+    Piece_(Size_ const s, Size_ const len) noexcept :
+      start(s),
+      length(len)
+    {}
+
+    Size_ start;
+    Size_ length;
+  };
+
+  struct Newline_ : Node_base_<Newline_>
+  {
+    Size_ index;
+  };
+
+  template<class Node>
+  struct Tree_static_base_
+  {
+    using Offset = Size_;
+
+    [[nodiscard]] static Node* address(Node* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node* parent(Node const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node* child(Node const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Node const& n) noexcept
+    {
+      return n.side;
+    }
+
+    [[nodiscard]] static Offset const& offset(Node const& n) noexcept
+    {
+      return n.offset;
+    }
+
+    static void set_parent(Node& n, Node* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Node& n, Node* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Node& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Node& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+
+    static void set_offset(Node& n, Offset const& o) noexcept
+    {
+      n.offset = o;
+    }
+
+    static void add_to_offset(Node& n, Offset const& o) noexcept
+    {
+      n.offset += o;
+    }
+
+    static void subtract_from_offset(Node& n, Offset const& o) noexcept
+    {
+      n.offset -= o;
+    }
+
+    template<unsigned o>
+    [[nodiscard]] static Offset make_offset() noexcept
+    {
+      return static_cast<Offset>(o);
+    }
+  };
+
+  struct Piece_tree_static_ : Tree_static_base_<Piece_>
+  {};
+
+  struct Newline_tree_static_ : Tree_static_base_<Newline_>
+  {
+    using Index = Size_;
+
+    [[nodiscard]] static Index const& index(Newline_ const& n) noexcept
+    {
+      return n.index;
+    }
+
+    static void increment_index(Newline_& n) noexcept
+    {
+      ++n.index;
+    }
+
+    static void decrement_index(Newline_& n) noexcept
+    {
+      --n.index;
+    }
+
+    static void add_to_index(Newline_& n, Index const& i) noexcept
+    {
+      n.index += i;
+    }
+
+    static void subtract_from_index(Newline_& n, Index const& i) noexcept
+    {
+      n.index -= i;
+    }
+
+    static void set_index(Newline_& n, Index const& i) noexcept
+    {
+      n.index = i;
+    }
+
+    template<unsigned i>
+    static void set_index(Newline_& n) noexcept
+    {
+      n.index = static_cast<Index>(i);
+    }
+
+    template<unsigned i>
+    [[nodiscard]] static Index make_index() noexcept
+    {
+      return static_cast<Index>(i);
+    }
+  };
+
+  template<class Node, class Static>
+  struct Tree_ : Static
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Node* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    void increment_size() noexcept
+    {
+      ++size_;
+    }
+
+    void decrement_size() noexcept
+    {
+      --size_;
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+  private:
+    Node* root_;
+    Node* leftmost_;
+    Node* rightmost_;
+    Size_ size_;
+  };
+
+  using Piece_tree_ = Tree_<Piece_, Piece_tree_static_>;
+  using Newline_tree_ = Tree_<Newline_, Newline_tree_static_>;
+
+  struct No_line_index_
+  {
+    void swap(No_line_index_&) noexcept
+    {}
+  };
+
+  struct Line_index_
+  {
+    void swap(Line_index_& x) noexcept
+    {
+      newlines.swap(x.newlines);
+    }
+
+    Newline_tree_ newlines;
+  };
+
+  using Line_index_base_ = typename ::std::conditional<
+    line_indexed, Line_index_, No_line_index_>::type;
+
+  struct Piece_location_
+  {
+    Piece_* piece;
+    Size_ offset;
+  };
+
+  using Allocator_traits_ = ::std::allocator_traits<allocator_type>;
+
+  template<class Node>
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node>;
+
+  template<class Node>
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_<Node>>;
+
+public:
+  text_rope() = default;
+
+  explicit text_rope(allocator_type const& alloc) :
+    buffer_(alloc)
+  {}
+
+  explicit text_rope(
+    string_view_type const text,
+    allocator_type const& alloc = allocator_type()) :
+    buffer_(alloc)
+  {
+    append(text);
+  }
+
+  text_rope(text_rope&& x) noexcept :
+    buffer_(static_cast<String_&&>(x.buffer_)),
+    size_(x.size_)
+  {
+    pieces_.swap(x.pieces_);
+    line_index_.swap(x.line_index_);
+    x.size_ = static_cast<Size_>(0u);
+  }
+
+  text_rope(text_rope const& x) :
+    buffer_(
+      Allocator_traits_::select_on_container_copy_construction(
+        x.buffer_.get_allocator()))
+  {
+    buffer_.reserve(x.size_);
+    x.for_each_span(
+      static_cast<Size_>(0u),
+      x.size_,
+      [this](string_view_type const span)
+      {
+        buffer_.append(span);
+      });
+    if(0u < buffer_.size())
+    {
+      Newline_batch_ newlines(*this);
+      if constexpr(line_indexed)
+      {
+        allocate_newlines_(String_view_(buffer_), newlines);
+      }
+
+      Piece_* const piece = create_node_<Piece_>(
+        static_cast<Size_>(0u), buffer_.size());
+      Tree_algo_::push_back(pieces_, piece, static_cast<Size_>(0u));
+      pieces_.increment_size();
+      size_ = buffer_.size();
+      if constexpr(line_indexed)
+      {
+        index_newlines_(
+          static_cast<Size_>(0u), String_view_(buffer_), newlines);
+      }
+    }
+  }
+
+  ~text_rope()
+  {
+    clear();
+  }
+
+  text_rope& operator =(text_rope&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      swap(x);
+    }
+
+    return *this;
+  }
+
+  text_rope& operator =(text_rope const& x)
+  {
+    if(this != ::std::addressof(x))
+    {
+      text_rope y(x);
+      swap(y);
+    }
+
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const
+  {
+    return buffer_.get_allocator();
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return 1u > size_;
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return size_;
+  }
+
+  [[nodiscard]] size_type piece_count() const noexcept
+  {
+    return pieces_.size();
+  }
+
+  [[nodiscard]] value_type operator [](size_type const& pos) const noexcept
+  {
+    TREEXX_ASSERT(pos < size_);
+    Piece_location_ const loc(find_piece_(pos));
+    return buffer_[loc.piece->start + (pos - loc.offset)];
+  }
+
+  [[nodiscard]] value_type at(size_type const& pos) const
+  {
+    if(size_ <= pos)
+    {
+      throw ::std::out_of_range("treexx::stdxx::text_rope: position");
+    }
+
+    return (*this)[pos];
+  }
+
+  template<class Fun>
+  void for_each_span(size_type pos, size_type count, Fun&& fun) const
+  {
+    TREEXX_ASSERT(pos <= size_);
+    if(size_ - pos < count)
+    {
+      count = size_ - pos;
+    }
+    if(1u > count)
+    {
+      return;
+    }
+
+    Piece_location_ const loc(find_piece_(pos));
+    Size_ rel_pos = pos - loc.offset;
+    for(Piece_* piece = loc.piece;;)
+    {
+      TREEXX_ASSERT(piece);
+      TREEXX_ASSERT(rel_pos < piece->length);
+      Size_ span_size = piece->length - rel_pos;
+      if(count < span_size)
+      {
+        span_size = count;
+      }
+
+      static_cast<Fun&&>(fun)(
+        String_view_(buffer_.data() + piece->start + rel_pos, span_size));
+      count -= span_size;
+      if(1u > count)
+      {
+        break;
+      }
+
+      piece = Tree_algo_::next_node(pieces_, *piece);
+      rel_pos = static_cast<Size_>(0u);
+    }
+  }
+
+  [[nodiscard]] string_type substr(
+    size_type const& pos,
+    size_type const& count = npos) const
+  {
+    if(size_ < pos)
+    {
+      throw ::std::out_of_range("treexx::stdxx::text_rope: position");
+    }
+
+    String_ str(buffer_.get_allocator());
+    for_each_span(
+      pos,
+      count,
+      [&str](string_view_type const span)
+      {
+        str.append(span);
+      });
+    return str;
+  }
+
+  [[nodiscard]] string_type str() const
+  {
+    return substr(static_cast<Size_>(0u));
+  }
+
+  void append(string_view_type const text)
+  {
+    insert(size_, text);
+  }
+
+  void insert(size_type const& pos, string_view_type const text)
+  {
+    if(size_ < pos)
+    {
+      throw ::std::out_of_range("treexx::stdxx::text_rope: position");
+    }
+
+    Size_ const count(text.size());
+    if(1u > count)
+    {
+      return;
+    }
+
+    // Everything that may throw happens before the first change to the
+    // trees: the newline nodes are allocated up front, and each branch below
+    // creates its pieces before linking any. Text appended to the buffer
+    // stays unreferenced if a later allocation fails.
+    Newline_batch_ newlines(*this);
+    if constexpr(line_indexed)
+    {
+      allocate_newlines_(text, newlines);
+    }
+
+    Size_ const start(buffer_.size());
+    buffer_.append(text);
+
+    if(size_ == pos)
+    {
+      Piece_* const last = pieces_.template extreme<Side_::right>();
+      if(last && start == last->start + last->length)
+      {
+        last->length += count;
+      }
+      else
+      {
+        Piece_* const piece = create_node_<Piece_>(start, count);
+        Tree_algo_::push_back(
+          pieces_, piece, last ? last->length : static_cast<Size_>(0u));
+        pieces_.increment_size();
+      }
+    }
+    else
+    {
+      Piece_location_ const loc(find_piece_(pos));
+      Piece_* const piece = loc.piece;
+      Size_ const rel_pos(pos - loc.offset);
+      if(1u > rel_pos)
+      {
+        Piece_* const prev = Tree_algo_::previous_node(pieces_, *piece);
+        if(prev && start == prev->start + prev->length)
+        {
+          prev->length += count;
+          Tree_algo_::shift_suffix<Side_::right>(pieces_, *piece, count);
+        }
+        else
+        {
+          Piece_* const new_piece = create_node_<Piece_>(start, count);
+          Tree_algo_::insert_at_offset(pieces_, new_piece, pos, count);
+          pieces_.increment_size();
+        }
+      }
+      else
+      {
+        Unique_node_<Piece_> tail(
+          create_node_<Piece_>(
+            piece->start + rel_pos,
+            piece->length - rel_pos),
+          *this);
+        Piece_* const new_piece = create_node_<Piece_>(start, count);
+        piece->length = rel_pos;
+        Tree_algo_::insert_at_offset(pieces_, new_piece, pos, count);
+        pieces_.increment_size();
+        Tree_algo_::insert_at_offset(pieces_, tail.release(), pos + count);
+        pieces_.increment_size();
+      }
+    }
+
+    if constexpr(line_indexed)
+    {
+      shift_newlines_<Side_::right>(pos, count);
+      index_newlines_(pos, text, newlines);
+    }
+
+    size_ += count;
+  }
+
+  void erase(size_type const& pos, size_type count = npos)
+  {
+    if(size_ < pos)
+    {
+      throw ::std::out_of_range("treexx::stdxx::text_rope: position");
+    }
+
+    if(size_ - pos < count)
+    {
+      count = size_ - pos;
+    }
+    if(1u > count)
+    {
+      return;
+    }
+
+    Piece_location_ loc(find_piece_(pos));
+    Size_ rel_pos(pos - loc.offset);
+    if(0u < rel_pos && rel_pos + count < loc.piece->length)
+    {
+      Piece_* const piece = loc.piece;
+      Piece_* const tail = create_node_<Piece_>(
+        piece->start + rel_pos + count,
+        piece->length - rel_pos - count);
+      Piece_* const next = Tree_algo_::next_node(pieces_, *piece);
+      piece->length = rel_pos;
+      if(next)
+      {
+        Tree_algo_::shift_suffix<Side_::left>(pieces_, *next, count);
+      }
+
+      Tree_algo_::insert_at_offset(pieces_, tail, pos);
+      pieces_.increment_size();
+    }
+    else
+    {
+      for(Size_ left_count = count;;)
+      {
+        Piece_* const piece = loc.piece;
+        Size_ const piece_length(piece->length);
+        Size_ erase_count(piece_length - rel_pos);
+        if(left_count < erase_count)
+        {
+          erase_count = left_count;
+        }
+
+        if(erase_count == piece_length)
+        {
+          Tree_algo_::erase_and_shift(pieces_, piece);
+          pieces_.decrement_size();
+          destroy_node_(piece);
+        }
+        else
+        {
+          Piece_* const next = Tree_algo_::next_node(pieces_, *piece);
+          if(1u > rel_pos)
+          {
+            piece->start += erase_count;
+          }
+
+          piece->length -= erase_count;
+          if(next)
+          {
+            Tree_algo_::shift_suffix<Side_::left>(pieces_, *next, erase_count);
+          }
+        }
+
+        left_count -= erase_count;
+        if(1u > left_count)
+        {
+          break;
+        }
+
+        loc = find_piece_(pos);
+        rel_pos = pos - loc.offset;
+      }
+    }
+
+    if constexpr(line_indexed)
+    {
+      erase_newlines_(pos, count);
+    }
+
+    size_ -= count;
+  }
+
+  void clear() noexcept
+  {
+    ::treexx::bin::Tree_algo::clear(
+      pieces_,
+      [this](Piece_* const piece) noexcept
+      {
+        destroy_node_(piece);
+      });
+    pieces_.reset();
+    if constexpr(line_indexed)
+    {
+      Newline_tree_& newlines = line_index_.newlines;
+      ::treexx::bin::Tree_algo::clear(
+        newlines,
+        [this](Newline_* const newline) noexcept
+        {
+          destroy_node_(newline);
+        });
+      newlines.reset();
+    }
+
+    buffer_.clear();
+    size_ = static_cast<Size_>(0u);
+  }
+
+  void swap(text_rope& x) noexcept
+  {
+    buffer_.swap(x.buffer_);
+    pieces_.swap(x.pieces_);
+    line_index_.swap(x.line_index_);
+    Size_ const size(size_);
+    size_ = x.size_;
+    x.size_ = size;
+  }
+
+  friend void swap(text_rope& x, text_rope& y) noexcept
+  {
+    x.swap(y);
+  }
+
+  template<bool e = line_indexed, class = typename Enable_if_<e>::Type>
+  [[nodiscard]] size_type line_count() const noexcept
+  {
+    return line_index_.newlines.size() + 1u;
+  }
+
+  template<bool e = line_indexed, class = typename Enable_if_<e>::Type>
+  [[nodiscard]] size_type line_of(size_type const& pos) const noexcept
+  {
+    TREEXX_ASSERT(pos <= size_);
+    Newline_tree_ const& newlines = line_index_.newlines;
+    Size_ line(newlines.size());
+    static_cast<void>(Tree_algo_::lower_bound<false, true, true>(
+      newlines,
+      [&pos, &line](
+        Size_ const& index,
+        Size_ const& offset) noexcept -> Compare_result_
+      {
+        if(offset < pos)
+        {
+          return Compare_result_::less;
+        }
+
+        line = index;
+        return Compare_result_::greater;
+      }));
+    return line;
+  }
+
+  template<bool e = line_indexed, class = typename Enable_if_<e>::Type>
+  [[nodiscard]] size_type line_start(size_type const& line) const noexcept
+  {
+    TREEXX_ASSERT(line < line_count());
+    if(1u > line)
+    {
+      return static_cast<Size_>(0u);
+    }
+
+    Size_ const newline_index(line - 1u);
+    Size_ newline_offset(static_cast<Size_>(0u));
+    static_cast<void>(Tree_algo_::binary_search<false, true, true>(
+      line_index_.newlines,
+      [&newline_index, &newline_offset](
+        Size_ const& index,
+        Size_ const& offset) noexcept -> Compare_result_
+      {
+        if(index < newline_index)
+        {
+          return Compare_result_::less;
+        }
+        if(newline_index < index)
+        {
+          return Compare_result_::greater;
+        }
+
+        newline_offset = offset;
+        return Compare_result_::equal;
+      }));
+    return newline_offset + 1u;
+  }
+
+private:
+  template<class Node>
+  struct Unique_node_
+  {
+    Unique_node_(Node* const n, text_rope& r) noexcept :
+      node_(n),
+      rope_(r)
+    {}
+
+    Unique_node_(Unique_node_&&) = delete;
+    Unique_node_(Unique_node_ const&) = delete;
+
+    ~Unique_node_()
+    {
+      if(node_)
+      {
+        rope_.destroy_node_(node_);
+      }
+    }
+
+    Unique_node_& operator =(Unique_node_&&) = delete;
+    Unique_node_& operator =(Unique_node_ const&) = delete;
+
+    [[nodiscard]] Node* release() noexcept
+    {
+      Node* const n = node_;
+      node_ = nullptr;
+      return n;
+    }
+
+  private:
+    Node* node_;
+    text_rope& rope_;
+  };
+
+  // Newline nodes allocated ahead of an edit and chained through their
+  // parent links. The ones not linked into the index are freed on exit.
+  struct Newline_batch_
+  {
+    explicit Newline_batch_(text_rope& r) noexcept :
+      head_(nullptr),
+      rope_(r)
+    {}
+
+    Newline_batch_(Newline_batch_&&) = delete;
+    Newline_batch_(Newline_batch_ const&) = delete;
+
+    ~Newline_batch_()
+    {
+      while(head_)
+      {
+        rope_.destroy_node_(pop());
+      }
+    }
+
+    Newline_batch_& operator =(Newline_batch_&&) = delete;
+    Newline_batch_& operator =(Newline_batch_ const&) = delete;
+
+    void push(Newline_* const n) noexcept
+    {
+      n->parent = head_;
+      head_ = n;
+    }
+
+    [[nodiscard]] Newline_* pop() noexcept
+    {
+      Newline_* const n = head_;
+      TREEXX_ASSERT(n);
+      head_ = n->parent;
+      n->parent = nullptr;
+      return n;
+    }
+
+  private:
+    Newline_* head_;
+    text_rope& rope_;
+  };
+
+  [[nodiscard]] Piece_location_ find_piece_(Size_ const& pos) const noexcept
+  {
+    TREEXX_ASSERT(pos < size_);
+    Piece_location_ loc{nullptr, static_cast<Size_>(0u)};
+    static_cast<void>(Tree_algo_::upper_bound<true, false, true>(
+      pieces_,
+      [&pos, &loc](Piece_& piece, Size_ const& offset) noexcept ->
+        Compare_result_
+      {
+        if(pos < offset)
+        {
+          return Compare_result_::greater;
+        }
+
+        loc.piece = ::std::addressof(piece);
+        loc.offset = offset;
+        return Compare_result_::less;
+      }));
+    TREEXX_ASSERT(loc.piece);
+    TREEXX_ASSERT(pos - loc.offset < loc.piece->length);
+    return loc;
+  }
+
+  template<Side_ side>
+  void shift_newlines_(Size_ const& pos, Size_ const& shift) noexcept
+  {
+    Newline_tree_& newlines = line_index_.newlines;
+    Newline_* const newline = Tree_algo_::lower_bound<false, false, true>(
+      newlines,
+      [&pos](Size_ const& offset) noexcept -> Compare_result_
+      {
+        return offset < pos ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+    if(newline)
+    {
+      Tree_algo_::shift_suffix<side>(newlines, *newline, shift);
+    }
+  }
+
+  void allocate_newlines_(String_view_ const text, Newline_batch_& batch)
+  {
+    Char_ const newline_char = static_cast<Char_>('\n');
+    for(Size_ i = text.find(newline_char);
+      String_view_::npos != i;
+      i = text.find(newline_char, i + 1u))
+    {
+      batch.push(create_node_<Newline_>());
+    }
+  }
+
+  // Links a node of batch for every newline of text, which starts at pos.
+  void index_newlines_(
+    Size_ const& pos,
+    String_view_ const text,
+    Newline_batch_& batch) noexcept
+  {
+    Newline_tree_& newlines = line_index_.newlines;
+    Char_ const newline_char = static_cast<Char_>('\n');
+    for(Size_ i = text.find(newline_char);
+      String_view_::npos != i;
+      i = text.find(newline_char, i + 1u))
+    {
+      Tree_algo_::insert_at_offset(newlines, batch.pop(), pos + i);
+      newlines.increment_size();
+    }
+  }
+
+  void erase_newlines_(Size_ const& pos, Size_ const& count) noexcept
+  {
+    Newline_tree_& newlines = line_index_.newlines;
+    Size_ const end_pos(pos + count);
+    Newline_* newline = Tree_algo_::lower_bound<false, false, true>(
+      newlines,
+      [&pos](Size_ const& offset) noexcept -> Compare_result_
+      {
+        return offset < pos ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+    Newline_* const end_newline = Tree_algo_::lower_bound<false, false, true>(
+      newlines,
+      [&end_pos](Size_ const& offset) noexcept -> Compare_result_
+      {
+        return offset < end_pos ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+
+    while(end_newline != newline)
+    {
+      TREEXX_ASSERT(newline);
+      Newline_* const next = Tree_algo_::next_node(newlines, *newline);
+      Tree_algo_::erase(newlines, newline);
+      newlines.decrement_size();
+      destroy_node_(newline);
+      newline = next;
+    }
+
+    if(end_newline)
+    {
+      Tree_algo_::shift_suffix<Side_::left>(newlines, *end_newline, count);
+    }
+  }
+
+  template<class Node, class... Args>
+  [[nodiscard]] Node* create_node_(Args&&... args)
+  {
+    using Traits = Node_allocator_traits_<Node>;
+    Node_allocator_<Node> alloc(buffer_.get_allocator());
+    Node* const node = Traits::allocate(alloc, 1u);
+    Traits::construct(alloc, node, static_cast<Args&&>(args)...);
+    return node;
+  }
+
+  template<class Node>
+  void destroy_node_(Node* const node) noexcept
+  {
+    using Traits = Node_allocator_traits_<Node>;
+    TREEXX_ASSERT(node);
+    Node_allocator_<Node> alloc(buffer_.get_allocator());
+    Traits::destroy(alloc, node);
+    Traits::deallocate(alloc, node, 1u);
+  }
+
+  String_ buffer_;
+  Piece_tree_ pieces_;
+  Line_index_base_ line_index_;
+  Size_ size_ = static_cast<Size_>(0u);
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_TEXTROPE_HH
@@ -0,0 +1,679 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef TREEXX_STDXX_TIMERQUEUE_HH
+#define TREEXX_STDXX_TIMERQUEUE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace treexx::stdxx
+{
+
+template<
+  class T,
+  class D = ::std::int64_t,
+  class A = ::std::allocator<T>>
+struct timer_queue
+{
+  using value_type = T;
+  using duration_type = D;
+  using allocator_type = A;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+  using size_type = ::std::size_t;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Value_ = value_type;
+  using Duration_ = duration_type;
+  using Size_ = size_type;
+
+  struct Bucket_;
+
+  struct Timer_
+  {
+    template<class... Args>
+    explicit Timer_(Args&&... args) :
+      value(static_cast<Args&&>(args)...)
+    {}
+
+    Timer_* prev;
+    Timer_* next;
+    Bucket_* bucket;
+    Value_ value;
+  };
+
+  struct Bucket_
+  {
+    Bucket_() noexcept :
+      first(nullptr),
+      last(nullptr)
+    {}
+
+    Bucket_* parent;
+    Bucket_* left_child;
+    Bucket_* right_child;
+    Duration_ offset;
+    Balance_ balance;
+    Side_ side;
+    Timer_* first;
+    Timer_* last;
+  };
+
+  struct Tree_static_
+  {
+    using Offset = Duration_;
+
+    [[nodiscard]] static Bucket_* address(Bucket_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Bucket_* parent(Bucket_ const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Bucket_* child(Bucket_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Bucket_ const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Bucket_ const& n) noexcept
+    {
+      return n.side;
+    }
+
+    [[nodiscard]] static Offset const& offset(Bucket_ const& n) noexcept
+    {
+      return n.offset;
+    }
+
+    static void set_parent(Bucket_& n, Bucket_* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Bucket_& n, Bucket_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Bucket_& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Bucket_& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+
+    static void set_offset(Bucket_& n, Offset const& o) noexcept
+    {
+      n.offset = o;
+    }
+
+    static void add_to_offset(Bucket_& n, Offset const& o) noexcept
+    {
+      n.offset += o;
+    }
+
+    static void subtract_from_offset(Bucket_& n, Offset const& o) noexcept
+    {
+      n.offset -= o;
+    }
+
+    template<unsigned o>
+    [[nodiscard]] static Offset make_offset() noexcept
+    {
+      return static_cast<Offset>(o);
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u))
+    {}
+
+    [[nodiscard]] Bucket_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Bucket_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Bucket_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Bucket_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    [[nodiscard]] Size_ size() const noexcept
+    {
+      return size_;
+    }
+
+    void increment_size() noexcept
+    {
+      ++size_;
+    }
+
+    void decrement_size() noexcept
+    {
+      --size_;
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+  private:
+    Bucket_* root_;
+    Bucket_* leftmost_;
+    Bucket_* rightmost_;
+    Size_ size_;
+  };
+
+  using Allocator_traits_ = ::std::allocator_traits<allocator_type>;
+
+  template<class Node>
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node>;
+
+  template<class Node>
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_<Node>>;
+
+public:
+  struct handle
+  {
+    handle() noexcept :
+      timer_(nullptr)
+    {}
+
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+      return timer_ ? true : false;
+    }
+
+    [[nodiscard]] reference operator *() const noexcept
+    {
+      TREEXX_ASSERT(timer_);
+      return timer_->value;
+    }
+
+    [[nodiscard]] value_type* operator ->() const noexcept
+    {
+      TREEXX_ASSERT(timer_);
+      return ::std::addressof(timer_->value);
+    }
+
+    [[nodiscard]] friend bool operator ==(
+      handle const& x,
+      handle const& y) noexcept
+    {
+      return x.timer_ == y.timer_;
+    }
+
+    [[nodiscard]] friend bool operator !=(
+      handle const& x,
+      handle const& y) noexcept
+    {
+      return x.timer_ != y.timer_;
+    }
+
+  private:
+    friend struct timer_queue;
+
+    explicit handle(Timer_* const t) noexcept :
+      timer_(t)
+    {}
+
+    Timer_* timer_;
+  };
+
+  timer_queue() = default;
+
+  explicit timer_queue(allocator_type const& alloc) :
+    alloc_(alloc)
+  {}
+
+  timer_queue(timer_queue&& x) noexcept :
+    alloc_(x.alloc_),
+    size_(x.size_)
+  {
+    buckets_.swap(x.buckets_);
+    x.size_ = static_cast<Size_>(0u);
+  }
+
+  timer_queue(timer_queue const&) = delete;
+
+  ~timer_queue()
+  {
+    clear();
+  }
+
+  timer_queue& operator =(timer_queue&& x) noexcept
+  {
+    if(this != ::std::addressof(x))
+    {
+      clear();
+      swap(x);
+    }
+
+    return *this;
+  }
+
+  timer_queue& operator =(timer_queue const&) = delete;
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept
+  {
+    return alloc_;
+  }
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return 1u > size_;
+  }
+
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return size_;
+  }
+
+  [[nodiscard]] size_type deadline_count() const noexcept
+  {
+    return buckets_.size();
+  }
+
+  [[nodiscard]] duration_type next_deadline() const noexcept
+  {
+    Bucket_* const bucket = buckets_.template extreme<Side_::left>();
+    TREEXX_ASSERT(bucket);
+    return Tree_static_::offset(*bucket);
+  }
+
+  [[nodiscard]] handle next() const noexcept
+  {
+    Bucket_* const bucket = buckets_.template extreme<Side_::left>();
+    return handle(bucket ? bucket->first : nullptr);
+  }
+
+  [[nodiscard]] duration_type deadline(handle const& h) const noexcept
+  {
+    TREEXX_ASSERT(h.timer_);
+    return Tree_algo_::node_offset(buckets_, *h.timer_->bucket);
+  }
+
+  template<class... Args>
+  handle emplace(duration_type const& deadline, Args&&... args)
+  {
+    Timer_* const timer = create_node_<Timer_>(static_cast<Args&&>(args)...);
+    try
+    {
+      schedule_(timer, deadline);
+    }
+    catch(...)
+    {
+      destroy_node_(timer);
+      throw;
+    }
+
+    ++size_;
+    return handle(timer);
+  }
+
+  handle schedule(duration_type const& deadline, value_type&& val)
+  {
+    return emplace(deadline, static_cast<value_type&&>(val));
+  }
+
+  handle schedule(duration_type const& deadline, value_type const& val)
+  {
+    return emplace(deadline, val);
+  }
+
+  void cancel(handle const& h) noexcept
+  {
+    Timer_* const timer = h.timer_;
+    TREEXX_ASSERT(timer);
+    unlink_(timer);
+    --size_;
+    destroy_node_(timer);
+  }
+
+  void reschedule(handle const& h, duration_type const& deadline)
+  {
+    Timer_* const timer = h.timer_;
+    TREEXX_ASSERT(timer);
+    unlink_(timer);
+    try
+    {
+      schedule_(timer, deadline);
+    }
+    catch(...)
+    {
+      --size_;
+      destroy_node_(timer);
+      throw;
+    }
+  }
+
+  void postpone(duration_type const& from, duration_type const& delay) noexcept
+  {
+    TREEXX_ASSERT(!(delay < Tree_static_::template make_offset<0u>()));
+    Bucket_* const bucket = Tree_algo_::lower_bound<false, false, true>(
+      buckets_,
+      [&from](Duration_ const& offset) -> Compare_result_
+      {
+        return offset < from ?
+          Compare_result_::less : Compare_result_::greater;
+      });
+    if(bucket)
+    {
+      Tree_algo_::shift_suffix<Side_::right>(buckets_, *bucket, delay);
+    }
+  }
+
+  void postpone_all(duration_type const& delay) noexcept
+  {
+    TREEXX_ASSERT(!(delay < Tree_static_::template make_offset<0u>()));
+    Bucket_* const bucket = buckets_.template extreme<Side_::left>();
+    if(bucket)
+    {
+      Tree_algo_::shift_suffix<Side_::right>(buckets_, *bucket, delay);
+    }
+  }
+
+  template<class Fun>
+  size_type expire(duration_type const& now, Fun&& fun)
+  {
+    Size_ count = static_cast<Size_>(0u);
+    for(;;)
+    {
+      Bucket_* const bucket = buckets_.template extreme<Side_::left>();
+      if(!bucket)
+      {
+        break;
+      }
+
+      Duration_ const deadline(Tree_static_::offset(*bucket));
+      if(now < deadline)
+      {
+        break;
+      }
+
+      Timer_* const timer = bucket->first;
+      TREEXX_ASSERT(timer);
+      unlink_(timer);
+      --size_;
+      Unique_timer_ const unique_timer(timer, *this);
+      ++count;
+      static_cast<Fun&&>(fun)(deadline, timer->value);
+    }
+
+    return count;
+  }
+
+  void clear() noexcept
+  {
+    ::treexx::bin::Tree_algo::clear(
+      buckets_,
+      [this](Bucket_* const bucket) noexcept
+      {
+        for(Timer_* timer = bucket->first; timer;)
+        {
+          Timer_* const next = timer->next;
+          destroy_node_(timer);
+          timer = next;
+        }
+
+        destroy_node_(bucket);
+      });
+    buckets_.reset();
+    size_ = static_cast<Size_>(0u);
+  }
+
+  void swap(timer_queue& x) noexcept
+  {
+    buckets_.swap(x.buckets_);
+    Size_ const size(size_);
+    size_ = x.size_;
+    x.size_ = size;
+    if constexpr(Allocator_traits_::propagate_on_container_swap::value)
+    {
+      using ::std::swap;
+      swap(alloc_, x.alloc_);
+    }
+  }
+
+  friend void swap(timer_queue& x, timer_queue& y) noexcept
+  {
+    x.swap(y);
+  }
+
+private:
+  struct Unique_timer_
+  {
+    Unique_timer_(Timer_* const t, timer_queue& q) noexcept :
+      timer_(t),
+      queue_(q)
+    {}
+
+    Unique_timer_(Unique_timer_&&) = delete;
+    Unique_timer_(Unique_timer_ const&) = delete;
+
+    ~Unique_timer_()
+    {
+      queue_.destroy_node_(timer_);
+    }
+
+    Unique_timer_& operator =(Unique_timer_&&) = delete;
+    Unique_timer_& operator =(Unique_timer_ const&) = delete;
+
+  private:
+    Timer_* timer_;
+    timer_queue& queue_;
+  };
+
+  void schedule_(Timer_* const timer, Duration_ const& deadline)
+  {
+    Bucket_* bucket = Tree_algo_::binary_search<false, false, true>(
+      buckets_,
+      [&deadline](Duration_ const& offset) -> Compare_result_
+      {
+        if(offset < deadline)
+        {
+          return Compare_result_::less;
+        }
+        if(deadline < offset)
+        {
+          return Compare_result_::greater;
+        }
+        return Compare_result_::equal;
+      });
+    if(!bucket)
+    {
+      bucket = create_node_<Bucket_>();
+      Tree_algo_::insert_at_offset(buckets_, bucket, deadline);
+      buckets_.increment_size();
+    }
+
+    timer->bucket = bucket;
+    timer->next = nullptr;
+    timer->prev = bucket->last;
+    if(bucket->last)
+    {
+      bucket->last->next = timer;
+    }
+    else
+    {
+      bucket->first = timer;
+    }
+
+    bucket->last = timer;
+  }
+
+  void unlink_(Timer_* const timer) noexcept
+  {
+    Bucket_* const bucket = timer->bucket;
+    TREEXX_ASSERT(bucket);
+    if(timer->prev)
+    {
+      timer->prev->next = timer->next;
+    }
+    else
+    {
+      bucket->first = timer->next;
+    }
+    if(timer->next)
+    {
+      timer->next->prev = timer->prev;
+    }
+    else
+    {
+      bucket->last = timer->prev;
+    }
+
+    if(!bucket->first)
+    {
+      Tree_algo_::erase(buckets_, bucket);
+      buckets_.decrement_size();
+      destroy_node_(bucket);
+    }
+  }
+
+  template<class Node, class... Args>
+  [[nodiscard]] Node* create_node_(Args&&... args)
+  {
+    using Traits = Node_allocator_traits_<Node>;
+    Node_allocator_<Node> alloc(alloc_);
+    Node* const node = Traits::allocate(alloc, 1u);
+    try
+    {
+      Traits::construct(alloc, node, static_cast<Args&&>(args)...);
+    }
+    catch(...)
+    {
+      Traits::deallocate(alloc, node, 1u);
+      throw;
+    }
+
+    return node;
+  }
+
+  template<class Node>
+  void destroy_node_(Node* const node) noexcept
+  {
+    using Traits = Node_allocator_traits_<Node>;
+    TREEXX_ASSERT(node);
+    Node_allocator_<Node> alloc(alloc_);
+    Traits::destroy(alloc, node);
+    Traits::deallocate(alloc, node, 1u);
+  }
+
+  allocator_type alloc_;
+  Tree_ buckets_;
+  Size_ size_ = static_cast<Size_>(0u);
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_TIMERQUEUE_HH
@@ -0,0 +1,730 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TREEXX_STDXX_UNROLLEDSPATIALLIST_HH
+#define TREEXX_STDXX_UNROLLEDSPATIALLIST_HH
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#include <treexx/assert.hh>
+#include <treexx/compare_result.hh>
+#include <treexx/bin/side.hh>
+#include <treexx/bin/tree_algo.hh>
+#include <treexx/bin/avl/balance.hh>
+#include <treexx/bin/avl/tree_algo.hh>
+
+namespace treexx::stdxx
+{
+
+// Sequence of positive spatial sizes, such as row heights, stored in chunks
+// of up to chunk_capacity elements. Every AVL node holds one chunk: the ends
+// of its elements relative to the chunk start, and an offset that counts
+// both the extent and the number of the elements before the chunk. A lookup
+// descends to the chunk and finishes with a fixed-length, branch-free count
+// of the ends not past the target, which compilers turn into vector
+// compares. Compared to spatial_list with one node per element, the tree has
+// chunk_capacity / 2 to chunk_capacity times fewer nodes to allocate and
+// chase pointers through.
+//
+// A full chunk is split in halves. A chunk that falls below a quarter of the
+// capacity is merged into a neighbour when both fit in half a chunk.
+template<
+  class S = ::std::size_t,
+  ::std::size_t capacity = 32u,
+  class A = ::std::allocator<S>>
+struct unrolled_spatial_list
+{
+  using spatial_size_type = S;
+  using allocator_type = A;
+  using size_type = ::std::size_t;
+
+  static size_type constexpr chunk_capacity = capacity;
+
+private:
+  using Side_ = ::treexx::bin::Side;
+  using Balance_ = ::treexx::bin::avl::Balance;
+  using Compare_result_ = ::treexx::Compare_result;
+  using Tree_algo_ = ::treexx::bin::avl::Tree_algo;
+  using Spatial_size_ = spatial_size_type;
+  using Size_ = size_type;
+
+  static_assert(4u <= capacity);
+  static_assert(::std::is_unsigned<Spatial_size_>::value);
+
+  static Spatial_size_ constexpr unused_end_ =
+    ::std::numeric_limits<Spatial_size_>::max();
+
+  // Position of a chunk start: the extent and the number of the elements
+  // before it. Chunks are never empty and elements have positive sizes, so
+  // both grow along the list and comparing the extents is enough.
+  struct Offset_
+  {
+    [[nodiscard]] friend Offset_ operator +(
+      Offset_ const& x,
+      Offset_ const& y) noexcept
+    {
+      return Offset_{x.extent + y.extent, x.count + y.count};
+    }
+
+    [[nodiscard]] friend Offset_ operator -(
+      Offset_ const& x,
+      Offset_ const& y) noexcept
+    {
+      return Offset_{x.extent - y.extent, x.count - y.count};
+    }
+
+    Offset_& operator +=(Offset_ const& x) noexcept
+    {
+      extent += x.extent;
+      count += x.count;
+      return *this;
+    }
+
+    Offset_& operator -=(Offset_ const& x) noexcept
+    {
+      extent -= x.extent;
+      count -= x.count;
+      return *this;
+    }
+
+    [[nodiscard]] friend bool operator <(
+      Offset_ const& x,
+      Offset_ const& y) noexcept
+    {
+      return x.extent < y.extent;
+    }
+
+    Spatial_size_ extent;
+    Size_ count;
+  };
+
+  struct Node_
+  {
+    Node_() noexcept :
+      count(static_cast<Size_>(0u))
+    {
+      for(Size_ i = 0u; capacity > i; ++i)
+      {
+        ends[i] = unused_end_;
+      }
+    }
+
+    Offset_ offset;
+    Node_* parent;
+    Node_* left_child;
+    Node_* right_child;
+    Balance_ balance;
+    Side_ side;
+    Size_ count;
+    Spatial_size_ ends[capacity];
+  };
+
+  struct Tree_static_
+  {
+    using Offset = Offset_;
+
+    [[nodiscard]] static Node_* address(Node_* const n) noexcept
+    {
+      return n;
+    }
+
+    [[nodiscard]] static Node_* parent(Node_ const& n) noexcept
+    {
+      return n.parent;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] static Node_* child(Node_ const& n) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return n.left_child;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return n.right_child;
+      }
+    }
+
+    [[nodiscard]] static Balance_ balance(Node_ const& n) noexcept
+    {
+      return n.balance;
+    }
+
+    [[nodiscard]] static Side_ side(Node_ const& n) noexcept
+    {
+      return n.side;
+    }
+
+    [[nodiscard]] static Offset_ const& offset(Node_ const& n) noexcept
+    {
+      return n.offset;
+    }
+
+    static void set_parent(Node_& n, Node_* const p) noexcept
+    {
+      n.parent = p;
+    }
+
+    template<Side_ side>
+    static void set_child(Node_& n, Node_* const c) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        n.left_child = c;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        n.right_child = c;
+      }
+    }
+
+    static void set_balance(Node_& n, Balance_ const b) noexcept
+    {
+      n.balance = b;
+    }
+
+    static void set_side(Node_& n, Side_ const s) noexcept
+    {
+      n.side = s;
+    }
+
+    static void add_to_offset(Node_& n, Offset_ const& o) noexcept
+    {
+      n.offset += o;
+    }
+
+    static void subtract_from_offset(Node_& n, Offset_ const& o) noexcept
+    {
+      n.offset -= o;
+    }
+
+    static void set_offset(Node_& n, Offset_ const& o) noexcept
+    {
+      n.offset = o;
+    }
+
+    template<unsigned o>
+    [[nodiscard]] static Offset_ make_offset() noexcept
+    {
+      return Offset_{static_cast<Spatial_size_>(o), static_cast<Size_>(o)};
+    }
+  };
+
+  struct Tree_ : Tree_static_
+  {
+    Tree_() noexcept :
+      root_(nullptr),
+      leftmost_(nullptr),
+      rightmost_(nullptr),
+      size_(static_cast<Size_>(0u)),
+      extent_(static_cast<Spatial_size_>(0u))
+    {}
+
+    [[nodiscard]] Node_* root() const noexcept
+    {
+      return root_;
+    }
+
+    template<Side_ side>
+    [[nodiscard]] Node_* extreme() const noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        return leftmost_;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        return rightmost_;
+      }
+    }
+
+    void set_root(Node_* const r) noexcept
+    {
+      root_ = r;
+    }
+
+    template<Side_ side>
+    void set_extreme(Node_* const x) noexcept
+    {
+      static_assert(Side_::left == side || Side_::right == side);
+      if constexpr(Side_::left == side)
+      {
+        leftmost_ = x;
+      }
+      else if constexpr(Side_::right == side)
+      {
+        rightmost_ = x;
+      }
+    }
+
+    void reset() noexcept
+    {
+      root_ = nullptr;
+      leftmost_ = nullptr;
+      rightmost_ = nullptr;
+      size_ = static_cast<Size_>(0u);
+      extent_ = static_cast<Spatial_size_>(0u);
+    }
+
+    void swap(Tree_& x) noexcept
+    {
+      Tree_ const t(*this);
+      *this = x;
+      x = t;
+    }
+
+    Node_* root_;
+    Node_* leftmost_;
+    Node_* rightmost_;
+    Size_ size_;
+    Spatial_size_ extent_;
+  };
+
+  // A chunk and the absolute offset of its start.
+  struct Chunk_
+  {
+    Node_* node;
+    Offset_ offset;
+  };
+
+  using Allocator_ = allocator_type;
+  using Allocator_traits_ = ::std::allocator_traits<Allocator_>;
+  using Node_allocator_ =
+    typename Allocator_traits_::template rebind_alloc<Node_>;
+  using Node_allocator_traits_ = ::std::allocator_traits<Node_allocator_>;
+
+  struct Tree_and_alloc_ : Node_allocator_
+  {
+    Tree_and_alloc_() = default;
+
+    template<class Alloc>
+    explicit Tree_and_alloc_(Alloc&& alloc) :
+      Node_allocator_(static_cast<Alloc&&>(alloc))
+    {}
+
+    [[nodiscard]] Node_allocator_& allocator() noexcept
+    {
+      return *this;
+    }
+
+    Tree_ tree;
+  };
+
+public:
+  unrolled_spatial_list() = default;
+
+  explicit unrolled_spatial_list(allocator_type const& alloc) :
+    tree_and_alloc_(Node_allocator_(alloc))
+  {}
+
+  unrolled_spatial_list(unrolled_spatial_list&& x) noexcept :
+    tree_and_alloc_(
+      static_cast<Node_allocator_&&>(x.tree_and_alloc_.allocator()))
+  {
+    tree_and_alloc_.tree.swap(x.tree_and_alloc_.tree);
+  }
+
+  unrolled_spatial_list(unrolled_spatial_list const&) = delete;
+
+  ~unrolled_spatial_list()
+  {
+    clear();
+  }
+
+  unrolled_spatial_list& operator =(unrolled_spatial_list&&) = delete;
+  unrolled_spatial_list& operator =(unrolled_spatial_list const&) = delete;
+
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return 1u > tree_and_alloc_.tree.size_;
+  }
+
+  // Number of the elements.
+  [[nodiscard]] size_type size() const noexcept
+  {
+    return tree_and_alloc_.tree.size_;
+  }
+
+  // Sum of the sizes of all the elements.
+  [[nodiscard]] spatial_size_type extent() const noexcept
+  {
+    return tree_and_alloc_.tree.extent_;
+  }
+
+  [[nodiscard]] spatial_size_type element_size(
+    size_type const& idx) const noexcept
+  {
+    Chunk_ const chunk(chunk_at_index_(idx));
+    Size_ const pos = idx - chunk.offset.count;
+    return chunk.node->ends[pos] - start_(*chunk.node, pos);
+  }
+
+  [[nodiscard]] spatial_size_type offset(size_type const& idx) const noexcept
+  {
+    Chunk_ const chunk(chunk_at_index_(idx));
+    return chunk.offset.extent + start_(*chunk.node, idx - chunk.offset.count);
+  }
+
+  // Index of the element covering offset off, or size() if there is none.
+  [[nodiscard]] size_type find_offset(
+    spatial_size_type const& off) const noexcept
+  {
+    Tree_ const& tree = tree_and_alloc_.tree;
+    if(!(off < tree.extent_))
+    {
+      return tree.size_;
+    }
+
+    Chunk_ chunk{nullptr, Tree_static_::template make_offset<0u>()};
+    static_cast<void>(Tree_algo_::binary_search<true, false, true>(
+      tree,
+      [&off, &chunk](Node_ const& n, Offset_ const& o) noexcept
+        -> Compare_result_
+      {
+        if(off < o.extent)
+        {
+          return Compare_result_::greater;
+        }
+        if(!(off - o.extent < extent_of_(n)))
+        {
+          return Compare_result_::less;
+        }
+
+        chunk.node = const_cast<Node_*>(::std::addressof(n));
+        chunk.offset = o;
+        return Compare_result_::equal;
+      }));
+
+    TREEXX_ASSERT(chunk.node);
+    return chunk.offset.count + rank_(*chunk.node, off - chunk.offset.extent);
+  }
+
+  void push_back(spatial_size_type const& sz)
+  {
+    insert(size(), sz);
+  }
+
+  void push_front(spatial_size_type const& sz)
+  {
+    insert(static_cast<Size_>(0u), sz);
+  }
+
+  // Inserts an element of size sz before the one at idx, or at the end if
+  // idx is size().
+  void insert(size_type const& idx, spatial_size_type const& sz)
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(idx <= tree.size_);
+    TREEXX_ASSERT(static_cast<Spatial_size_>(0u) < sz);
+
+    if(!tree.root())
+    {
+      Node_* const node = create_node_();
+      node->ends[0u] = sz;
+      node->count = static_cast<Size_>(1u);
+      Tree_algo_::push_back(
+        tree, node, Tree_static_::template make_offset<0u>());
+      tree.size_ = static_cast<Size_>(1u);
+      tree.extent_ = sz;
+      return;
+    }
+
+    Chunk_ chunk(
+      idx < tree.size_ ? chunk_at_index_(idx) : last_chunk_());
+    Size_ pos = idx - chunk.offset.count;
+    if(capacity == chunk.node->count)
+    {
+      Size_ constexpr half = capacity / 2u;
+      Chunk_ const upper(split_(chunk));
+      if(half < pos)
+      {
+        chunk = upper;
+        pos -= half;
+      }
+    }
+
+    Node_& node = *chunk.node;
+    Spatial_size_ const start = start_(node, pos);
+    for(Size_ i = node.count; pos < i; --i)
+    {
+      node.ends[i] = node.ends[i - 1u] + sz;
+    }
+
+    node.ends[pos] = start + sz;
+    ++node.count;
+    shift_after_<Side_::right>(node, Offset_{sz, static_cast<Size_>(1u)});
+    ++tree.size_;
+    tree.extent_ += sz;
+  }
+
+  void erase(size_type const& idx) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(idx < tree.size_);
+
+    Chunk_ const chunk(chunk_at_index_(idx));
+    Node_& node = *chunk.node;
+    Size_ const pos = idx - chunk.offset.count;
+    Spatial_size_ const sz = node.ends[pos] - start_(node, pos);
+    for(Size_ i = pos + 1u; node.count > i; ++i)
+    {
+      node.ends[i - 1u] = node.ends[i] - sz;
+    }
+
+    --node.count;
+    node.ends[node.count] = unused_end_;
+    --tree.size_;
+    tree.extent_ -= sz;
+
+    Offset_ const shift{sz, static_cast<Size_>(1u)};
+    if(0u < node.count)
+    {
+      shift_after_<Side_::left>(node, shift);
+      if(capacity / 4u > node.count)
+      {
+        merge_(node);
+      }
+    }
+    else
+    {
+      // The chunk has to go before its successor can move onto its start.
+      Node_* const next = Tree_algo_::next_node(tree, node);
+      Tree_algo_::erase(tree, ::std::addressof(node));
+      destroy_node_(::std::addressof(node));
+      if(next)
+      {
+        Tree_algo_::shift_suffix<Side_::left>(tree, *next, shift);
+      }
+    }
+  }
+
+  // Changes the size of the element at idx to sz.
+  void resize(size_type const& idx, spatial_size_type const& sz) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    TREEXX_ASSERT(idx < tree.size_);
+    TREEXX_ASSERT(static_cast<Spatial_size_>(0u) < sz);
+
+    Chunk_ const chunk(chunk_at_index_(idx));
+    Node_& node = *chunk.node;
+    Size_ const pos = idx - chunk.offset.count;
+    Spatial_size_ const old_sz = node.ends[pos] - start_(node, pos);
+    if(old_sz < sz)
+    {
+      Spatial_size_ const delta = sz - old_sz;
+      for(Size_ i = pos; node.count > i; ++i)
+      {
+        node.ends[i] += delta;
+      }
+
+      shift_after_<Side_::right>(node, Offset_{delta, static_cast<Size_>(0u)});
+      tree.extent_ += delta;
+    }
+    else if(sz < old_sz)
+    {
+      Spatial_size_ const delta = old_sz - sz;
+      for(Size_ i = pos; node.count > i; ++i)
+      {
+        node.ends[i] -= delta;
+      }
+
+      shift_after_<Side_::left>(node, Offset_{delta, static_cast<Size_>(0u)});
+      tree.extent_ -= delta;
+    }
+  }
+
+  void clear() noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    ::treexx::bin::Tree_algo::clear(
+      tree,
+      [this](Node_* const node) noexcept
+      {
+        destroy_node_(node);
+      });
+    tree.reset();
+  }
+
+private:
+  [[nodiscard]] static Spatial_size_ start_(
+    Node_ const& n,
+    Size_ const pos) noexcept
+  {
+    return 0u < pos ? n.ends[pos - 1u] : static_cast<Spatial_size_>(0u);
+  }
+
+  [[nodiscard]] static Spatial_size_ extent_of_(Node_ const& n) noexcept
+  {
+    TREEXX_ASSERT(0u < n.count);
+    return n.ends[n.count - 1u];
+  }
+
+  // Number of the elements of n ending at or before off, that is the
+  // position of the element covering off. The loop has a fixed trip count
+  // and no branches, so that it is vectorized; the unused ends never count.
+  [[nodiscard]] static Size_ rank_(
+    Node_ const& n,
+    Spatial_size_ const& off) noexcept
+  {
+    Size_ rank = 0u;
+    for(Size_ i = 0u; capacity > i; ++i)
+    {
+      rank += static_cast<Size_>(n.ends[i] <= off);
+    }
+
+    return rank;
+  }
+
+  [[nodiscard]] Chunk_ chunk_at_index_(Size_ const& idx) const noexcept
+  {
+    TREEXX_ASSERT(idx < tree_and_alloc_.tree.size_);
+    Chunk_ chunk{nullptr, Tree_static_::template make_offset<0u>()};
+    static_cast<void>(Tree_algo_::binary_search<true, false, true>(
+      tree_and_alloc_.tree,
+      [&idx, &chunk](Node_ const& n, Offset_ const& o) noexcept
+        -> Compare_result_
+      {
+        if(idx < o.count)
+        {
+          return Compare_result_::greater;
+        }
+        if(!(idx - o.count < n.count))
+        {
+          return Compare_result_::less;
+        }
+
+        chunk.node = const_cast<Node_*>(::std::addressof(n));
+        chunk.offset = o;
+        return Compare_result_::equal;
+      }));
+
+    TREEXX_ASSERT(chunk.node);
+    return chunk;
+  }
+
+  [[nodiscard]] Chunk_ last_chunk_() const noexcept
+  {
+    Tree_ const& tree = tree_and_alloc_.tree;
+    Node_* const node = tree.template extreme<Side_::right>();
+    TREEXX_ASSERT(node);
+    return Chunk_{node, Tree_algo_::node_offset(tree, *node)};
+  }
+
+  template<Side_ side>
+  void shift_after_(Node_& node, Offset_ const& shift) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const next = Tree_algo_::next_node(tree, node);
+    if(next)
+    {
+      Tree_algo_::shift_suffix<side>(tree, *next, shift);
+    }
+  }
+
+  // Moves the upper half of the full chunk into a new one linked right
+  // after it, and returns that.
+  [[nodiscard]] Chunk_ split_(Chunk_ const& chunk)
+  {
+    Size_ constexpr half = capacity / 2u;
+    Node_& node = *chunk.node;
+    TREEXX_ASSERT(capacity == node.count);
+
+    Node_* const upper = create_node_();
+    Spatial_size_ const base = node.ends[half - 1u];
+    for(Size_ i = half; capacity > i; ++i)
+    {
+      upper->ends[i - half] = node.ends[i] - base;
+      node.ends[i] = unused_end_;
+    }
+
+    upper->count = capacity - half;
+    node.count = half;
+    Offset_ const upper_offset(chunk.offset + Offset_{base, half});
+    Tree_algo_::insert_at_offset(
+      tree_and_alloc_.tree, upper, upper_offset);
+    return Chunk_{upper, upper_offset};
+  }
+
+  // Folds the chunk into a neighbour, or the next chunk into it, if the two
+  // fit in half a chunk. The offsets of the other chunks stay as they are.
+  void merge_(Node_& node) noexcept
+  {
+    Tree_& tree = tree_and_alloc_.tree;
+    Node_* const next = Tree_algo_::next_node(tree, node);
+    if(next && node.count + next->count <= capacity / 2u)
+    {
+      append_(node, *next);
+      return;
+    }
+
+    Node_* const previous = Tree_algo_::previous_node(tree, node);
+    if(previous && previous->count + node.count <= capacity / 2u)
+    {
+      append_(*previous, node);
+    }
+  }
+
+  // Moves the elements of the chunk following node to its end, and drops
+  // that chunk.
+  void append_(Node_& node, Node_& next) noexcept
+  {
+    Spatial_size_ const base = extent_of_(node);
+    for(Size_ i = 0u; next.count > i; ++i)
+    {
+      node.ends[node.count + i] = base + next.ends[i];
+    }
+
+    node.count += next.count;
+    Tree_algo_::erase(tree_and_alloc_.tree, ::std::addressof(next));
+    destroy_node_(::std::addressof(next));
+  }
+
+  [[nodiscard]] Node_* create_node_()
+  {
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_* const node = Node_allocator_traits_::allocate(alloc, 1u);
+    Node_allocator_traits_::construct(alloc, node);
+    return node;
+  }
+
+  void destroy_node_(Node_* const node) noexcept
+  {
+    TREEXX_ASSERT(node);
+    Node_allocator_& alloc = tree_and_alloc_.allocator();
+    Node_allocator_traits_::destroy(alloc, node);
+    Node_allocator_traits_::deallocate(alloc, node, 1u);
+  }
+
+  Tree_and_alloc_ tree_and_alloc_;
+};
+
+} // namespace treexx::stdxx
+
+#endif // TREEXX_STDXX_UNROLLEDSPATIALLIST_HH
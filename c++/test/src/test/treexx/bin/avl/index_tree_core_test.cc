@@ -22,8 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <type_traits>
@@ -40,6 +42,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <test/util/random/util.hh>
 #include <treexx/compare_result.hh>
 #include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/fork_join_pool.hh>
 
 namespace test::treexx::bin::avl
 {
@@ -86,9 +89,14 @@ protected:
   template<class... T>
   using Vector = ::std::vector<T...>;
 
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
   template<class T>
   using Uniform_gen = ::test::util::random::Uniform_gen<T>;
 
+  using Fork_join_pool = ::treexx::stdxx::fork_join_pool;
+
   template<class Value, class I = Size>
   struct Tree
   {
@@ -189,6 +197,102 @@ protected:
       }
     }
 
+    // Moves the elements from index idx on to other.
+    void split(Index const& idx, Tree& other)
+    {
+      auto const size = this->size();
+      Node_pointer const node_ptr = Tree_algo_::at_index(core_, idx);
+      REQUIRE(node_ptr);
+      Tree_algo_::split(core_, node_ptr, other.core_);
+      core_.set_xyz_size(idx);
+      other.core_.set_xyz_size(size - idx);
+    }
+
+    void join(Tree& other)
+    {
+      auto const size = this->size() + other.size();
+      Tree_algo_::join(core_, other.core_);
+      core_.set_xyz_size(size);
+      other.core_.set_xyz_size(0u);
+    }
+
+    // Joins through a new element placed between the two trees.
+    template<class... T>
+    Value& join(Tree& other, T&&... x)
+    {
+      auto const size = this->size() + other.size() + 1u;
+      auto n = ::std::make_unique<Node>(static_cast<T&&>(x)...);
+      Tree_algo_::join(
+        core_, Node_pointer::from_xyz_address(n.get()), other.core_);
+      core_.set_xyz_size(size);
+      other.core_.set_xyz_size(0u);
+      return n.release()->value();
+    }
+
+    // Builds the tree, which must be empty, out of the values in this order.
+    template<class Values, class Fork_join>
+    void build(Values const& values, Fork_join& fork_join)
+    {
+      REQUIRE(empty());
+      Vector<Unique_ptr_<Node>> nodes;
+      Vector<Node_pointer> node_ptrs;
+      for(auto const& x: values)
+      {
+        nodes.emplace_back(::std::make_unique<Node>(x));
+        node_ptrs.emplace_back(
+          Node_pointer::from_xyz_address(nodes.back().get()));
+      }
+
+      Tree_algo_::build(
+        core_, node_ptrs.cbegin(), node_ptrs.cend(), fork_join);
+      for(auto& node: nodes)
+      {
+        node.release();
+      }
+
+      core_.set_xyz_size(values.size());
+    }
+
+    template<class Fork_join>
+    void set_union(Tree& other, Fork_join& fork_join)
+    {
+      auto const size = this->size() + other.size();
+      auto const disposed = set_operation_(
+        [&](auto const& compare, auto const& dispose)
+        {
+          Tree_algo_::set_union(
+            core_, other.core_, compare, dispose, fork_join);
+        });
+      core_.set_xyz_size(size - disposed);
+      other.core_.set_xyz_size(0u);
+    }
+
+    template<class Fork_join>
+    void set_intersection(Tree& other, Fork_join& fork_join)
+    {
+      auto const size = this->size();
+      auto const disposed = set_operation_(
+        [&](auto const& compare, auto const& dispose)
+        {
+          Tree_algo_::set_intersection(
+            core_, other.core_, compare, dispose, fork_join);
+        });
+      core_.set_xyz_size(size - disposed);
+    }
+
+    template<class Fork_join>
+    void set_difference(Tree& other, Fork_join& fork_join)
+    {
+      auto const size = this->size();
+      auto const disposed = set_operation_(
+        [&](auto const& compare, auto const& dispose)
+        {
+          Tree_algo_::set_difference(
+            core_, other.core_, compare, dispose, fork_join);
+        });
+      core_.set_xyz_size(size - disposed);
+    }
+
     template<class T>
     bool try_insert(T&& x)
     {
@@ -255,6 +359,24 @@ protected:
   private:
     using Core_ = Tree_core_<Value, Index>;
 
+    // Returns the number of the disposed nodes.
+    template<class Fun>
+    [[nodiscard]] static Size set_operation_(Fun&& fun)
+    {
+      Atomic<Size> disposed(0u);
+      fun(
+        [](Node const& x, Node const& y) noexcept -> Compare_result_
+        {
+          return Util_::compare(x.value(), y.value());
+        },
+        [&disposed](Node_pointer const& node_ptr) noexcept
+        {
+          Unique_ptr_<Node> const node(Core_::address(node_ptr));
+          disposed.fetch_add(1u, ::std::memory_order_relaxed);
+        });
+      return disposed.load();
+    }
+
     template<Side_ side>
     [[nodiscard]] Value const& extreme_() const noexcept
     {
@@ -773,4 +895,202 @@ TEST_CASE_METHOD(
   }
 }
 
+TEST_CASE_METHOD(
+  Index_tree_core_test,
+  "Index AVL tree core: split, join",
+  "[tree++][treexx][bin][avl][algo][index][split][join]")
+{
+  using Value = Int_32;
+  using Tree = Tree<Value>;
+  using Index = Tree::Index;
+  using Vector = Vector<Value>;
+
+  auto const fill = [](Tree& tree, Vector& vec, Index const size, Value first)
+  {
+    for(Index i = 0u; size > i; ++i)
+    {
+      vec.emplace_back(first);
+      tree.emplace_back(first++);
+    }
+  };
+
+  auto const split_and_join = [&fill](Index const size, Index const idx)
+  {
+    Tree left;
+    Tree right;
+    Vector vec;
+    fill(left, vec, size, 0);
+    left.split(idx, right);
+    left.verify();
+    right.verify();
+    expect_match(Vector(vec.cbegin(), vec.cbegin() + idx), left);
+    expect_match(Vector(vec.cbegin() + idx, vec.cend()), right);
+
+    if(0u < idx % 2u)
+    {
+      left.join(right);
+    }
+    else
+    {
+      // Take the first element out of the right part and join through it.
+      Vector right_vec(vec.cbegin() + idx, vec.cend());
+      Tree tail;
+      if(1u < right.size())
+      {
+        right.split(1u, tail);
+      }
+
+      left.join(tail, right_vec.front());
+      right.pop_front();
+    }
+
+    left.verify();
+    right.verify();
+    CHECK(right.empty());
+    expect_match(vec, left);
+  };
+
+  for(Index size = 1u; 40u > size; ++size)
+  {
+    for(Index idx = 0u; size > idx; ++idx)
+    {
+      split_and_join(size, idx);
+    }
+  }
+
+  Uniform_gen<Index> gen(0u, 2999u);
+  for(int i = 0; 100 > i; ++i)
+  {
+    Index const size = 1u + gen();
+    split_and_join(size, gen() % size);
+  }
+
+  // Trees of very different heights.
+  for(Index small = 0u; 5u > small; ++small)
+  {
+    for(Index const large: {100u, 1000u})
+    {
+      Tree x;
+      Tree y;
+      Vector vec;
+      fill(x, vec, small, 0);
+      Value const middle = static_cast<Value>(small);
+      vec.emplace_back(middle);
+      fill(y, vec, large, middle + 1);
+      x.join(y, middle);
+      x.verify();
+      expect_match(vec, x);
+
+      Tree z;
+      Tree w;
+      Vector other;
+      fill(z, other, large, 0);
+      fill(w, other, small, static_cast<Value>(large));
+      z.join(w);
+      z.verify();
+      w.verify();
+      expect_match(other, z);
+    }
+  }
+}
+
+TEST_CASE_METHOD(
+  Index_tree_core_test,
+  "Index AVL tree core: build, set operations",
+  "[tree++][treexx][bin][avl][algo][index]"
+  "[build][set_union][set_intersection][set_difference]")
+{
+  using Value = Int_32;
+  using Tree = Tree<Value>;
+  using Index = Tree::Index;
+  using Vector = Vector<Value>;
+
+  Size const grain_size = GENERATE(1u, 16u, 100000u);
+  Fork_join_pool pool(3u, grain_size);
+
+  for(Index size = 0u; 70u > size; ++size)
+  {
+    Vector vec;
+    for(Index i = 0u; size > i; ++i)
+    {
+      vec.emplace_back(static_cast<Value>(i * 2u));
+    }
+
+    Tree tree;
+    tree.build(vec, pool);
+    tree.verify();
+    expect_match(vec, tree);
+  }
+
+  Uniform_gen<Index> gen_size(0u, 3000u);
+  Uniform_gen<Value> gen_range(1, 6000);
+  auto const gen_set = [&gen_size](Index const max_size, Value const range)
+  {
+    Uniform_gen<Value> gen(0, range - 1);
+    Set<Value> set;
+    for(Index i = gen_size() % max_size; 0u < i; --i)
+    {
+      set.emplace(gen());
+    }
+
+    return Vector(set.cbegin(), set.cend());
+  };
+
+  for(int i = 0; 120 > i; ++i)
+  {
+    Index const max_size = 60 > i ? 41u : 3001u;
+    Value const range = gen_range();
+    Vector const x_vec = gen_set(max_size, range);
+    Vector const y_vec = gen_set(max_size, range);
+
+    {
+      Tree x;
+      Tree y;
+      x.build(x_vec, pool);
+      y.build(y_vec, pool);
+      Vector expected;
+      ::std::set_union(
+        x_vec.cbegin(), x_vec.cend(), y_vec.cbegin(), y_vec.cend(),
+        ::std::back_inserter(expected));
+      x.set_union(y, pool);
+      x.verify();
+      y.verify();
+      expect_match(expected, x);
+      CHECK(y.empty());
+    }
+
+    {
+      Tree x;
+      Tree y;
+      x.build(x_vec, pool);
+      y.build(y_vec, pool);
+      Vector expected;
+      ::std::set_intersection(
+        x_vec.cbegin(), x_vec.cend(), y_vec.cbegin(), y_vec.cend(),
+        ::std::back_inserter(expected));
+      x.set_intersection(y, pool);
+      x.verify();
+      y.verify();
+      expect_match(expected, x);
+      expect_match(y_vec, y);
+    }
+
+    {
+      Tree x;
+      Tree y;
+      x.build(x_vec, pool);
+      y.build(y_vec, pool);
+      Vector expected;
+      ::std::set_difference(
+        x_vec.cbegin(), x_vec.cend(), y_vec.cbegin(), y_vec.cend(),
+        ::std::back_inserter(expected));
+      x.set_difference(y, pool);
+      x.verify();
+      y.verify();
+      expect_match(expected, x);
+      expect_match(y_vec, y);
+    }
+  }
+}
+
 } // namespace test::treexx::bin::avl
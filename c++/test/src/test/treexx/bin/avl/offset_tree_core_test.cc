@@ -47,6 +47,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <treexx/compare_result.hh>
 #include <treexx/bin/side.hh>
 #include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/fork_join_pool.hh>
 
 namespace test::treexx::bin::avl
 {
@@ -169,6 +170,22 @@ class Offset_tree_core_test
         core_, comparator(offset));
     }
 
+    [[nodiscard]] Node_const_pointer seek_offset(
+      Node_const_pointer const& finger_ptr,
+      Offset& finger_offset,
+      Offset const& offset) const noexcept
+    {
+      return Tree_algo_::seek_offset(core_, finger_ptr, finger_offset, offset);
+    }
+
+    [[nodiscard]] Node_pointer seek_offset(
+      Node_pointer const& finger_ptr,
+      Offset& finger_offset,
+      Offset const& offset) noexcept
+    {
+      return Tree_algo_::seek_offset(core_, finger_ptr, finger_offset, offset);
+    }
+
     void verify() const
     {
       Util_::verify_tree<indexed, true>(core_);
@@ -306,6 +323,21 @@ class Offset_tree_core_test
       return emplace_(offset, Tuple_<>(), static_cast<Val&&>(val)...);
     }
 
+    template<class... Val>
+    Node_pointer emplace_after(
+      Node_pointer const& prev_ptr,
+      Offset const& prev_offset,
+      Offset const& offset,
+      Val&&... val)
+    {
+      auto n = ::std::make_unique<Node>(static_cast<Val&&>(val)...);
+      auto const node_ptr = Node_pointer::from_xyz_address(n.get());
+      Tree_algo_::insert_after(core_, prev_ptr, prev_offset, node_ptr, offset);
+      core_.increment_xyz_size();
+      n.release();
+      return node_ptr;
+    }
+
     template<class... Val>
     Value& emplace_and_shift(
       Offset const& offset, Offset const& shift, Val&&... val)
@@ -356,6 +388,45 @@ class Offset_tree_core_test
       CHECK(node);
     }
 
+    void erase_and_shift(Node_pointer const& node_ptr)
+    {
+      REQUIRE(node_ptr);
+      if(empty())
+      {
+        CHECK(false);
+        return;
+      }
+
+      Tree_algo_::erase_and_shift(core_, node_ptr);
+      Unique_ptr_<Node> const node(Core_::address(node_ptr));
+      core_.decrement_xyz_size();
+      CHECK(node);
+    }
+
+    // Builds the tree, which must be empty, out of the entries.
+    template<class Entries, class Fork_join>
+    void build(Entries const& entries, Fork_join& fork_join)
+    {
+      REQUIRE(empty());
+      Vector_<Unique_ptr_<Node>> nodes;
+      Vector_<Node_pointer> node_ptrs;
+      for(auto const& e: entries)
+      {
+        nodes.emplace_back(::std::make_unique<Node>(e.value));
+        Core_::set_offset(*nodes.back(), e.offset);
+        node_ptrs.emplace_back(
+          Node_pointer::from_xyz_address(nodes.back().get()));
+      }
+
+      Tree_algo_::build(
+        core_, node_ptrs.cbegin(), node_ptrs.cend(), fork_join);
+      for(auto& node: nodes)
+      {
+        node.release();
+        core_.increment_xyz_size();
+      }
+    }
+
     [[nodiscard]] static Node* address(
       Node_pointer const& node_ptr) noexcept
     {
@@ -501,7 +572,9 @@ class Offset_tree_core_test
 
     static char const* tags() noexcept
     {
-      return "[tree++][treexx][bin][avl][algo][offset][insert]";
+      return
+        "[tree++][treexx][bin][avl][algo][offset]"
+        "[insert][insert_after]";
     }
 
     template<bool>
@@ -526,21 +599,39 @@ class Offset_tree_core_test
     static void run();
   };
 
+  struct Test_case_build_ : Test_case_base_<Test_case_build_>
+  {
+    TXX_TEST_CLASS()
+
+    static char const* name() noexcept
+    {
+      return "Offset AVL tree core: build";
+    }
+
+    static char const* tags() noexcept
+    {
+      return "[tree++][treexx][bin][avl][algo][offset][build]";
+    }
+
+    template<bool>
+    static void run();
+  };
+
   struct Test_case_0_ : Test_case_base_<Test_case_0_>
   {
     TXX_TEST_CLASS()
 
     static char const* name() noexcept
     {
-      return "Offset AVL tree core: erase, shift, binary search";
+      return "Offset AVL tree core: erase, shift, binary search, seek";
     }
 
     static char const* tags() noexcept
     {
       return
         "[tree++][treexx][bin][avl][algo][offset]"
-        "[erase][pop_back][pop_front][shift_suffix]"
-        "[binary_search][lower_bound][upper_bound]";
+        "[erase][erase_and_shift][pop_back][pop_front][shift_suffix]"
+        "[binary_search][lower_bound][upper_bound][seek_offset]";
     }
 
     template<bool>
@@ -665,6 +756,65 @@ void Offset_tree_core_test::Test_case_insert_::run()
     tree.expect_match(set);
     tree.verify();
   }
+
+  SECTION("Insert after")
+  {
+    // Every insertion finds its predecessor with seek_offset, starting from
+    // the node inserted last.
+    Set_<Node_data> set;
+    typename Tree::Node_pointer finger_ptr(nullptr);
+    Offset finger_offset = 0;
+    auto const insert = [&](Offset const& offset)
+    {
+      auto const val = gen_val();
+      if(!set.emplace(offset, val).second)
+      {
+        return;
+      }
+
+      typename Tree::Node_pointer prev_ptr(nullptr);
+      Offset prev_offset = finger_offset;
+      if(finger_ptr)
+      {
+        prev_ptr = tree.seek_offset(finger_ptr, prev_offset, offset);
+      }
+
+      finger_ptr = tree.emplace_after(prev_ptr, prev_offset, offset, val);
+      finger_offset = offset;
+      if(0u == set.size() % 97u)
+      {
+        tree.expect_match(set);
+        tree.verify();
+      }
+    };
+
+    Uniform_gen_<Offset> gen_offset(-200000, 200000);
+    for(Size i = 0u; 3000u > i; ++i)
+    {
+      insert(gen_offset());
+    }
+
+    // Sorted runs, the way a batch is applied.
+    for(Size i = 0u; 40u > i; ++i)
+    {
+      Vector_<Offset> run;
+      for(Size j = 0u; 60u > j; ++j)
+      {
+        run.push_back(gen_offset());
+      }
+
+      ::std::sort(run.begin(), run.end());
+      for(Offset const& offset: run)
+      {
+        insert(offset);
+      }
+    }
+
+    insert(-300000);
+    insert(300000);
+    tree.expect_match(set);
+    tree.verify();
+  }
 }
 
 template<bool indexed>
@@ -715,6 +865,46 @@ void Offset_tree_core_test::Test_case_insert_back_::run()
   CHECK(count == vec.size());
 }
 
+template<bool indexed>
+void Offset_tree_core_test::Test_case_build_::run()
+{
+  using Size = Size_;
+  using Value = Int_32_;
+  using Offset = Int_64_;
+  using Tree = Tree_<Value, Offset, indexed>;
+  using Vector = Vector_<Node_data_<Value, Offset>>;
+  using Fork_join_pool = ::treexx::stdxx::fork_join_pool;
+
+  Uniform_gen_<Value> gen_val(-9187, 716211);
+  Uniform_gen_<Offset> gen_rel_offset(1, 36512322);
+  Size const grain_size = GENERATE(1u, 16u, 100000u);
+  Fork_join_pool pool(3u, grain_size);
+  auto const build = [&](Size const count)
+  {
+    Vector vec;
+    Offset offset = -1762;
+    for(Size i = 0u; count > i; ++i)
+    {
+      vec.emplace_back(offset, gen_val());
+      offset += gen_rel_offset();
+    }
+
+    Tree tree;
+    tree.build(vec, pool);
+    tree.verify();
+    tree.expect_match(vec);
+    CHECK(count == tree.size());
+  };
+
+  for(Size count = 0u; 70u > count; ++count)
+  {
+    build(count);
+  }
+
+  build(10000u);
+  build(54321u);
+}
+
 template<bool indexed>
 void Offset_tree_core_test::Test_case_0_::run()
 {
@@ -819,6 +1009,27 @@ void Offset_tree_core_test::Test_case_0_::run()
       }
     }
 
+    SECTION("Erase random node and shift")
+    {
+      while(!deq.empty())
+      {
+        auto idx = gen_index();
+        REQUIRE(deq.size() > idx);
+        auto deq_it = deq.begin() + static_cast<Ptrdiff_>(idx);
+        auto const node_ptr = tree.at(idx);
+        REQUIRE(node_ptr);
+        Offset const offset = deq_it->offset;
+        deq_it = deq.erase(deq_it);
+        if(deq.end() != deq_it)
+        {
+          shift_suffix_(deq, deq_it, deq_it->offset - offset, Side::left);
+        }
+
+        tree.erase_and_shift(node_ptr);
+        verify();
+      }
+    }
+
     CHECK(tree.empty());
     CHECK(deq.empty());
   }
@@ -923,6 +1134,88 @@ void Offset_tree_core_test::Test_case_0_::run()
     CHECK(count == node_count);
     CHECK(count == tree.size());
   }
+
+  SECTION("Seek offset")
+  {
+    auto const& ctree = tree;
+    Vector_<typename Tree::Node_const_pointer> node_ptrs;
+    for(auto node_ptr = ctree.template extreme<Side::left>(); node_ptr;)
+    {
+      node_ptrs.push_back(node_ptr);
+      node_ptr = ctree.next_node(*Tree::address(node_ptr));
+    }
+
+    REQUIRE(count == node_ptrs.size());
+    auto const expected_index = [&deq](Offset const& offset) -> Size
+    {
+      Node_data_<Value, Offset> const key(offset, 0);
+      return static_cast<Size>(
+        ::std::upper_bound(deq.cbegin(), deq.cend(), key) - deq.cbegin());
+    };
+
+    auto const check_seek = [&](Size const finger_idx, Offset const& offset)
+    {
+      Offset finger_offset = deq[finger_idx].offset;
+      auto const found_node_ptr =
+        ctree.seek_offset(node_ptrs[finger_idx], finger_offset, offset);
+      Size const idx = expected_index(offset);
+      if(0u < idx)
+      {
+        CHECK(node_ptrs[idx - 1u] == found_node_ptr);
+        CHECK(deq[idx - 1u].offset == finger_offset);
+      }
+      else
+      {
+        CHECK(!found_node_ptr);
+        CHECK(deq[finger_idx].offset == finger_offset);
+      }
+    };
+
+    Offset const first_offset = deq.front().offset;
+    Offset const last_offset = deq.back().offset;
+    for(Size i = 0u; 20000u > i; ++i)
+    {
+      Size const finger_idx = gen_index();
+      Offset offset = deq[finger_idx].offset;
+      switch(i % 4u)
+      {
+      case 0u:
+        break;
+      case 1u:
+        offset += static_cast<Offset>(gen_val() % 4000000) - 2000000;
+        break;
+      case 2u:
+        offset += static_cast<Offset>(gen_val() % 64) - 32;
+        break;
+      default:
+        offset = first_offset - 5 +
+          static_cast<Offset>(gen_0_1() * static_cast<double>(
+            last_offset - first_offset + 10));
+        break;
+      }
+
+      check_seek(finger_idx, offset);
+    }
+
+    // Scroll through the whole tree, reusing the result as the finger.
+    auto finger_ptr = node_ptrs.front();
+    Offset finger_offset = first_offset;
+    Size steps = 0u;
+    for(Offset offset = first_offset; last_offset + 1000 > offset;)
+    {
+      auto const found_node_ptr =
+        ctree.seek_offset(finger_ptr, finger_offset, offset);
+      Size const idx = expected_index(offset);
+      REQUIRE(0u < idx);
+      CHECK(node_ptrs[idx - 1u] == found_node_ptr);
+      CHECK(deq[idx - 1u].offset == finger_offset);
+      finger_ptr = found_node_ptr;
+      offset += static_cast<Offset>(1 + gen_val() % 400000);
+      ++steps;
+    }
+
+    CHECK(0u < steps);
+  }
 }
 
 } // test::treexx::bin::avl
@@ -22,9 +22,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <vector>
@@ -40,6 +42,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <treexx/bin/side.hh>
 #include <treexx/compare_result.hh>
 #include <treexx/bin/avl/tree_algo.hh>
+#include <treexx/stdxx/fork_join_pool.hh>
 
 namespace test::treexx::bin::avl
 {
@@ -78,6 +81,11 @@ protected:
   template<class... T>
   using Deque = ::std::deque<T...>;
 
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
+  using Fork_join_pool = ::treexx::stdxx::fork_join_pool;
+
   template<class... T>
   using Vector = ::std::vector<T...>;
 
@@ -172,23 +180,71 @@ protected:
     template<class T>
     [[nodiscard]] Node_pointer lower_bound(T const& x) noexcept
     {
-      return Tree_algo_::lower_bound(
+      Node_pointer const node_ptr = Tree_algo_::lower_bound(
         core_,
         [&x](Node const& node) noexcept -> Compare_result_
         {
           return Util_::compare(node.value(), x);
         });
+      CHECK(node_ptr == Tree_algo_::partition_point(
+        core_,
+        [&x](Node const& node) noexcept -> bool
+        {
+          return node.value() < x;
+        }));
+      return node_ptr;
+    }
+
+    template<class T>
+    [[nodiscard]] Vector<Node_pointer> lower_bound_batch(
+      Vector<T> const& queries)
+    {
+      Vector<Node_pointer> result;
+      Tree_algo_::lower_bound_batch(
+        core_,
+        queries.cbegin(),
+        queries.cend(),
+        ::std::back_inserter(result),
+        [](Node const& node, T const& x) noexcept -> bool
+        {
+          return node.value() < x;
+        });
+      return result;
+    }
+
+    template<Size group_size, class T>
+    [[nodiscard]] Vector<Node_pointer> partition_point_interleaved(
+      Vector<T> const& queries)
+    {
+      Vector<Node_pointer> result;
+      Tree_algo_::partition_point_interleaved<group_size>(
+        core_,
+        queries.cbegin(),
+        queries.cend(),
+        ::std::back_inserter(result),
+        [](Node const& node, T const& x) noexcept -> bool
+        {
+          return node.value() < x;
+        });
+      return result;
     }
 
     template<class T>
     [[nodiscard]] Node_pointer upper_bound(T const& x) noexcept
     {
-      return Tree_algo_::upper_bound(
+      Node_pointer const node_ptr = Tree_algo_::upper_bound(
         core_,
         [&x](Node const& node) noexcept -> Compare_result_
         {
           return Util_::compare(node.value(), x);
         });
+      CHECK(node_ptr == Tree_algo_::partition_point(
+        core_,
+        [&x](Node const& node) noexcept -> bool
+        {
+          return !(x < node.value());
+        }));
+      return node_ptr;
     }
 
     template<class Fun>
@@ -203,6 +259,13 @@ protected:
       Tree_algo_::for_each_backward(core_, static_cast<Fun&&>(fun));
     }
 
+    template<class Fun, class Fork_join>
+    void for_each_unordered(Fun&& fun, Fork_join& fork_join) const
+    {
+      Tree_algo_::for_each_unordered(
+        core_, static_cast<Fun&&>(fun), fork_join);
+    }
+
     void verify() const
     {
       Util_::verify_tree<false, false>(core_);
@@ -305,6 +368,46 @@ protected:
       core_.xyz_reset();
     }
 
+    template<class Fun>
+    bool clear_some(Fun&& fun, Size const count) noexcept
+    {
+      bool const more = Tree_algo_::clear_some(
+        core_,
+        [&fun](Node_pointer const& node_ptr)
+        {
+          Unique_ptr_<Node> node(Core_::address(node_ptr));
+          bool const is_leaf =
+            !Core_::template child<Side_::left>(*node) &&
+            !Core_::template child<Side_::right>(*node);
+          static_cast<Fun&&>(fun)(node_ptr, is_leaf);
+          node.reset();
+        },
+        count);
+
+      if(!more)
+      {
+        core_.xyz_reset();
+      }
+
+      return more;
+    }
+
+    template<class Fun, class Fork_join>
+    void clear(Fun&& fun, Fork_join& fork_join) noexcept
+    {
+      Tree_algo_::clear(
+        core_,
+        [&fun](Node_pointer const& node_ptr)
+        {
+          Unique_ptr_<Node> node(Core_::address(node_ptr));
+          static_cast<Fun&&>(fun)(node_ptr);
+          node.reset();
+        },
+        fork_join);
+
+      core_.xyz_reset();
+    }
+
     [[nodiscard]] static Node const* address(
       Node_const_pointer const& node_ptr) noexcept
     {
@@ -409,11 +512,104 @@ protected:
   }
 };
 
+TEST_CASE_METHOD(
+  Simple_tree_core_test,
+  "Simple AVL tree core: lower_bound_batch",
+  "[tree++][treexx][bin][avl][algo][simple][lower_bound_batch]")
+{
+  using Value = Int_64;
+  using Tree = Tree<Value>;
+
+  Tree tree;
+  CHECK(Vector<Tree::Node_pointer>{nullptr, nullptr} ==
+    tree.lower_bound_batch(Vector<Value>{1, 2}));
+
+  Uniform_gen<Value> gen(0, 200000);
+  for(Size i = 0u; 20000u > i; ++i)
+  {
+    Value const val = gen() * 2;
+    tree.emplace(tree.lower_bound(val), val);
+  }
+
+  tree.verify();
+  Size const densities[] = {1u, 10u, 1000u, 100000u};
+  for(Size const density: densities)
+  {
+    Vector<Value> queries;
+    for(Size i = 0u; density > i; ++i)
+    {
+      queries.push_back(gen() * 2 + gen() % 2 - 1);
+    }
+
+    queries.push_back(-5);
+    queries.push_back(400001);
+    ::std::sort(queries.begin(), queries.end());
+    auto const found = tree.lower_bound_batch(queries);
+    REQUIRE(queries.size() == found.size());
+    for(Size i = 0u; queries.size() > i; ++i)
+    {
+      CHECK(tree.lower_bound(queries[i]) == found[i]);
+    }
+  }
+}
+
+TEST_CASE_METHOD(
+  Simple_tree_core_test,
+  "Simple AVL tree core: partition_point_interleaved",
+  "[tree++][treexx][bin][avl][algo][simple][partition_point_interleaved]")
+{
+  using Value = Int_64;
+  using Tree = Tree<Value>;
+
+  Tree tree;
+  Uniform_gen<Value> gen(-1000, 301000);
+  auto const check = [&tree, &gen](Size const count)
+  {
+    Vector<Value> queries;
+    for(Size i = 0u; count > i; ++i)
+    {
+      queries.push_back(gen());
+    }
+
+    auto const found_1 = tree.partition_point_interleaved<1u>(queries);
+    auto const found_3 = tree.partition_point_interleaved<3u>(queries);
+    auto const found_8 = tree.partition_point_interleaved<8u>(queries);
+    REQUIRE(count == found_1.size());
+    REQUIRE(count == found_3.size());
+    REQUIRE(count == found_8.size());
+    for(Size i = 0u; count > i; ++i)
+    {
+      auto const node_ptr = tree.lower_bound(queries[i]);
+      CHECK(node_ptr == found_1[i]);
+      CHECK(node_ptr == found_3[i]);
+      CHECK(node_ptr == found_8[i]);
+    }
+  };
+
+  check(0u);
+  check(5u);
+  for(Value val = 0; 300000 > val; val += 3)
+  {
+    tree.emplace(nullptr, val);
+    if(3 == val || 30 == val)
+    {
+      check(17u);
+    }
+  }
+
+  tree.verify();
+  check(0u);
+  check(1u);
+  check(7u);
+  check(8u);
+  check(20001u);
+}
+
 TEST_CASE_METHOD(
   Simple_tree_core_test,
   "Simple AVL tree core: binary_search, lower_bound, upper_bound",
   "[tree++][treexx][bin][avl][algo][simple]"
-  "[binary_search][lower_bound][upper_bound]")
+  "[binary_search][lower_bound][upper_bound][partition_point]")
 {
   using Value = Int_64;
   using Vector = Vector<Value>;
@@ -1091,4 +1287,106 @@ TEST_CASE_METHOD(
   tree.verify();
 }
 
+TEST_CASE_METHOD(
+  Simple_tree_core_test,
+  "Simple AVL tree core: for_each_unordered, parallel clear",
+  "[tree++][treexx][bin][avl][algo][simple][for_each][clear]")
+{
+  using Value = Unt_64;
+  using Tree = Tree<Value>;
+
+  Size const grain_size = GENERATE(1u, 16u, 100000u);
+  Size const count(GENERATE(
+    0u, 1u, 2u, 3u, 10u, 16u, 37u, 100u, 1000u, 2539u, 10000u, 0x10000u,
+    1000000u));
+  Fork_join_pool pool(3u, grain_size);
+
+  Tree tree;
+  for(Size i = 0u; count > i; ++i)
+  {
+    tree.emplace_back(static_cast<Value>(i));
+  }
+
+  Atomic<Size> visited(0u);
+  Atomic<Value> sum(0u);
+  tree.for_each_unordered(
+    [&visited, &sum](auto const& node) noexcept
+    {
+      visited.fetch_add(1u, ::std::memory_order_relaxed);
+      sum.fetch_add(node.value(), ::std::memory_order_relaxed);
+    },
+    pool);
+
+  Value const expected_sum(
+    static_cast<Value>(count) * static_cast<Value>(count - 1u) / 2u);
+  CHECK(count == visited.load());
+  CHECK(expected_sum == sum.load());
+  tree.verify();
+
+  Atomic<Size> destroyed(0u);
+  tree.clear(
+    [&destroyed](auto const&) noexcept
+    {
+      destroyed.fetch_add(1u, ::std::memory_order_relaxed);
+    },
+    pool);
+
+  CHECK(count == destroyed.load());
+  CHECK(0u == tree.size());
+  CHECK(tree.empty());
+  tree.verify();
+}
+
+TEST_CASE_METHOD(
+  Simple_tree_core_test,
+  "Simple AVL tree core: clear_some",
+  "[tree++][treexx][bin][avl][algo][simple][clear]")
+{
+  using Value = Unt_64;
+  using Tree = Tree<Value>;
+
+  Size const chunk = GENERATE(1u, 3u, 64u, 100000u);
+  Size const count(GENERATE(0u, 1u, 2u, 3u, 10u, 37u, 1000u, 2539u, 10000u));
+
+  Tree tree;
+  Set<void const*> nodes;
+  for(Size i = 0u; count > i; ++i)
+  {
+    nodes.emplace(&tree.emplace_back(static_cast<Value>(i)));
+  }
+
+  Size calls = 0u;
+  Size leaves = 0u;
+  for(;;)
+  {
+    Size destroyed = 0u;
+    bool const more = tree.clear_some(
+      [&](auto const& node_ptr, bool const is_leaf)
+      {
+        ++destroyed;
+        leaves += is_leaf ? 1u : 0u;
+        auto const nodes_erased(
+          nodes.erase(&Tree::address(node_ptr)->value()));
+        CHECK(1u == nodes_erased);
+      },
+      chunk);
+
+    ++calls;
+    CHECK(chunk >= destroyed);
+    if(!more)
+    {
+      break;
+    }
+
+    CHECK(chunk == destroyed);
+  }
+
+  // Each node is destroyed after its children, so it has none left then.
+  CHECK(count == leaves);
+  CHECK((0u < count ? (count + chunk - 1u) / chunk : 1u) == calls);
+  CHECK(nodes.empty());
+  CHECK(tree.empty());
+  tree.verify();
+}
+
 } // namespace test::treexx::bin::avl
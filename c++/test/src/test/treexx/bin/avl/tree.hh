@@ -188,6 +188,11 @@ public:
     }
   }
 
+  void set_xyz_size(Size const s) noexcept
+  {
+    size_ = s;
+  }
+
   void xyz_reset() noexcept
   {
     root_ = nullptr;
@@ -0,0 +1,192 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <treexx/stdxx/background_reclaimer.hh>
+#include <treexx/stdxx/indexed_multiset.hh>
+#include <treexx/stdxx/sparse_sequence_map.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Background_reclaimer_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Background_reclaimer = ::treexx::stdxx::background_reclaimer;
+
+  template<class... T>
+  using Indexed_multiset = ::treexx::stdxx::indexed_multiset<T...>;
+
+  template<class... T>
+  using Sparse_sequence_map = ::treexx::stdxx::sparse_sequence_map<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
+  // Keeps count of the live instances.
+  struct Counted
+  {
+    explicit Counted(int const x = 0) noexcept :
+      value(x)
+    {
+      live().fetch_add(1);
+    }
+
+    Counted(Counted const& x) noexcept :
+      value(x.value)
+    {
+      live().fetch_add(1);
+    }
+
+    ~Counted()
+    {
+      live().fetch_sub(1);
+    }
+
+    Counted& operator =(Counted const&) = default;
+
+    [[nodiscard]] friend bool operator <(
+      Counted const& x,
+      Counted const& y) noexcept
+    {
+      return x.value < y.value;
+    }
+
+    [[nodiscard]] static Atomic<long>& live() noexcept
+    {
+      static Atomic<long> n(0);
+      return n;
+    }
+
+    int value;
+  };
+};
+
+TEST_CASE_METHOD(
+  Background_reclaimer_test,
+  "Background reclaimer: jobs take turns by chunk",
+  "[tree++][treexx][stdxx][background_reclaimer]")
+{
+  Vector<int> calls;
+  {
+    Background_reclaimer reclaimer(10u);
+    CHECK(10u == reclaimer.chunk_size());
+
+    // Hold the worker until both jobs are queued.
+    Atomic<bool> go(false);
+    reclaimer.post(
+      [&go](Size) noexcept -> bool
+      {
+        while(!go.load())
+        {
+          ::std::this_thread::yield();
+        }
+
+        return false;
+      });
+
+    Size left_a = 50u;
+    Size left_b = 15u;
+    reclaimer.post(
+      [&calls, &left_a](Size const chunk) noexcept -> bool
+      {
+        calls.push_back(0);
+        left_a -= chunk < left_a ? chunk : left_a;
+        return 0u < left_a;
+      });
+    reclaimer.post(
+      [&calls, &left_b](Size const chunk) noexcept -> bool
+      {
+        calls.push_back(1);
+        left_b -= chunk < left_b ? chunk : left_b;
+        return 0u < left_b;
+      });
+
+    CHECK(3u == reclaimer.pending());
+    go.store(true);
+    reclaimer.drain();
+    CHECK(0u == reclaimer.pending());
+    CHECK((Vector<int>{0, 1, 0, 1, 0, 0, 0}) == calls);
+
+    // The destructor finishes what is still queued.
+    calls.clear();
+    reclaimer.post(
+      [&calls](Size) noexcept -> bool
+      {
+        calls.push_back(2);
+        return 3u > calls.size();
+      });
+  }
+
+  CHECK((Vector<int>{2, 2, 2}) == calls);
+}
+
+TEST_CASE_METHOD(
+  Background_reclaimer_test,
+  "Background reclaimer: containers cleared in the background",
+  "[tree++][treexx][stdxx][background_reclaimer]")
+{
+  Background_reclaimer reclaimer(100u);
+  {
+    Indexed_multiset<Counted> set;
+    Sparse_sequence_map<Counted> map;
+    set.clear(reclaimer);
+    map.clear(reclaimer);
+    CHECK(0u == reclaimer.pending());
+
+    for(int i = 0; 5000 > i; ++i)
+    {
+      set.insert(Counted(i % 1000));
+      map.insert_or_assign(static_cast<Size>(i) * 3u, Counted(i));
+    }
+
+    CHECK(10000 == Counted::live().load());
+    set.clear(reclaimer);
+    map.clear(reclaimer);
+    CHECK(set.empty());
+    CHECK(map.empty());
+    CHECK(set.begin() == set.end());
+    CHECK(map.begin() == map.end());
+
+    set.insert(Counted(7));
+    map.insert_or_assign(7u, Counted(7));
+    CHECK(1u == set.size());
+    CHECK(1u == map.size());
+    set.clear(reclaimer);
+  }
+
+  reclaimer.drain();
+  CHECK(0 == Counted::live().load());
+}
+
+} // namespace test::treexx::stdxx
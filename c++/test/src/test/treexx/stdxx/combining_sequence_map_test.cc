@@ -0,0 +1,245 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/combining_sequence_map.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Combining_sequence_map_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using Thread = ::std::thread;
+
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
+  template<class... T>
+  using Combining_sequence_map =
+    ::treexx::stdxx::combining_sequence_map<T...>;
+
+  template<class... T>
+  using Map = ::std::map<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class Seq, class Model>
+  static void check_equal(Seq const& seq, Model const& model)
+  {
+    seq.read(
+      [&model](auto const& map)
+      {
+        REQUIRE(model.size() == map.size());
+        auto it = map.begin();
+        for(auto const& x: model)
+        {
+          REQUIRE(map.end() != it);
+          CHECK(x.first == it.position());
+          CHECK(x.second == *it);
+          ++it;
+        }
+
+        CHECK(map.end() == it);
+      });
+  }
+};
+
+TEST_CASE_METHOD(
+  Combining_sequence_map_test,
+  "Combining sequence map: single writer against std::map",
+  "[tree++][treexx][stdxx][combining_sequence_map]")
+{
+  using Seq = Combining_sequence_map<Int_64>;
+
+  Uniform_gen<Size> gen(0u, 999u);
+  Map<Size, Int_64> model;
+  Seq seq(2u);
+  auto writer = seq.make_writer();
+  auto other = seq.make_writer();
+
+  CHECK(static_cast<bool>(writer));
+  CHECK(static_cast<bool>(other));
+  CHECK(seq.empty());
+  CHECK_THROWS_AS(seq.make_writer(), ::std::length_error);
+
+  for(Size i = 0u; 5000u > i; ++i)
+  {
+    Size const pos = gen();
+    Size const op = gen() % 10u;
+    if(5u > op)
+    {
+      Int_64 const val = static_cast<Int_64>(i);
+      bool const inserted = model.insert_or_assign(pos, val).second;
+      CHECK(inserted == writer.insert_or_assign(pos, val));
+    }
+    else if(7u > op)
+    {
+      CHECK(model.erase(pos) == writer.erase(pos));
+    }
+    else
+    {
+      Size const count = gen() % 4u + 1u;
+      Map<Size, Int_64> shifted;
+      Size erased = 0u;
+      for(auto const& x: model)
+      {
+        if(pos > x.first)
+        {
+          shifted.emplace(x.first, x.second);
+        }
+        else if(8u > op)
+        {
+          shifted.emplace(x.first + count, x.second);
+        }
+        else if(pos + count > x.first)
+        {
+          ++erased;
+        }
+        else
+        {
+          shifted.emplace(x.first - count, x.second);
+        }
+      }
+
+      model.swap(shifted);
+      if(8u > op)
+      {
+        writer.insert_rows(pos, count);
+      }
+      else
+      {
+        CHECK(erased == writer.erase_rows(pos, count));
+      }
+    }
+
+    if(0u == i % 500u)
+    {
+      check_equal(seq, model);
+    }
+  }
+
+  check_equal(seq, model);
+  CHECK(model.size() == seq.size());
+
+  other = {};
+  CHECK(!other);
+  CHECK(static_cast<bool>(seq.make_writer()));
+}
+
+TEST_CASE_METHOD(
+  Combining_sequence_map_test,
+  "Combining sequence map: concurrent writers",
+  "[tree++][treexx][stdxx][combining_sequence_map]")
+{
+  using Seq = Combining_sequence_map<Int_64>;
+
+  Size constexpr thread_count = 8u;
+  Size constexpr per_thread = 2000u;
+  Seq seq(thread_count + 1u);
+  Atomic<Size> erased(0u);
+
+  {
+    auto writer = seq.make_writer();
+    CHECK(writer.insert_or_assign(0u, -1));
+  }
+
+  Vector<Thread> threads;
+  for(Size t = 0u; thread_count > t; ++t)
+  {
+    threads.emplace_back(
+      [&seq, &erased, t]()
+      {
+        auto writer = seq.make_writer();
+        for(Size i = 0u; per_thread > i; ++i)
+        {
+          Size const pos = 1u + t + i * thread_count;
+          writer.insert_or_assign(pos, static_cast<Int_64>(pos));
+        }
+
+        for(Size i = 0u; per_thread > i; i += 2u)
+        {
+          Size const pos = 1u + t + i * thread_count;
+          erased.fetch_add(writer.erase(pos));
+        }
+      });
+  }
+
+  for(Thread& thread: threads)
+  {
+    thread.join();
+  }
+
+  CHECK(thread_count * per_thread / 2u == erased.load());
+  threads.clear();
+  for(Size t = 0u; thread_count > t; ++t)
+  {
+    threads.emplace_back(
+      [&seq]()
+      {
+        auto writer = seq.make_writer();
+        for(Size i = 0u; per_thread > i; ++i)
+        {
+          writer.insert_rows(0u, 1u);
+        }
+      });
+  }
+
+  for(Thread& thread: threads)
+  {
+    thread.join();
+  }
+
+  Size const shift = thread_count * per_thread;
+  Map<Size, Int_64> model;
+  model.emplace(shift, -1);
+  for(Size i = 1u; per_thread > i; i += 2u)
+  {
+    for(Size t = 0u; thread_count > t; ++t)
+    {
+      Size const pos = 1u + t + i * thread_count;
+      model.emplace(pos + shift, static_cast<Int_64>(pos));
+    }
+  }
+
+  check_equal(seq, model);
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,162 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <treexx/stdxx/fork_join_pool.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Fork_join_pool_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Unt_64 = ::std::uint64_t;
+  using Fork_join_pool = ::treexx::stdxx::fork_join_pool;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
+  // Sums [first, last) by recursive halving down to the grain size.
+  static Unt_64 sum(Fork_join_pool& pool, Unt_64 const first, Unt_64 const last)
+  {
+    if(last - first <= pool.grain_size())
+    {
+      Unt_64 s = 0u;
+      for(Unt_64 x = first; last > x; ++x)
+      {
+        s += x;
+      }
+
+      return s;
+    }
+
+    Unt_64 const middle = first + (last - first) / 2u;
+    Unt_64 left = 0u;
+    Unt_64 right = 0u;
+    pool.invoke(
+      [&]() { left = sum(pool, first, middle); },
+      [&]() { right = sum(pool, middle, last); });
+    return left + right;
+  }
+
+  [[nodiscard]] static Unt_64 expected_sum(Unt_64 const n) noexcept
+  {
+    return n * (n - 1u) / 2u;
+  }
+};
+
+TEST_CASE_METHOD(
+  Fork_join_pool_test,
+  "Fork-join pool: nested invoke",
+  "[tree++][treexx][stdxx][fork_join_pool]")
+{
+  for(Size const thread_count: {0u, 1u, 4u})
+  {
+    for(Size const grain_size: {1u, 7u, 1000u})
+    {
+      Fork_join_pool pool(thread_count, grain_size);
+      CHECK(thread_count == pool.thread_count());
+      CHECK(grain_size == pool.grain_size());
+      for(Unt_64 const n: {0u, 1u, 2u, 1000u, 100000u})
+      {
+        CHECK(expected_sum(n) == sum(pool, 0u, n));
+      }
+    }
+  }
+}
+
+TEST_CASE_METHOD(
+  Fork_join_pool_test,
+  "Fork-join pool: invoke from several threads",
+  "[tree++][treexx][stdxx][fork_join_pool]")
+{
+  Fork_join_pool pool(3u, 16u);
+  Atomic<Size> failures(0u);
+  Vector<::std::thread> threads;
+  for(int t = 0; 4 > t; ++t)
+  {
+    threads.emplace_back(
+      [&pool, &failures]()
+      {
+        for(int i = 0; 20 > i; ++i)
+        {
+          if(expected_sum(30000u) != sum(pool, 0u, 30000u))
+          {
+            failures.fetch_add(1u);
+          }
+        }
+      });
+  }
+
+  for(::std::thread& thread: threads)
+  {
+    thread.join();
+  }
+
+  CHECK(0u == failures.load());
+}
+
+TEST_CASE_METHOD(
+  Fork_join_pool_test,
+  "Fork-join pool: exceptions",
+  "[tree++][treexx][stdxx][fork_join_pool]")
+{
+  Fork_join_pool pool(2u, 1u);
+  bool f_done = false;
+  bool g_done = false;
+  CHECK_THROWS_AS(
+    pool.invoke(
+      [&f_done]() { f_done = true; },
+      []() { throw ::std::runtime_error("g"); }),
+    ::std::runtime_error);
+  CHECK(f_done);
+
+  // The exception of f wins, and g still runs to the end.
+  try
+  {
+    pool.invoke(
+      []() { throw ::std::logic_error("f"); },
+      [&g_done]() { g_done = true; throw ::std::runtime_error("g"); });
+    CHECK(false);
+  }
+  catch(::std::logic_error const&)
+  {
+    CHECK(g_done);
+  }
+
+  CHECK(expected_sum(5000u) == sum(pool, 0u, 5000u));
+}
+
+} // namespace test::treexx::stdxx
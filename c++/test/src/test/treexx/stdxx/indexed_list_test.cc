@@ -0,0 +1,410 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/indexed_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Indexed_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Ptrdiff = ::std::ptrdiff_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Indexed_list = ::treexx::stdxx::indexed_list<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  // Books every allocation under the arena of the allocator that made it,
+  // and counts deallocations through an allocator of another arena. Arenas
+  // do not propagate, so allocators of different arenas never mix.
+  struct Arena
+  {
+    ::std::set<void const*> live;
+    Size foreign_frees = 0u;
+  };
+
+  template<class T>
+  struct Arena_allocator
+  {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = ::std::false_type;
+    using propagate_on_container_move_assignment = ::std::false_type;
+    using propagate_on_container_swap = ::std::false_type;
+    using is_always_equal = ::std::false_type;
+
+    explicit Arena_allocator(Arena& a) noexcept :
+      arena(::std::addressof(a))
+    {}
+
+    template<class U>
+    Arena_allocator(Arena_allocator<U> const& x) noexcept :
+      arena(x.arena)
+    {}
+
+    [[nodiscard]] T* allocate(Size const n)
+    {
+      T* const p = ::std::allocator<T>().allocate(n);
+      arena->live.insert(p);
+      return p;
+    }
+
+    void deallocate(T* const p, Size const n) noexcept
+    {
+      if(0u == arena->live.erase(p))
+      {
+        ++arena->foreign_frees;
+      }
+
+      ::std::allocator<T>().deallocate(p, n);
+    }
+
+    template<class U>
+    [[nodiscard]] bool operator ==(
+      Arena_allocator<U> const& x) const noexcept
+    {
+      return arena == x.arena;
+    }
+
+    template<class U>
+    [[nodiscard]] bool operator !=(
+      Arena_allocator<U> const& x) const noexcept
+    {
+      return arena != x.arena;
+    }
+
+    Arena* arena;
+  };
+
+  template<class T, class... U>
+  static void expect_match(
+    Vector<T> const& vec,
+    Indexed_list<T, U...> const& list)
+  {
+    REQUIRE(vec.size() == list.size());
+    CHECK(vec.empty() == list.empty());
+
+    auto list_it = list.begin();
+    for(auto const& val: vec)
+    {
+      REQUIRE(list.end() != list_it);
+      CHECK(val == *list_it);
+      ++list_it;
+    }
+
+    CHECK(list.end() == list_it);
+  }
+};
+
+TEST_CASE_METHOD(
+  Indexed_list_test,
+  "Indexed list: push, pop, element access",
+  "[tree++][treexx][stdxx][indexed_list]")
+{
+  using Value = Int_64;
+  using Vector = Vector<Value>;
+  using List = Indexed_list<Value>;
+
+  Size constexpr count = 1000u;
+  Vector vec;
+  List list;
+
+  CHECK(list.empty());
+  CHECK(list.begin() == list.end());
+
+  for(Size i = 0u; count > i; ++i)
+  {
+    auto const val = static_cast<Value>(i);
+    if(0u == i % 3u)
+    {
+      vec.insert(vec.begin(), val);
+      CHECK(val == list.push_front(val));
+    }
+    else
+    {
+      vec.push_back(val);
+      CHECK(val == list.emplace_back(val));
+    }
+  }
+
+  expect_match(vec, list);
+  CHECK(vec.front() == list.front());
+  CHECK(vec.back() == list.back());
+
+  for(Size i = 0u; count > i; ++i)
+  {
+    CHECK(vec[i] == list[i]);
+    CHECK(vec[i] == list.at(i));
+    auto const it = list.find(i);
+    REQUIRE(list.end() != it);
+    CHECK(vec[i] == *it);
+    CHECK(i == it.index());
+  }
+
+  CHECK(list.end() == list.find(count));
+  CHECK_THROWS_AS(list.at(count), ::std::out_of_range);
+
+  while(!vec.empty())
+  {
+    if(0u == vec.size() % 2u)
+    {
+      vec.pop_back();
+      list.pop_back();
+    }
+    else
+    {
+      vec.erase(vec.begin());
+      list.pop_front();
+    }
+
+    CHECK(vec.size() == list.size());
+  }
+
+  CHECK(list.empty());
+}
+
+TEST_CASE_METHOD(
+  Indexed_list_test,
+  "Indexed list: insert and erase at random positions",
+  "[tree++][treexx][stdxx][indexed_list]")
+{
+  using Value = Int_64;
+  using Vector = Vector<Value>;
+  using List = Indexed_list<Value>;
+
+  Size constexpr count = 4000u;
+  Uniform_gen<Size> gen(0u, count);
+  Vector vec;
+  List list;
+
+  for(Size i = 0u; count > i; ++i)
+  {
+    auto const val = static_cast<Value>(i);
+    Size const idx = gen() % (vec.size() + 1u);
+    vec.insert(vec.begin() + static_cast<Ptrdiff>(idx), val);
+    if(0u == i % 2u)
+    {
+      auto const it = list.insert(idx, val);
+      CHECK(val == *it);
+      CHECK(idx == it.index());
+    }
+    else
+    {
+      auto const it =
+        list.emplace(list.cbegin() + static_cast<Ptrdiff>(idx), val);
+      CHECK(val == *it);
+      CHECK(idx == it.index());
+    }
+  }
+
+  expect_match(vec, list);
+
+  while(count / 4u < vec.size())
+  {
+    Size const idx = gen() % vec.size();
+    auto const vec_it = vec.erase(vec.begin() + static_cast<Ptrdiff>(idx));
+    auto const list_it = 0u == idx % 2u ?
+      list.erase(idx) :
+      list.erase(list.cbegin() + static_cast<Ptrdiff>(idx));
+
+    if(vec.end() == vec_it)
+    {
+      CHECK(list.end() == list_it);
+    }
+    else
+    {
+      REQUIRE(list.end() != list_it);
+      CHECK(*vec_it == *list_it);
+      CHECK(idx == list_it.index());
+    }
+  }
+
+  expect_match(vec, list);
+  list.clear();
+  CHECK(list.empty());
+  CHECK(0u == list.size());
+}
+
+TEST_CASE_METHOD(
+  Indexed_list_test,
+  "Indexed list: iterators",
+  "[tree++][treexx][stdxx][indexed_list][iterator]")
+{
+  using Value = Int_64;
+  using List = Indexed_list<Value>;
+
+  Size constexpr count = 500u;
+  List list;
+  for(Size i = 0u; count > i; ++i)
+  {
+    list.push_back(static_cast<Value>(i));
+  }
+
+  auto const begin = list.cbegin();
+  auto const end = list.cend();
+  CHECK(static_cast<Ptrdiff>(count) == end - begin);
+  CHECK(static_cast<Ptrdiff>(count) == ::std::distance(begin, end));
+  CHECK(begin < end);
+  CHECK(end > begin);
+  CHECK(begin <= begin);
+  CHECK(!(begin < begin));
+
+  auto it = end;
+  --it;
+  CHECK(static_cast<Value>(count - 1u) == *it);
+  it -= 99;
+  CHECK(static_cast<Value>(count - 100u) == *it);
+  CHECK(static_cast<Value>(count - 90u) == it[10]);
+  it += 100;
+  CHECK(end == it);
+
+  Value expected = static_cast<Value>(count);
+  for(auto r_it = list.rbegin(); list.rend() != r_it; ++r_it)
+  {
+    CHECK(--expected == *r_it);
+  }
+
+  CHECK(0 == expected);
+
+  for(auto& val: list)
+  {
+    val *= 2;
+  }
+
+  for(Size i = 0u; count > i; ++i)
+  {
+    CHECK(static_cast<Value>(i * 2u) == *(begin + static_cast<Ptrdiff>(i)));
+  }
+}
+
+TEST_CASE_METHOD(
+  Indexed_list_test,
+  "Indexed list: copy, move, swap",
+  "[tree++][treexx][stdxx][indexed_list]")
+{
+  using Value = String;
+  using Vector = Vector<Value>;
+  using List = Indexed_list<Value>;
+
+  List list{"alpha", "beta", "gamma"};
+  Vector const vec{"alpha", "beta", "gamma"};
+  expect_match(vec, list);
+
+  List copy(list);
+  expect_match(vec, copy);
+  copy[1u] = "delta";
+  CHECK("beta" == list[1u]);
+
+  List moved(static_cast<List&&>(copy));
+  CHECK(copy.empty());
+  CHECK("delta" == moved[1u]);
+
+  list.swap(moved);
+  CHECK("delta" == list[1u]);
+  CHECK("beta" == moved[1u]);
+
+  list = moved;
+  expect_match(vec, list);
+
+  moved = static_cast<List&&>(list);
+  expect_match(vec, moved);
+  CHECK(list.empty());
+}
+
+TEST_CASE_METHOD(
+  Indexed_list_test,
+  "Indexed list: assignment with stateful allocators",
+  "[tree++][treexx][stdxx][indexed_list]")
+{
+  using Value = String;
+  using Allocator = Arena_allocator<Value>;
+  using List = Indexed_list<Value, Allocator>;
+
+  Arena arena_a;
+  Arena arena_b;
+  Vector<Value> const vec{"alpha", "beta", "gamma", "delta"};
+  Vector<Value> const other{"epsilon"};
+
+  {
+    List a({"alpha", "beta", "gamma", "delta"}, Allocator(arena_a));
+    List b({"epsilon"}, Allocator(arena_b));
+    REQUIRE(4u == arena_a.live.size());
+    REQUIRE(1u == arena_b.live.size());
+
+    // Unequal allocators: the elements move into nodes of arena b.
+    b = static_cast<List&&>(a);
+    expect_match(vec, b);
+    CHECK(Allocator(arena_b) == b.get_allocator());
+    CHECK(4u == arena_b.live.size());
+    CHECK(a.size() == arena_a.live.size());
+
+    // Equal allocators: the nodes are taken over.
+    List c{Allocator(arena_b)};
+    c = static_cast<List&&>(b);
+    expect_match(vec, c);
+    CHECK(b.empty());
+    CHECK(4u == arena_b.live.size());
+
+    // Copies are made by the allocator of the target.
+    List d({"epsilon"}, Allocator(arena_a));
+    d = c;
+    expect_match(vec, d);
+    expect_match(vec, c);
+    CHECK(Allocator(arena_a) == d.get_allocator());
+    CHECK(a.size() + 4u == arena_a.live.size());
+    CHECK(4u == arena_b.live.size());
+
+    a = List({"epsilon"}, Allocator(arena_b));
+    expect_match(other, a);
+    CHECK(Allocator(arena_a) == a.get_allocator());
+  }
+
+  CHECK(arena_a.live.empty());
+  CHECK(arena_b.live.empty());
+  CHECK(0u == arena_a.foreign_frees);
+  CHECK(0u == arena_b.foreign_frees);
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,385 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <test/util/random/util.hh>
+#include <treexx/stdxx/indexed_multiset.hh>
+#include <treexx/stdxx/prefix_less.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Indexed_multiset_test
+{
+  using Random_util_ = ::test::util::random::Util;
+
+protected:
+  using Size = ::std::size_t;
+  using Ptrdiff = ::std::ptrdiff_t;
+  using Int_32 = ::std::int32_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Indexed_multiset = ::treexx::stdxx::indexed_multiset<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class T, class... U>
+  static void expect_match(
+    Vector<T> const& vec,
+    Indexed_multiset<T, U...> const& set)
+  {
+    REQUIRE(vec.size() == set.size());
+    CHECK(vec.empty() == set.empty());
+    CHECK(::std::equal(vec.begin(), vec.end(), set.begin(), set.end()));
+  }
+
+  template<class T, class Fun>
+  static void gen_7548(Fun&& fun)
+  {
+    Random_util_::gen_7548<T>(static_cast<Fun&&>(fun));
+  }
+};
+
+TEST_CASE_METHOD(
+  Indexed_multiset_test,
+  "Indexed multiset: insert, find, bounds, erase",
+  "[tree++][treexx][stdxx][indexed_multiset]")
+{
+  using Value = Int_64;
+  using Vector = Vector<Value>;
+  using Set = Indexed_multiset<Value>;
+
+  Vector vec;
+  Set set;
+
+  gen_7548<Int_32>(
+    [&vec, &set](Int_32 const val_32)
+    {
+      auto const val = static_cast<Value>(val_32 % 1000);
+      vec.emplace_back(val);
+      auto const it = set.insert(val);
+      CHECK(val == *it);
+
+      auto const next = ::std::next(it);
+      CHECK((set.end() == next || val < *next));
+    });
+
+  ::std::sort(vec.begin(), vec.end());
+  expect_match(vec, set);
+  CHECK(vec.front() == set.front());
+  CHECK(vec.back() == set.back());
+
+  for(Value key = -1; 1001 > key; ++key)
+  {
+    auto const vec_lower = ::std::lower_bound(vec.begin(), vec.end(), key);
+    auto const vec_upper = ::std::upper_bound(vec.begin(), vec.end(), key);
+    auto const lower = set.lower_bound(key);
+    auto const upper = set.upper_bound(key);
+
+    CHECK(vec_lower - vec.begin() == lower - set.begin());
+    CHECK(vec_upper - vec.begin() == upper - set.begin());
+    CHECK(static_cast<Size>(vec_upper - vec_lower) == set.count(key));
+    CHECK((vec_lower != vec_upper) == set.contains(key));
+    if(vec_lower != vec_upper)
+    {
+      CHECK(lower == set.find(key));
+    }
+    else
+    {
+      CHECK(set.end() == set.find(key));
+    }
+  }
+
+  for(Value key = 0; 1000 > key; key += 3)
+  {
+    auto const range = ::std::equal_range(vec.begin(), vec.end(), key);
+    Size const count = static_cast<Size>(range.second - range.first);
+    vec.erase(range.first, range.second);
+    CHECK(count == set.erase(key));
+  }
+
+  expect_match(vec, set);
+
+  for(auto it = set.begin(); set.end() != it;)
+  {
+    if(0 == *it % 2)
+    {
+      it = set.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  vec.erase(
+    ::std::remove_if(
+      vec.begin(),
+      vec.end(),
+      [](Value const val)
+      {
+        return 0 == val % 2;
+      }),
+    vec.end());
+  expect_match(vec, set);
+}
+
+TEST_CASE_METHOD(
+  Indexed_multiset_test,
+  "Indexed multiset: rank, select, count_in_range, quantile",
+  "[tree++][treexx][stdxx][indexed_multiset][rank][select]")
+{
+  using Value = Int_64;
+  using Vector = Vector<Value>;
+  using Set = Indexed_multiset<Value>;
+
+  Uniform_gen<Value> gen(0, 499);
+  Vector vec;
+  Set set;
+
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    Value const val = gen();
+    vec.insert(::std::upper_bound(vec.begin(), vec.end(), val), val);
+    set.insert(val);
+
+    if(0u == i % 97u)
+    {
+      for(Value key = -1; 501 > key; key += 7)
+      {
+        auto const rank = static_cast<Size>(
+          ::std::lower_bound(vec.begin(), vec.end(), key) - vec.begin());
+        CHECK(rank == set.rank(key));
+      }
+    }
+  }
+
+  expect_match(vec, set);
+
+  for(Size k = 0u; vec.size() > k; ++k)
+  {
+    auto const it = set.select(k);
+    REQUIRE(set.end() != it);
+    CHECK(vec[k] == *it);
+    CHECK(k == it.index());
+  }
+
+  CHECK(set.end() == set.select(vec.size()));
+
+  for(Value lo = -10; 510 > lo; lo += 13)
+  {
+    for(Value hi = lo - 20; lo + 200 > hi; hi += 17)
+    {
+      auto const count = ::std::count_if(
+        vec.begin(),
+        vec.end(),
+        [lo, hi](Value const val)
+        {
+          return lo <= val && val < hi;
+        });
+      CHECK(static_cast<Size>(count) == set.count_in_range(lo, hi));
+    }
+  }
+
+  Size const last = vec.size() - 1u;
+  CHECK(vec.front() == set.quantile(0.0));
+  CHECK(vec.back() == set.quantile(1.0));
+  CHECK(vec[last / 2u] == set.quantile(0.5));
+  CHECK(
+    vec[static_cast<Size>(0.99 * static_cast<double>(last))] ==
+    set.quantile(0.99));
+}
+
+TEST_CASE_METHOD(
+  Indexed_multiset_test,
+  "Indexed multiset: sliding window quantiles",
+  "[tree++][treexx][stdxx][indexed_multiset][quantile]")
+{
+  using Value = Int_32;
+  using Set = Indexed_multiset<Value, ::std::greater<Value>>;
+
+  Size const window = 256u;
+  Vector<Value> samples;
+  Set set;
+
+  gen_7548<Int_32>(
+    [&samples, &set, window](Int_32 const val)
+    {
+      samples.emplace_back(val);
+      set.insert(val);
+      if(window < samples.size())
+      {
+        auto const it = set.find(samples[samples.size() - window - 1u]);
+        REQUIRE(set.end() != it);
+        set.erase(it);
+      }
+
+      Size const size = ::std::min(window, samples.size());
+      REQUIRE(size == set.size());
+
+      Vector<Value> sorted(
+        samples.end() - static_cast<Ptrdiff>(size), samples.end());
+      ::std::sort(sorted.begin(), sorted.end(), ::std::greater<Value>());
+      CHECK(sorted[(size - 1u) / 2u] == set.quantile(0.5));
+      CHECK(sorted.front() == set.quantile(0.0));
+      CHECK(sorted.back() == set.quantile(1.0));
+    });
+}
+
+TEST_CASE_METHOD(
+  Indexed_multiset_test,
+  "Indexed multiset: copy, move, swap",
+  "[tree++][treexx][stdxx][indexed_multiset]")
+{
+  using Value = Int_64;
+  using Vector = Vector<Value>;
+  using Set = Indexed_multiset<Value>;
+
+  Set set{5, 1, 3, 3, 2};
+  Vector const vec{1, 2, 3, 3, 5};
+  expect_match(vec, set);
+
+  Set copy(set);
+  expect_match(vec, copy);
+  copy.insert(4);
+  CHECK(5u == set.size());
+  CHECK(2u == set.rank(3));
+
+  Set moved(static_cast<Set&&>(copy));
+  CHECK(copy.empty());
+  CHECK(6u == moved.size());
+
+  set.swap(moved);
+  CHECK(6u == set.size());
+  CHECK(5u == moved.size());
+
+  set = moved;
+  expect_match(vec, set);
+
+  moved = static_cast<Set&&>(set);
+  expect_match(vec, moved);
+  CHECK(set.empty());
+}
+
+TEST_CASE_METHOD(
+  Indexed_multiset_test,
+  "Indexed multiset: string keys with stored prefixes",
+  "[tree++][treexx][stdxx][indexed_multiset][prefix]")
+{
+  using Less = ::treexx::stdxx::prefix_less<String>;
+  using Set = Indexed_multiset<String, Less>;
+
+  Less const less;
+  CHECK(0u == less.prefix(String()));
+  CHECK(less.prefix("a") < less.prefix("b"));
+  CHECK(less.prefix("ab") == less.prefix(String("ab\0", 3u)));
+  CHECK(less.prefix("https://a") == less.prefix("https://b"));
+  CHECK(less.prefix(String(1u, '\x7f')) < less.prefix(String(1u, '\x80')));
+
+  // Most keys share their first eight bytes, some are shorter than that.
+  Uniform_gen<Size> gen(0u, 1000000u);
+  auto const gen_key = [&gen]() -> String
+  {
+    String key;
+    switch(gen() % 4u)
+    {
+    case 0u:
+      key = "https://example.com/";
+      break;
+    case 1u:
+      key = "https://ex";
+      break;
+    case 2u:
+      key = "http";
+      break;
+    default:
+      break;
+    }
+
+    for(Size n = gen() % 4u; 0u < n; --n)
+    {
+      key += static_cast<char>('a' + gen() % 3u);
+    }
+
+    if(0u == gen() % 8u)
+    {
+      key += '\x80';
+    }
+
+    return key;
+  };
+
+  Set set;
+  Vector<String> vec;
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    String const key = gen_key();
+    set.insert(key);
+    vec.insert(::std::upper_bound(vec.begin(), vec.end(), key), key);
+  }
+
+  expect_match(vec, set);
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    String const key = gen_key();
+    auto const lo = ::std::lower_bound(vec.begin(), vec.end(), key);
+    auto const hi = ::std::upper_bound(vec.begin(), vec.end(), key);
+    CHECK(lo - vec.begin() == set.lower_bound(key) - set.begin());
+    CHECK(hi - vec.begin() == set.upper_bound(key) - set.begin());
+    CHECK(static_cast<Size>(lo - vec.begin()) == set.rank(key));
+    CHECK(static_cast<Size>(hi - lo) == set.count(key));
+    CHECK((lo != hi) == set.contains(key));
+  }
+
+  for(Size i = 0u; 1000u > i; ++i)
+  {
+    String const key = gen_key();
+    auto const lo = ::std::lower_bound(vec.begin(), vec.end(), key);
+    auto const hi = ::std::upper_bound(vec.begin(), vec.end(), key);
+    CHECK(static_cast<Size>(hi - lo) == set.erase(key));
+    vec.erase(lo, hi);
+  }
+
+  expect_match(vec, set);
+  Set const copy(set);
+  expect_match(vec, copy);
+}
+
+} // namespace test::treexx::stdxx
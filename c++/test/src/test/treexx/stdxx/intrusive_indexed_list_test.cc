@@ -0,0 +1,170 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/avl_hook.hh>
+#include <treexx/stdxx/intrusive_indexed_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Intrusive_indexed_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Ptrdiff = ::std::ptrdiff_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Deque = ::std::deque<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  struct Item
+  {
+    explicit Item(Int_64 const v) noexcept :
+      val(v)
+    {}
+
+    Int_64 val;
+    ::treexx::stdxx::avl_hook<Item, Size> hook;
+  };
+
+  using List =
+    ::treexx::stdxx::intrusive_indexed_list<Item, &Item::hook>;
+
+  static void expect_match(Vector<Item*> const& model, List const& list)
+  {
+    REQUIRE(model.size() == list.size());
+    CHECK(model.empty() == list.empty());
+
+    auto it = list.begin();
+    for(Size i = 0u; model.size() > i; ++i, ++it)
+    {
+      REQUIRE(list.end() != it);
+      CHECK(model[i] == ::std::addressof(*it));
+      CHECK(i == it.index());
+      CHECK(i == list.index_of(*model[i]));
+    }
+
+    CHECK(list.end() == it);
+  }
+};
+
+TEST_CASE_METHOD(
+  Intrusive_indexed_list_test,
+  "Intrusive indexed list: positional insert and erase",
+  "[tree++][treexx][stdxx][intrusive_indexed_list]")
+{
+  Deque<Item> items;
+  Vector<Item*> model;
+  List list;
+
+  CHECK(list.empty());
+  CHECK_THROWS_AS(list.at(0u), ::std::out_of_range);
+
+  for(Int_64 i = 0; 1500 > i; ++i)
+  {
+    Item& item = items.emplace_back(i);
+    Uniform_gen<Size> gen(0u, model.size());
+    Size const idx = gen();
+    model.insert(model.begin() + static_cast<Ptrdiff>(idx), &item);
+    if(0 == i % 3)
+    {
+      auto const it = list.insert(idx, item);
+      CHECK(idx == it.index());
+    }
+    else
+    {
+      auto const pos = list.cbegin() + static_cast<Ptrdiff>(idx);
+      auto const it = list.insert(pos, item);
+      CHECK(&item == &*it);
+    }
+  }
+
+  expect_match(model, list);
+  CHECK(model.front() == &list.front());
+  CHECK(model.back() == &list.back());
+
+  for(Size i = 0u; 500u > i; ++i)
+  {
+    Uniform_gen<Size> gen(0u, model.size() - 1u);
+    Size const idx = gen();
+    Item& item = *model[idx];
+    CHECK(&item == &list[idx]);
+    CHECK(&item == &list.at(idx));
+    model.erase(model.begin() + static_cast<Ptrdiff>(idx));
+    auto const next = list.erase(item);
+    CHECK(idx == next.index());
+  }
+
+  expect_match(model, list);
+
+  CHECK(model.back() == &list.pop_back());
+  model.pop_back();
+  CHECK(model.front() == &list.pop_front());
+  model.erase(model.begin());
+  expect_match(model, list);
+
+  Item& first = items.emplace_back(-1);
+  Item& last = items.emplace_back(-2);
+  list.push_front(first);
+  list.push_back(last);
+  model.insert(model.begin(), &first);
+  model.push_back(&last);
+  expect_match(model, list);
+
+  auto rit = list.rbegin();
+  CHECK(&last == &*rit);
+  CHECK(list.end() - list.begin() == static_cast<Ptrdiff>(model.size()));
+
+  List moved(static_cast<List&&>(list));
+  CHECK(list.empty());
+  expect_match(model, moved);
+
+  Size disposed = 0u;
+  moved.clear_and_dispose(
+    [&disposed](Item* const item)
+    {
+      CHECK(item);
+      ++disposed;
+    });
+  CHECK(model.size() == disposed);
+  CHECK(moved.empty());
+}
+
+} // namespace test::treexx::stdxx
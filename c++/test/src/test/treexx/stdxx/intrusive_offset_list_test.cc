@@ -0,0 +1,244 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/avl_hook.hh>
+#include <treexx/stdxx/intrusive_offset_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Intrusive_offset_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Deque = ::std::deque<T...>;
+
+  template<class... T>
+  using Map = ::std::map<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  struct Item
+  {
+    ::treexx::stdxx::avl_hook<Item, void, Int_64> hook;
+  };
+
+  using List =
+    ::treexx::stdxx::intrusive_offset_list<Item, Int_64, &Item::hook>;
+
+  static void expect_match(Map<Int_64, Item*> const& model, List const& list)
+  {
+    REQUIRE(model.size() == list.size());
+    auto it = list.begin();
+    for(auto const& x: model)
+    {
+      REQUIRE(list.end() != it);
+      CHECK(x.first == it.offset());
+      CHECK(x.second == ::std::addressof(*it));
+      CHECK(x.first == list.offset_of(*x.second));
+      ++it;
+    }
+
+    CHECK(list.end() == it);
+  }
+
+  template<class Model>
+  static void shift(Model& model, Int_64 const from, Int_64 const delta)
+  {
+    Model shifted;
+    for(auto const& x: model)
+    {
+      shifted.emplace(from > x.first ? x.first : x.first + delta, x.second);
+    }
+
+    model.swap(shifted);
+  }
+};
+
+TEST_CASE_METHOD(
+  Intrusive_offset_list_test,
+  "Intrusive offset list: insert, shift, erase",
+  "[tree++][treexx][stdxx][intrusive_offset_list]")
+{
+  Uniform_gen<Int_64> off_gen(0, 20000);
+  Uniform_gen<Int_64> delta_gen(1, 50);
+  Uniform_gen<Size> op_gen(0u, 5u);
+  Deque<Item> items;
+  Map<Int_64, Item*> model;
+  List list;
+
+  CHECK(list.empty());
+  CHECK(list.end() == list.find(0));
+
+  for(Size i = 0u; 4000u > i; ++i)
+  {
+    Int_64 const off = off_gen();
+    switch(op_gen())
+    {
+    case 0u:
+    case 1u:
+      {
+        Item& item = items.emplace_back();
+        bool const inserted = model.emplace(off, &item).second;
+        auto const res = list.insert(off, item);
+        CHECK(inserted == res.second);
+        CHECK(off == res.first.offset());
+        if(!inserted)
+        {
+          items.pop_back();
+        }
+      }
+      break;
+    case 2u:
+      {
+        Item& item = items.emplace_back();
+        Int_64 const delta = delta_gen();
+        shift(model, off, delta);
+        model.emplace(off, &item);
+        auto const it = list.insert_and_shift(off, item, delta);
+        CHECK(off == it.offset());
+      }
+      break;
+    case 3u:
+      {
+        auto const it = list.lower_bound(off);
+        if(list.end() != it)
+        {
+          Int_64 const from = it.offset();
+          Int_64 const delta = delta_gen();
+          shift(model, from, delta);
+          list.shift_right(*it, delta);
+        }
+      }
+      break;
+    case 4u:
+      {
+        auto const it = list.lower_bound(off);
+        if(list.end() != it)
+        {
+          Int_64 const from = it.offset();
+          auto prev = model.find(from);
+          Int_64 const room = model.begin() == prev ?
+            from : from - (--prev)->first - 1;
+          if(0 < room)
+          {
+            Uniform_gen<Int_64> gen(1, room);
+            Int_64 const delta = gen();
+            shift(model, from, -delta);
+            list.shift_left(*it, delta);
+          }
+        }
+      }
+      break;
+    default:
+      {
+        auto const it = list.upper_bound(off);
+        if(list.end() != it)
+        {
+          Item& item = *it;
+          auto const model_it = model.find(it.offset());
+          REQUIRE(model.end() != model_it);
+          auto next = model_it;
+          ++next;
+          if(model.end() != next)
+          {
+            Int_64 const gap = next->first - model_it->first;
+            model.erase(model_it);
+            shift(model, next->first, -gap);
+          }
+          else
+          {
+            model.erase(model_it);
+          }
+
+          static_cast<void>(list.erase_and_shift(item));
+        }
+      }
+      break;
+    }
+
+    if(0u == i % 400u)
+    {
+      expect_match(model, list);
+    }
+  }
+
+  expect_match(model, list);
+
+  for(Int_64 off = -1; 20100 > off; off += 7)
+  {
+    auto const model_it = model.find(off);
+    auto const it = list.find(off);
+    CHECK((model.end() == model_it) == (list.end() == it));
+    CHECK((model.end() != model_it) == list.contains(off));
+
+    auto const model_lower = model.lower_bound(off);
+    auto const lower = list.lower_bound(off);
+    REQUIRE((model.end() == model_lower) == (list.end() == lower));
+    if(model.end() != model_lower)
+    {
+      CHECK(model_lower->second == ::std::addressof(*lower));
+    }
+
+    auto const model_upper = model.upper_bound(off);
+    auto const upper = list.upper_bound(off);
+    REQUIRE((model.end() == model_upper) == (list.end() == upper));
+    if(model.end() != model_upper)
+    {
+      CHECK(model_upper->second == ::std::addressof(*upper));
+    }
+  }
+
+  while(!model.empty())
+  {
+    auto const it = model.begin();
+    CHECK(it->second == ::std::addressof(list.front()));
+    static_cast<void>(list.erase(*it->second));
+    model.erase(it);
+  }
+
+  CHECK(list.empty());
+
+  Item& a = items.emplace_back();
+  Item& b = items.emplace_back();
+  list.push_back(a, 5);
+  list.push_back(b, 7);
+  CHECK(5 == list.offset_of(a));
+  CHECK(12 == list.offset_of(b));
+  CHECK(&b == &list.back());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,267 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/avl_hook.hh>
+#include <treexx/stdxx/intrusive_indexed_list.hh>
+#include <treexx/stdxx/intrusive_offset_list.hh>
+#include <treexx/stdxx/intrusive_set.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Intrusive_set_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Avl_hook = ::treexx::stdxx::avl_hook<T...>;
+
+  template<class... T>
+  using Set = ::std::set<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  struct Session
+  {
+    explicit Session(Int_64 const i) noexcept :
+      id(i)
+    {}
+
+    Int_64 id;
+    Avl_hook<Session> by_id;
+    Avl_hook<Session, Size> by_order;
+    Avl_hook<Session, void, Int_64> by_time;
+  };
+
+  struct Id_less
+  {
+    bool operator ()(Session const& x, Session const& y) const noexcept
+    {
+      return x.id < y.id;
+    }
+
+    bool operator ()(Session const& x, Int_64 const y) const noexcept
+    {
+      return x.id < y;
+    }
+
+    bool operator ()(Int_64 const x, Session const& y) const noexcept
+    {
+      return x < y.id;
+    }
+  };
+
+  using Session_set =
+    ::treexx::stdxx::intrusive_set<Session, &Session::by_id, Id_less>;
+  using Session_list =
+    ::treexx::stdxx::intrusive_indexed_list<Session, &Session::by_order>;
+  using Session_timeline = ::treexx::stdxx::intrusive_offset_list<
+    Session, Int_64, &Session::by_time>;
+
+  static void expect_match(Set<Int_64> const& model, Session_set const& set)
+  {
+    REQUIRE(model.size() == set.size());
+    auto it = set.begin();
+    for(auto const id: model)
+    {
+      REQUIRE(set.end() != it);
+      CHECK(id == it->id);
+      ++it;
+    }
+
+    CHECK(set.end() == it);
+  }
+};
+
+TEST_CASE_METHOD(
+  Intrusive_set_test,
+  "Intrusive set: insert, find, erase",
+  "[tree++][treexx][stdxx][intrusive_set]")
+{
+  Uniform_gen<Int_64> gen(0, 3000);
+  Vector<::std::unique_ptr<Session>> sessions;
+  Set<Int_64> model;
+  Session_set set;
+
+  CHECK(set.empty());
+  CHECK(set.end() == set.find(Int_64(0)));
+
+  for(Size i = 0u; 2000u > i; ++i)
+  {
+    sessions.emplace_back(new Session(gen()));
+    Session& s = *sessions.back();
+    bool const inserted = model.insert(s.id).second;
+    auto const res = set.insert(s);
+    CHECK(inserted == res.second);
+    CHECK(s.id == res.first->id);
+    CHECK(inserted == (::std::addressof(s) == ::std::addressof(*res.first)));
+  }
+
+  expect_match(model, set);
+
+  for(Int_64 id = -1; 3002 > id; ++id)
+  {
+    auto const it = set.find(id);
+    CHECK((0u < model.count(id)) == (set.end() != it));
+    CHECK((0u < model.count(id)) == set.contains(id));
+    if(set.end() != it)
+    {
+      CHECK(id == it->id);
+    }
+
+    auto const lower = set.lower_bound(id);
+    auto const model_lower = model.lower_bound(id);
+    CHECK((model.end() == model_lower) == (set.end() == lower));
+    if(model.end() != model_lower)
+    {
+      CHECK(*model_lower == lower->id);
+    }
+
+    auto const upper = set.upper_bound(id);
+    auto const model_upper = model.upper_bound(id);
+    CHECK((model.end() == model_upper) == (set.end() == upper));
+    if(model.end() != model_upper)
+    {
+      CHECK(*model_upper == upper->id);
+    }
+  }
+
+  for(Int_64 id = 0; 3000 > id; id += 3)
+  {
+    auto const it = set.find(id);
+    if(set.end() != it)
+    {
+      Session& s = *it;
+      auto const next = set.erase(s);
+      auto const model_next = model.upper_bound(id);
+      CHECK(1u == model.erase(id));
+      CHECK((model.end() == model_next) == (set.end() == next));
+      CHECK(!set.contains(id));
+    }
+  }
+
+  expect_match(model, set);
+
+  Session_set moved(static_cast<Session_set&&>(set));
+  CHECK(set.empty());
+  expect_match(model, moved);
+
+  Size disposed = 0u;
+  moved.clear_and_dispose(
+    [&disposed](Session* const s)
+    {
+      CHECK(s);
+      ++disposed;
+    });
+  CHECK(model.size() == disposed);
+  CHECK(moved.empty());
+  CHECK(moved.begin() == moved.end());
+}
+
+TEST_CASE_METHOD(
+  Intrusive_set_test,
+  "Intrusive set: object in several containers",
+  "[tree++][treexx][stdxx][intrusive_set]")
+{
+  Uniform_gen<Int_64> gen(0, 1000000);
+  Vector<::std::unique_ptr<Session>> sessions;
+  Session_set by_id;
+  Session_list by_order;
+  Session_timeline by_time;
+
+  for(Int_64 i = 0; 1000 > i; ++i)
+  {
+    sessions.emplace_back(new Session(gen()));
+    Session& s = *sessions.back();
+    if(!by_id.insert(s).second)
+    {
+      sessions.pop_back();
+      continue;
+    }
+
+    by_order.push_back(s);
+    by_time.push_back(s, 10);
+  }
+
+  REQUIRE(sessions.size() == by_id.size());
+  REQUIRE(sessions.size() == by_order.size());
+  REQUIRE(sessions.size() == by_time.size());
+
+  for(Size i = 0u; sessions.size() > i; ++i)
+  {
+    Session& s = *sessions[i];
+    CHECK(::std::addressof(s) == ::std::addressof(by_order[i]));
+    CHECK(i == by_order.index_of(s));
+    CHECK(static_cast<Int_64>(10u * (i + 1u)) == by_time.offset_of(s));
+    CHECK(::std::addressof(s) == ::std::addressof(*by_id.find(s.id)));
+  }
+
+  for(Size i = 0u; sessions.size() > i; i += 2u)
+  {
+    Session& s = *sessions[i];
+    static_cast<void>(by_id.erase(s));
+    static_cast<void>(by_order.erase(s));
+    static_cast<void>(by_time.erase_and_shift(s));
+  }
+
+  Size idx = 0u;
+  for(Size i = 1u; sessions.size() > i; i += 2u, ++idx)
+  {
+    Session& s = *sessions[i];
+    CHECK(::std::addressof(s) == ::std::addressof(by_order[idx]));
+    CHECK(idx == by_order.index_of(s));
+    CHECK(static_cast<Int_64>(10u * (idx + 1u)) == by_time.offset_of(s));
+    CHECK(by_id.contains(s.id));
+  }
+
+  CHECK(idx == by_id.size());
+  CHECK(idx == by_order.size());
+  CHECK(idx == by_time.size());
+
+  by_id.clear();
+  by_order.clear();
+  by_time.clear();
+  for(auto const& s: sessions)
+  {
+    CHECK(by_id.insert(*s).second);
+  }
+
+  CHECK(sessions.size() == by_id.size());
+}
+
+} // namespace test::treexx::stdxx
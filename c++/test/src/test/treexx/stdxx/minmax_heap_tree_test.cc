@@ -0,0 +1,249 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <test/util/random/util.hh>
+#include <treexx/stdxx/minmax_heap_tree.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Minmax_heap_tree_test
+{
+  using Random_util_ = ::test::util::random::Util;
+
+protected:
+  using Size = ::std::size_t;
+  using Int_32 = ::std::int32_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Minmax_heap_tree = ::treexx::stdxx::minmax_heap_tree<T...>;
+
+  template<class... T>
+  using Multiset = ::std::multiset<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class T, class Fun>
+  static void gen_7548(Fun&& fun)
+  {
+    Random_util_::gen_7548<T>(static_cast<Fun&&>(fun));
+  }
+};
+
+TEST_CASE_METHOD(
+  Minmax_heap_tree_test,
+  "Minmax heap tree: push, min, max, pop",
+  "[tree++][treexx][stdxx][minmax_heap_tree]")
+{
+  using Value = Int_64;
+  using Heap = Minmax_heap_tree<Value>;
+
+  Multiset<Value> set;
+  Heap heap;
+  CHECK(heap.empty());
+  CHECK(!heap.min_handle());
+
+  gen_7548<Int_32>(
+    [&set, &heap](Int_32 const val_32)
+    {
+      auto const val = static_cast<Value>(val_32 % 2000);
+      set.emplace(val);
+      CHECK(val == *heap.push(val));
+      CHECK(*set.begin() == heap.min());
+      CHECK(*set.rbegin() == heap.max());
+    });
+
+  CHECK(set.size() == heap.size());
+
+  for(Size i = 0u; !set.empty(); ++i)
+  {
+    REQUIRE(set.size() == heap.size());
+    CHECK(*set.begin() == heap.min());
+    CHECK(*set.rbegin() == heap.max());
+    CHECK(*set.begin() == *heap.min_handle());
+    CHECK(*set.rbegin() == *heap.max_handle());
+    if(0u == i % 3u)
+    {
+      set.erase(::std::prev(set.end()));
+      heap.pop_max();
+    }
+    else
+    {
+      set.erase(set.begin());
+      heap.pop_min();
+    }
+  }
+
+  CHECK(heap.empty());
+}
+
+TEST_CASE_METHOD(
+  Minmax_heap_tree_test,
+  "Minmax heap tree: erase and update by handle",
+  "[tree++][treexx][stdxx][minmax_heap_tree]")
+{
+  using Value = Int_64;
+  using Heap = Minmax_heap_tree<Value, ::std::greater<Value>>;
+  using Handle = typename Heap::handle;
+
+  Uniform_gen<Value> gen(-100000, 100000);
+  Multiset<Value, ::std::greater<Value>> set;
+  Vector<Handle> handles;
+  Heap heap;
+
+  for(Size i = 0u; 5000u > i; ++i)
+  {
+    Value const val = gen();
+    set.emplace(val);
+    handles.emplace_back(heap.push(val));
+  }
+
+  while(!handles.empty())
+  {
+    auto const idx = static_cast<Size>(gen() + 100000) % handles.size();
+    Handle& h = handles[idx];
+    REQUIRE(h);
+    auto const it = set.find(*h);
+    REQUIRE(set.end() != it);
+    set.erase(it);
+
+    if(0u == idx % 2u)
+    {
+      Value const val = gen();
+      set.emplace(val);
+      h = heap.update(h, val);
+      CHECK(val == *h);
+      if(0u == idx % 4u)
+      {
+        set.erase(set.find(val));
+        heap.erase(h);
+        handles.erase(handles.begin() + static_cast<::std::ptrdiff_t>(idx));
+      }
+    }
+    else
+    {
+      heap.erase(h);
+      handles.erase(handles.begin() + static_cast<::std::ptrdiff_t>(idx));
+    }
+
+    REQUIRE(set.size() == heap.size());
+    if(!set.empty())
+    {
+      CHECK(*set.begin() == heap.min());
+      CHECK(*set.rbegin() == heap.max());
+    }
+  }
+
+  CHECK(heap.empty());
+}
+
+TEST_CASE_METHOD(
+  Minmax_heap_tree_test,
+  "Minmax heap tree: equal elements keep insertion order",
+  "[tree++][treexx][stdxx][minmax_heap_tree]")
+{
+  using Value = ::std::pair<Int_32, Int_32>;
+  struct Compare
+  {
+    bool operator ()(Value const& x, Value const& y) const noexcept
+    {
+      return x.first < y.first;
+    }
+  };
+
+  Minmax_heap_tree<Value, Compare> heap;
+  for(Int_32 i = 0; 10 > i; ++i)
+  {
+    heap.emplace(i % 2, i);
+  }
+
+  for(Int_32 i = 0; 10 > i; i += 2)
+  {
+    CHECK(0 == heap.min().first);
+    CHECK(i == heap.min().second);
+    heap.pop_min();
+  }
+
+  for(Int_32 i = 9; 0 < i; i -= 2)
+  {
+    CHECK(1 == heap.max().first);
+    CHECK(i == heap.max().second);
+    heap.pop_max();
+  }
+
+  CHECK(heap.empty());
+}
+
+TEST_CASE_METHOD(
+  Minmax_heap_tree_test,
+  "Minmax heap tree: copy, move, swap",
+  "[tree++][treexx][stdxx][minmax_heap_tree]")
+{
+  using Value = Int_64;
+  using Heap = Minmax_heap_tree<Value>;
+
+  Heap heap;
+  for(Value val: {5, 1, 9, 3})
+  {
+    heap.push(val);
+  }
+
+  Heap copy(heap);
+  CHECK(4u == copy.size());
+  CHECK(1 == copy.min());
+  CHECK(9 == copy.max());
+  copy.pop_min();
+  CHECK(1 == heap.min());
+
+  Heap moved(static_cast<Heap&&>(copy));
+  CHECK(copy.empty());
+  CHECK(3 == moved.min());
+
+  heap.swap(moved);
+  CHECK(3 == heap.min());
+  CHECK(1 == moved.min());
+
+  heap = moved;
+  CHECK(4u == heap.size());
+  moved = static_cast<Heap&&>(heap);
+  CHECK(heap.empty());
+  CHECK(4u == moved.size());
+}
+
+} // namespace test::treexx::stdxx
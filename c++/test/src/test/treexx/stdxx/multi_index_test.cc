@@ -0,0 +1,319 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/multi_index.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Multi_index_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Multimap = ::std::multimap<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  struct Record
+  {
+    Record(Size const s, Int_64 const i, Int_64 const b) :
+      serial(s),
+      id(i),
+      bytes(b)
+    {}
+
+    Size serial;
+    Int_64 id;
+    Int_64 bytes;
+  };
+
+  struct Id_of
+  {
+    Int_64 operator ()(Record const& r) const noexcept
+    {
+      return r.id;
+    }
+  };
+
+  struct Bytes_of
+  {
+    Int_64 operator ()(Record const& r) const noexcept
+    {
+      return r.bytes;
+    }
+  };
+
+  using Records = ::treexx::stdxx::multi_index<
+    Record,
+    ::treexx::stdxx::views<
+      ::treexx::stdxx::ordered_view<Id_of>,
+      ::treexx::stdxx::sequenced_view,
+      ::treexx::stdxx::offset_view<Int_64, Bytes_of>>>;
+
+  struct Model
+  {
+    void insert(Size const serial, Int_64 const id, Int_64 const bytes)
+    {
+      records.emplace_back(serial, id, bytes);
+    }
+
+    void erase(Size const serial)
+    {
+      for(auto it = records.begin(); records.end() != it; ++it)
+      {
+        if(serial == it->serial)
+        {
+          records.erase(it);
+          break;
+        }
+      }
+    }
+
+    Record* find(Size const serial)
+    {
+      for(auto& r: records)
+      {
+        if(serial == r.serial)
+        {
+          return &r;
+        }
+      }
+
+      return nullptr;
+    }
+
+    Vector<Record> records;
+  };
+
+  static void expect_match(Model const& model, Records const& records)
+  {
+    auto const& by_id = records.get<0u>();
+    auto const& seq = records.get<1u>();
+    auto const& layout = records.get<2u>();
+
+    REQUIRE(model.records.size() == records.size());
+    REQUIRE(model.records.size() == by_id.size());
+    REQUIRE(model.records.size() == seq.size());
+    REQUIRE(model.records.size() == layout.size());
+
+    Multimap<Int_64, Size> ids;
+    Int_64 offset = 0;
+    auto seq_it = seq.begin();
+    auto layout_it = layout.begin();
+    for(Size i = 0u; model.records.size() > i; ++i, ++seq_it, ++layout_it)
+    {
+      Record const& r = model.records[i];
+      ids.emplace(r.id, r.serial);
+      CHECK(r.serial == seq_it->serial);
+      CHECK(r.serial == seq[i].serial);
+      CHECK(i == seq.index_of(seq_it));
+      CHECK(r.serial == layout_it->serial);
+      CHECK(offset == layout.offset_of(layout_it));
+      if(0 < r.bytes)
+      {
+        CHECK(r.serial == layout.locate(offset)->serial);
+        CHECK(r.serial == layout.locate(offset + r.bytes - 1)->serial);
+      }
+
+      offset += r.bytes;
+    }
+
+    CHECK(seq.end() == seq_it);
+    CHECK(layout.end() == layout_it);
+    CHECK(offset == layout.extent());
+    CHECK(layout.end() == layout.locate(offset));
+
+    Vector<::std::pair<Int_64, Size>> expected(ids.begin(), ids.end());
+    Vector<::std::pair<Int_64, Size>> actual;
+    for(auto const& r: by_id)
+    {
+      CHECK((actual.empty() || actual.back().first <= r.id));
+      actual.emplace_back(r.id, r.serial);
+    }
+
+    ::std::sort(expected.begin(), expected.end());
+    ::std::sort(actual.begin(), actual.end());
+    CHECK(expected == actual);
+  }
+};
+
+TEST_CASE_METHOD(
+  Multi_index_test,
+  "Multi index: insert, erase and modify through every view",
+  "[tree++][treexx][stdxx][multi_index]")
+{
+  Uniform_gen<Int_64> id_gen(0, 500);
+  Uniform_gen<Int_64> bytes_gen(0, 100);
+  Uniform_gen<Size> op_gen(0u, 5u);
+  Model model;
+  Records records;
+  Size serial = 0u;
+
+  CHECK(records.empty());
+  CHECK(0 == records.get<2u>().extent());
+
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    switch(op_gen())
+    {
+    case 0u:
+    case 1u:
+    case 2u:
+      {
+        Int_64 const id = id_gen();
+        Int_64 const bytes = bytes_gen();
+        model.insert(serial, id, bytes);
+        auto const it = records.emplace(serial, id, bytes);
+        CHECK(serial == it->serial);
+        ++serial;
+      }
+      break;
+    case 3u:
+      if(!records.empty())
+      {
+        Uniform_gen<Size> gen(0u, records.size() - 1u);
+        auto const it = records.get<1u>().nth(gen());
+        model.erase(it->serial);
+        static_cast<void>(records.erase(it));
+      }
+      break;
+    case 4u:
+      {
+        auto const it = records.get<0u>().find(id_gen());
+        if(records.get<0u>().end() != it)
+        {
+          Int_64 const id = it->id;
+          model.erase(it->serial);
+          auto const next = records.erase(it);
+          CHECK((records.get<0u>().end() == next || id <= next->id));
+        }
+      }
+      break;
+    default:
+      if(!records.empty())
+      {
+        Uniform_gen<Size> gen(0u, records.size() - 1u);
+        auto const it = records.get<1u>().nth(gen());
+        Int_64 const id = id_gen();
+        Int_64 const bytes = bytes_gen();
+        Record* const r = model.find(it->serial);
+        REQUIRE(r);
+        r->id = id;
+        r->bytes = bytes;
+        auto const layout_it = records.project<2u>(it);
+        records.modify(
+          layout_it,
+          [id, bytes](Record& x)
+          {
+            x.id = id;
+            x.bytes = bytes;
+          });
+      }
+      break;
+    }
+
+    if(0u == i % 300u)
+    {
+      expect_match(model, records);
+    }
+  }
+
+  expect_match(model, records);
+
+  auto const& by_id = records.get<0u>();
+  for(Int_64 id = -1; 502 > id; ++id)
+  {
+    Size count = 0u;
+    for(auto const& r: model.records)
+    {
+      count += id == r.id ? 1u : 0u;
+    }
+
+    CHECK(count == by_id.count(id));
+    CHECK((0u < count) == by_id.contains(id));
+    auto const range = by_id.equal_range(id);
+    for(auto it = range.first; range.second != it; ++it)
+    {
+      CHECK(id == it->id);
+    }
+  }
+
+  Records moved(static_cast<Records&&>(records));
+  CHECK(records.empty());
+  expect_match(model, moved);
+
+  moved.clear();
+  CHECK(moved.empty());
+  CHECK(moved.get<1u>().begin() == moved.get<1u>().end());
+}
+
+TEST_CASE_METHOD(
+  Multi_index_test,
+  "Multi index: throwing modification erases the element",
+  "[tree++][treexx][stdxx][multi_index]")
+{
+  Records records;
+  static_cast<void>(records.emplace(0u, 10, 5));
+  static_cast<void>(records.emplace(1u, 20, 7));
+  static_cast<void>(records.emplace(2u, 30, 9));
+
+  auto const it = records.get<0u>().find(20);
+  REQUIRE(records.get<0u>().end() != it);
+  CHECK_THROWS_AS(
+    records.modify(
+      it,
+      [](Record& r)
+      {
+        r.id = 40;
+        throw ::std::runtime_error("modify");
+      }),
+    ::std::runtime_error);
+
+  Model model;
+  model.insert(0u, 10, 5);
+  model.insert(2u, 30, 9);
+  expect_match(model, records);
+  CHECK_THROWS_AS(records.get<1u>().at(2u), ::std::out_of_range);
+}
+
+} // namespace test::treexx::stdxx
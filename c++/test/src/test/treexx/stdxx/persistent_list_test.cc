@@ -0,0 +1,289 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/persistent_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Persistent_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Persistent_list = ::treexx::stdxx::persistent_list<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class L, class V>
+  static void check_equal(L const& list, V const& model)
+  {
+    REQUIRE(model.size() == list.size());
+    auto it = list.begin();
+    for(Size i = 0u; model.size() > i; ++i, ++it)
+    {
+      REQUIRE(list.end() != it);
+      CHECK(model[i] == *it);
+      CHECK(model[i] == list[i]);
+    }
+
+    CHECK(list.end() == it);
+  }
+
+  template<class L, class V>
+  static void check_offsets(L const& list, V const& model)
+  {
+    REQUIRE(model.size() == list.size());
+    auto it = list.begin();
+    for(Size i = 0u; model.size() > i; ++i, ++it)
+    {
+      REQUIRE(list.end() != it);
+      CHECK(model[i].first == *it);
+      CHECK(model[i].second == it.offset());
+      CHECK(model[i].second == list.offset(i));
+      CHECK(model[i].second == list.find(i).offset());
+    }
+  }
+};
+
+TEST_CASE_METHOD(
+  Persistent_list_test,
+  "Persistent list: insert, erase, replace with snapshots",
+  "[tree++][treexx][stdxx][persistent_list]")
+{
+  Uniform_gen<Size> gen(0u, 1000000u);
+  Persistent_list<String> list;
+  Vector<String> model;
+  Vector<::std::pair<Persistent_list<String>, Vector<String>>> snapshots;
+
+  for(Size i = 0u; 1500u > i; ++i)
+  {
+    Size const op = gen() % 8u;
+    if(3u > op || model.empty())
+    {
+      Size const idx = gen() % (model.size() + 1u);
+      String const val = ::std::to_string(i);
+      list.insert(idx, val);
+      model.insert(model.begin() + idx, val);
+    }
+    else if(6u > op)
+    {
+      Size const idx = gen() % model.size();
+      list.erase(idx);
+      model.erase(model.begin() + idx);
+    }
+    else
+    {
+      Size const idx = gen() % model.size();
+      String const val = "r" + ::std::to_string(i);
+      list.replace(idx, val);
+      model[idx] = val;
+    }
+
+    if(0u == i % 100u)
+    {
+      snapshots.emplace_back(list.snapshot(), model);
+    }
+  }
+
+  check_equal(list, model);
+  for(auto const& s: snapshots)
+  {
+    check_equal(s.first, s.second);
+  }
+
+  // Modifying a snapshot must not affect the list it was taken from.
+  Persistent_list<String> copy(list);
+  copy.push_front("front");
+  copy.push_back("back");
+  copy.pop_front();
+  copy.erase(copy.size() / 2u);
+  check_equal(list, model);
+  CHECK("back" == copy.back());
+  CHECK(model.size() == copy.size());
+
+  CHECK_THROWS(list.at(list.size()));
+  list.clear();
+  CHECK(list.empty());
+  check_equal(snapshots.back().first, snapshots.back().second);
+
+  Persistent_list<int> const small{1, 2, 3};
+  CHECK(3u == small.size());
+  CHECK(1 == small.front());
+  CHECK(3 == small.back());
+  CHECK(small.end() == small.find(3u));
+}
+
+TEST_CASE_METHOD(
+  Persistent_list_test,
+  "Persistent list: offsets, shift_suffix and bounds",
+  "[tree++][treexx][stdxx][persistent_list]")
+{
+  using Element = ::std::pair<Int_64, Int_64>;
+
+  Uniform_gen<Int_64> gen(0, 1000000);
+  Persistent_list<Int_64, Int_64> list;
+  Vector<Element> model;
+  Vector<::std::pair<Persistent_list<Int_64, Int_64>, Vector<Element>>>
+    snapshots;
+
+  // Elements are kept back-to-back: the size of element i is its value.
+  auto const offset_at = [&model](Size const idx) -> Int_64
+  {
+    return 0u < idx ?
+      model[idx - 1u].second + model[idx - 1u].first :
+      static_cast<Int_64>(0);
+  };
+
+  for(Int_64 i = 0; 2000 > i; ++i)
+  {
+    Int_64 const op = gen() % 8;
+    if(4 > op || model.empty())
+    {
+      Size const idx = static_cast<Size>(gen()) % (model.size() + 1u);
+      Int_64 const size = 1 + gen() % 50;
+      Int_64 const offset = offset_at(idx);
+      list.emplace(idx, offset, size);
+      list.shift_suffix(idx + 1u, size);
+      model.insert(model.begin() + idx, Element(size, offset));
+      for(Size j = idx + 1u; model.size() > j; ++j)
+      {
+        model[j].second += size;
+      }
+    }
+    else if(6 > op)
+    {
+      Size const idx = static_cast<Size>(gen()) % model.size();
+      Int_64 const size = model[idx].first;
+      list.erase(idx);
+      list.shift_suffix(idx, -size);
+      model.erase(model.begin() + idx);
+      for(Size j = idx; model.size() > j; ++j)
+      {
+        model[j].second -= size;
+      }
+    }
+    else
+    {
+      // Resize: replace the value and move the suffix.
+      Size const idx = static_cast<Size>(gen()) % model.size();
+      Int_64 const size = 1 + gen() % 50;
+      Int_64 const delta = size - model[idx].first;
+      list.replace(idx, size);
+      list.shift_suffix(idx + 1u, delta);
+      model[idx].first = size;
+      for(Size j = idx + 1u; model.size() > j; ++j)
+      {
+        model[j].second += delta;
+      }
+    }
+
+    if(0 == i % 150)
+    {
+      snapshots.emplace_back(list.snapshot(), model);
+    }
+  }
+
+  check_offsets(list, model);
+  for(auto const& s: snapshots)
+  {
+    check_offsets(s.first, s.second);
+  }
+
+  Int_64 const total = offset_at(model.size());
+  for(Int_64 off = -1; total + 1 > off; off += 7)
+  {
+    Size lower = 0u;
+    while(model.size() > lower && model[lower].second < off)
+    {
+      ++lower;
+    }
+
+    Size upper = lower;
+    while(model.size() > upper && !(off < model[upper].second))
+    {
+      ++upper;
+    }
+
+    CHECK(lower == list.lower_bound(off));
+    CHECK(upper == list.upper_bound(off));
+  }
+}
+
+TEST_CASE_METHOD(
+  Persistent_list_test,
+  "Persistent list: snapshot scanned by another thread",
+  "[tree++][treexx][stdxx][persistent_list]")
+{
+  Persistent_list<Int_64> list;
+  for(Int_64 i = 0; 5000 > i; ++i)
+  {
+    list.push_back(i);
+  }
+
+  auto const snapshot = list.snapshot();
+  bool ordered = true;
+  ::std::thread scan(
+    [&snapshot, &ordered]()
+    {
+      Int_64 expected = 0;
+      for(Int_64 const x: snapshot)
+      {
+        ordered = ordered && expected == x;
+        ++expected;
+      }
+
+      ordered = ordered && 5000 == expected;
+    });
+
+  Uniform_gen<Size> gen(0u, 1000000u);
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    list.erase(gen() % list.size());
+    list.insert(gen() % (list.size() + 1u), -1);
+  }
+
+  scan.join();
+  CHECK(ordered);
+  CHECK(5000u == list.size());
+  CHECK(5000u == snapshot.size());
+}
+
+} // namespace test::treexx::stdxx
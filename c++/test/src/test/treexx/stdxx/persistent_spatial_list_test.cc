@@ -0,0 +1,182 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/persistent_spatial_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Persistent_spatial_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Persistent_spatial_list =
+    ::treexx::stdxx::persistent_spatial_list<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  // Pairs of (size, data).
+  template<class L>
+  static void check_equal(
+    L const& list,
+    Vector<::std::pair<Size, Int_64>> const& model)
+  {
+    REQUIRE(model.size() == list.size());
+    Size offset = 0u;
+    Size i = 0u;
+    for(auto it = list.begin(); list.end() != it; ++it, ++i)
+    {
+      REQUIRE(model.size() > i);
+      CHECK(model[i].first == it->size());
+      CHECK(model[i].second == it->data());
+      CHECK(offset == it.offset());
+      CHECK(i == it.index());
+      CHECK(it == list.find(i));
+      offset += model[i].first;
+    }
+
+    CHECK(model.size() == i);
+    CHECK(offset == list.extent());
+  }
+};
+
+TEST_CASE_METHOD(
+  Persistent_spatial_list_test,
+  "Persistent spatial list: push with snapshots",
+  "[tree++][treexx][stdxx][persistent_spatial_list]")
+{
+  using Element = ::treexx::stdxx::spatial_list_element<Int_64, Size>;
+  using List = ::treexx::stdxx::persistent_spatial_list<
+    Int_64, Size, ::std::allocator<Element>, true>;
+
+  Uniform_gen<Size> gen(0u, 1000000u);
+  List list;
+  Vector<::std::pair<Size, Int_64>> model;
+  Vector<::std::pair<List, Vector<::std::pair<Size, Int_64>>>> snapshots;
+
+  CHECK(list.empty());
+  CHECK(0u == list.extent());
+  CHECK(list.end() == list.find_offset(0u));
+
+  for(Int_64 i = 0; 1000 > i; ++i)
+  {
+    Size const size = 1u + gen() % 20u;
+    if(0u == gen() % 2u)
+    {
+      CHECK(i == list.emplace_back(size, i).data());
+      model.emplace_back(size, i);
+    }
+    else
+    {
+      CHECK(i == list.emplace_front(size, i).data());
+      model.emplace(model.begin(), size, i);
+    }
+
+    if(0 == i % 100)
+    {
+      snapshots.emplace_back(list.snapshot(), model);
+    }
+  }
+
+  check_equal(list, model);
+  for(auto const& s: snapshots)
+  {
+    check_equal(s.first, s.second);
+  }
+
+  Size offset = 0u;
+  for(Size i = 0u; model.size() > i; ++i)
+  {
+    for(Size j = 0u; model[i].first > j; ++j)
+    {
+      auto const it = list.find_offset(offset + j);
+      REQUIRE(list.end() != it);
+      CHECK(i == it.index());
+    }
+
+    offset += model[i].first;
+  }
+
+  CHECK(list.end() == list.find_offset(offset));
+  list.clear();
+  CHECK(list.empty());
+  check_equal(snapshots.back().first, snapshots.back().second);
+}
+
+TEST_CASE_METHOD(
+  Persistent_spatial_list_test,
+  "Persistent spatial list: frame snapshot read by another thread",
+  "[tree++][treexx][stdxx][persistent_spatial_list]")
+{
+  Persistent_spatial_list<Int_64> list;
+  for(Int_64 i = 0; 2000 > i; ++i)
+  {
+    list.emplace_back(static_cast<Size>(1 + i % 7), i);
+  }
+
+  auto const frame = list.snapshot();
+  bool consistent = true;
+  ::std::thread render(
+    [&frame, &consistent]()
+    {
+      Size offset = 0u;
+      Int_64 expected = 0;
+      for(auto it = frame.begin(); frame.end() != it; ++it)
+      {
+        consistent = consistent &&
+          offset == it.offset() && expected == it->data();
+        offset += it->size();
+        ++expected;
+      }
+
+      consistent = consistent && 2000 == expected && offset == frame.extent();
+    });
+
+  for(Int_64 i = 0; 2000 > i; ++i)
+  {
+    list.emplace_front(static_cast<Size>(3), -i);
+  }
+
+  render.join();
+  CHECK(consistent);
+  CHECK(4000u == list.size());
+  CHECK(2000u == frame.size());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,332 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/epoch_domain.hh>
+#include <treexx/stdxx/rcu_set.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Rcu_set_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using Epoch_domain = ::treexx::stdxx::epoch_domain;
+
+  template<class... T>
+  using Rcu_set = ::treexx::stdxx::rcu_set<T...>;
+
+  template<class... T>
+  using Set = ::std::set<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class S, class M>
+  static void check_equal(S const& set, M const& model)
+  {
+    auto reader = set.domain().make_reader();
+    auto const view = set.read(reader);
+    REQUIRE(model.size() == view.size());
+    auto it = view.begin();
+    for(auto const& val: model)
+    {
+      REQUIRE(view.end() != it);
+      CHECK(val == *it);
+      ++it;
+    }
+
+    CHECK(view.end() == it);
+  }
+};
+
+TEST_CASE_METHOD(
+  Rcu_set_test,
+  "RCU set: single thread insert, erase, lookup",
+  "[tree++][treexx][stdxx][rcu_set]")
+{
+  Uniform_gen<Int_64> gen(0, 2000);
+  Epoch_domain domain(4u);
+  Set<Int_64> model;
+  Rcu_set<Int_64> set(domain);
+  auto reader = domain.make_reader();
+
+  CHECK(set.empty());
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    Int_64 const x = gen();
+    CHECK(model.insert(x).second == set.insert(x));
+    if(0u == i % 3u)
+    {
+      Int_64 const y = gen();
+      CHECK(model.erase(y) == set.erase(y));
+    }
+  }
+
+  CHECK(model.size() == set.size());
+  check_equal(set, model);
+
+  {
+    auto const view = set.read(reader);
+    for(Int_64 x = -1; 2002 > x; ++x)
+    {
+      CHECK((model.find(x) != model.end()) == view.contains(x));
+      auto const lb = model.lower_bound(x);
+      auto const ub = model.upper_bound(x);
+      if(model.end() == lb)
+      {
+        CHECK(view.end() == view.lower_bound(x));
+      }
+      else
+      {
+        CHECK(*lb == *view.lower_bound(x));
+      }
+      if(model.end() == ub)
+      {
+        CHECK(view.end() == view.upper_bound(x));
+      }
+      else
+      {
+        CHECK(*ub == *view.upper_bound(x));
+      }
+    }
+
+    auto rit = view.rbegin();
+    for(auto mit = model.rbegin(); model.rend() != mit; ++mit, ++rit)
+    {
+      CHECK(*mit == *rit);
+    }
+  }
+
+  // Both trees have to agree once the pending change is replayed.
+  set.flush();
+  CHECK(set.insert(5000));
+  model.insert(5000);
+  check_equal(set, model);
+
+  set.clear();
+  model.clear();
+  CHECK(set.empty());
+  check_equal(set, model);
+
+  CHECK(set.insert(7));
+  CHECK(!set.insert(7));
+  CHECK(1u == set.erase(7));
+  CHECK(0u == set.erase(7));
+}
+
+TEST_CASE_METHOD(
+  Rcu_set_test,
+  "RCU set: reader slots",
+  "[tree++][treexx][stdxx][rcu_set]")
+{
+  Epoch_domain domain(2u);
+  auto r_0 = domain.make_reader();
+  {
+    auto r_1 = domain.make_reader();
+    CHECK(r_0);
+    CHECK(r_1);
+    CHECK_THROWS(domain.make_reader());
+  }
+
+  auto r_2 = domain.make_reader();
+  CHECK(r_2);
+}
+
+TEST_CASE_METHOD(
+  Rcu_set_test,
+  "RCU set: concurrent readers and one writer",
+  "[tree++][treexx][stdxx][rcu_set]")
+{
+  static Size constexpr reader_count = 2u;
+  static Int_64 constexpr key_count = 4000;
+
+  // The writer inserts all the keys in ascending order and erases the odd
+  // ones right after. It moves the watermark whenever no write is held back.
+  // Readers check that every even key below the watermark is present and
+  // that the iteration order is strictly ascending.
+  Epoch_domain domain(reader_count);
+  Rcu_set<Int_64> set(domain);
+  Atomic<Int_64> watermark(0);
+  Atomic<bool> done(false);
+  Atomic<Size> failures(0u);
+
+  Vector<::std::thread> readers;
+  for(Size i = 0u; reader_count > i; ++i)
+  {
+    readers.emplace_back(
+      [&set, &watermark, &done, &failures, i]()
+      {
+        auto reader = set.domain().make_reader();
+        Uniform_gen<Int_64> gen(0, key_count);
+        Size iteration = 0u;
+        while(!done.load(::std::memory_order_acquire))
+        {
+          ::std::this_thread::yield();
+          Int_64 const limit = watermark.load(::std::memory_order_acquire);
+          auto const view = set.read(reader);
+          for(Size j = 0u; 64u > j; ++j)
+          {
+            Int_64 const key = (gen() % (limit + 1)) & ~Int_64(1);
+            if(key < limit && !view.contains(key))
+            {
+              failures.fetch_add(1u, ::std::memory_order_relaxed);
+            }
+          }
+
+          if(0u == (iteration++ + i) % 16u)
+          {
+            bool first = true;
+            Int_64 previous = 0;
+            for(Int_64 const x: view)
+            {
+              if(!first && !(previous < x))
+              {
+                failures.fetch_add(1u, ::std::memory_order_relaxed);
+              }
+
+              first = false;
+              previous = x;
+            }
+          }
+        }
+      });
+  }
+
+  for(Int_64 key = 0; key_count > key; ++key)
+  {
+    set.insert(key);
+    if(1 == key % 2)
+    {
+      set.erase(key);
+    }
+    else if(0u == set.backlog())
+    {
+      watermark.store(key, ::std::memory_order_release);
+    }
+
+    if(0 == key % 64)
+    {
+      ::std::this_thread::yield();
+    }
+  }
+
+  done.store(true, ::std::memory_order_release);
+  for(auto& t: readers)
+  {
+    t.join();
+  }
+
+  CHECK(0u == failures.load());
+  set.flush();
+  CHECK(0u == set.backlog());
+  CHECK(static_cast<Size>(key_count / 2) == set.size());
+
+  Set<Int_64> model;
+  for(Int_64 key = 0; key_count > key; key += 2)
+  {
+    model.insert(key);
+  }
+
+  check_equal(set, model);
+}
+
+TEST_CASE_METHOD(
+  Rcu_set_test,
+  "RCU set: writer does not wait for a pinned reader",
+  "[tree++][treexx][stdxx][rcu_set]")
+{
+  Epoch_domain domain(2u);
+  Rcu_set<Int_64> set(domain);
+  Set<Int_64> model;
+  for(Int_64 x = 0; 100 > x; ++x)
+  {
+    set.insert(x);
+    model.insert(x);
+  }
+
+  // The writer starts only once the view pins the published tree.
+  auto reader = domain.make_reader();
+  ::std::future<bool> writer;
+  {
+    auto const view = set.read(reader);
+    writer = ::std::async(
+      ::std::launch::async,
+      [&set, &model]() -> bool
+      {
+        for(Int_64 x = 0; 300 > x; ++x)
+        {
+          if(0 == x % 3)
+          {
+            set.erase(x);
+            model.erase(x);
+          }
+          else
+          {
+            set.insert(x);
+            model.insert(x);
+          }
+        }
+
+        return !set.insert(299) && 0u == set.erase(3);
+      });
+
+    bool const finished = ::std::future_status::ready ==
+      writer.wait_for(::std::chrono::seconds(10));
+    CHECK(finished);
+    CHECK(100u == view.size());
+    CHECK(view.contains(0));
+  }
+
+  CHECK(writer.get());
+  CHECK(0u < set.backlog());
+  set.flush();
+  CHECK(0u == set.backlog());
+  check_equal(set, model);
+
+  CHECK(set.insert(0));
+  CHECK(1u == set.erase(0));
+  set.clear();
+  CHECK(set.empty());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,241 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/seqlock_set.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Seqlock_set_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Seqlock_set = ::treexx::stdxx::seqlock_set<T...>;
+
+  template<class... T>
+  using Set = ::std::set<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Atomic = ::std::atomic<T>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class S, class M>
+  static void check_equal(S const& set, M const& model)
+  {
+    REQUIRE(model.size() == set.size());
+    Size idx = 0u;
+    for(auto const& val: model)
+    {
+      auto const found = set.at_index(idx);
+      REQUIRE(found);
+      CHECK(val == *found);
+      auto const found_idx = set.index_of(val);
+      REQUIRE(found_idx);
+      CHECK(idx == *found_idx);
+      ++idx;
+    }
+
+    CHECK(!set.at_index(idx));
+  }
+};
+
+TEST_CASE_METHOD(
+  Seqlock_set_test,
+  "Seqlock set: single thread insert, erase, lookup",
+  "[tree++][treexx][stdxx][seqlock_set]")
+{
+  Uniform_gen<Int_64> gen(0, 1999);
+  Seqlock_set<Int_64> set;
+  Set<Int_64> model;
+
+  CHECK(set.empty());
+  CHECK(!set.contains(0));
+  CHECK(!set.find(0));
+  CHECK(!set.at_index(0u));
+  CHECK(!set.index_of(0));
+
+  for(int i = 0; 6000 > i; ++i)
+  {
+    Int_64 const key = gen();
+    if(0 == i % 3)
+    {
+      CHECK(model.erase(key) == set.erase(key));
+    }
+    else
+    {
+      CHECK(model.insert(key).second == set.insert(key));
+    }
+
+    bool const present = model.end() != model.find(key);
+    CHECK(present == set.contains(key));
+    auto const found = set.find(key);
+    CHECK(present == static_cast<bool>(found));
+    if(found)
+    {
+      CHECK(key == *found);
+      auto const idx = set.index_of(key);
+      REQUIRE(idx);
+      CHECK(
+        static_cast<Size>(::std::distance(model.begin(), model.find(key))) ==
+        *idx);
+    }
+
+    if(0 == i % 1000)
+    {
+      check_equal(set, model);
+    }
+  }
+
+  check_equal(set, model);
+
+  // Erased nodes are reused rather than freed.
+  Size const capacity = set.capacity();
+  CHECK(model.size() <= capacity);
+  set.clear();
+  model.clear();
+  CHECK(set.empty());
+  CHECK(capacity == set.capacity());
+  check_equal(set, model);
+
+  for(Int_64 key = 0; static_cast<Int_64>(capacity) > key; ++key)
+  {
+    CHECK(set.insert(key));
+    model.insert(key);
+  }
+
+  CHECK(capacity == set.capacity());
+  check_equal(set, model);
+}
+
+TEST_CASE_METHOD(
+  Seqlock_set_test,
+  "Seqlock set: concurrent readers and one writer",
+  "[tree++][treexx][stdxx][seqlock_set]")
+{
+  static Size constexpr reader_count = 3u;
+  static Int_64 constexpr key_count = 4000;
+
+  // The writer inserts all the keys in ascending order and erases the odd
+  // ones right after, so nodes keep being reused. Readers check that every
+  // even key below the published watermark is found and that the smallest
+  // element is 0.
+  Seqlock_set<Int_64> set;
+  Atomic<Int_64> watermark(0);
+  Atomic<bool> done(false);
+  Atomic<Size> failures(0u);
+
+  Vector<::std::thread> readers;
+  for(Size i = 0u; reader_count > i; ++i)
+  {
+    readers.emplace_back(
+      [&set, &watermark, &done, &failures]()
+      {
+        Uniform_gen<Int_64> gen(0, key_count);
+        while(!done.load(::std::memory_order_acquire))
+        {
+          Int_64 const limit = watermark.load(::std::memory_order_acquire);
+          for(Size j = 0u; 64u > j; ++j)
+          {
+            Int_64 const key = (gen() % (limit + 1)) & ~Int_64(1);
+            if(key < limit)
+            {
+              auto const found = set.find(key);
+              auto const idx = set.index_of(key);
+              if(!found || key != *found || !idx)
+              {
+                failures.fetch_add(1u, ::std::memory_order_relaxed);
+              }
+            }
+          }
+
+          if(0 < limit)
+          {
+            auto const first = set.at_index(0u);
+            if(!first || 0 != *first)
+            {
+              failures.fetch_add(1u, ::std::memory_order_relaxed);
+            }
+          }
+
+          ::std::this_thread::yield();
+        }
+      });
+  }
+
+  for(Int_64 key = 0; key_count > key; ++key)
+  {
+    set.insert(key);
+    if(1 == key % 2)
+    {
+      set.erase(key);
+    }
+    else
+    {
+      watermark.store(key, ::std::memory_order_release);
+    }
+
+    if(0 == key % 64)
+    {
+      ::std::this_thread::yield();
+    }
+  }
+
+  done.store(true, ::std::memory_order_release);
+  for(auto& t: readers)
+  {
+    t.join();
+  }
+
+  CHECK(0u == failures.load());
+  CHECK(static_cast<Size>(key_count / 2) == set.size());
+  CHECK(static_cast<Size>(key_count / 2 + 1) == set.capacity());
+
+  Set<Int_64> model;
+  for(Int_64 key = 0; key_count > key; key += 2)
+  {
+    model.insert(key);
+  }
+
+  check_equal(set, model);
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,282 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/sharded_map.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Sharded_map_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Sharded_map = ::treexx::stdxx::sharded_map<T...>;
+
+  template<class... T>
+  using Map = ::std::map<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class M, class K, class V>
+  static void check_equal(M const& map, Map<K, V> const& model)
+  {
+    CHECK(model.size() == map.size());
+    auto it = model.cbegin();
+    bool ordered = true;
+    map.for_each(
+      [&](auto const& x)
+      {
+        ordered = ordered &&
+          model.cend() != it &&
+          it->first == x.first &&
+          it->second == x.second;
+        if(model.cend() != it)
+        {
+          ++it;
+        }
+      });
+
+    CHECK(ordered);
+    CHECK(model.cend() == it);
+  }
+};
+
+TEST_CASE_METHOD(
+  Sharded_map_test,
+  "Sharded map: insert, erase, find against std::map",
+  "[tree++][treexx][stdxx][sharded_map]")
+{
+  Uniform_gen<Int_64> gen(0, 999);
+  Sharded_map<Int_64, String> map(32u);
+  Map<Int_64, String> model;
+
+  CHECK(map.empty());
+  CHECK(1u == map.shard_count());
+
+  for(int i = 0; 6000 > i; ++i)
+  {
+    Int_64 const key = gen();
+    Int_64 const op = gen() % 10;
+    if(5 > op)
+    {
+      String const val = ::std::to_string(i);
+      CHECK(model.emplace(key, val).second == map.try_emplace(key, val));
+    }
+    else if(6 > op)
+    {
+      String const val = "a" + ::std::to_string(i);
+      bool const inserted = model.find(key) == model.end();
+      model[key] = val;
+      CHECK(inserted == map.insert_or_assign(key, val));
+    }
+    else
+    {
+      CHECK(model.erase(key) == map.erase(key));
+    }
+
+    if(0 == i % 500)
+    {
+      check_equal(map, model);
+    }
+  }
+
+  check_equal(map, model);
+  CHECK(1u < map.shard_count());
+
+  for(Int_64 key = -1; 1001 > key; ++key)
+  {
+    auto const found = model.find(key);
+    auto const value = map.get(key);
+    CHECK(map.contains(key) == (model.end() != found));
+    REQUIRE(value.has_value() == (model.end() != found));
+    if(value)
+    {
+      CHECK(found->second == *value);
+    }
+  }
+
+  for(Int_64 first = 0; 1000 > first; first += 37)
+  {
+    Int_64 const last = first + 150;
+    Vector<Int_64> expected;
+    for(auto it = model.lower_bound(first); model.end() != it; ++it)
+    {
+      if(!(it->first < last))
+      {
+        break;
+      }
+
+      expected.push_back(it->first);
+    }
+
+    Vector<Int_64> keys;
+    map.for_each(
+      first, last,
+      [&keys](auto const& x)
+      {
+        keys.push_back(x.first);
+      });
+    CHECK(expected == keys);
+  }
+
+  CHECK(map.visit(
+    model.begin()->first,
+    [](auto& x)
+    {
+      x.second = "visited";
+    }));
+  CHECK("visited" == *map.get(model.begin()->first));
+
+  // Shrinking joins the shards back.
+  Size const shard_count = map.shard_count();
+  for(auto const& x: model)
+  {
+    CHECK(1u == map.erase(x.first));
+  }
+
+  CHECK(map.empty());
+  CHECK(shard_count > map.shard_count());
+
+  map.try_emplace(7, "seven");
+  map.clear();
+  CHECK(map.empty());
+  CHECK(1u == map.shard_count());
+  CHECK(!map.contains(7));
+}
+
+TEST_CASE_METHOD(
+  Sharded_map_test,
+  "Sharded map: try_emplace leaves the arguments of a present key alone",
+  "[tree++][treexx][stdxx][sharded_map]")
+{
+  Sharded_map<Int_64, String> map(8u);
+  for(Int_64 key = 0; 100 > key; ++key)
+  {
+    CHECK(map.try_emplace(key, ::std::to_string(key)));
+  }
+
+  for(Int_64 key = 0; 100 > key; ++key)
+  {
+    String val("other");
+    CHECK(!map.try_emplace(key, static_cast<String&&>(val)));
+    CHECK("other" == val);
+    CHECK(::std::to_string(key) == *map.get(key));
+  }
+
+  String val("assigned");
+  CHECK(!map.insert_or_assign(5, static_cast<String&&>(val)));
+  CHECK("assigned" == *map.get(5));
+  CHECK(100u == map.size());
+  CHECK(1u < map.shard_count());
+}
+
+TEST_CASE_METHOD(
+  Sharded_map_test,
+  "Sharded map: concurrent writers",
+  "[tree++][treexx][stdxx][sharded_map]")
+{
+  static Int_64 constexpr thread_count = 4;
+  static Int_64 constexpr key_count = 3000;
+
+  Sharded_map<Int_64, Int_64> map(64u);
+  Vector<::std::thread> threads;
+  for(Int_64 t = 0; thread_count > t; ++t)
+  {
+    threads.emplace_back(
+      [&map, t]()
+      {
+        // Interleaved key ranges make the writers meet in every shard.
+        for(Int_64 i = 0; key_count > i; ++i)
+        {
+          Int_64 const key = i * thread_count + t;
+          map.try_emplace(key, key);
+          if(0 == i % 3)
+          {
+            map.erase(key);
+          }
+
+          if(0 == i % 64)
+          {
+            ::std::this_thread::yield();
+          }
+        }
+      });
+  }
+
+  // Scans run along with the writers and must always see sorted keys.
+  bool ordered = true;
+  for(int i = 0; 20 > i; ++i)
+  {
+    Int_64 previous = -1;
+    map.for_each(
+      [&](auto const& x)
+      {
+        ordered = ordered && previous < x.first && x.first == x.second;
+        previous = x.first;
+      });
+    ::std::this_thread::yield();
+  }
+
+  for(auto& thread: threads)
+  {
+    thread.join();
+  }
+
+  CHECK(ordered);
+  Map<Int_64, Int_64> model;
+  for(Int_64 i = 0; key_count > i; ++i)
+  {
+    if(0 != i % 3)
+    {
+      for(Int_64 t = 0; thread_count > t; ++t)
+      {
+        Int_64 const key = i * thread_count + t;
+        model.emplace(key, key);
+      }
+    }
+  }
+
+  check_equal(map, model);
+  CHECK(1u < map.shard_count());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,383 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/sparse_sequence_map.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Sparse_sequence_map_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Sparse_sequence_map = ::treexx::stdxx::sparse_sequence_map<T...>;
+
+  template<class... T>
+  using Map = ::std::map<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class Seq, class Model>
+  static void check_equal(Seq const& seq, Model const& model)
+  {
+    REQUIRE(model.size() == seq.size());
+    auto it = seq.begin();
+    for(auto const& x: model)
+    {
+      REQUIRE(seq.end() != it);
+      CHECK(x.first == it.position());
+      CHECK(x.second == *it);
+      ++it;
+    }
+
+    CHECK(seq.end() == it);
+  }
+
+  template<class Model>
+  static void insert_rows(Model& model, Size const pos, Size const count)
+  {
+    Model shifted;
+    for(auto const& x: model)
+    {
+      shifted.emplace(pos > x.first ? x.first : x.first + count, x.second);
+    }
+
+    model.swap(shifted);
+  }
+
+  template<class Model>
+  static Size erase_rows(Model& model, Size const pos, Size const count)
+  {
+    Model shifted;
+    Size erased = 0u;
+    for(auto const& x: model)
+    {
+      if(pos > x.first)
+      {
+        shifted.emplace(x.first, x.second);
+      }
+      else if(pos + count > x.first)
+      {
+        ++erased;
+      }
+      else
+      {
+        shifted.emplace(x.first - count, x.second);
+      }
+    }
+
+    model.swap(shifted);
+    return erased;
+  }
+};
+
+TEST_CASE_METHOD(
+  Sparse_sequence_map_test,
+  "Sparse sequence map: assign, find, erase",
+  "[tree++][treexx][stdxx][sparse_sequence_map]")
+{
+  using Seq = Sparse_sequence_map<Int_64>;
+
+  Uniform_gen<Size> pos_gen(0u, 20000u);
+  Uniform_gen<Int_64> val_gen(-1000000, 1000000);
+  Map<Size, Int_64> model;
+  Seq seq;
+
+  CHECK(seq.empty());
+  CHECK(seq.end() == seq.find(0u));
+  CHECK_THROWS_AS(seq.at(0u), ::std::out_of_range);
+
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    Size const pos = pos_gen();
+    Int_64 const val = val_gen();
+    auto const inserted = model.insert_or_assign(pos, val).second;
+    auto const res = seq.insert_or_assign(pos, val);
+    CHECK(inserted == res.second);
+    CHECK(pos == res.first.position());
+    CHECK(val == *res.first);
+  }
+
+  check_equal(seq, model);
+
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    Size const pos = pos_gen();
+    auto const model_it = model.find(pos);
+    auto const it = seq.find(pos);
+    if(model.end() == model_it)
+    {
+      CHECK(seq.end() == it);
+      CHECK(!seq.contains(pos));
+      CHECK_THROWS_AS(seq.at(pos), ::std::out_of_range);
+    }
+    else
+    {
+      REQUIRE(seq.end() != it);
+      CHECK(model_it->second == *it);
+      CHECK(model_it->second == seq.at(pos));
+    }
+
+    auto const model_lower = model.lower_bound(pos);
+    auto const lower = seq.lower_bound(pos);
+    CHECK((model.end() == model_lower) == (seq.end() == lower));
+    if(model.end() != model_lower)
+    {
+      CHECK(model_lower->first == lower.position());
+    }
+
+    auto const model_upper = model.upper_bound(pos);
+    auto const upper = seq.upper_bound(pos);
+    CHECK((model.end() == model_upper) == (seq.end() == upper));
+    if(model.end() != model_upper)
+    {
+      CHECK(model_upper->first == upper.position());
+    }
+  }
+
+  for(Size i = 0u; 2000u > i; ++i)
+  {
+    Size const pos = pos_gen();
+    CHECK(model.erase(pos) == seq.erase(pos));
+  }
+
+  check_equal(seq, model);
+
+  seq[7u] = 42;
+  model[7u] = 42;
+  CHECK(42 == seq[7u]);
+  check_equal(seq, model);
+
+  Seq const copy(seq);
+  check_equal(copy, model);
+
+  Seq moved(static_cast<Seq&&>(seq));
+  CHECK(seq.empty());
+  check_equal(moved, model);
+
+  moved.clear();
+  CHECK(moved.empty());
+  CHECK(moved.begin() == moved.end());
+}
+
+TEST_CASE_METHOD(
+  Sparse_sequence_map_test,
+  "Sparse sequence map: insert and erase rows",
+  "[tree++][treexx][stdxx][sparse_sequence_map]")
+{
+  using Seq = Sparse_sequence_map<Int_64>;
+
+  Uniform_gen<Size> pos_gen(0u, 5000u);
+  Uniform_gen<Size> count_gen(1u, 300u);
+  Uniform_gen<Size> op_gen(0u, 3u);
+  Uniform_gen<Int_64> val_gen(-1000000, 1000000);
+  Map<Size, Int_64> model;
+  Seq seq;
+
+  for(Size i = 0u; 6000u > i; ++i)
+  {
+    Size const pos = pos_gen();
+    switch(op_gen())
+    {
+    case 0u:
+    case 1u:
+      {
+        Int_64 const val = val_gen();
+        model.insert_or_assign(pos, val);
+        static_cast<void>(seq.insert_or_assign(pos, val));
+      }
+      break;
+    case 2u:
+      {
+        Size const count = count_gen();
+        insert_rows(model, pos, count);
+        seq.insert_rows(pos, count);
+      }
+      break;
+    default:
+      {
+        Size const count = count_gen();
+        CHECK(erase_rows(model, pos, count) == seq.erase_rows(pos, count));
+      }
+      break;
+    }
+
+    if(0u == i % 500u)
+    {
+      check_equal(seq, model);
+    }
+  }
+
+  check_equal(seq, model);
+
+  SECTION("Insert and erase rows at front")
+  {
+    seq.insert_rows(0u, 1000u);
+    insert_rows(model, 0u, 1000u);
+    check_equal(seq, model);
+
+    CHECK(0u == seq.erase_rows(0u, 1000u));
+    static_cast<void>(erase_rows(model, 0u, 1000u));
+    check_equal(seq, model);
+  }
+
+  SECTION("Erase rows to the end")
+  {
+    Size const max_pos = ::std::numeric_limits<Size>::max();
+    Size const pos = seq.begin().position() + 1u;
+    Size const erased = seq.erase_rows(pos, max_pos);
+    CHECK(model.size() - 1u == erased);
+    CHECK(1u == seq.size());
+    CHECK(0u == seq.erase_rows(0u, 0u));
+    CHECK(1u == seq.erase_rows(0u, max_pos));
+    CHECK(seq.empty());
+  }
+}
+
+TEST_CASE_METHOD(
+  Sparse_sequence_map_test,
+  "Sparse sequence map: finger",
+  "[tree++][treexx][stdxx][sparse_sequence_map][finger]")
+{
+  using Seq = Sparse_sequence_map<Int_64>;
+
+  Uniform_gen<Size> pos_gen(0u, 5000u);
+  Uniform_gen<Size> step_gen(0u, 40u);
+  Uniform_gen<Size> count_gen(1u, 300u);
+  Uniform_gen<Size> op_gen(0u, 5u);
+  Uniform_gen<Int_64> val_gen(-1000000, 1000000);
+  Map<Size, Int_64> model;
+  Seq seq;
+  Seq::finger finger;
+  Size pos = 0u;
+
+  // Mostly short forward steps, as in a sorted batch, with a jump now and then.
+  for(Size i = 0u; 8000u > i; ++i)
+  {
+    pos = 0u == i % 50u ? pos_gen() : pos + step_gen();
+    switch(op_gen())
+    {
+    case 0u:
+    case 1u:
+    case 2u:
+      {
+        Int_64 const val = val_gen();
+        bool const inserted = model.insert_or_assign(pos, val).second;
+        auto const res = seq.insert_or_assign(finger, pos, val);
+        CHECK(inserted == res.second);
+        CHECK(pos == res.first.position());
+        CHECK(val == *res.first);
+      }
+      break;
+    case 3u:
+      CHECK(model.erase(pos) == seq.erase(finger, pos));
+      break;
+    case 4u:
+      {
+        Size const count = count_gen();
+        insert_rows(model, pos, count);
+        seq.insert_rows(finger, pos, count);
+      }
+      break;
+    default:
+      {
+        Size const count = count_gen();
+        CHECK(
+          erase_rows(model, pos, count) == seq.erase_rows(finger, pos, count));
+      }
+      break;
+    }
+
+    if(0u == i % 500u)
+    {
+      check_equal(seq, model);
+    }
+  }
+
+  check_equal(seq, model);
+
+  SECTION("Erase everything through the finger")
+  {
+    Size const max_pos = ::std::numeric_limits<Size>::max();
+    CHECK(model.size() == seq.erase_rows(finger, 0u, max_pos));
+    CHECK(seq.empty());
+
+    auto const res = seq.insert_or_assign(finger, 7u, 1);
+    CHECK(res.second);
+    CHECK(7u == res.first.position());
+    CHECK(1u == seq.erase(finger, 7u));
+    CHECK(seq.empty());
+  }
+}
+
+TEST_CASE_METHOD(
+  Sparse_sequence_map_test,
+  "Sparse sequence map: non-trivial values",
+  "[tree++][treexx][stdxx][sparse_sequence_map]")
+{
+  using Seq = Sparse_sequence_map<String>;
+
+  Seq seq;
+  CHECK(seq.try_emplace(10u, "ten").second);
+  CHECK(!seq.try_emplace(10u, "TEN").second);
+  CHECK(seq.try_emplace(20u, 3u, 'x').second);
+  CHECK("ten" == seq.at(10u));
+  CHECK("xxx" == seq.at(20u));
+
+  seq.insert_rows(15u, 5u);
+  CHECK("xxx" == seq.at(25u));
+  CHECK(!seq.contains(20u));
+
+  CHECK(1u == seq.erase_rows(5u, 10u));
+  CHECK("xxx" == seq.at(15u));
+  CHECK(1u == seq.size());
+
+  Seq other;
+  other[3u] = "three";
+  swap(seq, other);
+  CHECK("three" == seq.at(3u));
+  CHECK("xxx" == other.at(15u));
+
+  seq = other;
+  CHECK("xxx" == seq.at(15u));
+  CHECK(1u == seq.size());
+  CHECK(seq.rbegin() != seq.rend());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,191 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/spatial_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Spatial_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+
+  template<class... T>
+  using Spatial_list = ::treexx::stdxx::spatial_list<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+};
+
+TEST_CASE_METHOD(
+  Spatial_list_test,
+  "Spatial list: find offset",
+  "[tree++][treexx][stdxx][spatial_list]")
+{
+  Spatial_list<Int_64> list;
+  auto const& clist = list;
+  CHECK(list.end() == list.find_offset(0u));
+  CHECK(clist.end() == clist.find_offset(0u));
+
+  Uniform_gen<Size> gen(0u, 1000000u);
+  Vector<Size> offsets;
+  Vector<Int_64> data;
+  Size extent = 0u;
+  Int_64 const none = ::std::numeric_limits<Int_64>::min();
+  for(Int_64 i = 0; 3000 > i; ++i)
+  {
+    Size const size = 1u + gen() % 30u;
+    list.emplace_back(size, i);
+    offsets.push_back(extent);
+    data.push_back(i);
+    extent += size;
+  }
+
+  auto const expected = [&offsets, &data, &extent, none](Size const off) -> Int_64
+  {
+    if(extent <= off)
+    {
+      return none;
+    }
+
+    Size lo = 0u;
+    Size hi = offsets.size();
+    while(1u < hi - lo)
+    {
+      Size const mid = lo + (hi - lo) / 2u;
+      (off < offsets[mid] ? hi : lo) = mid;
+    }
+
+    return data[lo];
+  };
+
+  auto const check_find = [&](Size const off)
+  {
+    Int_64 const e = expected(off);
+    auto const it = list.find_offset(off);
+    auto const cit = clist.find_offset(off);
+    if(none == e)
+    {
+      CHECK(list.end() == it);
+      CHECK(clist.end() == cit);
+    }
+    else
+    {
+      REQUIRE(list.end() != it);
+      REQUIRE(clist.end() != cit);
+      CHECK(e == it->data());
+      CHECK(e == cit->data());
+      CHECK(it.offset() <= off);
+      CHECK(off < it.offset() + it->size());
+    }
+  };
+
+  // Scroll down and up by small steps, then jump around.
+  for(Size off = 0u; extent + 50u > off; off += 1u + gen() % 40u)
+  {
+    check_find(off);
+  }
+
+  for(Size off = extent + 50u; 0u < off; off -= 1u + (off - 1u) % 37u)
+  {
+    check_find(off);
+  }
+
+  for(Size i = 0u; 5000u > i; ++i)
+  {
+    check_find(gen() % (extent + 100u));
+  }
+
+  // Mutations invalidate the remembered element.
+  check_find(extent - 1u);
+  for(Int_64 i = 0; 200 > i; ++i)
+  {
+    Size const size = 1u + gen() % 30u;
+    list.emplace_front(size, -i - 2);
+    for(Size& o: offsets)
+    {
+      o += size;
+    }
+
+    offsets.insert(offsets.begin(), 0u);
+    data.insert(data.begin(), -i - 2);
+    extent += size;
+    check_find(gen() % extent);
+    check_find(extent - 1u);
+  }
+}
+
+TEST_CASE_METHOD(
+  Spatial_list_test,
+  "Spatial list: clear",
+  "[tree++][treexx][stdxx][spatial_list]")
+{
+  Spatial_list<Int_64> list;
+  list.clear();
+  CHECK(list.empty());
+
+  Uniform_gen<Size> gen(1u, 30u);
+  Vector<Size> sizes;
+  for(Int_64 i = 0; 500 > i; ++i)
+  {
+    sizes.push_back(gen());
+    list.emplace_back(sizes.back(), i);
+  }
+
+  CHECK(500u == list.size());
+  list.clear();
+  CHECK(list.empty());
+  CHECK(0u == list.size());
+  CHECK(list.end() == list.begin());
+
+  for(Int_64 i = 0; 300 > i; ++i)
+  {
+    list.emplace_front(sizes[static_cast<Size>(i)], -i);
+  }
+
+  Size count = 0u;
+  Int_64 expected = -299;
+  for(auto const& element: list)
+  {
+    CHECK(expected == element.data());
+    ++expected;
+    ++count;
+  }
+
+  CHECK(300u == count);
+}
+
+} // namespace test::treexx::stdxx
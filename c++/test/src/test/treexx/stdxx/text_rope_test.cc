@@ -0,0 +1,359 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/text_rope.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Text_rope_test
+{
+protected:
+  using Size = ::std::size_t;
+  using String = ::std::string;
+  using String_view = ::std::string_view;
+
+  template<bool line_indexed, class... A>
+  using Text_rope = ::treexx::stdxx::text_rope<char, line_indexed, A...>;
+
+  // Allocations left before Limited_allocator starts throwing.
+  static inline Size allocation_budget = ::std::numeric_limits<Size>::max();
+
+  template<class T>
+  struct Limited_allocator
+  {
+    using value_type = T;
+
+    Limited_allocator() noexcept = default;
+
+    template<class U>
+    Limited_allocator(Limited_allocator<U> const&) noexcept
+    {}
+
+    [[nodiscard]] T* allocate(Size const n)
+    {
+      if(1u > allocation_budget)
+      {
+        throw ::std::bad_alloc();
+      }
+
+      --allocation_budget;
+      return ::std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* const p, Size const n) noexcept
+    {
+      ::std::allocator<T>().deallocate(p, n);
+    }
+
+    template<class U>
+    [[nodiscard]] bool operator ==(Limited_allocator<U> const&) const noexcept
+    {
+      return true;
+    }
+
+    template<class U>
+    [[nodiscard]] bool operator !=(Limited_allocator<U> const&) const noexcept
+    {
+      return false;
+    }
+  };
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<bool line_indexed, class... A>
+  static void expect_match(
+    String const& str,
+    Text_rope<line_indexed, A...> const& rope)
+  {
+    REQUIRE(str.size() == rope.size());
+    CHECK(str.empty() == rope.empty());
+    auto const rope_str = rope.str();
+    CHECK(String_view(str) == String_view(rope_str));
+
+    for(Size pos = 0u; str.size() > pos; pos += 7u)
+    {
+      CHECK(str[pos] == rope[pos]);
+    }
+
+    if constexpr(line_indexed)
+    {
+      auto const line_count =
+        static_cast<Size>(::std::count(str.begin(), str.end(), '\n')) + 1u;
+      REQUIRE(line_count == rope.line_count());
+
+      Size line = 0u;
+      Size line_start = 0u;
+      for(Size pos = 0u;; ++pos)
+      {
+        CHECK(line == rope.line_of(pos));
+        if(str.size() <= pos)
+        {
+          break;
+        }
+        if('\n' == str[pos])
+        {
+          ++line;
+          line_start = pos + 1u;
+          CHECK(line_start == rope.line_start(line));
+        }
+      }
+
+      CHECK(0u == rope.line_start(0u));
+    }
+  }
+
+  [[nodiscard]] static String make_text(
+    Uniform_gen<int>& gen,
+    Size const size)
+  {
+    String text;
+    for(Size i = 0u; size > i; ++i)
+    {
+      int const x = gen() % 12;
+      text.push_back(0 == x ? '\n' : static_cast<char>('a' + x));
+    }
+
+    return text;
+  }
+
+  template<bool line_indexed>
+  static void run_random_edits()
+  {
+    Uniform_gen<int> gen(0, 1000000);
+    String str;
+    Text_rope<line_indexed> rope;
+
+    for(Size i = 0u; 3000u > i; ++i)
+    {
+      int const op = gen() % 10;
+      if(4 > op || str.empty())
+      {
+        String const text = make_text(gen, static_cast<Size>(gen() % 20));
+        Size const pos = 2 > op ?
+          str.size() :
+          static_cast<Size>(gen()) % (str.size() + 1u);
+        str.insert(pos, text);
+        rope.insert(pos, text);
+      }
+      else if(7 > op)
+      {
+        Size const pos = static_cast<Size>(gen()) % str.size();
+        Size const count = static_cast<Size>(gen() % 40);
+        str.erase(pos, count);
+        rope.erase(pos, count);
+      }
+      else
+      {
+        Size const pos = static_cast<Size>(gen()) % (str.size() + 1u);
+        Size const count = static_cast<Size>(gen() % 30);
+        CHECK(str.substr(pos, count) == rope.substr(pos, count));
+      }
+
+      if(0u == i % 50u)
+      {
+        expect_match(str, rope);
+      }
+    }
+
+    expect_match(str, rope);
+  }
+};
+
+TEST_CASE_METHOD(
+  Text_rope_test,
+  "Text rope: insert and erase",
+  "[tree++][treexx][stdxx][text_rope]")
+{
+  Text_rope<false> rope(String_view("hello world"));
+  CHECK("hello world" == rope.str());
+  CHECK(1u == rope.piece_count());
+
+  rope.insert(5u, ",");
+  CHECK("hello, world" == rope.str());
+  CHECK(3u == rope.piece_count());
+
+  rope.insert(6u, " dear");
+  CHECK("hello, dear world" == rope.str());
+
+  rope.insert(11u, "est");
+  CHECK("hello, dearest world" == rope.str());
+
+  rope.append("!");
+  CHECK("hello, dearest world!" == rope.str());
+
+  rope.insert(0u, ">> ");
+  CHECK(">> hello, dearest world!" == rope.str());
+
+  rope.erase(3u, 7u);
+  CHECK(">> dearest world!" == rope.str());
+
+  rope.erase(0u, 3u);
+  CHECK("dearest world!" == rope.str());
+
+  rope.erase(4u, 3u);
+  CHECK("dear world!" == rope.str());
+
+  rope.erase(rope.size() - 1u);
+  CHECK("dear world" == rope.str());
+  CHECK("r wo" == rope.substr(3u, 4u));
+  CHECK('w' == rope.at(5u));
+  CHECK_THROWS_AS(rope.at(rope.size()), ::std::out_of_range);
+
+  rope.erase(0u);
+  CHECK(rope.empty());
+  CHECK(0u == rope.piece_count());
+}
+
+TEST_CASE_METHOD(
+  Text_rope_test,
+  "Text rope: typing coalesces pieces",
+  "[tree++][treexx][stdxx][text_rope]")
+{
+  Text_rope<false> rope(String_view("0123456789"));
+  for(char c = 'a'; 'z' >= c; ++c)
+  {
+    rope.insert(static_cast<Size>(5 + (c - 'a')), String_view(&c, 1u));
+  }
+
+  CHECK("01234abcdefghijklmnopqrstuvwxyz56789" == rope.str());
+  CHECK(3u == rope.piece_count());
+
+  for(Size i = 0u; 10u > i; ++i)
+  {
+    rope.append("x");
+  }
+
+  CHECK(4u == rope.piece_count());
+}
+
+TEST_CASE_METHOD(
+  Text_rope_test,
+  "Text rope: line index",
+  "[tree++][treexx][stdxx][text_rope][line]")
+{
+  Text_rope<true> rope(String_view("first\nsecond\nthird"));
+  CHECK(3u == rope.line_count());
+  CHECK(0u == rope.line_of(0u));
+  CHECK(0u == rope.line_of(5u));
+  CHECK(1u == rope.line_of(6u));
+  CHECK(2u == rope.line_of(rope.size()));
+  CHECK(6u == rope.line_start(1u));
+  CHECK(13u == rope.line_start(2u));
+
+  rope.insert(6u, "inserted\n");
+  CHECK(4u == rope.line_count());
+  CHECK(15u == rope.line_start(2u));
+
+  rope.erase(0u, 6u);
+  CHECK(3u == rope.line_count());
+  CHECK(0u == rope.line_start(0u));
+  CHECK(9u == rope.line_start(1u));
+  expect_match(String("inserted\nsecond\nthird"), rope);
+}
+
+TEST_CASE_METHOD(
+  Text_rope_test,
+  "Text rope: failed insert leaves the rope intact",
+  "[tree++][treexx][stdxx][text_rope][line]")
+{
+  using Rope = Text_rope<true, Limited_allocator<char>>;
+
+  String const text("first\nsecond\nthird");
+  String const inserted("one\ntwo\n");
+  String expected(text);
+  expected.insert(8u, inserted);
+
+  bool done = false;
+  for(Size budget = 0u; !done; ++budget)
+  {
+    allocation_budget = ::std::numeric_limits<Size>::max();
+    Rope rope{String_view(text)};
+    rope.insert(3u, "++");
+    rope.erase(3u, 2u);
+
+    allocation_budget = budget;
+    try
+    {
+      rope.insert(8u, inserted);
+      done = true;
+    }
+    catch(::std::bad_alloc const&)
+    {}
+
+    allocation_budget = ::std::numeric_limits<Size>::max();
+    expect_match(done ? expected : text, rope);
+  }
+}
+
+TEST_CASE_METHOD(
+  Text_rope_test,
+  "Text rope: random edits",
+  "[tree++][treexx][stdxx][text_rope]")
+{
+  run_random_edits<false>();
+  run_random_edits<true>();
+}
+
+TEST_CASE_METHOD(
+  Text_rope_test,
+  "Text rope: copy, move, swap",
+  "[tree++][treexx][stdxx][text_rope]")
+{
+  Text_rope<true> rope(String_view("a\nb"));
+  rope.insert(1u, "xyz");
+  rope.insert(0u, "\n");
+
+  Text_rope<true> copy(rope);
+  expect_match(String("\naxyz\nb"), copy);
+  CHECK(1u == copy.piece_count());
+
+  Text_rope<true> moved(static_cast<Text_rope<true>&&>(copy));
+  CHECK(copy.empty());
+  expect_match(String("\naxyz\nb"), moved);
+
+  copy.swap(moved);
+  CHECK(moved.empty());
+  expect_match(String("\naxyz\nb"), copy);
+
+  moved = rope;
+  expect_match(String("\naxyz\nb"), moved);
+  rope.clear();
+  CHECK(rope.empty());
+  CHECK(1u == rope.line_count());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,243 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/timer_queue.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Timer_queue_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Int_64 = ::std::int64_t;
+  using String = ::std::string;
+
+  template<class... T>
+  using Timer_queue = ::treexx::stdxx::timer_queue<T...>;
+
+  template<class... T>
+  using Multimap = ::std::multimap<T...>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+};
+
+TEST_CASE_METHOD(
+  Timer_queue_test,
+  "Timer queue: schedule, cancel, expire",
+  "[tree++][treexx][stdxx][timer_queue]")
+{
+  using Queue = Timer_queue<Size>;
+  using Handle = typename Queue::handle;
+
+  Uniform_gen<Int_64> gen(0, 5000);
+  Multimap<Int_64, Size> model;
+  Vector<Handle> handles;
+  Vector<bool> alive;
+  Queue queue;
+
+  CHECK(queue.empty());
+  CHECK(!queue.next());
+
+  for(Size i = 0u; 4000u > i; ++i)
+  {
+    Int_64 const deadline = gen();
+    model.emplace(deadline, i);
+    handles.emplace_back(queue.schedule(deadline, i));
+    alive.emplace_back(true);
+    CHECK(i == *handles.back());
+    CHECK(deadline == queue.deadline(handles.back()));
+    CHECK(model.begin()->first == queue.next_deadline());
+  }
+
+  CHECK(model.size() == queue.size());
+
+  for(Size i = 0u; handles.size() > i; i += 3u)
+  {
+    Int_64 const deadline = queue.deadline(handles[i]);
+    auto range = model.equal_range(deadline);
+    for(; range.first != range.second; ++range.first)
+    {
+      if(i == range.first->second)
+      {
+        model.erase(range.first);
+        break;
+      }
+    }
+
+    queue.cancel(handles[i]);
+    alive[i] = false;
+  }
+
+  CHECK(model.size() == queue.size());
+  CHECK(model.begin()->first == queue.next_deadline());
+  CHECK(model.begin()->second == *queue.next());
+
+  for(Int_64 now = 0; 5100 > now; now += 97)
+  {
+    Vector<::std::pair<Int_64, Size>> expired;
+    Size const count = queue.expire(
+      now,
+      [&expired](Int_64 const deadline, Size const& val)
+      {
+        expired.emplace_back(deadline, val);
+      });
+    CHECK(expired.size() == count);
+
+    for(auto const& e: expired)
+    {
+      REQUIRE(!model.empty());
+      CHECK(model.begin()->first == e.first);
+      CHECK(model.begin()->second == e.second);
+      CHECK(now >= e.first);
+      model.erase(model.begin());
+    }
+
+    REQUIRE(model.size() == queue.size());
+    if(!model.empty())
+    {
+      CHECK(now < model.begin()->first);
+      CHECK(model.begin()->first == queue.next_deadline());
+    }
+  }
+
+  CHECK(queue.empty());
+  CHECK(0u == queue.deadline_count());
+}
+
+TEST_CASE_METHOD(
+  Timer_queue_test,
+  "Timer queue: postpone and reschedule",
+  "[tree++][treexx][stdxx][timer_queue][postpone]")
+{
+  using Queue = Timer_queue<Size>;
+  using Handle = typename Queue::handle;
+
+  Uniform_gen<Int_64> gen(0, 100000);
+  Vector<Int_64> deadlines;
+  Vector<Handle> handles;
+  Queue queue;
+
+  for(Size i = 0u; 3000u > i; ++i)
+  {
+    deadlines.emplace_back(gen());
+    handles.emplace_back(queue.schedule(deadlines.back(), i));
+  }
+
+  for(Size round = 0u; 200u > round; ++round)
+  {
+    Int_64 const from = gen();
+    Int_64 const delay = gen() % 1000;
+    queue.postpone(from, delay);
+    for(auto& deadline: deadlines)
+    {
+      if(from <= deadline)
+      {
+        deadline += delay;
+      }
+    }
+
+    Size const idx = static_cast<Size>(gen()) % handles.size();
+    deadlines[idx] = gen();
+    queue.reschedule(handles[idx], deadlines[idx]);
+  }
+
+  queue.postpone_all(10);
+  for(auto& deadline: deadlines)
+  {
+    deadline += 10;
+  }
+
+  for(Size i = 0u; handles.size() > i; ++i)
+  {
+    CHECK(i == *handles[i]);
+    CHECK(deadlines[i] == queue.deadline(handles[i]));
+  }
+
+  Int_64 last = 0;
+  Size const count = queue.expire(
+    Int_64(1000000000),
+    [&last](Int_64 const deadline, Size const&)
+    {
+      CHECK(last <= deadline);
+      last = deadline;
+    });
+  CHECK(deadlines.size() == count);
+  CHECK(queue.empty());
+}
+
+TEST_CASE_METHOD(
+  Timer_queue_test,
+  "Timer queue: chrono durations and FIFO order",
+  "[tree++][treexx][stdxx][timer_queue]")
+{
+  using Duration = ::std::chrono::milliseconds;
+  using Queue = Timer_queue<String, Duration>;
+
+  Queue queue;
+  queue.schedule(Duration(20), "c");
+  queue.schedule(Duration(10), "a");
+  auto const h = queue.schedule(Duration(10), "b");
+  queue.schedule(Duration(10), "x");
+  queue.schedule(Duration(30), "d");
+  queue.cancel(queue.schedule(Duration(5), "never"));
+
+  CHECK(Duration(10) == queue.next_deadline());
+  CHECK(3u == queue.deadline_count());
+  queue.postpone(Duration(15), Duration(100));
+  queue.reschedule(h, Duration(25));
+
+  String order;
+  queue.expire(
+    Duration(1000),
+    [&order](Duration const&, String const& val)
+    {
+      order += val;
+    });
+  CHECK("axbcd" == order);
+
+  queue.schedule(Duration(1), "y");
+  Queue moved(static_cast<Queue&&>(queue));
+  CHECK(queue.empty());
+  CHECK(1u == moved.size());
+  moved.clear();
+  CHECK(moved.empty());
+}
+
+} // namespace test::treexx::stdxx
@@ -0,0 +1,166 @@
+/*
+The MIT License (MIT) https://opensource.org/license/mit
+
+Copyright (c) 2013-2024 Roman Panov roman.a.panov@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the “Software”), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <test/util/random/uniform_gen.hh>
+#include <treexx/stdxx/unrolled_spatial_list.hh>
+
+namespace test::treexx::stdxx
+{
+
+class Unrolled_spatial_list_test
+{
+protected:
+  using Size = ::std::size_t;
+  using Uint_32 = ::std::uint32_t;
+
+  template<class S, Size capacity>
+  using Unrolled_spatial_list =
+    ::treexx::stdxx::unrolled_spatial_list<S, capacity>;
+
+  template<class... T>
+  using Vector = ::std::vector<T...>;
+
+  template<class T>
+  using Uniform_gen = ::test::util::random::Uniform_gen<T>;
+
+  template<class L, class S>
+  static void check_equal(L const& list, Vector<S> const& model)
+  {
+    REQUIRE(model.size() == list.size());
+    CHECK(model.empty() == list.empty());
+    S offset = 0u;
+    for(Size i = 0u; model.size() > i; ++i)
+    {
+      CHECK(model[i] == list.element_size(i));
+      CHECK(offset == list.offset(i));
+      CHECK(i == list.find_offset(offset));
+      CHECK(i == list.find_offset(offset + model[i] - 1u));
+      offset += model[i];
+    }
+
+    CHECK(offset == list.extent());
+    CHECK(list.size() == list.find_offset(offset));
+  }
+
+  template<class S, Size capacity>
+  static void run_random(Size const steps)
+  {
+    Uniform_gen<Size> gen(0u, 1000000u);
+    Unrolled_spatial_list<S, capacity> list;
+    Vector<S> model;
+    for(Size step = 0u; steps > step; ++step)
+    {
+      Size const op = gen() % 10u;
+      S const sz = static_cast<S>(1u + gen() % 50u);
+      if(4u > op || model.empty())
+      {
+        Size const idx = gen() % (model.size() + 1u);
+        list.insert(idx, sz);
+        model.insert(model.begin() + idx, sz);
+      }
+      else if(7u > op)
+      {
+        Size const idx = gen() % model.size();
+        list.erase(idx);
+        model.erase(model.begin() + idx);
+      }
+      else
+      {
+        Size const idx = gen() % model.size();
+        list.resize(idx, sz);
+        model[idx] = sz;
+      }
+
+      if(0u == step % 500u)
+      {
+        check_equal(list, model);
+      }
+    }
+
+    check_equal(list, model);
+    while(!model.empty())
+    {
+      Size const idx = gen() % model.size();
+      list.erase(idx);
+      model.erase(model.begin() + idx);
+    }
+
+    check_equal(list, model);
+  }
+};
+
+TEST_CASE_METHOD(
+  Unrolled_spatial_list_test,
+  "Unrolled spatial list: push and find",
+  "[tree++][treexx][stdxx][unrolled_spatial_list]")
+{
+  Unrolled_spatial_list<Size, 32u> list;
+  Vector<Size> model;
+
+  CHECK(list.empty());
+  CHECK(0u == list.extent());
+  CHECK(0u == list.find_offset(0u));
+
+  for(Size i = 0u; 5000u > i; ++i)
+  {
+    Size const size = 1u + i % 7u;
+    if(0u == i % 3u)
+    {
+      list.push_front(size);
+      model.insert(model.begin(), size);
+    }
+    else
+    {
+      list.push_back(size);
+      model.push_back(size);
+    }
+  }
+
+  check_equal(list, model);
+  list.clear();
+  CHECK(list.empty());
+  CHECK(0u == list.extent());
+  list.push_back(5u);
+  CHECK(1u == list.size());
+  CHECK(0u == list.find_offset(4u));
+  CHECK(1u == list.find_offset(5u));
+}
+
+TEST_CASE_METHOD(
+  Unrolled_spatial_list_test,
+  "Unrolled spatial list: random insert, erase and resize",
+  "[tree++][treexx][stdxx][unrolled_spatial_list]")
+{
+  run_random<Uint_32, 4u>(20000u);
+  run_random<Uint_32, 5u>(20000u);
+  run_random<Size, 32u>(20000u);
+  run_random<Uint_32, 64u>(20000u);
+}
+
+} // namespace test::treexx::stdxx